@@ -0,0 +1,84 @@
+/*
+ * FrameFile.h
+ *
+ * Names of frame files in file mode: <client folder>/<minute>/<timestamp>.jpg
+ * Timestamp is in milliseconds with 20 digits, the same as ImageCapture names frames,
+ * so that a frame is found by its timestamp whatever name it was uploaded with.
+ * PersistanceTask writes, reads and indexes frame files with these functions only.
+ */
+
+#ifndef FRAMEFILE_H_
+#define FRAMEFILE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace FrameFile
+{
+	inline std::string FolderName(long long timestamp)
+	{
+		char buf[32];
+
+		sprintf(buf, "%010ld", (long)(timestamp/60000)); //change milliseconds to minutes
+		return buf;
+	}
+
+	inline std::string FileName(long long timestamp)
+	{
+		char buf[32];
+
+		sprintf(buf, "%020lld.jpg", timestamp);
+		return buf;
+	}
+
+	inline long long Timestamp(const std::string & baseName)
+	{
+		return std::atoll(baseName.c_str());
+	}
+
+	//uploaded frame name is the timestamp, with or without leading zeros.
+	inline long long FrameTimestamp(const std::string & frameName)
+	{
+		return std::stoll(frameName);
+	}
+
+	//path of frame file relative to client folder
+	inline std::string RelativePath(long long timestamp)
+	{
+		return FolderName(timestamp) + "/" + FileName(timestamp);
+	}
+
+	//false if file can't be created, count is 1 if frame is written completely.
+	inline bool Write(const std::string & path, const unsigned char * pData, unsigned int size, int & count)
+	{
+		FILE * pF = fopen(path.c_str(), "wb");
+		if(pF == NULL) {
+			return false;
+		}
+		count = fwrite(pData, size, 1, pF);
+		fclose(pF);
+
+		return true;
+	}
+
+	//false if file doesn't exist, is empty or can't be read.
+	inline bool Read(const std::string & path, std::vector<unsigned char> & data)
+	{
+		FILE * pF = fopen(path.c_str(), "rb");
+		if(pF == NULL) {
+			return false;
+		}
+		fseek(pF, 0, SEEK_END);
+		long size = ftell(pF);
+		fseek(pF, 0, SEEK_SET);
+		data.resize(size > 0 ? size : 0);
+		bool rc = (size > 0) && (fread(data.data(), size, 1, pF) == 1);
+		fclose(pF);
+
+		return rc;
+	}
+}
+
+#endif /* FRAMEFILE_H_ */
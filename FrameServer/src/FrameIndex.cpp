@@ -0,0 +1,92 @@
+/*
+ * FrameIndex.cpp
+ */
+
+#include <algorithm>
+
+#include "FrameIndex.h"
+
+void FrameIndex::Add(long long timestamp)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	if(_timestamps.empty() || (timestamp > _timestamps.back())) {
+		_timestamps.push_back(timestamp);
+		return;
+	}
+
+	auto it = std::lower_bound(_timestamps.begin(), _timestamps.end(), timestamp);
+	if((it != _timestamps.end()) && (*it == timestamp)) {
+		return; //the frame was uploaded again
+	}
+	_timestamps.insert(it, timestamp);
+}
+
+void FrameIndex::DeleteBefore(long earliestMinute)
+{
+	long long end = ((long long)earliestMinute + 1) * 60000;
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	auto it = std::lower_bound(_timestamps.begin(), _timestamps.end(), end);
+	_timestamps.erase(_timestamps.begin(), it);
+}
+
+bool FrameIndex::Nearest(long long timestamp, long long & nearest)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	if(_timestamps.empty()) {
+		return false;
+	}
+
+	auto it = std::upper_bound(_timestamps.begin(), _timestamps.end(), timestamp);
+	if(it == _timestamps.begin()) {
+		nearest = _timestamps.front();
+	}
+	else {
+		nearest = *(it - 1);
+	}
+
+	return true;
+}
+
+bool FrameIndex::First(long long & first)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	if(_timestamps.empty()) {
+		return false;
+	}
+	first = _timestamps.front();
+
+	return true;
+}
+
+bool FrameIndex::Last(long long & last)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	if(_timestamps.empty()) {
+		return false;
+	}
+	last = _timestamps.back();
+
+	return true;
+}
+
+void FrameIndex::Range(long long from, long long to, unsigned int maxAmount, std::vector<long long> & timestamps)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	timestamps.clear();
+	auto it = std::lower_bound(_timestamps.begin(), _timestamps.end(), from);
+	for(; (it != _timestamps.end()) && (*it <= to) && (timestamps.size() < maxAmount); it++) {
+		timestamps.push_back(*it);
+	}
+}
+
+unsigned int FrameIndex::Size()
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+	return _timestamps.size();
+}
@@ -0,0 +1,38 @@
+/*
+ * FrameIndex.h
+ */
+
+#ifndef FRAMEINDEX_H_
+#define FRAMEINDEX_H_
+
+#include <deque>
+#include <vector>
+
+#include "Poco/Mutex.h"
+
+/**
+ * Sorted timestamps (milliseconds) of persisted frames of a client.
+ * Frames normally come in order, so adding is appending and retention is removing from front.
+ * Lookups are binary searches, the storage isn't touched.
+ */
+class FrameIndex
+{
+public:
+	void Add(long long timestamp);
+	// remove frames of minutes not later than earliestMinute.
+	void DeleteBefore(long earliestMinute);
+
+	// the latest frame at or before timestamp, or the first frame if there isn't one.
+	bool Nearest(long long timestamp, long long & nearest);
+	bool First(long long & first);
+	bool Last(long long & last);
+	// frames in [from, to], at most maxAmount of them.
+	void Range(long long from, long long to, unsigned int maxAmount, std::vector<long long> & timestamps);
+	unsigned int Size();
+
+private:
+	Poco::Mutex _mutex;
+	std::deque<long long> _timestamps;
+};
+
+#endif /* FRAMEINDEX_H_ */
@@ -10,6 +10,10 @@
 //
 
 #include <iostream>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <atomic>
 
 #include "Poco/Net/HTTPServer.h"
 #include "Poco/Net/HTTPRequestHandler.h"
@@ -30,13 +34,16 @@
 #include "Poco/Util/Option.h"
 #include "Poco/Util/OptionSet.h"
 #include "Poco/Util/HelpFormatter.h"
-#include "Poco/Semaphore.h"
 #include "Poco/TaskManager.h"
 #include "Poco/Path.h"
 #include "Poco/File.h"
 #include "Poco/DirectoryIterator.h"
 
 #include "Logger.h"
+#include "SegmentStore.h"
+#include "FrameIndex.h"
+#include "FrameFile.h"
+#include "SlotFreeList.h"
 
 using Poco::Net::ServerSocket;
 using Poco::Net::HTTPRequestHandler;
@@ -65,7 +72,6 @@ struct PendingFile
 	{
 		IDLE = 0,
 		WRITING,
-		READY,
 		PERSISTING
 	};
 
@@ -75,6 +81,9 @@ struct PendingFile
 	unsigned char * pData;
 	unsigned int actualSize;
 	unsigned int maxSize;
+	//a frame larger than maxSize is held in an oversize buffer borrowed from cache
+	unsigned char * pFrameData; //pData or the oversize buffer
+	int oversizeIndex; //-1 if frame is in pData
 
 	PendingFile()
 	{
@@ -82,27 +91,153 @@ struct PendingFile
 		pData = NULL;
 		maxSize = 0;
 		actualSize = 0;
+		pFrameData = NULL;
+		oversizeIndex = -1;
 	}
 };
 
-struct PendingFileCache
+//upper bounds of write latency buckets in milliseconds, the last bucket has no bound.
+static const unsigned int _latencyBounds[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+static const unsigned int LATENCY_BUCKET_AMOUNT = sizeof(_latencyBounds)/sizeof(_latencyBounds[0]) + 1;
+
+struct PersistanceMetrics
 {
-	Poco::Mutex mutex;
-	Poco::Semaphore * pFrameAvailableSemaphore;
+	unsigned long accepted; //frames queued for persistence
+	unsigned long rejected; //frames rejected because of quota, slot shortage or size
+	unsigned long dropped; //queued frames dropped for newer ones
+	unsigned long persisted;
+	unsigned long failed; //frames failed to be written
+	unsigned int queueDepth; //frames queued or being written
+	unsigned long latencyCounts[LATENCY_BUCKET_AMOUNT];
+
+	PersistanceMetrics()
+	{
+		accepted = 0;
+		rejected = 0;
+		dropped = 0;
+		persisted = 0;
+		failed = 0;
+		queueDepth = 0;
+		for(unsigned int i=0; i<LATENCY_BUCKET_AMOUNT; i++) {
+			latencyCounts[i] = 0;
+		}
+	}
+
+	void AddLatency(Poco::Timestamp::TimeDiff microseconds)
+	{
+		unsigned int i;
+
+		for(i=0; i<LATENCY_BUCKET_AMOUNT - 1; i++)
+		{
+			if(microseconds < (Poco::Timestamp::TimeDiff)_latencyBounds[i] * 1000) {
+				break;
+			}
+		}
+		latencyCounts[i]++;
+	}
+};
 
+struct PendingFileCache
+{
 	std::vector<PendingFile *> pendingFilePtrArray;
-	std::deque<int> availableFrameIndexes;
+	//indexes of IDLE slots, taken by request threads without lock
+	SlotFreeList * pFreeSlots;
+
+	//a few large buffers shared by all slots for frames larger than max_file_size
+	std::vector<unsigned char *> oversizeBuffers;
+	SlotFreeList * pFreeOversizeBuffers;
+	unsigned int oversizeBufferSize;
+	unsigned int maxFrameSize; //larger frames are rejected
+
+	PendingFileCache()
+	{
+		pFreeSlots = nullptr;
+		pFreeOversizeBuffers = nullptr;
+		oversizeBufferSize = 0;
+		maxFrameSize = 0;
+	}
 };
 
 static PendingFileCache * _pCache = NULL;
 static std::string _frameRootFolder;
 static std::vector<std::string> _clientIds;
-static std::vector<PersistanceTask *> _persistanceTaskList;
+//client id to its persistence task, not changed after server starts
+static std::map<std::string, PersistanceTask *> _persistanceTasks;
 static int _maxFramePeriods;
+static bool _segmentStorage; //frames are appended to per-minute segments instead of one file per frame
 static std::string _serverURI;
+static std::string _rawUploadURI;
+static std::string _metricsURI;
+static unsigned int _clientQuota; //max frames of a client queued or being written
+static bool _dropOldest; //drop the oldest queued frame of a client reaching quota instead of rejecting the new one
+static std::atomic<unsigned long> _noSlotRejected; //rejected before client is known
+static std::string _queryURI;
+static std::string _frameURI;
 
 Logger * pLogger;
 
+//the slot is reset for a new frame, it belongs to calling thread until it is released or handed to persistence task.
+static PendingFile * acquireSlot(int & slotIndex)
+{
+	slotIndex = _pCache->pFreeSlots->Pop();
+	if(slotIndex == SlotFreeList::EMPTY) {
+		return nullptr;
+	}
+
+	PendingFile * pFrame = _pCache->pendingFilePtrArray[slotIndex];
+	pFrame->state = PendingFile::WRITING;
+	pFrame->clientId.clear();
+	pFrame->fileName.clear();
+	pFrame->actualSize = 0;
+	pFrame->pFrameData = pFrame->pData;
+	pFrame->oversizeIndex = -1;
+
+	return pFrame;
+}
+
+static void releaseSlot(int slotIndex)
+{
+	PendingFile * pFrame = _pCache->pendingFilePtrArray[slotIndex];
+
+	if(pFrame->oversizeIndex >= 0) {
+		_pCache->pFreeOversizeBuffers->Push(pFrame->oversizeIndex);
+		pFrame->oversizeIndex = -1;
+	}
+	pFrame->pFrameData = pFrame->pData;
+	pFrame->state = PendingFile::IDLE;
+	_pCache->pFreeSlots->Push(slotIndex);
+}
+
+//move frame to an oversize buffer, received data is kept.
+static bool useOversizeBuffer(PendingFile * pFrame)
+{
+	if(_pCache->oversizeBufferSize <= pFrame->maxSize) {
+		return false;
+	}
+	int index = _pCache->pFreeOversizeBuffers->Pop();
+	if(index == SlotFreeList::EMPTY) {
+		return false;
+	}
+
+	pFrame->oversizeIndex = index;
+	pFrame->pFrameData = _pCache->oversizeBuffers[index];
+	memcpy(pFrame->pFrameData, pFrame->pData, pFrame->actualSize);
+
+	return true;
+}
+
+static unsigned int frameCapacity(PendingFile * pFrame)
+{
+	return (pFrame->oversizeIndex < 0) ? pFrame->maxSize : _pCache->oversizeBufferSize;
+}
+
+//query string may follow the path
+static bool isUriPath(const std::string & uri, const std::string & path)
+{
+	return (uri.compare(0, path.size(), path) == 0) &&
+		((uri.size() == path.size()) || (uri[path.size()] == '?'));
+}
+
 class PersistanceTask: public Poco::Task
 {
 public:
@@ -110,13 +245,76 @@ public:
 	{
 		frameFolder = _frameRootFolder;
 		frameFolder.pushDirectory(clientId);
+		pSegmentStore = NULL;
+		if(_segmentStorage) {
+			pSegmentStore = new SegmentStore(frameFolder.toString());
+		}
+	}
+
+	~PersistanceTask()
+	{
+		if(pSegmentStore != NULL) {
+			delete pSegmentStore;
+		}
 	}
 
-	void AddPendingFileIndex(int index)
+	FrameIndex & Index() { return persistedFrames; }
+
+	bool ReadFrame(long long timestamp, std::vector<unsigned char> & data)
+	{
+		if(pSegmentStore != NULL)
+		{
+			SegmentStore::FrameLocation location;
+			if(!pSegmentStore->Find(timestamp, location) || (location.timestamp != timestamp)) {
+				return false;
+			}
+			return pSegmentStore->Read(location, data);
+		}
+
+		//false if file is deleted by retention
+		return FrameFile::Read(framePath(timestamp).toString(), data);
+	}
+
+	//false if client reaches its quota, the slot isn't taken then.
+	bool AddPendingFileIndex(int index)
+	{
+		int droppedIndex = -1;
+		{
+			Poco::ScopedLock<Poco::Mutex> lock(mutex);
+			if(metrics.queueDepth >= _clientQuota)
+			{
+				//the frame being written can't be dropped
+				if(!_dropOldest || pendingFrameIndexes.empty()) {
+					metrics.rejected++;
+					return false;
+				}
+				droppedIndex = pendingFrameIndexes[0];
+				pendingFrameIndexes.pop_front();
+				metrics.dropped++;
+				metrics.queueDepth--;
+			}
+			pendingFrameIndexes.push_back(index);
+			metrics.accepted++;
+			metrics.queueDepth++;
+			event.set(); //trigger the persistance
+		}
+		if(droppedIndex >= 0) {
+			releaseSlot(droppedIndex);
+		}
+
+		return true;
+	}
+
+	void CountRejected()
 	{
 		Poco::ScopedLock<Poco::Mutex> lock(mutex);
-		pendingFrameIndexes.push_back(index);
-		event.set(); //trigger the persistance
+		metrics.rejected++;
+	}
+
+	PersistanceMetrics Metrics()
+	{
+		Poco::ScopedLock<Poco::Mutex> lock(mutex);
+		return metrics;
 	}
 
 private:
@@ -124,6 +322,9 @@ private:
 	std::deque<int> pendingFrameIndexes;
 	Poco::Event event;
 	Poco::Path frameFolder;
+	SegmentStore * pSegmentStore;
+	FrameIndex persistedFrames;
+	PersistanceMetrics metrics;
 	Poco::Timestamp obsoleteFolderCheckTime;
 	const long obsoleteFolderCheckInterval = 60000000; //1 minute
 
@@ -132,6 +333,7 @@ private:
 		int frameIndex;
 
 		pLogger->LogInfo("PersistanceTask " + name() + " starts");
+		loadFrameIndex();
 
 		for(;;)
 		{
@@ -141,10 +343,13 @@ private:
 			event.tryWait(1000); //try to wait for 1 seconds
 
 			//persist pending frames
-			for(;pendingFrameIndexes.empty() == false;)
+			for(;;)
 			{
 				{
 					Poco::ScopedLock<Poco::Mutex> lock(mutex);
+					if(pendingFrameIndexes.empty()) {
+						break;
+					}
 					frameIndex = pendingFrameIndexes[0];
 					pendingFrameIndexes.pop_front();
 				}
@@ -152,36 +357,26 @@ private:
 				auto pFrame = _pCache->pendingFilePtrArray[frameIndex];
 				if(pFrame->state != PendingFile::PERSISTING) {
 					//wrong frame state
+					Poco::ScopedLock<Poco::Mutex> lock(mutex);
+					metrics.queueDepth--;
 					continue;
 				}
 
+				Poco::Timestamp writeTime;
+				bool persisted = false;
 				try
 				{
-					char buf[64];
-					long minute = std::stol(pFrame->fileName)/60000;//change milliseconds to minutes
-					FILE * pF;
-					int count;
-
-					Poco::Path folderPath = frameFolder;
-					sprintf(buf, "%010ld", minute);
-					folderPath.pushDirectory(buf);
-					Poco::File folder(folderPath);
-					if(folder.exists() == false) {
-						folder.createDirectories();
-					}
+					long long timestamp = std::stoll(pFrame->fileName);
 
-					Poco::Path filePath = folderPath;
-					filePath.setFileName(pFrame->fileName + ".jpg");
-					pF = fopen(filePath.toString().c_str(), "wb");
-					if(pF == NULL) {
-						pLogger->LogError("PersistanceTask failed to create: " + filePath.toString());
-						throw Poco::Exception("failed to create file: " + filePath.toString());
+					if(pSegmentStore != NULL) {
+						persisted = pSegmentStore->Append(timestamp, pFrame->pFrameData, pFrame->actualSize);
+					}
+					else {
+						persisted = persistFile(pFrame);
 					}
-					count = fwrite(pFrame->pData, pFrame->actualSize, 1, pF);
-					if(count != 1) {
-						pLogger->LogError("PersistanceTask persistence return code: " + std::to_string(count));
+					if(persisted) {
+						persistedFrames.Add(timestamp);
 					}
-					fclose(pF);
 				}
 				catch(Poco::Exception & e)
 				{
@@ -198,16 +393,94 @@ private:
 
 				{
 					Poco::ScopedLock<Poco::Mutex> lock(mutex);
-					pFrame->state = PendingFile::IDLE;
+					if(persisted) {
+						metrics.persisted++;
+						metrics.AddLatency(writeTime.elapsed());
+					}
+					else {
+						metrics.failed++;
+					}
+					metrics.queueDepth--;
 				}
+				releaseSlot(frameIndex);
 			}
 
 			deleteObsoleteFiles();
 		}
 
+		if(pSegmentStore != NULL) {
+			pSegmentStore->Close();
+		}
 		pLogger->LogInfo("PersistanceTask " + name() + " exits");
 	}
 
+	Poco::Path framePath(long long timestamp)
+	{
+		return Poco::Path(frameFolder, Poco::Path(FrameFile::RelativePath(timestamp)));
+	}
+
+	//index is built from storage once, then maintained as frames are persisted and deleted.
+	void loadFrameIndex()
+	{
+		std::vector<long long> timestamps;
+
+		try
+		{
+			if(pSegmentStore != NULL) {
+				pSegmentStore->Timestamps(timestamps);
+			}
+			else if(Poco::File(frameFolder).exists())
+			{
+				Poco::DirectoryIterator end;
+				for(Poco::DirectoryIterator it(frameFolder); it!=end; it++)
+				{
+					if(it->isDirectory() == false) {
+						continue;
+					}
+					for(Poco::DirectoryIterator fileIt(it.path()); fileIt!=end; fileIt++)
+					{
+						Poco::Path filePath(fileIt.name());
+						if(filePath.getExtension() == "jpg") {
+							timestamps.push_back(FrameFile::Timestamp(filePath.getBaseName()));
+						}
+					}
+				}
+			}
+		}
+		catch(Poco::Exception & e)
+		{
+			pLogger->LogError("PersistanceTask exception in loading frame index: " + e.displayText());
+		}
+
+		std::sort(timestamps.begin(), timestamps.end());
+		for(auto it = timestamps.begin(); it != timestamps.end(); it++) {
+			persistedFrames.Add(*it);
+		}
+		pLogger->LogInfo("PersistanceTask " + name() + " has " + std::to_string(persistedFrames.Size()) + " frames");
+	}
+
+	bool persistFile(PendingFile * pFrame)
+	{
+		int count;
+
+		//file is named by timestamp, ReadFrame finds it with the same name.
+		Poco::Path filePath = framePath(FrameFile::FrameTimestamp(pFrame->fileName));
+		Poco::File folder(filePath.parent());
+		if(folder.exists() == false) {
+			folder.createDirectories();
+		}
+
+		if(!FrameFile::Write(filePath.toString(), pFrame->pFrameData, pFrame->actualSize, count)) {
+			pLogger->LogError("PersistanceTask failed to create: " + filePath.toString());
+			throw Poco::Exception("failed to create file: " + filePath.toString());
+		}
+		if(count != 1) {
+			pLogger->LogError("PersistanceTask persistence return code: " + std::to_string(count));
+		}
+
+		return count == 1;
+	}
+
 	void deleteObsoleteFiles()
 	{
 		if(obsoleteFolderCheckTime.elapsed() < obsoleteFolderCheckInterval)
@@ -218,6 +491,13 @@ private:
 		obsoleteFolderCheckTime.update();
 		long earliestMinute = obsoleteFolderCheckTime.epochMicroseconds()/60000000 - _maxFramePeriods * 60;
 
+		persistedFrames.DeleteBefore(earliestMinute);
+
+		if(pSegmentStore != NULL) {
+			pSegmentStore->DeleteBefore(earliestMinute);
+			return;
+		}
+
 		Poco::Path folderPath = _frameRootFolder;
 		folderPath.pushDirectory(name());
 		Poco::DirectoryIterator it(folderPath);
@@ -255,175 +535,401 @@ private:
 	}
 };
 
-class PersistanceAllocator: public Poco::Task
+class FrameFileHandler: public Poco::Net::PartHandler
 {
 public:
-	PersistanceAllocator(): Task("PersistanceAllocator") { }
-
-private:
+	FrameFileHandler(PendingFile * p)
+	{
+		pFrame = p;
+		overflow = false;
+		noBuffer = false;
+	}
 
-	virtual void runTask() override
+	void handlePart(const MessageHeader& header, std::istream& stream)
 	{
-		pLogger->LogInfo("PersistanceAllocator " + name() + " starts");
+		if(pFrame == nullptr) {
+			return;
+		}
 
-		for(;;)
+		readPart(stream);
+		if((stream.peek() != std::char_traits<char>::eof()) && (pFrame->oversizeIndex < 0))
 		{
-			if(isCancelled()) {
-				break;
+			if(useOversizeBuffer(pFrame)) {
+				readPart(stream);
 			}
-			if(_pCache->pFrameAvailableSemaphore->tryWait(1000) == false) {
-				continue;
+			else if(_pCache->oversizeBufferSize > pFrame->maxSize) {
+				noBuffer = true;
 			}
+		}
+		if(stream.peek() != std::char_traits<char>::eof())
+		{
+			//frame isn't truncated, the rest of form still has to be parsed.
+			overflow = !noBuffer;
+			NullOutputStream nullStream;
+			StreamCopier::copyStream(stream, nullStream);
+		}
+	}
 
-			{
-				Poco::ScopedLock<Poco::Mutex> lock(_pCache->mutex);
-				for(; _pCache->availableFrameIndexes.empty() == false;)
-				{
-					auto frameIndex = _pCache->availableFrameIndexes[0];
-					auto pFrame = _pCache->pendingFilePtrArray[frameIndex];
-
-					_pCache->availableFrameIndexes.pop_front();
+	// frame is larger than the largest buffer.
+	bool Overflow() { return overflow; }
+	// frame is larger than slot buffer and all oversize buffers are in use.
+	bool NoBuffer() { return noBuffer; }
 
-					if(pFrame->state == PendingFile::READY)
-					{
-						int taskIndex;
-						pFrame->state = PendingFile::PERSISTING;
-
-						//assign it to corresponding persistence task
-						for(taskIndex=0; taskIndex<_persistanceTaskList.size(); taskIndex++)
-						{
-							auto pTask = _persistanceTaskList[taskIndex];
-							if(pFrame->clientId == pTask->name()) {
-								pTask->AddPendingFileIndex(frameIndex);
-								break;
-							}
-						}
-						if(taskIndex == _persistanceTaskList.size()) {
-							//no available task is found
-							pFrame->state = PendingFile::IDLE; //ignore the frame data.
-						}
-					}
-					else
-					{
-						pLogger->LogError("PersistanceAllocator frame state not ready: " + std::to_string(pFrame->state));
-					}
-				}
-			}
-		}
+private:
+	FrameFileHandler(): pFrame(nullptr), overflow(false), noBuffer(false) { }
+	PendingFile * pFrame;
+	bool overflow;
+	bool noBuffer;
 
-		pLogger->LogInfo("PersistanceAllocator " + name() + " exits");
+	void readPart(std::istream& stream)
+	{
+		stream.read((char *)(pFrame->pFrameData) + pFrame->actualSize, frameCapacity(pFrame) - pFrame->actualSize);
+		pFrame->actualSize += stream.gcount();
 	}
 };
 
-class FrameFileHandler: public Poco::Net::PartHandler
+
+class UploadRequestHandler: public HTTPRequestHandler
+	/// Return a HTML document with the current date and time.
 {
 public:
-	FrameFileHandler(PendingFile * p)
+	UploadRequestHandler()
 	{
-		pFrame = p;
 	}
 
-	void handlePart(const MessageHeader& header, std::istream& stream)
+	void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+	{
+		const std::string & uri = request.getURI();
+		if(uri == _serverURI) {
+			handleFormUpload(request, response);
+		}
+		else if(uri == _rawUploadURI) {
+			handleRawUpload(request, response);
+		}
+		else {
+			discardBody(request);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+		}
+		//an empty body with length lets client reuse the connection
+		response.setContentLength(0);
+		response.send();
+	}
+
+private:
+	//multipart form with fields "monitorId" and "frameName", frame is in a file part.
+	void handleFormUpload(HTTPServerRequest& request, HTTPServerResponse& response)
 	{
+		int slotIndex;
+		PendingFile * pFrame = acquireSlot(slotIndex);
 		if(pFrame == nullptr) {
+			pLogger->LogError("FrameFileHandler no available pending file slot");
+			_noSlotRejected++;
+			discardBody(request);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
 			return;
 		}
 
-		stream.read((char *)(pFrame->pData) + pFrame->actualSize, pFrame->maxSize - pFrame->actualSize);
-		pFrame->actualSize += stream.gcount();
+		std::string clientId;
+		std::string fileName;
+
+		FrameFileHandler partHandler(pFrame);
+		try
+		{
+			HTMLForm form(request, request.stream(), partHandler);
+
+			for(auto it=form.begin(); it!=form.end(); it++)
+			{
+				if(it->first == "monitorId") {
+					clientId =it->second;
+				}
+				else if(it->first == "frameName") {
+					fileName = it->second;
+				}
+			}
+		}
+		catch(...)
+		{
+			//connection is broken or form is malformed, slot and oversize buffer go back to cache.
+			releaseSlot(slotIndex);
+			throw;
+		}
+
+		if(partHandler.NoBuffer()) {
+			pLogger->LogError("FrameFileHandler no available oversize buffer: " + clientId + " " + fileName);
+			countRejected(clientId);
+			releaseSlot(slotIndex);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+			return;
+		}
+		if(partHandler.Overflow()) {
+			pLogger->LogError("FrameFileHandler frame is too large: " + clientId + " " + fileName);
+			countRejected(clientId);
+			releaseSlot(slotIndex);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_REQUEST_ENTITY_TOO_LARGE);
+			return;
+		}
+		submitFrame(slotIndex, clientId, fileName, response);
 	}
 
-private:
-	FrameFileHandler(): pFrame(nullptr) { }
-	PendingFile * pFrame;
+	//body is the frame itself, client id and frame name are in headers "Monitor-Id" and "Frame-Name".
+	//body is read into slot buffer directly, no multipart parsing.
+	void handleRawUpload(HTTPServerRequest& request, HTTPServerResponse& response)
+	{
+		std::string clientId = request.get("Monitor-Id", "");
+		std::string fileName = request.get("Frame-Name", "");
+
+		if(_persistanceTasks.find(clientId) == _persistanceTasks.end()) {
+			discardBody(request);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_NOT_ACCEPTABLE);
+			return;
+		}
+		if(!request.hasContentLength() || request.getChunkedTransferEncoding()) {
+			discardBody(request);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_LENGTH_REQUIRED);
+			return;
+		}
+
+		Poco::Int64 length = request.getContentLength64();
+		if((length <= 0) || (length > _pCache->maxFrameSize)) {
+			pLogger->LogError("UploadRequestHandler frame is too large: " + clientId + " " + fileName + " " + std::to_string(length));
+			countRejected(clientId);
+			//body isn't read, connection is closed instead.
+			response.setKeepAlive(false);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_REQUEST_ENTITY_TOO_LARGE);
+			return;
+		}
+
+		int slotIndex;
+		PendingFile * pFrame = acquireSlot(slotIndex);
+		if((pFrame != nullptr) && (length > pFrame->maxSize) && !useOversizeBuffer(pFrame)) {
+			releaseSlot(slotIndex);
+			pFrame = nullptr;
+		}
+		if(pFrame == nullptr) {
+			pLogger->LogError("UploadRequestHandler no available pending file slot");
+			countRejected(clientId);
+			discardBody(request);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+			return;
+		}
+
+		try
+		{
+			request.stream().read((char *)(pFrame->pFrameData), length);
+			pFrame->actualSize = request.stream().gcount();
+		}
+		catch(...)
+		{
+			releaseSlot(slotIndex);
+			throw;
+		}
+		if(pFrame->actualSize != length) {
+			pLogger->LogError("UploadRequestHandler incomplete frame: " + clientId + " " + fileName);
+			releaseSlot(slotIndex);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+			return;
+		}
+		submitFrame(slotIndex, clientId, fileName, response);
+	}
+
+	void submitFrame(int slotIndex, const std::string & clientId, const std::string & fileName, HTTPServerResponse& response)
+	{
+		auto taskIt = _persistanceTasks.find(clientId);
+		if(taskIt == _persistanceTasks.end()) {
+			releaseSlot(slotIndex);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_NOT_ACCEPTABLE);
+			return;
+		}
+
+		PendingFile * pFrame = _pCache->pendingFilePtrArray[slotIndex];
+		pFrame->clientId = clientId;
+		pFrame->fileName = fileName;
+		pFrame->state = PendingFile::PERSISTING;
+		if(!taskIt->second->AddPendingFileIndex(slotIndex)) {
+			//persistence of this client falls behind, other clients aren't affected.
+			releaseSlot(slotIndex);
+			response.setStatus(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+			return;
+		}
+		response.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+	}
+
+	void countRejected(const std::string & clientId)
+	{
+		auto taskIt = _persistanceTasks.find(clientId);
+		if(taskIt != _persistanceTasks.end()) {
+			taskIt->second->CountRejected();
+		}
+		else {
+			_noSlotRejected++;
+		}
+	}
+
+	//the whole request has to be read before the next one on a kept-alive connection.
+	void discardBody(HTTPServerRequest& request)
+	{
+		NullOutputStream nullStream;
+		StreamCopier::copyStream(request.stream(), nullStream);
+	}
 };
 
 
-class UploadRequestHandler: public HTTPRequestHandler
-	/// Return a HTML document with the current date and time.
+class FrameQueryRequestHandler: public HTTPRequestHandler
+	/// Answer frame queries from the in-memory frame index, storage is only read to return frame data.
 {
 public:
-	UploadRequestHandler()
+	FrameQueryRequestHandler()
 	{
 	}
 
 	void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
 	{
-		const std::string & uri = request.getURI();
-		if(uri != _serverURI) {
-			response.setStatus(Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+		HTMLForm form(request, request.stream());
+		std::string clientId = form.get("client", "");
+		PersistanceTask * pTask = nullptr;
+
+		auto taskIt = _persistanceTasks.find(clientId);
+		if(taskIt != _persistanceTasks.end()) {
+			pTask = taskIt->second;
 		}
-		else
+
+		long long milliseconds = 0;
+		long long nearest;
+		if((pTask == nullptr) || !parseTimestamp(form.get("milliseconds", ""), milliseconds)) {
+			sendEmpty(response, Poco::Net::HTTPResponse::HTTP_BAD_REQUEST);
+			return;
+		}
+		if(!pTask->Index().Nearest(milliseconds, nearest)) {
+			sendEmpty(response, Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+			return;
+		}
+
+		if(isUriPath(request.getURI(), _frameURI))
 		{
-			int slotIndex;
-			PendingFile * pFrame = nullptr;
-			{
-				//find an IDLE frame slot
-				Poco::ScopedLock<Poco::Mutex> lock(_pCache->mutex);
-				for(int i=0; i<_pCache->pendingFilePtrArray.size(); i++)
-				{
-					auto p = _pCache->pendingFilePtrArray[i];
-					if(p->state != PendingFile::IDLE) {
-						continue;
-					}
-					p->state = PendingFile::WRITING;
-					p->clientId.clear();
-					p->fileName.clear();
-					p->actualSize = 0;
-					pFrame = p;
-					slotIndex = i;
-					break;
-				}
+			std::vector<unsigned char> data;
+			if(!pTask->ReadFrame(nearest, data)) {
+				sendEmpty(response, Poco::Net::HTTPResponse::HTTP_NOT_FOUND);
+				return;
 			}
-			if(pFrame == nullptr) {
-				pLogger->LogError("FrameFileHandler no available pending file slot");
-				response.setStatus(Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+			response.set("Frame-Timestamp", std::to_string(nearest));
+			response.setContentType("image/jpeg");
+			response.sendBuffer(data.data(), data.size());
+			return;
+		}
+
+		long long first = nearest;
+		long long last = nearest;
+		pTask->Index().First(first);
+		pTask->Index().Last(last);
+
+		std::string reply = "{\"client\":\"" + clientId + "\"";
+		reply += ",\"first\":" + std::to_string(first);
+		reply += ",\"last\":" + std::to_string(last);
+		reply += ",\"nearest\":" + std::to_string(nearest);
+
+		//range listing: frames in [milliseconds, to]
+		long long to;
+		if(parseTimestamp(form.get("to", ""), to))
+		{
+			long long limit = MAX_RANGE_AMOUNT;
+			parseTimestamp(form.get("limit", ""), limit);
+			if((limit <= 0) || (limit > MAX_RANGE_AMOUNT)) {
+				limit = MAX_RANGE_AMOUNT;
 			}
-			else
+
+			std::vector<long long> timestamps;
+			pTask->Index().Range(milliseconds, to, limit, timestamps);
+			reply += ",\"frames\":[";
+			for(int i=0; i<timestamps.size(); i++)
 			{
-				std::string clientId;
-				std::string fileName;
+				if(i > 0) {
+					reply += ",";
+				}
+				reply += std::to_string(timestamps[i]);
+			}
+			reply += "]";
+		}
+		reply += "}";
 
-				FrameFileHandler partHandler(pFrame);
-				HTMLForm form(request, request.stream(), partHandler);
+		response.setContentType("application/json");
+		response.sendBuffer(reply.data(), reply.size());
+	}
 
-				for(auto it=form.begin(); it!=form.end(); it++)
-				{
-					if(it->first == "monitorId") {
-						clientId =it->second;
-					}
-					else if(it->first == "frameName") {
-						fileName = it->second;
-					}
-				}
+private:
+	const long long MAX_RANGE_AMOUNT = 10000;
 
-				bool validClient = false;
-				for(int i=0; i<_clientIds.size(); i++)
-				{
-					if(clientId == _clientIds[i]) {
-						validClient = true;
-						break;
-					}
-				}
-				if(validClient == false) {
-					pFrame->state = PendingFile::IDLE;
-					response.setStatus(Poco::Net::HTTPResponse::HTTP_NOT_ACCEPTABLE);
-				}
-				else
-				{
-					{
-						Poco::ScopedLock<Poco::Mutex> lock(_pCache->mutex);
-						pFrame->clientId = clientId;
-						pFrame->fileName = fileName;
-						pFrame->state = PendingFile::READY;
-						_pCache->availableFrameIndexes.push_back(slotIndex);
-						_pCache->pFrameAvailableSemaphore->set();
-					}
-					response.setStatus(Poco::Net::HTTPResponse::HTTP_OK);
+	bool parseTimestamp(const std::string & text, long long & value)
+	{
+		char * pEnd;
+
+		if(text.empty()) {
+			return false;
+		}
+		value = strtoll(text.c_str(), &pEnd, 10);
+		return *pEnd == 0;
+	}
+
+	void sendEmpty(HTTPServerResponse& response, Poco::Net::HTTPResponse::HTTPStatus status)
+	{
+		response.setStatus(status);
+		response.setContentLength(0);
+		response.send();
+	}
+};
+
+
+class MetricsRequestHandler: public HTTPRequestHandler
+	/// Persistence counters of each client in JSON.
+{
+public:
+	MetricsRequestHandler()
+	{
+	}
+
+	void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+	{
+		std::string reply = "{\"rejectedWithoutClient\":" + std::to_string(_noSlotRejected.load());
+		reply += ",\"clientQuota\":" + std::to_string(_clientQuota);
+		reply += ",\"dropPolicy\":\"" + std::string(_dropOldest ? "drop_oldest" : "reject_newest") + "\"";
+		reply += ",\"latencyBoundsMs\":[";
+		for(unsigned int i=0; i<LATENCY_BUCKET_AMOUNT - 1; i++)
+		{
+			if(i > 0) {
+				reply += ",";
+			}
+			reply += std::to_string(_latencyBounds[i]);
+		}
+		reply += "],\"clients\":{";
+
+		for(auto it = _persistanceTasks.begin(); it != _persistanceTasks.end(); it++)
+		{
+			PersistanceMetrics metrics = it->second->Metrics();
+
+			if(it != _persistanceTasks.begin()) {
+				reply += ",";
+			}
+			reply += "\"" + it->first + "\":{";
+			reply += "\"accepted\":" + std::to_string(metrics.accepted);
+			reply += ",\"rejected\":" + std::to_string(metrics.rejected);
+			reply += ",\"dropped\":" + std::to_string(metrics.dropped);
+			reply += ",\"persisted\":" + std::to_string(metrics.persisted);
+			reply += ",\"failed\":" + std::to_string(metrics.failed);
+			reply += ",\"queueDepth\":" + std::to_string(metrics.queueDepth);
+			//the last count is for latencies beyond the last bound
+			reply += ",\"writeLatencyCounts\":[";
+			for(unsigned int i=0; i<LATENCY_BUCKET_AMOUNT; i++)
+			{
+				if(i > 0) {
+					reply += ",";
 				}
+				reply += std::to_string(metrics.latencyCounts[i]);
 			}
+			reply += "]}";
 		}
-		response.send();
+		reply += "}}";
+
+		response.setContentType("application/json");
+		response.sendBuffer(reply.data(), reply.size());
 	}
 };
 
@@ -437,6 +943,14 @@ public:
 
 	HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
 	{
+		const std::string & uri = request.getURI();
+
+		if(isUriPath(uri, _queryURI) || isUriPath(uri, _frameURI)) {
+			return new FrameQueryRequestHandler;
+		}
+		if(isUriPath(uri, _metricsURI)) {
+			return new MetricsRequestHandler;
+		}
 		return new UploadRequestHandler;
 	}
 };
@@ -496,8 +1010,14 @@ protected:
 	{
 		if(_pCache != nullptr)
 		{
-			if(_pCache->pFrameAvailableSemaphore != nullptr) {
-				delete _pCache->pFrameAvailableSemaphore;
+			if(_pCache->pFreeSlots != nullptr) {
+				delete _pCache->pFreeSlots;
+			}
+			if(_pCache->pFreeOversizeBuffers != nullptr) {
+				delete _pCache->pFreeOversizeBuffers;
+			}
+			for(int i=0; i<_pCache->oversizeBuffers.size(); i++) {
+				free(_pCache->oversizeBuffers[i]);
 			}
 
 			for(int i=0; i<_pCache->pendingFilePtrArray.size(); i++)
@@ -525,8 +1045,13 @@ protected:
 			unsigned short port;
 			int requestServiceThreadAmount;
 			int maxQueuedRequest;
+			int keepAliveTimeout;
+			int maxKeepAliveRequests;
 			unsigned int maxPendingFileAmount;
 			unsigned int maxFileSize;
+			unsigned int clientQuota;
+			unsigned int maxOversizeFileSize;
+			unsigned int oversizeBufferAmount;
 			bool bException = false;
 			bool bMemoryShortage = false;
 			HTTPServerParams * pServerParams;
@@ -535,6 +1060,7 @@ protected:
 			std::string logFile;
 			std::string logFileSize;
 			std::string logFileAmount;
+			bool logBinary = false;
 
 			Poco::TaskManager tmLogger;
 
@@ -543,13 +1069,24 @@ protected:
 			{
 				port = (unsigned short) config().getInt("server_port");
 				_serverURI = config().getString("server_uri");
+				_rawUploadURI = config().getString("raw_upload_uri", "/frameUploadRaw");
+				_metricsURI = config().getString("metrics_uri", "/metrics");
+				_queryURI = config().getString("query_uri", "/frameQuery");
+				_frameURI = config().getString("frame_uri", "/frame");
 				requestServiceThreadAmount = config().getInt("max_request_service_thread_amount");
 				maxQueuedRequest = config().getInt("max_queued_request");
+				keepAliveTimeout = config().getInt("keep_alive_timeout", 10);
+				maxKeepAliveRequests = config().getInt("max_keep_alive_requests", 0);
 				maxPendingFileAmount = config().getInt("max_pending_file_amount");
 				maxFileSize = config().getInt("max_file_size");
+				clientQuota = config().getInt("max_pending_file_amount_per_client", 0);
+				_dropOldest = (config().getString("drop_policy", "reject_newest") == "drop_oldest");
+				maxOversizeFileSize = config().getInt("max_oversize_file_size", maxFileSize * 4);
+				oversizeBufferAmount = config().getInt("oversize_buffer_amount", 4);
 
 				_frameRootFolder = config().getString("frames_root_folder");
 				_maxFramePeriods = config().getInt("max_frame_period_hours");
+				_segmentStorage = (config().getString("storage_mode", "files") == "segments");
 
 				for(int i=0; ;i++)
 				{
@@ -567,11 +1104,17 @@ protected:
 					std::cout << "No client is specified in configuration" << "\r\n";
 					return Application::EXIT_CONFIG;
 				}
+				//slots are shared evenly by default, so a slow client can't take all of them.
+				_clientQuota = clientQuota;
+				if(_clientQuota == 0) {
+					_clientQuota = (maxPendingFileAmount + _clientIds.size() - 1) / _clientIds.size();
+				}
 
 				logFolder = config().getString("log_file_folder", "./logs/ImageCapture");
 				logFile = config().getString("log_file_name", "ImageCapture");
 				logFileSize = config().getString("log_file_size", "1M");
 				logFileAmount = config().getString("log_file_amount", "10");
+				logBinary = config().getBool("log_binary", false);
 			}
 			catch(Poco::Exception & e)
 			{
@@ -583,7 +1126,7 @@ protected:
 			}
 
 			//start the logger
-			pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount);
+			pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount, logBinary);
 			pLogger->CopyToConsole(true);
 			tmLogger.start(pLogger);
 			pLogger->LogInfo("**** FrameServer version 1.0.0 ****");
@@ -597,8 +1140,8 @@ protected:
 					throw Poco::Exception("memory shortage");
 				}
 
-				_pCache->pFrameAvailableSemaphore = new Poco::Semaphore(0, maxPendingFileAmount);
-				if(_pCache->pFrameAvailableSemaphore == nullptr) {
+				_pCache->pFreeSlots = new SlotFreeList(maxPendingFileAmount);
+				if(_pCache->pFreeSlots == nullptr) {
 					throw Poco::Exception("memory shortage");
 				}
 
@@ -615,6 +1158,21 @@ protected:
 					}
 					_pCache->pendingFilePtrArray.push_back(p);
 				}
+
+				_pCache->oversizeBufferSize = maxOversizeFileSize;
+				_pCache->maxFrameSize = std::max(maxFileSize, maxOversizeFileSize);
+				_pCache->pFreeOversizeBuffers = new SlotFreeList(oversizeBufferAmount);
+				for(int i=0; i<oversizeBufferAmount; i++)
+				{
+					auto p = (unsigned char *)malloc(maxOversizeFileSize);
+					if(p == NULL) {
+						throw Poco::Exception("memory shortage");
+					}
+					_pCache->oversizeBuffers.push_back(p);
+				}
+				if(oversizeBufferAmount == 0) {
+					_pCache->maxFrameSize = maxFileSize;
+				}
 			}
 			catch(Poco::Exception & e)
 			{
@@ -627,20 +1185,22 @@ protected:
 			}
 			else
 			{
-				Poco::ThreadPool persistTaskPool(1, 1 + _clientIds.size());
+				Poco::ThreadPool persistTaskPool(1, _clientIds.size());
 				Poco::TaskManager persistTaskManager(persistTaskPool);
 
 				for(int i=0; i<_clientIds.size(); i++)
 				{
 					auto p = new PersistanceTask(_clientIds[i]);
-					_persistanceTaskList.push_back(p);
+					_persistanceTasks[_clientIds[i]] = p;
 					persistTaskManager.start(p);
 				}
-				persistTaskManager.start(new PersistanceAllocator);
 
 				pServerParams = new HTTPServerParams;
 				pServerParams->setMaxThreads(requestServiceThreadAmount);
 				pServerParams->setMaxQueued(maxQueuedRequest);
+				pServerParams->setKeepAlive(true);
+				pServerParams->setKeepAliveTimeout(Poco::Timespan(keepAliveTimeout, 0));
+				pServerParams->setMaxKeepAliveRequests(maxKeepAliveRequests); //0 for unlimited
 
 				// set-up a server socket
 				ServerSocket svs(port);
@@ -0,0 +1,415 @@
+/*
+ * SegmentStore.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "Poco/Path.h"
+#include "Poco/File.h"
+#include "Poco/DirectoryIterator.h"
+
+#include "SegmentStore.h"
+#include "Logger.h"
+
+extern Logger * pLogger;
+
+SegmentStore::SegmentStore(const std::string & folder)
+{
+	_folder = folder;
+	_current.minute = 0;
+	_current.dataFd = -1;
+	_current.indexFd = -1;
+	_current.dataSize = 0;
+
+	try
+	{
+		Poco::File folderFile(_folder);
+		if(folderFile.exists() == false) {
+			folderFile.createDirectories();
+		}
+
+		Poco::DirectoryIterator it(_folder);
+		Poco::DirectoryIterator end;
+		for(; it!=end; it++)
+		{
+			Poco::Path path(it.name());
+			if(path.getExtension() == "seg") {
+				_minutes.insert(std::atol(path.getBaseName().c_str()));
+			}
+		}
+	}
+	catch(Poco::Exception & e)
+	{
+		pLogger->LogError("SegmentStore exception in scanning " + _folder + ": " + e.displayText());
+	}
+}
+
+SegmentStore::~SegmentStore()
+{
+	Close();
+}
+
+std::string SegmentStore::segmentPath(long minute, const char * extension)
+{
+	char buf[64];
+
+	sprintf(buf, "%010ld.%s", minute, extension);
+	Poco::Path path(_folder);
+	path.setFileName(buf);
+
+	return path.toString();
+}
+
+void SegmentStore::sortIndex(std::vector<IndexRecord> & index)
+{
+	std::stable_sort(index.begin(), index.end(),
+		[](const IndexRecord & a, const IndexRecord & b) { return a.timestamp < b.timestamp; });
+}
+
+bool SegmentStore::loadIndex(long minute, std::vector<IndexRecord> & index)
+{
+	std::string dataPath = segmentPath(minute, "seg");
+	std::string indexPath = segmentPath(minute, "idx");
+	struct stat dataStat;
+	struct stat indexStat;
+
+	index.clear();
+	if(stat(dataPath.c_str(), &dataStat) != 0) {
+		return false;
+	}
+	if(stat(indexPath.c_str(), &indexStat) != 0) {
+		return false;
+	}
+
+	int fd = open(indexPath.c_str(), O_RDONLY);
+	if(fd < 0) {
+		pLogger->LogError("SegmentStore failed to open: " + indexPath + ", " + strerror(errno));
+		return false;
+	}
+	index.resize(indexStat.st_size / sizeof(IndexRecord));
+	ssize_t size = index.size() * sizeof(IndexRecord);
+	if((size > 0) && (pread(fd, index.data(), size, 0) != size)) {
+		pLogger->LogError("SegmentStore failed to read: " + indexPath);
+		index.clear();
+	}
+	close(fd);
+
+	//records written after the last synchronization may refer to data which didn't reach the disk.
+	for(auto it = index.begin(); it != index.end(); it++)
+	{
+		if(it->offset + it->length > (unsigned long long)dataStat.st_size) {
+			index.erase(it, index.end());
+			break;
+		}
+	}
+	sortIndex(index);
+
+	return true;
+}
+
+bool SegmentStore::openSegment(long minute, Segment & segment)
+{
+	std::string dataPath = segmentPath(minute, "seg");
+	std::string indexPath = segmentPath(minute, "idx");
+
+	//a segment can be reopened after restart, its valid part is kept.
+	loadIndex(minute, segment.index);
+	_indexes.erase(minute);
+	segment.minute = minute;
+	segment.dataSize = 0;
+	for(auto it = segment.index.begin(); it != segment.index.end(); it++) {
+		segment.dataSize = std::max(segment.dataSize, it->offset + it->length);
+	}
+
+	segment.dataFd = open(dataPath.c_str(), O_WRONLY | O_CREAT, 0644);
+	if(segment.dataFd < 0) {
+		pLogger->LogError("SegmentStore failed to create: " + dataPath + ", " + strerror(errno));
+		return false;
+	}
+	segment.indexFd = open(indexPath.c_str(), O_WRONLY | O_CREAT, 0644);
+	if(segment.indexFd < 0) {
+		pLogger->LogError("SegmentStore failed to create: " + indexPath + ", " + strerror(errno));
+		close(segment.dataFd);
+		segment.dataFd = -1;
+		return false;
+	}
+
+	//index is rewritten in timestamp order, garbage after valid part is dropped.
+	size_t indexSize = segment.index.size() * sizeof(IndexRecord);
+	if((ftruncate(segment.dataFd, segment.dataSize) != 0) ||
+		(ftruncate(segment.indexFd, 0) != 0) ||
+		((indexSize > 0) && (pwrite(segment.indexFd, segment.index.data(), indexSize, 0) != (ssize_t)indexSize)))
+	{
+		pLogger->LogError("SegmentStore failed to recover segment: " + dataPath);
+	}
+	lseek(segment.dataFd, segment.dataSize, SEEK_SET);
+	lseek(segment.indexFd, indexSize, SEEK_SET);
+
+	_minutes.insert(minute);
+
+	return true;
+}
+
+void SegmentStore::closeFiles(Segment & segment)
+{
+	close(segment.dataFd);
+	close(segment.indexFd);
+	segment.dataFd = -1;
+	segment.indexFd = -1;
+}
+
+void SegmentStore::detachSegment(Segment & segment, std::vector<Segment> & detached)
+{
+	if(segment.dataFd < 0) {
+		return;
+	}
+
+	//records stay visible to Find while files are being synchronized.
+	_indexes[segment.minute] = std::move(segment.index);
+	segment.index.clear();
+	detached.push_back(segment);
+	segment.dataFd = -1;
+	segment.indexFd = -1;
+}
+
+void SegmentStore::detachSegments(std::vector<Segment> & detached)
+{
+	detachSegment(_current, detached);
+	for(auto it = _lateSegments.begin(); it != _lateSegments.end(); it++) {
+		detachSegment(it->second, detached);
+	}
+	_lateSegments.clear();
+}
+
+void SegmentStore::closeSegments(std::vector<Segment> & segments)
+{
+	for(auto it = segments.begin(); it != segments.end(); it++)
+	{
+		//data first, so that a synchronized index never refers to missing data.
+		if(fdatasync(it->dataFd) != 0) {
+			pLogger->LogError("SegmentStore failed to synchronize data of segment " + std::to_string(it->minute));
+		}
+		if(fdatasync(it->indexFd) != 0) {
+			pLogger->LogError("SegmentStore failed to synchronize index of segment " + std::to_string(it->minute));
+		}
+		closeFiles(*it);
+	}
+	segments.clear();
+}
+
+bool SegmentStore::appendToSegment(Segment & segment, long long timestamp, const unsigned char * pData, unsigned int size)
+{
+	IndexRecord record;
+
+	record.timestamp = timestamp;
+	record.offset = segment.dataSize;
+	record.length = size;
+	record.reserved = 0;
+
+	if(write(segment.dataFd, pData, size) != (ssize_t)size) {
+		pLogger->LogError("SegmentStore failed to write data of segment " + std::to_string(segment.minute) + ", " + strerror(errno));
+		//following frames are written after the valid part
+		lseek(segment.dataFd, segment.dataSize, SEEK_SET);
+		return false;
+	}
+	if(write(segment.indexFd, &record, sizeof(record)) != sizeof(record)) {
+		pLogger->LogError("SegmentStore failed to write index of segment " + std::to_string(segment.minute) + ", " + strerror(errno));
+		lseek(segment.dataFd, segment.dataSize, SEEK_SET);
+		lseek(segment.indexFd, segment.index.size() * sizeof(IndexRecord), SEEK_SET);
+		return false;
+	}
+	segment.dataSize += size;
+
+	//frames normally come in order, insertion keeps index sorted otherwise.
+	auto it = std::upper_bound(segment.index.begin(), segment.index.end(), record,
+		[](const IndexRecord & a, const IndexRecord & b) { return a.timestamp < b.timestamp; });
+	segment.index.insert(it, record);
+
+	return true;
+}
+
+bool SegmentStore::Append(long long timestamp, const unsigned char * pData, unsigned int size)
+{
+	long minute = timestamp/60000;
+	std::vector<Segment> detached;
+	bool rc = false;
+
+	{
+		Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+		if((_current.dataFd >= 0) && (minute < _current.minute))
+		{
+			//a late frame of a closed segment, the segment is kept open for other late frames.
+			auto it = _lateSegments.find(minute);
+			if(it == _lateSegments.end())
+			{
+				Segment segment;
+				if(!openSegment(minute, segment)) {
+					return false;
+				}
+				it = _lateSegments.insert(std::make_pair(minute, segment)).first;
+			}
+			return appendToSegment(it->second, timestamp, pData, size);
+		}
+
+		if((_current.dataFd >= 0) && (minute > _current.minute)) {
+			detachSegments(detached);
+		}
+		if((_current.dataFd >= 0) || openSegment(minute, _current)) {
+			rc = appendToSegment(_current, timestamp, pData, size);
+		}
+	}
+
+	closeSegments(detached);
+
+	return rc;
+}
+
+void SegmentStore::Close()
+{
+	std::vector<Segment> detached;
+
+	{
+		Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+		detachSegments(detached);
+	}
+
+	closeSegments(detached);
+}
+
+const std::vector<SegmentStore::IndexRecord> & SegmentStore::segmentIndex(long minute)
+{
+	if((_current.dataFd >= 0) && (minute == _current.minute)) {
+		return _current.index;
+	}
+	auto lateIt = _lateSegments.find(minute);
+	if(lateIt != _lateSegments.end()) {
+		return lateIt->second.index;
+	}
+
+	auto it = _indexes.find(minute);
+	if(it == _indexes.end())
+	{
+		it = _indexes.insert(std::make_pair(minute, std::vector<IndexRecord>())).first;
+		loadIndex(minute, it->second);
+	}
+
+	return it->second;
+}
+
+bool SegmentStore::Find(long long timestamp, FrameLocation & location)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	if(_minutes.empty()) {
+		return false;
+	}
+
+	//from the segment of timestamp towards earlier ones
+	auto it = _minutes.upper_bound(timestamp/60000);
+	while(it != _minutes.begin())
+	{
+		it--;
+
+		const std::vector<IndexRecord> & index = segmentIndex(*it);
+		IndexRecord key;
+		key.timestamp = timestamp;
+		auto recordIt = std::upper_bound(index.begin(), index.end(), key,
+			[](const IndexRecord & a, const IndexRecord & b) { return a.timestamp < b.timestamp; });
+		if(recordIt != index.begin())
+		{
+			recordIt--;
+			location.timestamp = recordIt->timestamp;
+			location.minute = *it;
+			location.offset = recordIt->offset;
+			location.length = recordIt->length;
+			return true;
+		}
+	}
+
+	//all frames are later than timestamp
+	for(it = _minutes.begin(); it != _minutes.end(); it++)
+	{
+		const std::vector<IndexRecord> & index = segmentIndex(*it);
+		if(!index.empty())
+		{
+			location.timestamp = index.front().timestamp;
+			location.minute = *it;
+			location.offset = index.front().offset;
+			location.length = index.front().length;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SegmentStore::Read(const FrameLocation & location, std::vector<unsigned char> & data)
+{
+	std::string dataPath = segmentPath(location.minute, "seg");
+
+	int fd = open(dataPath.c_str(), O_RDONLY);
+	if(fd < 0) {
+		//segment might be deleted by retention
+		return false;
+	}
+	data.resize(location.length);
+	ssize_t size = pread(fd, data.data(), location.length, location.offset);
+	close(fd);
+	if(size != (ssize_t)location.length) {
+		pLogger->LogError("SegmentStore failed to read frame " + std::to_string(location.timestamp) + " from " + dataPath);
+		data.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void SegmentStore::Timestamps(std::vector<long long> & timestamps)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	timestamps.clear();
+	for(auto it = _minutes.begin(); it != _minutes.end(); it++)
+	{
+		const std::vector<IndexRecord> & index = segmentIndex(*it);
+		for(auto recordIt = index.begin(); recordIt != index.end(); recordIt++) {
+			timestamps.push_back(recordIt->timestamp);
+		}
+	}
+}
+
+void SegmentStore::DeleteBefore(long earliestMinute)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	for(auto it = _minutes.begin(); (it != _minutes.end()) && (*it <= earliestMinute);)
+	{
+		//files to be deleted don't need synchronization
+		if((_current.dataFd >= 0) && (*it == _current.minute)) {
+			closeFiles(_current);
+			_current.index.clear();
+		}
+		auto lateIt = _lateSegments.find(*it);
+		if(lateIt != _lateSegments.end()) {
+			closeFiles(lateIt->second);
+			_lateSegments.erase(lateIt);
+		}
+
+		std::string dataPath = segmentPath(*it, "seg");
+		pLogger->LogInfo("delete segment: " + dataPath);
+		if((unlink(dataPath.c_str()) != 0) && (errno != ENOENT)) {
+			pLogger->LogError("SegmentStore failed to delete: " + dataPath + ", " + strerror(errno));
+		}
+		unlink(segmentPath(*it, "idx").c_str());
+		_indexes.erase(*it);
+		it = _minutes.erase(it);
+	}
+}
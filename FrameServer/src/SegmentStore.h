@@ -0,0 +1,89 @@
+/*
+ * SegmentStore.h
+ */
+
+#ifndef SEGMENTSTORE_H_
+#define SEGMENTSTORE_H_
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+#include "Poco/Mutex.h"
+
+/**
+ * Frames of a client stored in per-minute segments instead of one file per frame.
+ * In client folder, minute M (milliseconds/60000) has
+ *   <M>.seg: JPEG data of frames appended one after another
+ *   <M>.idx: an IndexRecord for each frame in .seg
+ * Segment is synchronized to disk once when it is closed, which happens when the next minute starts.
+ * A closed segment receiving late frames is reopened once and closed together with the current one.
+ * Synchronization is done without the lock, so Find isn't blocked by disk.
+ * Retention deletes whole segments.
+ */
+class SegmentStore
+{
+public:
+	struct FrameLocation
+	{
+		long long timestamp; //milliseconds
+		long minute; //segment of the frame
+		unsigned long long offset;
+		unsigned int length;
+	};
+
+	SegmentStore(const std::string & folder);
+	~SegmentStore();
+
+	bool Append(long long timestamp, const unsigned char * pData, unsigned int size);
+	// synchronize and close current segment.
+	void Close();
+
+	// the latest frame at or before timestamp, or the earliest frame if all frames are later.
+	bool Find(long long timestamp, FrameLocation & location);
+	bool Read(const FrameLocation & location, std::vector<unsigned char> & data);
+	// timestamps of all frames in the store, in order.
+	void Timestamps(std::vector<long long> & timestamps);
+	// delete segments of minutes not later than earliestMinute.
+	void DeleteBefore(long earliestMinute);
+
+private:
+	struct IndexRecord
+	{
+		long long timestamp;
+		unsigned long long offset;
+		unsigned int length;
+		unsigned int reserved;
+	};
+
+	struct Segment
+	{
+		long minute;
+		int dataFd;
+		int indexFd;
+		unsigned long long dataSize;
+		std::vector<IndexRecord> index; //sorted by timestamp
+	};
+
+	std::string _folder;
+	Poco::Mutex _mutex;
+	std::set<long> _minutes; //all segments in folder
+	Segment _current; //segment being appended, dataFd is -1 if it isn't open
+	std::map<long, Segment> _lateSegments; //closed segments reopened for late frames
+	std::map<long, std::vector<IndexRecord>> _indexes; //records of closed segments, loaded from disk once
+
+	std::string segmentPath(long minute, const char * extension);
+	bool openSegment(long minute, Segment & segment);
+	//open segments are detached with _mutex locked, closeSegments synchronizes and closes them without it.
+	void detachSegment(Segment & segment, std::vector<Segment> & detached);
+	void detachSegments(std::vector<Segment> & detached);
+	void closeSegments(std::vector<Segment> & segments);
+	static void closeFiles(Segment & segment);
+	bool appendToSegment(Segment & segment, long long timestamp, const unsigned char * pData, unsigned int size);
+	bool loadIndex(long minute, std::vector<IndexRecord> & index);
+	const std::vector<IndexRecord> & segmentIndex(long minute);
+	static void sortIndex(std::vector<IndexRecord> & index);
+};
+
+#endif /* SEGMENTSTORE_H_ */
@@ -0,0 +1,72 @@
+/*
+ * SlotFreeList.h
+ */
+
+#ifndef SLOTFREELIST_H_
+#define SLOTFREELIST_H_
+
+#include <atomic>
+#include <vector>
+
+/**
+ * Lock-free stack of free slot indexes 0 ~ amount-1.
+ * Head keeps a tag besides the index of top slot, the tag changes in every update
+ * so that a slot popped and pushed back by other threads between read and compare-exchange is detected (ABA).
+ * The most recently freed slot is reused first, its buffer is likely still in cache.
+ */
+class SlotFreeList
+{
+public:
+	static const int EMPTY = -1;
+
+	SlotFreeList(unsigned int amount) : _next(amount)
+	{
+		for(unsigned int i=0; i<amount; i++) {
+			_next[i].store((i + 1 < amount) ? (int)(i + 1) : EMPTY, std::memory_order_relaxed);
+		}
+		_head.store(pack(0, amount > 0 ? 0 : EMPTY));
+	}
+
+	// index of a free slot, or EMPTY if all slots are in use.
+	int Pop()
+	{
+		unsigned long long head = _head.load(std::memory_order_acquire);
+
+		for(;;)
+		{
+			int index = indexOf(head);
+			if(index == EMPTY) {
+				return EMPTY;
+			}
+			//_next[index] may be changed by the owner of popped slot, the tag makes compare-exchange fail then.
+			unsigned long long newHead = pack(tagOf(head) + 1, _next[index].load(std::memory_order_relaxed));
+			if(_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+				return index;
+			}
+		}
+	}
+
+	void Push(int index)
+	{
+		unsigned long long head = _head.load(std::memory_order_relaxed);
+
+		for(;;)
+		{
+			_next[index].store(indexOf(head), std::memory_order_relaxed);
+			unsigned long long newHead = pack(tagOf(head) + 1, index);
+			if(_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+	}
+
+private:
+	std::atomic<unsigned long long> _head; //tag in high 32 bits, index in low 32 bits
+	std::vector<std::atomic<int>> _next;
+
+	static unsigned long long pack(unsigned int tag, int index) { return ((unsigned long long)tag << 32) | (unsigned int)index; }
+	static unsigned int tagOf(unsigned long long head) { return head >> 32; }
+	static int indexOf(unsigned long long head) { return (int)(unsigned int)head; }
+};
+
+#endif /* SLOTFREELIST_H_ */
@@ -0,0 +1,98 @@
+/*
+ * FrameFileCheck.cpp
+ *
+ * Check that a frame persisted in file mode is found again by its timestamp.
+ * Frame names are made the way ImageCapture makes them and the way other clients may send them (no leading zeros).
+ * Frames are written and read with the FrameFile functions called by persistFile and ReadFrame,
+ * and the timestamp is taken back from file name as loadFrameIndex does.
+ * Only creation of minute folder, which FrameServer does with Poco, is done here with mkdir.
+ * Files are really written and read in a temporary folder.
+ *
+ * Build: g++ -O2 -std=c++11 -Wall -Wextra -I../src -o FrameFileCheck FrameFileCheck.cpp
+ * Usage: FrameFileCheck
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+#include "FrameFile.h"
+
+static std::string _root;
+
+//FrameServer persistFile, frame content is its name
+static bool persist(const std::string & frameName)
+{
+	long long timestamp = FrameFile::FrameTimestamp(frameName);
+	int count;
+
+	mkdir((_root + "/" + FrameFile::FolderName(timestamp)).c_str(), 0755);
+	if(!FrameFile::Write(_root + "/" + FrameFile::RelativePath(timestamp), (const unsigned char *)frameName.data(), frameName.size(), count)) {
+		return false;
+	}
+
+	return count == 1;
+}
+
+static int check(const std::string & frameName, long long timestamp)
+{
+	std::vector<unsigned char> data;
+	std::string fileName = FrameFile::FileName(timestamp);
+
+	if(!persist(frameName)) {
+		printf("FAILED: cannot persist %s\n", frameName.c_str());
+		return 1;
+	}
+	//FrameServer ReadFrame
+	if(!FrameFile::Read(_root + "/" + FrameFile::RelativePath(timestamp), data) || (std::string(data.begin(), data.end()) != frameName)) {
+		printf("FAILED: frame %s isn't found by timestamp %lld\n", frameName.c_str(), timestamp);
+		return 1;
+	}
+	//PersistanceTask loadFrameIndex
+	if(FrameFile::Timestamp(fileName.substr(0, fileName.size() - 4)) != timestamp) {
+		printf("FAILED: %s is loaded as another timestamp\n", fileName.c_str());
+		return 1;
+	}
+
+	return 0;
+}
+
+int main()
+{
+	char folder[] = "/tmp/FrameFileCheckXXXXXX";
+	std::vector<long long> timestamps = {0, 59999, 60000, 999999999999LL, 1540000000000LL, 1540000059999LL, 9223372036854775807LL};
+	int failures = 0;
+
+	if(mkdtemp(folder) == NULL) {
+		printf("FrameFileCheck cannot create temporary folder\n");
+		return 1;
+	}
+	_root = folder;
+
+	srand(1);
+	for(int i=0; i<1000; i++) {
+		timestamps.push_back(1500000000000LL + ((long long)rand() << 8) + rand() % 256);
+	}
+
+	for(auto it = timestamps.begin(); it != timestamps.end(); it++)
+	{
+		char frameName[32];
+
+		//ImageCapture
+		sprintf(frameName, "%020lld", *it);
+		failures += check(frameName, *it);
+		//other clients
+		failures += check(std::to_string(*it), *it);
+	}
+
+	printf("%lu timestamps, %d failures\n", (unsigned long)timestamps.size(), failures);
+	std::string command = "rm -rf " + _root;
+	if(system(command.c_str()) != 0) {
+		printf("FrameFileCheck cannot delete %s\n", _root.c_str());
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/*
+ * UploadLoadTest.cpp
+ *
+ * Upload a JPEG file to FrameServer from concurrent connections, the same way as ImageCapture does,
+ * and print uploads per second for each amount of threads.
+ * Each thread has its own kept-alive connection, frame names are unique among all threads.
+ * Client id must be in configuration of FrameServer, max_pending_file_amount limits the frames being persisted,
+ * uploads rejected with HTTP_TOO_MANY_REQUESTS are counted separately.
+ *
+ * Build: g++ -O2 -std=c++11 -o UploadLoadTest UploadLoadTest.cpp -lPocoNet -lPocoFoundation -lpthread
+ * Usage: UploadLoadTest <host> <port> <uri> <client id> <jpeg file> [<seconds>] [<thread amounts>] [raw]
+ *   thread amounts is a comma separated list, 1,2,4,8,16,30 by default.
+ *   raw: frame is uploaded as request body with headers, uri should be raw_upload_uri of FrameServer.
+ *
+ * Comparison: run FrameServer built from the baseline and from the current tree on a multi-core host,
+ * client on another host or on cores not used by FrameServer, same jpeg and configuration, then
+ *   UploadLoadTest <host> <port> <server_uri> <client id> <jpeg file> 10 1,2,4,8,16,30
+ *   UploadLoadTest <host> <port> <raw_upload_uri> <client id> <jpeg file> 10 1,2,4,8,16,30 raw
+ * the baseline has no raw upload, its multipart figures are the reference for both.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTMLForm.h"
+#include "Poco/Net/StringPartSource.h"
+#include "Poco/NullStream.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Exception.h"
+
+struct LoadTestResult
+{
+	std::atomic<long> accepted;
+	std::atomic<long> rejected;
+	std::atomic<long> failed;
+};
+
+static std::string _host;
+static unsigned short _port;
+static std::string _uri;
+static std::string _clientId;
+static std::string _jpeg;
+static std::atomic<long long> _frameName;
+static std::atomic<bool> _stop;
+static bool _raw;
+
+static void uploadThread(LoadTestResult * pResult)
+{
+	Poco::Net::HTTPClientSession session(_host, _port);
+	session.setKeepAlive(true);
+
+	while(!_stop)
+	{
+		try
+		{
+			std::string frameName = std::to_string(_frameName++);
+			Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_POST, _uri, Poco::Net::HTTPMessage::HTTP_1_1);
+			Poco::Net::HTMLForm form;
+			Poco::Net::HTTPResponse response;
+
+			request.setKeepAlive(true);
+			if(_raw)
+			{
+				request.setContentType("application/octet-stream");
+				request.set("Monitor-Id", _clientId);
+				request.set("Frame-Name", frameName);
+				request.setContentLength(_jpeg.size());
+
+				std::ostream & outputStream = session.sendRequest(request);
+				outputStream.write(_jpeg.data(), _jpeg.size());
+			}
+			else
+			{
+				form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
+				form.addPart("file", new Poco::Net::StringPartSource(_jpeg, "application/octet-stream", frameName));
+				form.add("monitorId", _clientId);
+				form.add("frameName", frameName);
+				form.prepareSubmit(request);
+
+				std::ostream & outputStream = session.sendRequest(request);
+				form.write(outputStream);
+			}
+
+			std::istream & responseStream = session.receiveResponse(response);
+			Poco::NullOutputStream nullStream;
+			Poco::StreamCopier::copyStream(responseStream, nullStream);
+
+			if(response.getStatus() == Poco::Net::HTTPResponse::HTTP_OK) {
+				pResult->accepted++;
+			}
+			else if(response.getStatus() == Poco::Net::HTTPResponse::HTTP_TOO_MANY_REQUESTS) {
+				pResult->rejected++;
+			}
+			else {
+				pResult->failed++;
+			}
+		}
+		catch(Poco::Exception & e)
+		{
+			pResult->failed++;
+			session.reset();
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned int seconds = 10;
+	std::vector<unsigned int> threadAmounts = {1, 2, 4, 8, 16, 30};
+
+	if(argc < 6) {
+		fprintf(stderr, "Usage: %s <host> <port> <uri> <client id> <jpeg file> [<seconds>] [<thread amounts>] [raw]\n", argv[0]);
+		return 1;
+	}
+	_host = argv[1];
+	_port = atoi(argv[2]);
+	_uri = argv[3];
+	_clientId = argv[4];
+	if(argc > 6) {
+		seconds = atoi(argv[6]);
+	}
+	if(argc > 7)
+	{
+		std::stringstream list(argv[7]);
+		std::string amount;
+
+		threadAmounts.clear();
+		while(std::getline(list, amount, ',')) {
+			threadAmounts.push_back(atoi(amount.c_str()));
+		}
+	}
+
+	_raw = (argc > 8) && (std::string(argv[8]) == "raw");
+
+	std::ifstream file(argv[5], std::ios::binary);
+	if(!file) {
+		fprintf(stderr, "UploadLoadTest cannot open %s\n", argv[5]);
+		return 1;
+	}
+	std::stringstream content;
+	content << file.rdbuf();
+	_jpeg = content.str();
+
+	//frame names are timestamps in milliseconds, start from now so that retention doesn't delete them at once.
+	_frameName = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+	printf("%lu bytes per frame, %u seconds per round\n", (unsigned long)_jpeg.size(), seconds);
+	printf("threads  uploads/s  rejected/s  failed\n");
+	for(auto it = threadAmounts.begin(); it != threadAmounts.end(); it++)
+	{
+		LoadTestResult result;
+		std::vector<std::thread> threads;
+
+		result.accepted = 0;
+		result.rejected = 0;
+		result.failed = 0;
+		_stop = false;
+
+		auto start = std::chrono::steady_clock::now();
+		for(unsigned int i=0; i<*it; i++) {
+			threads.push_back(std::thread(uploadThread, &result));
+		}
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+		_stop = true;
+		for(auto threadIt = threads.begin(); threadIt != threads.end(); threadIt++) {
+			threadIt->join();
+		}
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		printf("%7u  %9.1f  %10.1f  %6ld\n", *it, result.accepted / elapsed, result.rejected / elapsed, (long)result.failed);
+	}
+
+	return 0;
+}
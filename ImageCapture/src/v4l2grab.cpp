@@ -68,14 +68,18 @@
 #include "Poco/Exception.h"
 #include "Poco/Path.h"
 #include "Poco/File.h"
-#include "Poco/DirectoryIterator.h"
 #include "Poco/Mutex.h"
 #include "Poco/Semaphore.h"
+#include "Poco/Condition.h"
+#include "Poco/Environment.h"
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPRequest.h"
 #include "Poco/Net/HTMLForm.h"
 #include "Poco/Net/HTTPResponse.h"
-#include "Poco/Net/FilePartSource.h"
+#include "Poco/Net/PartSource.h"
+#include "Poco/MemoryStream.h"
+#include "Poco/NullStream.h"
+#include "Poco/StreamCopier.h"
 #include "Poco/ThreadPool.h"
 
 #include "Logger.h"
@@ -106,7 +110,9 @@ enum FrameDataState
 	IDLE = 0,
 	CAPTURING,
 	RAW_DATA_READY,
-	DECODING
+	DECODING,
+	ENCODED,
+	UPLOADING
 };
 
 struct FrameData
@@ -116,8 +122,12 @@ struct FrameData
 	int dataSize;
 	void * pRawFrame;
 	void * pDecodedFrame;
+	void * pJpeg; //encoded frame
+	unsigned long jpegBufferSize;
+	unsigned long jpegSize; //0 if the frame failed to be encoded
 
 	Poco::Timestamp stamp;
+	unsigned long long sequence; //capture order, frames are uploaded in this order
 };
 
 struct FrameCache
@@ -127,6 +137,8 @@ struct FrameCache
 		pSemaphore = NULL;
 		frameAmount = 0;
 		pFrames = NULL;
+		nextSequence = 0;
+		nextUploadSequence = 0;
 	}
 
 	~FrameCache()
@@ -135,9 +147,12 @@ struct FrameCache
 	}
 
 	Poco::Mutex mutex;
-	Poco::Semaphore * pSemaphore;
+	Poco::Semaphore * pSemaphore; //signaled when a frame becomes RAW_DATA_READY
+	Poco::Condition encodedCondition; //signaled with mutex when a frame becomes ENCODED
 	int frameAmount;
 	struct FrameData * pFrames;
+	unsigned long long nextSequence; //sequence of the next captured frame
+	unsigned long long nextUploadSequence; //sequence of the next frame to upload
 } _frameCache;
 
 static int _fd = -1;
@@ -147,13 +162,75 @@ static unsigned int _width;
 static unsigned int _height;
 static int _fps;
 static unsigned char _jpegQuality;
+static bool _jpegRawData; //YUV420 planes are fed to libjpeg without conversion to YUV444
 static std::string _deviceFile;
-std::string _ramdiskFolder;
 std::string _hostServerIp;
 int _hostServerPort;
 std::string _hostServerApi;
 std::string _monitorId;
 int _uploadTimeout;
+static bool _rawUpload; //frame is the request body, not a part of multipart form
+
+/**
+ * Persistent HTTP/1.1 connections to host server, shared by uploading tasks.
+ * A connection is kept alive between uploads, so a frame doesn't pay for TCP connection setup,
+ * and the amount of connections doesn't grow with the amount of uploading tasks.
+ */
+struct UploadSessionPool
+{
+	UploadSessionPool()
+	{
+		pSemaphore = NULL;
+	}
+
+	~UploadSessionPool()
+	{
+		for(unsigned int i=0; i<sessionPtrArray.size(); i++) {
+			delete sessionPtrArray[i];
+		}
+		delete pSemaphore;
+	}
+
+	void Init(int amount)
+	{
+		for(int i=0; i<amount; i++)
+		{
+			Poco::Net::HTTPClientSession * pSession = new Poco::Net::HTTPClientSession(_hostServerIp, _hostServerPort);
+
+			pSession->setKeepAlive(true);
+			pSession->setTimeout(Poco::Timespan(_uploadTimeout, 0));
+			sessionPtrArray.push_back(pSession);
+			idleSessionPtrArray.push_back(pSession);
+		}
+		pSemaphore = new Poco::Semaphore(amount, amount);
+	}
+
+	//wait until a connection is idle
+	Poco::Net::HTTPClientSession * Acquire()
+	{
+		pSemaphore->wait();
+
+		Poco::ScopedLock<Poco::Mutex> lock(mutex);
+		Poco::Net::HTTPClientSession * pSession = idleSessionPtrArray.back();
+		idleSessionPtrArray.pop_back();
+
+		return pSession;
+	}
+
+	void Release(Poco::Net::HTTPClientSession * pSession)
+	{
+		{
+			Poco::ScopedLock<Poco::Mutex> lock(mutex);
+			idleSessionPtrArray.push_back(pSession);
+		}
+		pSemaphore->set();
+	}
+
+	Poco::Mutex mutex;
+	Poco::Semaphore * pSemaphore;
+	std::vector<Poco::Net::HTTPClientSession *> sessionPtrArray;
+	std::vector<Poco::Net::HTTPClientSession *> idleSessionPtrArray;
+} _uploadSessions;
 
 /**
 	Do ioctl and retry if error was EINTR ("A signal was caught during the ioctl() operation."). Parameters are the same as on ioctl.
@@ -174,28 +251,122 @@ static int xioctl(int fd, int request, void* argp)
 }
 
 /**
-	Write image to jpeg file.
+	JPEG destination which writes to jpeg buffer of a frame.
+	The buffer is enlarged if it is full, output is dropped if the buffer cannot be enlarged.
+*/
+struct FrameJpegDestination
+{
+	struct jpeg_destination_mgr pub;
+	struct FrameData * pFrame;
+	bool overflow;
+};
+
+static void jpegInitDestination(j_compress_ptr cinfo)
+{
+	FrameJpegDestination * pDest = (FrameJpegDestination *)cinfo->dest;
+
+	pDest->pub.next_output_byte = (JOCTET *)pDest->pFrame->pJpeg;
+	pDest->pub.free_in_buffer = pDest->pFrame->jpegBufferSize;
+	pDest->overflow = false;
+}
+
+static boolean jpegEmptyOutputBuffer(j_compress_ptr cinfo)
+{
+	FrameJpegDestination * pDest = (FrameJpegDestination *)cinfo->dest;
+	struct FrameData * pFrame = pDest->pFrame;
+	unsigned long newSize = pFrame->jpegBufferSize * 2;
+	void * pNewBuffer = NULL;
+
+	if(!pDest->overflow) {
+		pNewBuffer = realloc(pFrame->pJpeg, newSize);
+	}
+	if(pNewBuffer == NULL)
+	{
+		//keep compressing to the start of buffer, the output is dropped in jpegTermDestination
+		pDest->overflow = true;
+		pDest->pub.next_output_byte = (JOCTET *)pFrame->pJpeg;
+		pDest->pub.free_in_buffer = pFrame->jpegBufferSize;
+		return TRUE;
+	}
 
-	\param img image to write
+	//the whole old buffer is valid output
+	pDest->pub.next_output_byte = (JOCTET *)pNewBuffer + pFrame->jpegBufferSize;
+	pDest->pub.free_in_buffer = newSize - pFrame->jpegBufferSize;
+	pFrame->pJpeg = pNewBuffer;
+	pFrame->jpegBufferSize = newSize;
+
+	return TRUE;
+}
+
+static void jpegTermDestination(j_compress_ptr cinfo)
+{
+	FrameJpegDestination * pDest = (FrameJpegDestination *)cinfo->dest;
+
+	if(pDest->overflow) {
+		pDest->pFrame->jpegSize = 0;
+	}
+	else {
+		pDest->pFrame->jpegSize = pDest->pFrame->jpegBufferSize - pDest->pub.free_in_buffer;
+	}
+}
+
+/**
+	Feed YUV420 planes of raw frame to libjpeg as 4:2:0 components, no conversion is needed.
+	Rows of a plane are read up to a multiple of 16 (Y) or 8 (U and V) samples,
+	the reading stays inside raw frame buffer since it is larger than the image.
+*/
+static void jpegWriteRawData(j_compress_ptr cinfo, unsigned char * img)
+{
+	unsigned char *base_py = img;
+	unsigned char *base_pu = img+(_height*_width);
+	unsigned char *base_pv = img+(_height*_width)+(_height*_width)/4;
+	JSAMPROW yRows[2 * DCTSIZE];
+	JSAMPROW uRows[DCTSIZE];
+	JSAMPROW vRows[DCTSIZE];
+	JSAMPARRAY planes[3] = {yRows, uRows, vRows};
+
+	while (cinfo->next_scanline < cinfo->image_height) {
+		for (unsigned int i = 0; i < 2 * DCTSIZE; i++) {
+			unsigned int line = cinfo->next_scanline + i;
+
+			// rows below the image repeat the last row
+			if (line >= _height) {
+				line = _height - 1;
+			}
+			yRows[i] = base_py+(line*_width);
+			if ((i & 1) == 0) {
+				uRows[i/2] = base_pu+(line/2*_width/2);
+				vRows[i/2] = base_pv+(line/2*_width/2);
+			}
+		}
+		jpeg_write_raw_data(cinfo, planes, 2 * DCTSIZE);
+	}
+}
+
+/**
+	Encode a frame to JPEG in memory.
+
+	\param pFrame frame whose pRawFrame (raw data mode) or pDecodedFrame is encoded to pJpeg
+	\returns false if the frame cannot be encoded
 */
-static void jpegWrite(unsigned char* img, const char* jpegFilename)
+static bool jpegEncode(struct FrameData * pFrame)
 {
 	struct jpeg_compress_struct cinfo;
 	struct jpeg_error_mgr jerr;
+	FrameJpegDestination dest;
 
 	JSAMPROW row_pointer[1];
-	FILE *outfile = fopen( jpegFilename, "wb" );
-
-	// try to open file for saving
-	if (!outfile) {
-		pLogger->LogError("jpegWrite unable to open jpeg file");
-		return;
-	}
 
 	// create jpeg data
 	cinfo.err = jpeg_std_error( &jerr );
 	jpeg_create_compress(&cinfo);
-	jpeg_stdio_dest(&cinfo, outfile);
+
+	dest.pub.init_destination = jpegInitDestination;
+	dest.pub.empty_output_buffer = jpegEmptyOutputBuffer;
+	dest.pub.term_destination = jpegTermDestination;
+	dest.pFrame = pFrame;
+	dest.overflow = false;
+	cinfo.dest = &dest.pub;
 
 	// set image parameters
 	cinfo.image_width = _width;
@@ -208,13 +379,31 @@ static void jpegWrite(unsigned char* img, const char* jpegFilename)
 	// and then adjust quality setting
 	jpeg_set_quality(&cinfo, _jpegQuality, TRUE);
 
-	// start compress
-	jpeg_start_compress(&cinfo, TRUE);
+	if (_jpegRawData) {
+		// Y is 2x2 sampled relative to U and V, same as YUV420
+		cinfo.raw_data_in = TRUE;
+		jpeg_set_colorspace(&cinfo, JCS_YCbCr);
+		cinfo.comp_info[0].h_samp_factor = 2;
+		cinfo.comp_info[0].v_samp_factor = 2;
+		cinfo.comp_info[1].h_samp_factor = 1;
+		cinfo.comp_info[1].v_samp_factor = 1;
+		cinfo.comp_info[2].h_samp_factor = 1;
+		cinfo.comp_info[2].v_samp_factor = 1;
+
+		jpeg_start_compress(&cinfo, TRUE);
+		jpegWriteRawData(&cinfo, (unsigned char *)(pFrame->pRawFrame));
+	}
+	else {
+		unsigned char * img = (unsigned char *)(pFrame->pDecodedFrame);
+
+		// start compress
+		jpeg_start_compress(&cinfo, TRUE);
 
-	// feed data
-	while (cinfo.next_scanline < cinfo.image_height) {
-		row_pointer[0] = &img[cinfo.next_scanline * cinfo.image_width *  cinfo.input_components];
-		jpeg_write_scanlines(&cinfo, row_pointer, 1);
+		// feed data
+		while (cinfo.next_scanline < cinfo.image_height) {
+			row_pointer[0] = &img[cinfo.next_scanline * cinfo.image_width *  cinfo.input_components];
+			jpeg_write_scanlines(&cinfo, row_pointer, 1);
+		}
 	}
 
 	// finish compression
@@ -223,8 +412,12 @@ static void jpegWrite(unsigned char* img, const char* jpegFilename)
 	// destroy jpeg data
 	jpeg_destroy_compress(&cinfo);
 
-	// close output file
-	fclose(outfile);
+	if(pFrame->jpegSize == 0) {
+		pLogger->LogError("jpegEncode not enough memory for jpeg data");
+		return false;
+	}
+
+	return true;
 }
 
 /**
@@ -278,8 +471,9 @@ static int frameRead(void)
 			Poco::ScopedLock<Poco::Mutex> lock(_frameCache.mutex);
 
 			pFrameData->stamp.update();
+			pFrameData->sequence = _frameCache.nextSequence++;
 			pFrameData->state = RAW_DATA_READY;
-			_frameCache.pSemaphore->set();//trigger an uploading task.
+			_frameCache.pSemaphore->set();//trigger an encoding task.
 		}
 	}
 
@@ -527,10 +721,41 @@ private:
 	}
 };
 
-class UploadingTask: public Poco::Task
+/**
+ * Multipart form part which reads JPEG data of a frame in place.
+ */
+class FramePartSource: public Poco::Net::PartSource
 {
 public:
-	UploadingTask():Task("uploading")
+	FramePartSource(const char * pData, std::size_t size, const std::string & frameName):
+		PartSource("application/octet-stream"),
+		_stream(pData, size),
+		_frameName(frameName)
+	{
+	}
+
+	std::istream& stream() override
+	{
+		return _stream;
+	}
+
+	const std::string& filename() const override
+	{
+		return _frameName;
+	}
+
+private:
+	Poco::MemoryInputStream _stream;
+	std::string _frameName;
+};
+
+/**
+ * Converts and encodes raw frames, several encoding tasks run in parallel.
+ */
+class EncodingTask: public Poco::Task
+{
+public:
+	EncodingTask():Task("encoding")
 	{
 	}
 
@@ -540,55 +765,102 @@ private:
 		for(;;)
 		{
 			struct FrameData * pFrame = NULL;
-			long long milliseconds;
-			char fileName[64];
-			Poco::Path jpegFilePath = _ramdiskFolder;
-
-			_frameCache.pSemaphore->wait();
 
 			if(isCancelled()) {
 				break;
 			}
+			if(_frameCache.pSemaphore->tryWait(1000) == false) {
+				continue;
+			}
 
-			//find a pending frame
+			//the oldest raw frame is encoded first, so that uploading seldom waits for a frame.
 			{
 				Poco::ScopedLock<Poco::Mutex> lock(_frameCache.mutex);
-				for(int i=0; i<_frameCache.frameAmount; i++) {
-					if(_frameCache.pFrames[i].state == RAW_DATA_READY) {
+				for(int i=0; i<_frameCache.frameAmount; i++)
+				{
+					if(_frameCache.pFrames[i].state != RAW_DATA_READY) {
+						continue;
+					}
+					if((pFrame == NULL) || (_frameCache.pFrames[i].sequence < pFrame->sequence)) {
 						pFrame = &(_frameCache.pFrames[i]);
-						_frameCache.pFrames[i].state = DECODING;
-						break;
 					}
 				}
+				if(pFrame != NULL) {
+					pFrame->state = DECODING;
+				}
 			}
 
 			if(pFrame == NULL) {
-				pLogger->LogError("UploadingTask: no raw frame is ready");
+				pLogger->LogError("EncodingTask: no raw frame is ready");
 				continue;
 			}
 
-			//transcoding
-			YUV420toYUV444(_width, _height, (unsigned char *)(pFrame->pRawFrame), (unsigned char *)(pFrame->pDecodedFrame));
+			//transcoding, raw data mode encodes YUV420 directly
+			if(!_jpegRawData) {
+				YUV420toYUV444(_width, _height, (unsigned char *)(pFrame->pRawFrame), (unsigned char *)(pFrame->pDecodedFrame));
+			}
 
-			//write to JPEG file
-			milliseconds = pFrame->stamp.raw()/1000;
-			sprintf(fileName, "%020lld", milliseconds);
-			jpegFilePath.setFileName(fileName);
-			jpegWrite((unsigned char *)(pFrame->pDecodedFrame), jpegFilePath.toString().c_str());
+			//encode to JPEG, a frame failing to be encoded is still passed to uploading to keep the order.
+			if(jpegEncode(pFrame) == false) {
+				pFrame->jpegSize = 0;
+			}
 
-			//upload JPEG file
-			Poco::File jpegFile(jpegFilePath);
-			if(jpegFile.exists()) {
-				uploadFile(jpegFilePath.toString());
-				jpegFile.remove(false); //delete the file
+			{
+				Poco::ScopedLock<Poco::Mutex> lock(_frameCache.mutex);
+				pFrame->state = ENCODED;
+				_frameCache.encodedCondition.broadcast();
 			}
-			else {
-				pLogger->LogError("UploadingTask: failed to save jpeg file: " + jpegFilePath.toString());
+		}
+
+		pLogger->LogInfo("encoding task exit");
+	}
+};
+
+/**
+ * Uploads encoded frames in capture order.
+ * Each uploading task takes the next frame in sequence, so uploads start in timestamp order.
+ */
+class UploadingTask: public Poco::Task
+{
+public:
+	UploadingTask():Task("uploading")
+	{
+	}
+
+private:
+	virtual void runTask() override
+	{
+		for(;;)
+		{
+			struct FrameData * pFrame = NULL;
+			long long milliseconds;
+			char frameName[64];
+
+			//wait for the next frame in sequence
+			{
+				Poco::ScopedLock<Poco::Mutex> lock(_frameCache.mutex);
+				while(!isCancelled())
+				{
+					pFrame = nextEncodedFrame();
+					if(pFrame != NULL) {
+						break;
+					}
+					_frameCache.encodedCondition.tryWait(_frameCache.mutex, 1000);
+				}
+				if(pFrame == NULL) {
+					break; //cancelled
+				}
+				pFrame->state = UPLOADING;
+				_frameCache.nextUploadSequence++;
+			}
+
+			if(pFrame->jpegSize > 0)
+			{
+				milliseconds = pFrame->stamp.raw()/1000;
+				sprintf(frameName, "%020lld", milliseconds);
+				uploadFrame(pFrame, frameName);
 			}
 
-			//reset frame data
-			memset(pFrame->pRawFrame, 0, pFrame->dataSize);
-			memset(pFrame->pDecodedFrame, 0, pFrame->dataSize);
 			{
 				Poco::ScopedLock<Poco::Mutex> lock(_frameCache.mutex);
 				pFrame->state = IDLE;
@@ -598,45 +870,75 @@ private:
 		pLogger->LogInfo("uploading task exit");
 	}
 
-	void uploadFile(const std::string & fileName)
+	//_frameCache.mutex must be locked
+	struct FrameData * nextEncodedFrame()
+	{
+		for(int i=0; i<_frameCache.frameAmount; i++)
+		{
+			if((_frameCache.pFrames[i].state == ENCODED) && (_frameCache.pFrames[i].sequence == _frameCache.nextUploadSequence)) {
+				return &(_frameCache.pFrames[i]);
+			}
+		}
+
+		return NULL;
+	}
+
+	void uploadFrame(struct FrameData * pFrame, const std::string & frameName)
 	{
+		Poco::Net::HTTPClientSession * pSession = _uploadSessions.Acquire();
+
 		try
 		{
-			Poco::Path path(fileName);
-			Poco::Net::HTTPClientSession session(_hostServerIp, _hostServerPort);
-			Poco::Net::HTTPRequest request;
+			Poco::Net::HTTPRequest request(Poco::Net::HTTPRequest::HTTP_POST, _hostServerApi, Poco::Net::HTTPMessage::HTTP_1_1);
 			Poco::Net::HTMLForm form;
 			Poco::Net::HTTPResponse response;
+			Poco::NullOutputStream nullStream;
 
-			request.setURI(_hostServerApi);
-			request.setMethod(Poco::Net::HTTPRequest::HTTP_POST);
+			request.setKeepAlive(true);
 			request.setContentType("application/octet-stream");
 
-			form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
-			form.addPart("file", new Poco::Net::FilePartSource(fileName));
-			form.add("monitorId", _monitorId);
-			form.add("frameName", path.getFileName());
-			form.prepareSubmit(request);
+			if(_rawUpload)
+			{
+				request.set("Monitor-Id", _monitorId);
+				request.set("Frame-Name", frameName);
+				request.setContentLength(pFrame->jpegSize);
 
-			session.setTimeout(Poco::Timespan(_uploadTimeout, 0));
-			std::ostream & outputStream = session.sendRequest(request);
-			form.write(outputStream);
+				std::ostream & outputStream = pSession->sendRequest(request);
+				outputStream.write((const char *)(pFrame->pJpeg), pFrame->jpegSize);
+			}
+			else
+			{
+				form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
+				form.addPart("file", new FramePartSource((const char *)(pFrame->pJpeg), pFrame->jpegSize, frameName));
+				form.add("monitorId", _monitorId);
+				form.add("frameName", frameName);
+				form.prepareSubmit(request);
+
+				std::ostream & outputStream = pSession->sendRequest(request);
+				form.write(outputStream);
+			}
 
-			//http response is ignored.
-			session.receiveResponse(response);
+			//http response is ignored, but its body is consumed so that the connection can be reused.
+			std::istream & responseStream = pSession->receiveResponse(response);
+			Poco::StreamCopier::copyStream(responseStream, nullStream);
 		}
 		catch(Poco::Exception & e)
 		{
-			pLogger->LogError("uploadFile exception: " + e.displayText());
+			pLogger->LogError("uploadFrame exception: " + e.displayText());
+			pSession->reset(); //reconnect in next upload
 		}
 		catch(std::exception & e)
 		{
-			pLogger->LogError("uploadFile exception: " + std::string(e.what()));
+			pLogger->LogError("uploadFrame exception: " + std::string(e.what()));
+			pSession->reset();
 		}
 		catch(...)
 		{
-			pLogger->LogError("uploadFile unknown exception");
+			pLogger->LogError("uploadFrame unknown exception");
+			pSession->reset();
 		}
+
+		_uploadSessions.Release(pSession);
 	}
 };
 
@@ -706,7 +1008,10 @@ protected:
 		std::string logFile;
 		std::string logFileSize;
 		std::string logFileAmount;
+		bool logBinary = false;
 		int cacheSize;
+		int encoderAmount;
+		int uploadConnectionAmount = 2;
 		bool bMemoryShortage = false;
 
 		//use the designated configuration if it exist
@@ -732,20 +1037,24 @@ protected:
 			logFile = config().getString("log_file_name", "ImageCapture");
 			logFileSize = config().getString("log_file_size", "1M");
 			logFileAmount = config().getString("log_file_amount", "10");
+			logBinary = config().getBool("log_binary", false);
 
 			_deviceFile = config().getString("device_file", "/dev/video0");
 			_width = config().getUInt("width", 640);
 			_height = config().getUInt("height", 480);
 			_fps = config().getInt("fps", 30);
 			_jpegQuality = config().getUInt("quality", 70);
+			_jpegRawData = config().getBool("jpeg_raw_data", true);
 
 			cacheSize = config().getInt("frame_cache_size", 30);
-			_ramdiskFolder = config().getString("ramdisk_folder");
 
 			_hostServerIp = config().getString("host_server_ip");
 			_hostServerPort = config().getInt("host_server_port");
 			_hostServerApi = config().getString("host_server_api");
+			_rawUpload = config().getBool("host_server_raw_upload", false);
 			_uploadTimeout = config().getInt("upload_time_out");
+			uploadConnectionAmount = config().getInt("upload_connection_amount", 2);
+			encoderAmount = config().getInt("encoder_amount", Poco::Environment::processorCount());
 
 			_monitorId = config().getString("monitor_id");
 		}
@@ -767,7 +1076,7 @@ protected:
 		}
 
 		//start the logger
-		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount);
+		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount, logBinary);
 		pLogger->CopyToConsole(true);
 		tmLogger.start(pLogger);
 		pLogger->LogInfo("**** ImageCapture version 1.0.0 ****");
@@ -788,6 +1097,14 @@ protected:
 		{
 			pLogger->LogError("failed to create semaphore");
 		}
+		if(uploadConnectionAmount < 1) {
+			uploadConnectionAmount = 1;
+		}
+		if(encoderAmount < 1) {
+			encoderAmount = 1;
+		}
+		_uploadSessions.Init(uploadConnectionAmount);
+
 		//allocate memory
 		_frameCache.frameAmount = cacheSize;
 		_frameCache.pFrames = (FrameData *)malloc(sizeof(FrameData) * cacheSize);
@@ -802,6 +1119,7 @@ protected:
 			{
 				_frameCache.pFrames[i].pRawFrame = NULL;
 				_frameCache.pFrames[i].pDecodedFrame = NULL;
+				_frameCache.pFrames[i].pJpeg = NULL;
 			}
 
 			for(int i=0; i<cacheSize; i++)
@@ -815,8 +1133,22 @@ protected:
 					break;
 				}
 
-				_frameCache.pFrames[i].pDecodedFrame = malloc(_frameCache.pFrames[i].dataSize);
-				if(_frameCache.pFrames[i].pDecodedFrame == NULL) {
+				//YUV444 frame isn't needed in raw data mode
+				if(!_jpegRawData)
+				{
+					_frameCache.pFrames[i].pDecodedFrame = malloc(_frameCache.pFrames[i].dataSize);
+					if(_frameCache.pFrames[i].pDecodedFrame == NULL) {
+						bMemoryShortage = true;
+						pLogger->LogError("Not enough memory");
+						break;
+					}
+				}
+
+				//jpeg buffer is enlarged on demand, 1 byte per pixel is enough for usual quality.
+				_frameCache.pFrames[i].jpegBufferSize = _width * _height;
+				_frameCache.pFrames[i].jpegSize = 0;
+				_frameCache.pFrames[i].pJpeg = malloc(_frameCache.pFrames[i].jpegBufferSize);
+				if(_frameCache.pFrames[i].pJpeg == NULL) {
 					bMemoryShortage = true;
 					pLogger->LogError("Not enough memory");
 					break;
@@ -826,45 +1158,30 @@ protected:
 			}
 		}
 
-		//clean up frames in _ramdiskFolder
+		if(!bMemoryShortage)
 		{
-			std::vector<std::string> frameFiles;
-			Poco::DirectoryIterator it(_ramdiskFolder);
-			Poco::DirectoryIterator end;
-
-			for(; it != end; it++) {
-				frameFiles.push_back(it.name());
+			//every task has its own thread
+			int taskAmount = encoderAmount + uploadConnectionAmount + 1;
+			if(uploadThreadPool.capacity() < taskAmount) {
+				uploadThreadPool.addCapacity(taskAmount - uploadThreadPool.capacity());
 			}
-			for(unsigned int i=0; i<frameFiles.size(); i++)
-			{
-				pLogger->LogInfo("delete obsolete frame file: " + frameFiles[i]);
 
-				if(frameFiles[i].empty()) {
-					continue;
-				}
-				Poco::Path path(_ramdiskFolder);
-
-				path.setFileName(frameFiles[i]);
-				Poco::File file(path);
-				if(file.exists()) {
-					file.remove(false);
-				}
-			}
-		}
-
-		if(!bMemoryShortage)
-		{
-			//start upload tasks
-			for(int i=0; i<cacheSize; i++)
+			//start encoding tasks, then one uploading task per upload connection
+			for(int i=0; i<encoderAmount + uploadConnectionAmount; i++)
 			{
 				bool exceptionOccured = false;
-				UploadingTask * pTask = NULL;
+				Poco::Task * pTask = NULL;
 				try
 				{
-					pTask = new UploadingTask;
+					if(i < encoderAmount) {
+						pTask = new EncodingTask;
+					}
+					else {
+						pTask = new UploadingTask;
+					}
 
 					if(pTask == NULL) {
-						pLogger->LogError("Failed to allocate uploading task");
+						pLogger->LogError("Failed to allocate " + std::string(i < encoderAmount ? "encoding" : "uploading") + " task");
 						exceptionOccured = true;
 					}
 					else {
@@ -873,20 +1190,21 @@ protected:
 				}
 				catch(Poco::Exception &e)
 				{
-					pLogger->LogError("Exception in creating uploading task: " + e.displayText());
+					pLogger->LogError("Exception in creating task: " + e.displayText());
 					exceptionOccured = true;
 				}
 				catch(...)
 				{
-					pLogger->LogError("Unknown exception in creating uploading task");
+					pLogger->LogError("Unknown exception in creating task");
 					exceptionOccured = true;
 				}
 
 				if(exceptionOccured) {
-					pLogger->LogInfo("Uploading task amount: " + std::to_string(i));
+					pLogger->LogInfo("Encoding and uploading task amount: " + std::to_string(i));
 					break;
 				}
 			}
+			pLogger->LogInfo("Encoding tasks: " + std::to_string(encoderAmount) + ", uploading tasks: " + std::to_string(uploadConnectionAmount));
 
 			//start the CaptureTask
 			CaptureTask * pTask = new CaptureTask();
@@ -896,10 +1214,7 @@ protected:
 
 			//stop tasks
 			pLogger->LogInfo("**** ImageCapture Exiting ****");
-			tm.cancelAll();
-			for(int i=0; i<_frameCache.frameAmount; i++) {
-				_frameCache.pSemaphore->set(); //to terminate all uploading tasks.
-			}
+			tm.cancelAll(); //encoding and uploading tasks check cancellation every second
 			tm.joinAll();
 
 			//stop logger
@@ -917,6 +1232,9 @@ protected:
 					if(_frameCache.pFrames[i].pDecodedFrame != NULL) {
 						free(_frameCache.pFrames[i].pDecodedFrame);
 					}
+					if(_frameCache.pFrames[i].pJpeg != NULL) {
+						free(_frameCache.pFrames[i].pJpeg);
+					}
 				}
 				free(_frameCache.pFrames);
 			}
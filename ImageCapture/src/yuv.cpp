@@ -18,15 +18,24 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define YUV_X86 1
+#endif
+
+#include "yuv.h"
+
 /**
-	Convert from YUV420 format to YUV444.
+	Convert from YUV420 format to YUV444, one pixel at a time.
+	It is kept as reference for the row based conversion.
 
 	\param width width of image
 	\param height height of image
 	\param src source
 	\param dst destination
 */
-void YUV420toYUV444(int width, int height, unsigned char* src, unsigned char* dst) {
+void YUV420toYUV444Reference(int width, int height, unsigned char* src, unsigned char* dst) {
 	int line, column;
 	unsigned char *py, *pu, *pv;
 	unsigned char *tmp = dst;
@@ -50,3 +59,173 @@ void YUV420toYUV444(int width, int height, unsigned char* src, unsigned char* ds
 	}
 }
 
+/**
+	Convert pixels [start, width) of a row, two pixels share U and V.
+*/
+static void rowScalar(const unsigned char* py, const unsigned char* pu, const unsigned char* pv, unsigned char* dst, int start, int width) {
+	int column = start;
+
+	dst += column * 3;
+	if (column & 1) {
+		*dst++ = py[column];
+		*dst++ = pu[column/2];
+		*dst++ = pv[column/2];
+		column++;
+	}
+	for (; column + 1 < width; column += 2) {
+		unsigned char u = pu[column/2];
+		unsigned char v = pv[column/2];
+
+		dst[0] = py[column];
+		dst[1] = u;
+		dst[2] = v;
+		dst[3] = py[column+1];
+		dst[4] = u;
+		dst[5] = v;
+		dst += 6;
+	}
+	if (column < width) {
+		*dst++ = py[column];
+		*dst++ = pu[column/2];
+		*dst++ = pv[column/2];
+	}
+}
+
+#ifdef YUV_X86
+
+// byte shuffles which build 48 bytes of YUV444 from 16 Y bytes and 8 interleaved UV pairs.
+// -1 clears the byte, so the Y part and the UV part are combined with OR.
+#define YUV_SHUFFLE_MASKS \
+	const __m128i maskY0 = _mm_setr_epi8(0,-1,-1, 1,-1,-1, 2,-1,-1, 3,-1,-1, 4,-1,-1, 5); \
+	const __m128i maskY1 = _mm_setr_epi8(-1,-1, 6,-1,-1, 7,-1,-1, 8,-1,-1, 9,-1,-1,10,-1); \
+	const __m128i maskY2 = _mm_setr_epi8(-1,11,-1,-1,12,-1,-1,13,-1,-1,14,-1,-1,15,-1,-1); \
+	const __m128i maskUV0 = _mm_setr_epi8(-1, 0, 1,-1, 0, 1,-1, 2, 3,-1, 2, 3,-1, 4, 5,-1); \
+	const __m128i maskUV1 = _mm_setr_epi8( 4, 5,-1, 6, 7,-1, 6, 7,-1, 8, 9,-1, 8, 9,-1,10); \
+	const __m128i maskUV2 = _mm_setr_epi8(11,-1,10,11,-1,12,13,-1,12,13,-1,14,15,-1,14,15);
+
+__attribute__((target("ssse3")))
+static void rowSsse3(const unsigned char* py, const unsigned char* pu, const unsigned char* pv, unsigned char* dst, int width) {
+	YUV_SHUFFLE_MASKS
+	int column;
+
+	for (column = 0; column + 16 <= width; column += 16) {
+		__m128i y = _mm_loadu_si128((const __m128i *)(py + column));
+		__m128i u = _mm_loadl_epi64((const __m128i *)(pu + column/2));
+		__m128i v = _mm_loadl_epi64((const __m128i *)(pv + column/2));
+		__m128i uv = _mm_unpacklo_epi8(u, v);
+		unsigned char * out = dst + column * 3;
+
+		_mm_storeu_si128((__m128i *)out, _mm_or_si128(_mm_shuffle_epi8(y, maskY0), _mm_shuffle_epi8(uv, maskUV0)));
+		_mm_storeu_si128((__m128i *)(out + 16), _mm_or_si128(_mm_shuffle_epi8(y, maskY1), _mm_shuffle_epi8(uv, maskUV1)));
+		_mm_storeu_si128((__m128i *)(out + 32), _mm_or_si128(_mm_shuffle_epi8(y, maskY2), _mm_shuffle_epi8(uv, maskUV2)));
+	}
+	rowScalar(py, pu, pv, dst, column, width);
+}
+
+__attribute__((target("avx2")))
+static void rowAvx2(const unsigned char* py, const unsigned char* pu, const unsigned char* pv, unsigned char* dst, int width) {
+	YUV_SHUFFLE_MASKS
+	const __m256i maskY0x2 = _mm256_broadcastsi128_si256(maskY0);
+	const __m256i maskY1x2 = _mm256_broadcastsi128_si256(maskY1);
+	const __m256i maskY2x2 = _mm256_broadcastsi128_si256(maskY2);
+	const __m256i maskUV0x2 = _mm256_broadcastsi128_si256(maskUV0);
+	const __m256i maskUV1x2 = _mm256_broadcastsi128_si256(maskUV1);
+	const __m256i maskUV2x2 = _mm256_broadcastsi128_si256(maskUV2);
+	int column;
+
+	// each 128 bit lane converts 16 pixels, same as rowSsse3
+	for (column = 0; column + 32 <= width; column += 32) {
+		__m256i y = _mm256_loadu_si256((const __m256i *)(py + column));
+		__m128i u = _mm_loadu_si128((const __m128i *)(pu + column/2));
+		__m128i v = _mm_loadu_si128((const __m128i *)(pv + column/2));
+		__m256i uv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(u, v)), _mm_unpackhi_epi8(u, v), 1);
+		unsigned char * out = dst + column * 3;
+
+		__m256i r0 = _mm256_or_si256(_mm256_shuffle_epi8(y, maskY0x2), _mm256_shuffle_epi8(uv, maskUV0x2));
+		__m256i r1 = _mm256_or_si256(_mm256_shuffle_epi8(y, maskY1x2), _mm256_shuffle_epi8(uv, maskUV1x2));
+		__m256i r2 = _mm256_or_si256(_mm256_shuffle_epi8(y, maskY2x2), _mm256_shuffle_epi8(uv, maskUV2x2));
+
+		// lanes hold pixels 0~15 and 16~31, put them back in order
+		_mm256_storeu_si256((__m256i *)out, _mm256_permute2x128_si256(r0, r1, 0x20));
+		_mm256_storeu_si256((__m256i *)(out + 32), _mm256_permute2x128_si256(r2, r0, 0x30));
+		_mm256_storeu_si256((__m256i *)(out + 64), _mm256_permute2x128_si256(r1, r2, 0x31));
+	}
+	rowSsse3(py + column, pu + column/2, pv + column/2, dst + column * 3, width - column);
+}
+
+#endif
+
+int YUV420toYUV444Supported(enum YuvKernel kernel) {
+	switch (kernel) {
+		case YUV_KERNEL_SCALAR:
+			return 1;
+#ifdef YUV_X86
+		case YUV_KERNEL_SSSE3:
+			return __builtin_cpu_supports("ssse3");
+		case YUV_KERNEL_AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+		default:
+			return 0;
+	}
+}
+
+/**
+	Convert from YUV420 format to YUV444 row by row with the given kernel.
+	Falls back to scalar kernel if the kernel isn't supported by processor.
+*/
+void YUV420toYUV444Kernel(enum YuvKernel kernel, int width, int height, unsigned char* src, unsigned char* dst) {
+	int line;
+	unsigned char *base_py = src;
+	unsigned char *base_pu = src+(height*width);
+	unsigned char *base_pv = src+(height*width)+(height*width)/4;
+
+	if (!YUV420toYUV444Supported(kernel)) {
+		kernel = YUV_KERNEL_SCALAR;
+	}
+
+	for (line = 0; line < height; ++line) {
+		unsigned char *py = base_py+(line*width);
+		unsigned char *pu = base_pu+(line/2*width/2);
+		unsigned char *pv = base_pv+(line/2*width/2);
+		unsigned char *out = dst+(line*width*3);
+
+		switch (kernel) {
+#ifdef YUV_X86
+			case YUV_KERNEL_AVX2:
+				rowAvx2(py, pu, pv, out, width);
+				break;
+			case YUV_KERNEL_SSSE3:
+				rowSsse3(py, pu, pv, out, width);
+				break;
+#endif
+			default:
+				rowScalar(py, pu, pv, out, 0, width);
+				break;
+		}
+	}
+}
+
+static enum YuvKernel bestKernel() {
+	if (YUV420toYUV444Supported(YUV_KERNEL_AVX2)) {
+		return YUV_KERNEL_AVX2;
+	}
+	if (YUV420toYUV444Supported(YUV_KERNEL_SSSE3)) {
+		return YUV_KERNEL_SSSE3;
+	}
+	return YUV_KERNEL_SCALAR;
+}
+
+/**
+	Convert from YUV420 format to YUV444 with the fastest kernel supported by processor.
+
+	\param width width of image
+	\param height height of image
+	\param src source
+	\param dst destination
+*/
+void YUV420toYUV444(int width, int height, unsigned char* src, unsigned char* dst) {
+	static const enum YuvKernel kernel = bestKernel(); // thread safe initialization in C++11
+
+	YUV420toYUV444Kernel(kernel, width, height, src, dst);
+}
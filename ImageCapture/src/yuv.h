@@ -1,6 +1,18 @@
 #ifndef _YUV_H_
 #define _YUV_H_
 
+enum YuvKernel
+{
+	YUV_KERNEL_SCALAR = 0,
+	YUV_KERNEL_SSSE3,
+	YUV_KERNEL_AVX2
+};
+
+// fastest kernel supported by processor, selected at run time
 void YUV420toYUV444(int width, int height, unsigned char* src, unsigned char* dst);
+// one pixel at a time, kept as reference
+void YUV420toYUV444Reference(int width, int height, unsigned char* src, unsigned char* dst);
+void YUV420toYUV444Kernel(enum YuvKernel kernel, int width, int height, unsigned char* src, unsigned char* dst);
+int YUV420toYUV444Supported(enum YuvKernel kernel);
 
 #endif
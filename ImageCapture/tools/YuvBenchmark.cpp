@@ -0,0 +1,93 @@
+/*
+ * YuvBenchmark.cpp
+ *
+ * Compare YUV420 to YUV444 conversion kernels with the per pixel reference conversion.
+ * Output of each kernel supported by processor must be the same as the reference one.
+ *
+ * Build: g++ -O2 -std=c++11 -I../src -o YuvBenchmark YuvBenchmark.cpp ../src/yuv.cpp
+ * Usage: YuvBenchmark [<rounds>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "yuv.h"
+
+struct Resolution
+{
+	const char * name;
+	int width;
+	int height;
+};
+
+static const Resolution resolutions[] = {
+	{"720p", 1280, 720},
+	{"1080p", 1920, 1080},
+	{"odd", 642, 362} //width isn't a multiple of vector size
+};
+
+static const struct
+{
+	const char * name;
+	YuvKernel kernel;
+} kernels[] = {
+	{"scalar", YUV_KERNEL_SCALAR},
+	{"ssse3", YUV_KERNEL_SSSE3},
+	{"avx2", YUV_KERNEL_AVX2}
+};
+
+int main(int argc, char * argv[])
+{
+	unsigned int rounds = 200;
+	int rc = 0;
+
+	if(argc > 1) {
+		rounds = atoi(argv[1]);
+	}
+
+	for(auto& resolution : resolutions)
+	{
+		int pixels = resolution.width * resolution.height;
+		std::vector<unsigned char> src(pixels * 3 / 2);
+		std::vector<unsigned char> reference(pixels * 3);
+		std::vector<unsigned char> dst(pixels * 3);
+
+		srand(1);
+		for(auto& c : src) {
+			c = rand();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for(unsigned int round=0; round<rounds; round++) {
+			YUV420toYUV444Reference(resolution.width, resolution.height, src.data(), reference.data());
+		}
+		double referenceTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e6 / rounds;
+		printf("%-6s reference: %8.3f ms/frame\n", resolution.name, referenceTime);
+
+		for(auto& kernel : kernels)
+		{
+			if(!YUV420toYUV444Supported(kernel.kernel)) {
+				printf("%-6s %-9s  not supported\n", resolution.name, kernel.name);
+				continue;
+			}
+
+			memset(dst.data(), 0, dst.size());
+			YUV420toYUV444Kernel(kernel.kernel, resolution.width, resolution.height, src.data(), dst.data());
+			if(dst != reference) {
+				printf("MISMATCH %s %s\n", resolution.name, kernel.name);
+				rc = 1;
+			}
+
+			start = std::chrono::steady_clock::now();
+			for(unsigned int round=0; round<rounds; round++) {
+				YUV420toYUV444Kernel(kernel.kernel, resolution.width, resolution.height, src.data(), dst.data());
+			}
+			double time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1e6 / rounds;
+			printf("%-6s %-9s: %8.3f ms/frame, %.1fx\n", resolution.name, kernel.name, time, referenceTime / time);
+		}
+	}
+
+	return rc;
+}
@@ -0,0 +1,368 @@
+/*
+ * LogFormatter.h
+ */
+
+#ifndef LOGFORMATTER_H_
+#define LOGFORMATTER_H_
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Shared by Logger and LogDecoder.
+//
+// Arguments of Logger::LogFormat are stored as typed values:
+//   'i' + int64, 'u' + uint64, 'f' + double, 's' + uint32 length + characters
+//
+// A binary log file is a sequence of records in host byte order:
+//   RECORD_TAG | uint32 arguments length | int64 epoch microseconds | uint32 format id | arguments
+// FileChannel appends a line feed to each batch of records, decoder skips it.
+// Format id is FNV-1a hash of the format string, format strings are saved in dictionary file.
+// Format id 0 stands for a plain text line which has a single 's' argument.
+namespace LogFormatter
+{
+	const unsigned char RECORD_TAG = 0xB7;
+	const unsigned int RECORD_HEADER_LENGTH = 1 + 4 + 8 + 4;
+	const uint32_t PLAIN_TEXT_FORMAT_ID = 0;
+	//not in "<log file>.*" form, otherwise FileChannel purges it together with archived logs.
+	const char * const DICTIONARY_SUFFIX = "_formats.txt";
+
+	inline uint32_t FormatId(const char * pFormat)
+	{
+		uint32_t id = 2166136261u;
+
+		for(; *pFormat != 0; pFormat++) {
+			id = (id ^ (unsigned char)(*pFormat)) * 16777619u;
+		}
+		if(id == PLAIN_TEXT_FORMAT_ID) {
+			id = 1;
+		}
+		return id;
+	}
+
+	inline void appendRaw(std::string& buffer, const void * pData, size_t length)
+	{
+		buffer.append((const char *)pData, length);
+	}
+
+	// argument serialization
+	template<typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+	AppendArg(std::string& buffer, T value)
+	{
+		int64_t v = value;
+		buffer.push_back('i');
+		appendRaw(buffer, &v, sizeof(v));
+	}
+
+	template<typename T>
+	inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+	AppendArg(std::string& buffer, T value)
+	{
+		uint64_t v = value;
+		buffer.push_back('u');
+		appendRaw(buffer, &v, sizeof(v));
+	}
+
+	template<typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value>::type
+	AppendArg(std::string& buffer, T value)
+	{
+		double v = value;
+		buffer.push_back('f');
+		appendRaw(buffer, &v, sizeof(v));
+	}
+
+	inline void AppendArg(std::string& buffer, const char * pString, size_t length)
+	{
+		uint32_t len = length;
+		buffer.push_back('s');
+		appendRaw(buffer, &len, sizeof(len));
+		appendRaw(buffer, pString, length);
+	}
+
+	inline void AppendArg(std::string& buffer, const char * pString)
+	{
+		if(pString == nullptr) {
+			pString = "(null)";
+		}
+		AppendArg(buffer, pString, strlen(pString));
+	}
+
+	inline void AppendArg(std::string& buffer, const std::string& str)
+	{
+		AppendArg(buffer, str.data(), str.size());
+	}
+
+	inline void AppendArgs(std::string& /*buffer*/) {}
+
+	template<typename T, typename... Args>
+	inline void AppendArgs(std::string& buffer, const T& value, const Args&... args)
+	{
+		AppendArg(buffer, value);
+		AppendArgs(buffer, args...);
+	}
+
+	// binary record
+	inline void AppendRecord(std::string& buffer, int64_t time, uint32_t formatId, const char * pArgs, size_t length)
+	{
+		uint32_t len = length;
+
+		buffer.push_back((char)RECORD_TAG);
+		appendRaw(buffer, &len, sizeof(len));
+		appendRaw(buffer, &time, sizeof(time));
+		appendRaw(buffer, &formatId, sizeof(formatId));
+		appendRaw(buffer, pArgs, length);
+	}
+
+	// return false if no complete record is available.
+	inline bool ParseRecord(const char * pData, size_t length, int64_t& time, uint32_t& formatId, const char *& pArgs, size_t& argsLength)
+	{
+		uint32_t len;
+
+		if((length < RECORD_HEADER_LENGTH) || ((unsigned char)pData[0] != RECORD_TAG)) {
+			return false;
+		}
+		memcpy(&len, pData + 1, sizeof(len));
+		if(length < RECORD_HEADER_LENGTH + len) {
+			return false;
+		}
+		memcpy(&time, pData + 5, sizeof(time));
+		memcpy(&formatId, pData + 13, sizeof(formatId));
+		pArgs = pData + RECORD_HEADER_LENGTH;
+		argsLength = len;
+
+		return true;
+	}
+
+	// rendering
+	struct LogArg
+	{
+		char type;
+		int64_t i;
+		uint64_t u;
+		double f;
+		const char * pString;
+		uint32_t length;
+	};
+
+	// return false if arguments are exhausted or corrupted.
+	inline bool NextArg(const char *& pArgs, const char * pEnd, LogArg& arg)
+	{
+		if(pArgs >= pEnd) {
+			return false;
+		}
+
+		arg.type = *pArgs++;
+		switch(arg.type)
+		{
+			case 'i':
+				if(pEnd - pArgs < 8) return false;
+				memcpy(&arg.i, pArgs, 8);
+				pArgs += 8;
+				break;
+			case 'u':
+				if(pEnd - pArgs < 8) return false;
+				memcpy(&arg.u, pArgs, 8);
+				pArgs += 8;
+				break;
+			case 'f':
+				if(pEnd - pArgs < 8) return false;
+				memcpy(&arg.f, pArgs, 8);
+				pArgs += 8;
+				break;
+			case 's':
+				if(pEnd - pArgs < 4) return false;
+				memcpy(&arg.length, pArgs, 4);
+				pArgs += 4;
+				if((size_t)(pEnd - pArgs) < arg.length) return false;
+				arg.pString = pArgs;
+				pArgs += arg.length;
+				break;
+			default:
+				return false;
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	inline void appendPrintf(std::string& out, const std::string& spec, T value)
+	{
+		char buffer[64];
+		int amount = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+
+		if(amount < 0) {
+			return;
+		}
+		if((size_t)amount < sizeof(buffer)) {
+			out.append(buffer, amount);
+		}
+		else {
+			std::vector<char> big(amount + 1);
+			snprintf(big.data(), big.size(), spec.c_str(), value);
+			out.append(big.data(), amount);
+		}
+	}
+
+	// spec contains '%', flags, width and precision of the conversion.
+	inline void renderArg(std::string spec, char conversion, const LogArg& arg, std::string& out)
+	{
+		bool isInteger = (strchr("diouxXc", conversion) != nullptr);
+		bool isFloat = (strchr("eEfFgGaA", conversion) != nullptr);
+
+		switch(arg.type)
+		{
+			case 'i':
+				if(conversion == 'c') {
+					appendPrintf(out, spec + 'c', (int)arg.i);
+				}
+				else if(isInteger) {
+					appendPrintf(out, spec + "ll" + conversion, (long long)arg.i);
+				}
+				else if(isFloat) {
+					appendPrintf(out, spec + conversion, (double)arg.i);
+				}
+				else {
+					appendPrintf(out, spec + "lld", (long long)arg.i);
+				}
+				break;
+			case 'u':
+				if(conversion == 'c') {
+					appendPrintf(out, spec + 'c', (int)arg.u);
+				}
+				else if((conversion == 'd') || (conversion == 'i')) {
+					appendPrintf(out, spec + "llu", (unsigned long long)arg.u);
+				}
+				else if(isInteger) {
+					appendPrintf(out, spec + "ll" + conversion, (unsigned long long)arg.u);
+				}
+				else if(isFloat) {
+					appendPrintf(out, spec + conversion, (double)arg.u);
+				}
+				else {
+					appendPrintf(out, spec + "llu", (unsigned long long)arg.u);
+				}
+				break;
+			case 'f':
+				if(isFloat) {
+					appendPrintf(out, spec + conversion, arg.f);
+				}
+				else {
+					appendPrintf(out, spec + 'g', arg.f);
+				}
+				break;
+			case 's':
+				if(spec.size() == 1) {
+					out.append(arg.pString, arg.length);
+				}
+				else {
+					appendPrintf(out, spec + 's', std::string(arg.pString, arg.length).c_str());
+				}
+				break;
+		}
+	}
+
+	// render printf style format with stored arguments.
+	// length modifiers in format are ignored since arguments carry their own types.
+	inline void Render(const char * pFormat, const char * pArgs, size_t length, std::string& out)
+	{
+		const char * pEnd = pArgs + length;
+		LogArg arg;
+
+		for(const char * p = pFormat; *p != 0; p++)
+		{
+			if(*p != '%') {
+				out.push_back(*p);
+				continue;
+			}
+			if(p[1] == '%') {
+				out.push_back('%');
+				p++;
+				continue;
+			}
+
+			const char * pSpec = p;
+			std::string spec("%");
+
+			for(p++; (*p != 0) && (strchr("-+ #0123456789.", *p) != nullptr); p++) {
+				spec.push_back(*p);
+			}
+			for(; (*p != 0) && (strchr("hlLqjzt", *p) != nullptr); p++) {}
+
+			if(*p == 0) {
+				out.append(pSpec);
+				break;
+			}
+			if(!NextArg(pArgs, pEnd, arg)) {
+				out.append(pSpec, p + 1 - pSpec);
+				continue;
+			}
+			renderArg(spec, *p, arg, out);
+		}
+	}
+
+	// render format id 0 record
+	inline void RenderPlainText(const char * pArgs, size_t length, std::string& out)
+	{
+		LogArg arg;
+
+		if(NextArg(pArgs, pArgs + length, arg) && (arg.type == 's')) {
+			out.append(arg.pString, arg.length);
+		}
+	}
+
+	// dictionary line: "<format id in hex> <format with '\\' and line feed escaped>"
+	inline std::string DictionaryLine(uint32_t formatId, const char * pFormat)
+	{
+		char buffer[16];
+		std::string line;
+
+		sprintf(buffer, "%08x ", formatId);
+		line = buffer;
+		for(; *pFormat != 0; pFormat++)
+		{
+			if(*pFormat == '\\') {
+				line += "\\\\";
+			}
+			else if(*pFormat == '\n') {
+				line += "\\n";
+			}
+			else {
+				line.push_back(*pFormat);
+			}
+		}
+		line.push_back('\n');
+
+		return line;
+	}
+
+	// return false if line isn't a dictionary line.
+	inline bool ParseDictionaryLine(const std::string& line, uint32_t& formatId, std::string& format)
+	{
+		unsigned int id;
+
+		if((line.size() < 9) || (line[8] != ' ') || (sscanf(line.c_str(), "%8x", &id) != 1)) {
+			return false;
+		}
+		formatId = id;
+		format.clear();
+		for(size_t i = 9; i < line.size(); i++)
+		{
+			if((line[i] == '\\') && (i + 1 < line.size())) {
+				i++;
+				format.push_back((line[i] == 'n') ? '\n' : line[i]);
+			}
+			else {
+				format.push_back(line[i]);
+			}
+		}
+
+		return true;
+	}
+}
+
+#endif /* LOGFORMATTER_H_ */
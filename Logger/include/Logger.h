@@ -8,19 +8,24 @@
 #ifndef PROXYLOGGER_H_
 #define PROXYLOGGER_H_
 
-#include <deque>
+#include <atomic>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include "Poco/Task.h"
 #include "Poco/Path.h"
-#include "Poco/Mutex.h"
+#include "Poco/Event.h"
+#include "Poco/Timestamp.h"
 #include "Poco/Logger.h"
 #include "Poco/FileChannel.h"
 #include "Poco/Channel.h"
 #include "Poco/Message.h"
+#include "LogFormatter.h"
 
 class Logger: public Poco::Task {
 public:
-	Logger(const std::string& folder, const std::string& name, const std::string& fileSize, const std::string& fileAmount);
+	//binary: log file is written in binary records, use LogDecoder to read it.
+	Logger(const std::string& folder, const std::string& name, const std::string& fileSize, const std::string& fileAmount, bool binary = false);
 	virtual ~Logger();
 
 	void Log(const std::string& log);
@@ -28,25 +33,79 @@ public:
 	void LogDebug(const std::string& debug);
 	void LogInfo(const std::string& info);
 
+	//pFormat must be a string literal in printf style.
+	//arguments are stored as they are, and formatted by writer or by LogDecoder in binary mode.
+	template<typename... Args>
+	void LogFormat(const char * pFormat, const Args&... args)
+	{
+		unsigned long index;
+		LogRecord * pRecord = reserve(index);
+
+		if(pRecord != nullptr)
+		{
+			pRecord->pFormat = pFormat;
+			pRecord->text.clear();
+			LogFormatter::AppendArgs(pRecord->text, args...);
+			commit(pRecord, index);
+		}
+	}
+
 	void CopyToConsole(bool copyToConsole);
 
+	//wake up writer so that it can flush logs and exit.
+	virtual void cancel() override;
+
 private:
 	void runTask();
 
 private:
-	static const int MAX_LINES = 10240;
-	static const int OVERFLOW_DIFF = 1024;
+	static const unsigned long RECORD_AMOUNT = 16384; //must be power of 2
+	static const unsigned long RECORD_INDEX_MASK = RECORD_AMOUNT - 1;
+	static const unsigned int RECORD_TEXT_RESERVE = 128; //preallocated characters of each record
+	static const unsigned int BATCH_LINES = 256; //max lines written to file at a time
+	static const long WRITER_WAIT_TIMEOUT = 100; //milliseconds
 
-	bool _overflowed;
-	bool _copyToConsole;
+	// A log line waiting for writer.
+	// Records form a bounded multi-producer single-consumer ring:
+	// sequence == index: the record is free for the producer reserving that index,
+	// sequence == index + 1: the record is filled and can be written by writer.
+	struct LogRecord
+	{
+		std::atomic<unsigned long> sequence;
+		Poco::Timestamp::TimeVal time;
+		const char * pFormat; //nullptr: text is a plain line; otherwise text holds arguments of the format
+		std::string text;
+	};
 
-	Poco::Mutex _mutex;
-	std::deque<std::string> _logBuffer;
+	LogRecord * _records;
+	std::atomic<unsigned long> _producerIndex;
+	unsigned long _consumerIndex; //accessed by writer only
+	std::atomic<unsigned long> _droppedLines;
+
+	std::atomic<bool> _writerWaiting;
+	Poco::Event _logEvent;
+
+	bool _copyToConsole;
 
 	Poco::Logger* _pLogger;
 	bool _logFileInitialized;
 
-	std::string currentTime();
+	//binary mode, accessed by writer only
+	bool _binary;
+	std::string _dictionaryFile;
+	std::unordered_map<const char *, uint32_t> _formatIds;
+	std::unordered_set<uint32_t> _savedFormatIds;
+	std::string _dictionaryLines;
+
+	LogRecord * reserve(unsigned long& index);
+	void commit(LogRecord * pRecord, unsigned long index);
+	void push(const char * pPrefix, const std::string& log);
+	void loadDictionary();
+	uint32_t formatId(const char * pFormat);
+	void saveDictionary();
+	void appendRecord(std::string& lines, std::string& consoleLines, Poco::Timestamp::TimeVal time, const char * pFormat, const std::string& text);
+	unsigned int retrieveLines(std::string& lines, std::string& consoleLines);
+	void writeLines(const std::string& lines, const std::string& consoleLines);
 };
 
 #endif /* PROXYLOGGER_H_ */
@@ -12,15 +12,30 @@
 #include "Poco/DateTimeFormatter.h"
 #include "Poco/Path.h"
 #include "Poco/File.h"
+#include <fstream>
 
 Logger::Logger(const std::string& folder,
 		const std::string& name,
 		const std::string& fileSize,
-		const std::string& fileAmount):Task("Logger")
+		const std::string& fileAmount,
+		bool binary):Task("Logger")
 {
 	_logFileInitialized = false;
-	_overflowed = false;
 	_copyToConsole = false;
+	_binary = binary;
+
+	//preallocate records so that logging doesn't allocate memory in most cases
+	_records = new LogRecord[RECORD_AMOUNT];
+	for(unsigned long i=0; i<RECORD_AMOUNT; i++) {
+		_records[i].sequence.store(i, std::memory_order_relaxed);
+		_records[i].time = 0;
+		_records[i].pFormat = nullptr;
+		_records[i].text.reserve(RECORD_TEXT_RESERVE);
+	}
+	_producerIndex.store(0);
+	_consumerIndex = 0;
+	_droppedLines.store(0);
+	_writerWaiting.store(false);
 
 	try
 	{
@@ -40,6 +55,11 @@ Logger::Logger(const std::string& folder,
 		auto& logger = Poco::Logger::create("proxyLogger", pFileChannel, Poco::Message::PRIO_TRACE);
 		_pLogger = &logger;
 		_logFileInitialized = true;
+
+		if(_binary) {
+			_dictionaryFile = logFile.toString() + LogFormatter::DICTIONARY_SUFFIX;
+			loadDictionary();
+		}
 	}
 	catch(Poco::Exception& e)
 	{
@@ -55,54 +75,88 @@ Logger::Logger(const std::string& folder,
 
 Logger::~Logger()
 {
-
+	delete [] _records;
 }
 
-std::string Logger::currentTime()
+// reserve a free record.
+// return nullptr if writer falls behind and the line has to be discarded.
+Logger::LogRecord * Logger::reserve(unsigned long& index)
 {
-	Poco::Timestamp currentTime;
-	std::string rc = Poco::DateTimeFormatter::format(currentTime, Poco::DateTimeFormat::ISO8601_FRAC_FORMAT);
+	LogRecord * pRecord;
+
+	index = _producerIndex.load(std::memory_order_relaxed);
+	for(;;)
+	{
+		pRecord = _records + (index & RECORD_INDEX_MASK);
 
-	return rc;
+		long diff = (long)(pRecord->sequence.load(std::memory_order_acquire) - index);
+		if(diff == 0)
+		{
+			if(_producerIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			//writer falls behind, this line is discarded.
+			_droppedLines.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else
+		{
+			index = _producerIndex.load(std::memory_order_relaxed);
+		}
+	}
+
+	//time is formatted by writer
+	pRecord->time = Poco::Timestamp().epochMicroseconds();
+
+	return pRecord;
 }
 
-void Logger::Log(const std::string& log)
+// hand over a filled record to writer
+void Logger::commit(LogRecord * pRecord, unsigned long index)
 {
-	std::string logLine = currentTime() + " " + log;
+	pRecord->sequence.store(index + 1);
 
-	if(_copyToConsole) {
-		printf("%s\r\n", logLine.c_str());
+	if(_writerWaiting.load()) {
+		_logEvent.set();
 	}
+}
 
-	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+void Logger::push(const char * pPrefix, const std::string& log)
+{
+	unsigned long index;
+	LogRecord * pRecord = reserve(index);
 
-	if(_overflowed) {
-		if(_logBuffer.size() < (MAX_LINES - OVERFLOW_DIFF)) {
-			_overflowed = false;
-		}
-	}
-	if(!_overflowed) {
-		_logBuffer.push_back(logLine);
-		if(_logBuffer.size() >= MAX_LINES) {
-			_overflowed = true;
-			_logBuffer.push_back(currentTime() + " !!!! overflowed !!!!");
-		}
+	if(pRecord == nullptr) {
+		return;
 	}
+
+	pRecord->pFormat = nullptr;
+	pRecord->text.assign(pPrefix);
+	pRecord->text.append(log);
+	commit(pRecord, index);
+}
+
+void Logger::Log(const std::string& log)
+{
+	push("", log);
 }
 
 void Logger::LogError(const std::string& err)
 {
-	Log("ERROR: " + err);
+	push("ERROR: ", err);
 }
 
 void Logger::LogDebug(const std::string& debug)
 {
-	Log(debug);
+	push("", debug);
 }
 
 void Logger::LogInfo(const std::string& info)
 {
-	Log(info);
+	push("", info);
 }
 
 void Logger::CopyToConsole(bool copyToConsole)
@@ -110,69 +164,203 @@ void Logger::CopyToConsole(bool copyToConsole)
 	_copyToConsole = copyToConsole;
 }
 
+void Logger::cancel()
+{
+	Task::cancel();
+	_logEvent.set();
+}
+
+// read format ids which have been saved in dictionary file.
+void Logger::loadDictionary()
+{
+	std::ifstream file(_dictionaryFile);
+	std::string line;
+	std::string format;
+	uint32_t id;
+
+	while(std::getline(file, line))
+	{
+		if(LogFormatter::ParseDictionaryLine(line, id, format)) {
+			_savedFormatIds.insert(id);
+		}
+	}
+}
+
+uint32_t Logger::formatId(const char * pFormat)
+{
+	auto it = _formatIds.find(pFormat);
+	if(it != _formatIds.end()) {
+		return it->second;
+	}
+
+	uint32_t id = LogFormatter::FormatId(pFormat);
+	_formatIds[pFormat] = id;
+	if(_savedFormatIds.insert(id).second) {
+		_dictionaryLines += LogFormatter::DictionaryLine(id, pFormat);
+	}
+
+	return id;
+}
+
+// append new formats to dictionary file before records using them reach log file.
+void Logger::saveDictionary()
+{
+	if(_dictionaryLines.empty()) {
+		return;
+	}
+
+	std::ofstream file(_dictionaryFile, std::ios::out | std::ios::app | std::ios::binary);
+	file << _dictionaryLines;
+	if(!file) {
+		printf("Logger::saveDictionary failed to write %s\r\n", _dictionaryFile.c_str());
+	}
+	_dictionaryLines.clear();
+}
+
+// lines: content to log file
+// consoleLines: text of binary records, filled only when they are printed to console
+void Logger::appendRecord(std::string& lines, std::string& consoleLines, Poco::Timestamp::TimeVal time, const char * pFormat, const std::string& text)
+{
+	if(_binary)
+	{
+		uint32_t id = (pFormat == nullptr) ? LogFormatter::PLAIN_TEXT_FORMAT_ID : formatId(pFormat);
+
+		if(pFormat == nullptr)
+		{
+			std::string args;
+			LogFormatter::AppendArg(args, text);
+			LogFormatter::AppendRecord(lines, time, id, args.data(), args.size());
+		}
+		else
+		{
+			LogFormatter::AppendRecord(lines, time, id, text.data(), text.size());
+		}
+
+		if(!_copyToConsole && _logFileInitialized) {
+			return;
+		}
+	}
+
+	std::string& output = _binary ? consoleLines : lines;
+
+	Poco::DateTimeFormatter::append(output, Poco::Timestamp(time), Poco::DateTimeFormat::ISO8601_FRAC_FORMAT);
+	output += ' ';
+	if(pFormat == nullptr) {
+		output += text;
+	}
+	else {
+		LogFormatter::Render(pFormat, text.data(), text.size(), output);
+	}
+	output += '\n';
+}
+
+// format filled records to lines, and release those records.
+// return value: amount of lines retrieved
+unsigned int Logger::retrieveLines(std::string& lines, std::string& consoleLines)
+{
+	unsigned int amount = 0;
+
+	unsigned long dropped = _droppedLines.exchange(0, std::memory_order_relaxed);
+	if(dropped > 0) {
+		appendRecord(lines, consoleLines, Poco::Timestamp().epochMicroseconds(), nullptr,
+				"!!!! overflowed, " + std::to_string(dropped) + " lines dropped !!!!");
+		amount++;
+	}
+
+	for(; amount < BATCH_LINES; amount++)
+	{
+		LogRecord * pRecord = _records + (_consumerIndex & RECORD_INDEX_MASK);
+
+		if(pRecord->sequence.load(std::memory_order_acquire) != (_consumerIndex + 1)) {
+			break; //no more filled record
+		}
+
+		appendRecord(lines, consoleLines, pRecord->time, pRecord->pFormat, pRecord->text);
+
+		pRecord->sequence.store(_consumerIndex + RECORD_AMOUNT, std::memory_order_release);
+		_consumerIndex++;
+	}
+
+	return amount;
+}
+
+// write a batch of lines to log file at a time
+void Logger::writeLines(const std::string& lines, const std::string& consoleLines)
+{
+	const std::string& text = _binary ? consoleLines : lines;
+
+	if(_copyToConsole) {
+		printf("%s", text.c_str());
+	}
+
+	if(_logFileInitialized)
+	{
+		try
+		{
+			if(_binary) {
+				saveDictionary();
+				_pLogger->trace(lines);
+			}
+			else {
+				//FileChannel appends the last line feed.
+				_pLogger->trace(lines.substr(0, lines.size() - 1));
+			}
+		}
+		catch(Poco::Exception& e)
+		{
+			_logFileInitialized = false; //output to console
+			Log("Logger exception in log output: " + e.displayText());
+		}
+		catch(...)
+		{
+			_logFileInitialized = false; //output to console
+			Log("Logger unknown exception in log output");
+		}
+	}
+	else if(!_copyToConsole)
+	{
+		printf("%s", text.c_str());
+	}
+}
+
 void Logger::runTask()
 {
-	while(1)
+	std::string lines;
+	std::string consoleLines;
+
+	for(;;)
 	{
-		if(isCancelled())
+		bool cancelled = isCancelled();
+
+		lines.clear();
+		consoleLines.clear();
+		if(retrieveLines(lines, consoleLines) > 0)
+		{
+			writeLines(lines, consoleLines);
+			continue;
+		}
+
+		if(cancelled)
 		{
-			for(; _logBuffer.size() > 0; )
-			{
-				std::string logLine = _logBuffer.front();
-				_logBuffer.pop_front();
-				if(_logFileInitialized) {
-					_pLogger->trace(logLine);
+			if(_logFileInitialized) {
+				if(_binary) {
+					appendRecord(lines, consoleLines, Poco::Timestamp().epochMicroseconds(), nullptr, "Logger::runTask exits");
+					_pLogger->trace(lines);
 				}
 				else {
-					printf("%s\r\n", logLine.c_str());
+					_pLogger->trace(std::string("Logger::runTask exits"));
 				}
-			}
-
-			if(_logFileInitialized) {
-				_pLogger->trace(std::string("Logger::runTask exits"));
 				_pLogger->close();
 				_pLogger->shutdown();
 			}
 			break;
 		}
-		else
-		{
-			std::string logLine;
-			{
-				//retrieve a line of log
-				Poco::ScopedLock<Poco::Mutex> lock(_mutex);
-				if(_logBuffer.size() > 0) {
-					logLine = _logBuffer.front();
-					_logBuffer.pop_front();
-				}
-			}
-			if(logLine.size() > 0)
-			{
-				if(_logFileInitialized)
-				{
-					try
-					{
-						_pLogger->trace(logLine);
-					}
-					catch(Poco::Exception& e)
-					{
-						_logFileInitialized = false; //output to console
-						Log("Logger exception in log output: " + e.displayText());
-					}
-					catch(...)
-					{
-						_logFileInitialized = false; //output to console
-						Log("Logger unknown exception in log output");
-					}
-				}
-				else
-				{
-					printf("%s\r\n", logLine.c_str());
-				}
-			}
-			else {
-				sleep(10);
-			}
+
+		//wait for new logs
+		_writerWaiting.store(true);
+		if(_records[_consumerIndex & RECORD_INDEX_MASK].sequence.load() != (_consumerIndex + 1)) {
+			_logEvent.tryWait(WRITER_WAIT_TIMEOUT);
 		}
+		_writerWaiting.store(false);
 	}
 }
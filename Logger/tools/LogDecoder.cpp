@@ -0,0 +1,150 @@
+/*
+ * LogDecoder.cpp
+ *
+ * Render binary log files written by Logger to the text layout.
+ *
+ * Build: g++ -O2 -std=c++11 -o LogDecoder LogDecoder.cpp
+ * Usage: LogDecoder <dictionary file> <log file> [<log file> ...]
+ *   dictionary file is "<log file name>_formats.txt" in the log folder,
+ *   log files are decoded in the order given, archived files first.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include "../include/LogFormatter.h"
+
+static bool loadDictionary(const char * pPathFile, std::unordered_map<uint32_t, std::string>& formats)
+{
+	std::ifstream file(pPathFile);
+	std::string line;
+	std::string format;
+	uint32_t id;
+
+	if(!file) {
+		return false;
+	}
+	while(std::getline(file, line))
+	{
+		if(LogFormatter::ParseDictionaryLine(line, id, format)) {
+			formats[id] = format;
+		}
+	}
+
+	return true;
+}
+
+// same layout as Poco ISO8601_FRAC_FORMAT in UTC
+static void appendTime(std::string& out, int64_t time)
+{
+	time_t seconds = time / 1000000;
+	int microseconds = time % 1000000;
+	struct tm t;
+	char buffer[64];
+
+	if(microseconds < 0) {
+		seconds--;
+		microseconds += 1000000;
+	}
+	gmtime_r(&seconds, &t);
+	sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%06dZ",
+			t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, microseconds);
+	out += buffer;
+}
+
+static bool decodeFile(const char * pPathFile, const std::unordered_map<uint32_t, std::string>& formats)
+{
+	std::ifstream file(pPathFile, std::ios::in | std::ios::binary);
+
+	if(!file) {
+		fprintf(stderr, "LogDecoder cannot open %s\n", pPathFile);
+		return false;
+	}
+
+	std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	std::string lines;
+	size_t offset = 0;
+	size_t skipped = 0;
+
+	while(offset < content.size())
+	{
+		int64_t time;
+		uint32_t id;
+		const char * pArgs;
+		size_t argsLength;
+
+		//line feed appended by FileChannel
+		if((content[offset] == '\n') || (content[offset] == '\r')) {
+			offset++;
+			continue;
+		}
+		if(!LogFormatter::ParseRecord(content.data() + offset, content.size() - offset, time, id, pArgs, argsLength)) {
+			//truncated or corrupted data, look for next record.
+			skipped++;
+			offset++;
+			continue;
+		}
+		if(skipped > 0) {
+			fprintf(stderr, "LogDecoder skipped %lu bytes in %s\n", (unsigned long)skipped, pPathFile);
+			skipped = 0;
+		}
+
+		appendTime(lines, time);
+		lines += ' ';
+		if(id == LogFormatter::PLAIN_TEXT_FORMAT_ID)
+		{
+			LogFormatter::RenderPlainText(pArgs, argsLength, lines);
+		}
+		else
+		{
+			auto it = formats.find(id);
+			if(it != formats.end()) {
+				LogFormatter::Render(it->second.c_str(), pArgs, argsLength, lines);
+			}
+			else {
+				char buffer[32];
+				sprintf(buffer, "<unknown format %08x>", id);
+				lines += buffer;
+			}
+		}
+		lines += '\n';
+		offset += LogFormatter::RECORD_HEADER_LENGTH + argsLength;
+
+		if(lines.size() > 65536) {
+			fwrite(lines.data(), 1, lines.size(), stdout);
+			lines.clear();
+		}
+	}
+	if(skipped > 0) {
+		fprintf(stderr, "LogDecoder skipped %lu bytes in %s\n", (unsigned long)skipped, pPathFile);
+	}
+	fwrite(lines.data(), 1, lines.size(), stdout);
+
+	return true;
+}
+
+int main(int argc, char * argv[])
+{
+	std::unordered_map<uint32_t, std::string> formats;
+	int rc = 0;
+
+	if(argc < 3) {
+		fprintf(stderr, "Usage: %s <dictionary file> <log file> [<log file> ...]\n", argv[0]);
+		return 1;
+	}
+	if(!loadDictionary(argv[1], formats)) {
+		fprintf(stderr, "LogDecoder cannot open dictionary %s\n", argv[1]);
+		return 1;
+	}
+	for(int i = 2; i < argc; i++)
+	{
+		if(!decodeFile(argv[i], formats)) {
+			rc = 1;
+		}
+	}
+
+	return rc;
+}
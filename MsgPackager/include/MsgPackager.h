@@ -8,9 +8,9 @@
 #ifndef MSGPACKAGER_H_
 #define MSGPACKAGER_H_
 
-#include <deque>
 #include <vector>
 #include <string>
+#include <cstring>
 
 class MsgPackager
 {
@@ -43,37 +43,6 @@ public:
 
 	}
 
-	// make JSON command with data.
-	// invalid data at the beginning of data will be deleted.
-	// if a JSON command is created, the relevant content in data is deleted.
-	static void RetrieveMsgs(std::deque<unsigned char>& data/*input*/, std::vector<std::string>& msgs/*output*/)
-	{
-		for(;;)
-		{
-			std::string msg;
-
-			auto rc = retrieveMsg(data, msg);
-
-			if((rc == DataState::HEADER_ERROR) ||
-				(rc == DataState::LENGTH_ERROR) ||
-				(rc == DataState::VERSION_ERROR) ||
-				(rc == DataState::JSON_ERROR) ||
-				(rc == DataState::TAIL_ERROR))
-			{
-				//discard the first byte
-				data.pop_front();
-			}
-			else if(rc == DataState::PARTIAL_COMMAND)
-			{
-				break;
-			}
-			else if(rc == DataState::COMPLETE_COMMAND)
-			{
-				msgs.push_back(msg);
-			}
-		}
-	}
-
 private:
 	static const unsigned short HEADER_TAG = 0xAABB;
 	static const unsigned short VERSION = 0x0000;
@@ -85,78 +54,169 @@ private:
 	static const unsigned int tailWidth = 2;
 	static const unsigned int minimumCommandPacketLength = headerWidth + lengthWidth + versionWidth + tailWidth;
 
-	enum DataState
+	friend class MsgFramer;
+};
+
+
+/**
+ * Contiguous receiving buffer which retrieves packaged messages in place.
+ * Received bytes are appended to the end of buffer, complete messages are
+ * handed out as views into the buffer, and invalid bytes are skipped by searching
+ * for the next header tag.
+ */
+class MsgFramer
+{
+public:
+	//a message in the buffer, valid until the next call to Append() or Clear().
+	struct MsgView
 	{
-		HEADER_ERROR,
-		LENGTH_ERROR,
-		VERSION_ERROR,
-		JSON_ERROR,
-		TAIL_ERROR,
-		PARTIAL_COMMAND,
-		COMPLETE_COMMAND
+		const char * pData;
+		size_t length;
+
+		std::string ToString() const { return std::string(pData, length); }
 	};
 
-	//retrieve a command from deque and delete bytes of a complete command package
-	static DataState retrieveMsg(std::deque<unsigned char>& data, std::string& msg)
+	MsgFramer()
 	{
-		unsigned long contentLength;
-		unsigned short version;
+		_begin = 0;
+		_end = 0;
+	}
 
-		if(data.size() < minimumCommandPacketLength) {
-			return DataState::PARTIAL_COMMAND;
-		}
-		//check header
-		if(data[0] != ((HEADER_TAG>>8)&0xff)) {
-			return DataState::HEADER_ERROR;
-		}
-		if(data[1] != (HEADER_TAG&0xff)) {
-			return DataState::HEADER_ERROR;
-		}
-		//check length
-		contentLength = data[2];
-		contentLength = (contentLength<<8)+data[3];
-		if(contentLength < (versionWidth + tailWidth)) {
-			return DataState::LENGTH_ERROR;
-		}
-		//check version
-		version = data[4];
-		version = (version<<8) + data[5];
-		if(version > VERSION) {
-			return DataState::VERSION_ERROR;
-		}
-		//check package length
-		if((contentLength + headerWidth + lengthWidth) > data.size()) {
-			return DataState::PARTIAL_COMMAND;
+	//append received bytes to the buffer
+	void Append(const unsigned char * pData, size_t length)
+	{
+		if(length == 0) {
+			return;
 		}
-		//check tail
-		if(data[headerWidth + lengthWidth + contentLength -2] != ((TAIL_TAG >> 8) & 0xff)) {
-			return DataState::TAIL_ERROR;
+		if(_begin == _end) {
+			_begin = 0;
+			_end = 0;
 		}
-		if(data[headerWidth + lengthWidth + contentLength -1] != ((TAIL_TAG) & 0xff)) {
-			return DataState::TAIL_ERROR;
+		if((_end + length) > _buffer.size())
+		{
+			//move the unconsumed bytes to the front before growing the buffer
+			if(_begin > 0) {
+				memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+				_end -= _begin;
+				_begin = 0;
+			}
+			if((_end + length) > _buffer.size()) {
+				_buffer.resize(_end + length);
+			}
 		}
-		//check JSON
-		for(int i=0; i<(contentLength - versionWidth - tailWidth); i++) {
-			unsigned char c = data[headerWidth + lengthWidth + versionWidth +i];
-			if((c < ' ') || (c > '~')) {
-				//illegal JSON character
-				return DataState::JSON_ERROR;
+		memcpy(_buffer.data() + _end, pData, length);
+		_end += length;
+	}
+
+	// retrieve the next complete message.
+	// invalid data at the beginning of buffer will be deleted.
+	// return false if no complete message is available.
+	bool Next(MsgView& msg)
+	{
+		for(;;)
+		{
+			size_t size = _end - _begin;
+			const unsigned char * pData = _buffer.data() + _begin;
+			unsigned long contentLength;
+			unsigned short version;
+
+			if(size < MsgPackager::minimumCommandPacketLength) {
+				return false;
+			}
+			//check header
+			if((pData[0] != ((MsgPackager::HEADER_TAG>>8)&0xff)) || (pData[1] != (MsgPackager::HEADER_TAG&0xff))) {
+				resync();
+				continue;
+			}
+			//check length
+			contentLength = pData[2];
+			contentLength = (contentLength<<8) + pData[3];
+			if(contentLength < (MsgPackager::versionWidth + MsgPackager::tailWidth)) {
+				resync();
+				continue;
+			}
+			//check version
+			version = pData[4];
+			version = (version<<8) + pData[5];
+			if(version > MsgPackager::VERSION) {
+				resync();
+				continue;
+			}
+			//check package length
+			if((contentLength + MsgPackager::headerWidth + MsgPackager::lengthWidth) > size) {
+				return false;
+			}
+			//check tail
+			const unsigned char * pTail = pData + MsgPackager::headerWidth + MsgPackager::lengthWidth + contentLength - MsgPackager::tailWidth;
+			if((pTail[0] != ((MsgPackager::TAIL_TAG >> 8) & 0xff)) || (pTail[1] != (MsgPackager::TAIL_TAG & 0xff))) {
+				resync();
+				continue;
+			}
+			//check JSON
+			const unsigned char * pMsg = pData + MsgPackager::headerWidth + MsgPackager::lengthWidth + MsgPackager::versionWidth;
+			size_t msgLength = contentLength - MsgPackager::versionWidth - MsgPackager::tailWidth;
+			if(!isPrintable(pMsg, msgLength)) {
+				resync();
+				continue;
 			}
+
+			msg.pData = reinterpret_cast<const char *>(pMsg);
+			msg.length = msgLength;
+			_begin += MsgPackager::headerWidth + MsgPackager::lengthWidth + contentLength;
+			return true;
 		}
-		//retrieve command
-		for(int i=0; i<(contentLength - versionWidth - tailWidth); i++) {
-			unsigned char c = data[headerWidth + lengthWidth + versionWidth +i];
-			msg.push_back(c);
+	}
+
+	//retrieve all complete messages
+	void RetrieveMsgs(std::vector<std::string>& msgs/*output*/)
+	{
+		MsgView msg;
+
+		while(Next(msg)) {
+			msgs.push_back(msg.ToString());
 		}
-		//delete data
-		for(int i=0; i<(headerWidth + lengthWidth + contentLength); i++) {
-			data.pop_front();
+	}
+
+	size_t Size() const { return _end - _begin; }
+	bool Empty() const { return _begin == _end; }
+
+	void Clear()
+	{
+		_begin = 0;
+		_end = 0;
+	}
+
+private:
+	std::vector<unsigned char> _buffer;
+	size_t _begin; //first unconsumed byte
+	size_t _end; //end of received bytes
+
+	//discard the first byte, and then bytes up to the next possible header.
+	void resync()
+	{
+		const void * pTag;
+
+		_begin++;
+		pTag = memchr(_buffer.data() + _begin, (MsgPackager::HEADER_TAG >> 8) & 0xff, _end - _begin);
+		if(pTag == nullptr) {
+			_begin = _end;
+		}
+		else {
+			_begin = static_cast<const unsigned char *>(pTag) - _buffer.data();
 		}
+	}
 
-		return DataState::COMPLETE_COMMAND;
+	//check characters are in range of ' ' to '~' in one branchless pass
+	static bool isPrintable(const unsigned char * pData, size_t length)
+	{
+		unsigned char illegal = 0;
+
+		for(size_t i=0; i<length; i++) {
+			illegal |= (unsigned char)(pData[i] - ' ') > (unsigned char)('~' - ' ');
+		}
+		return illegal == 0;
 	}
 };
 
 
-
 #endif /* MSGPACKAGER_H_ */
@@ -0,0 +1,178 @@
+/*
+ * MsgFramerBenchmark.cpp
+ *
+ * Compare MsgFramer with the std::deque based framing it replaced.
+ * A stream of packaged messages mixed with garbage bytes is fed to both in chunks of random size,
+ * retrieved messages must be the same.
+ *
+ * Build: g++ -O2 -std=c++11 -I../include -o MsgFramerBenchmark MsgFramerBenchmark.cpp
+ * Usage: MsgFramerBenchmark [<stream size in MB>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include "MsgPackager.h"
+
+//former MsgPackager::RetrieveMsgs
+namespace DequeFraming
+{
+	const unsigned short HEADER_TAG = 0xAABB;
+	const unsigned short VERSION = 0x0000;
+	const unsigned short TAIL_TAG = 0xCCDD;
+	const unsigned int headerWidth = 2;
+	const unsigned int lengthWidth = 2;
+	const unsigned int versionWidth = 2;
+	const unsigned int tailWidth = 2;
+	const unsigned int minimumCommandPacketLength = headerWidth + lengthWidth + versionWidth + tailWidth;
+
+	enum DataState
+	{
+		FRAME_ERROR,
+		PARTIAL_COMMAND,
+		COMPLETE_COMMAND
+	};
+
+	DataState retrieveMsg(std::deque<unsigned char>& data, std::string& msg)
+	{
+		unsigned long contentLength;
+		unsigned short version;
+
+		if(data.size() < minimumCommandPacketLength) {
+			return PARTIAL_COMMAND;
+		}
+		if((data[0] != ((HEADER_TAG>>8)&0xff)) || (data[1] != (HEADER_TAG&0xff))) {
+			return FRAME_ERROR;
+		}
+		contentLength = data[2];
+		contentLength = (contentLength<<8)+data[3];
+		if(contentLength < (versionWidth + tailWidth)) {
+			return FRAME_ERROR;
+		}
+		version = data[4];
+		version = (version<<8) + data[5];
+		if(version > VERSION) {
+			return FRAME_ERROR;
+		}
+		if((contentLength + headerWidth + lengthWidth) > data.size()) {
+			return PARTIAL_COMMAND;
+		}
+		if((data[headerWidth + lengthWidth + contentLength -2] != ((TAIL_TAG >> 8) & 0xff)) ||
+			(data[headerWidth + lengthWidth + contentLength -1] != ((TAIL_TAG) & 0xff))) {
+			return FRAME_ERROR;
+		}
+		for(unsigned int i=0; i<(contentLength - versionWidth - tailWidth); i++) {
+			unsigned char c = data[headerWidth + lengthWidth + versionWidth +i];
+			if((c < ' ') || (c > '~')) {
+				return FRAME_ERROR;
+			}
+		}
+		for(unsigned int i=0; i<(contentLength - versionWidth - tailWidth); i++) {
+			msg.push_back(data[headerWidth + lengthWidth + versionWidth +i]);
+		}
+		for(unsigned int i=0; i<(headerWidth + lengthWidth + contentLength); i++) {
+			data.pop_front();
+		}
+
+		return COMPLETE_COMMAND;
+	}
+
+	void RetrieveMsgs(std::deque<unsigned char>& data, std::vector<std::string>& msgs)
+	{
+		for(;;)
+		{
+			std::string msg;
+			auto rc = retrieveMsg(data, msg);
+
+			if(rc == FRAME_ERROR) {
+				data.pop_front();
+			}
+			else if(rc == PARTIAL_COMMAND) {
+				break;
+			}
+			else {
+				msgs.push_back(msg);
+			}
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned int megaBytes = 16;
+	std::vector<unsigned char> stream;
+	std::vector<size_t> chunks;
+	int rc = 0;
+
+	if(argc > 1) {
+		megaBytes = atoi(argv[1]);
+	}
+
+	//packages of JSON like messages, 1 of 8 is followed by garbage which may contain header tag
+	srand(1);
+	while(stream.size() < megaBytes * 1024 * 1024)
+	{
+		std::string msg = "{\"command\":\"stepper query\",\"commandId\":" + std::to_string(rand()) + ",\"index\":" + std::to_string(rand() % 5) + "}";
+		MsgPackager::PackageMsg(msg, stream);
+		if((rand() % 8) == 0)
+		{
+			unsigned int amount = rand() % 32;
+			for(unsigned int i=0; i<amount; i++) {
+				stream.push_back((rand() % 4) == 0 ? 0xAA : rand() & 0xff);
+			}
+		}
+	}
+	//bytes come from socket in chunks
+	for(size_t total = 0; total < stream.size();)
+	{
+		size_t chunk = 1 + rand() % 2048;
+		if(total + chunk > stream.size()) {
+			chunk = stream.size() - total;
+		}
+		chunks.push_back(chunk);
+		total += chunk;
+	}
+
+	std::vector<std::string> dequeMsgs;
+	std::deque<unsigned char> dequeData;
+	auto start = std::chrono::steady_clock::now();
+	{
+		size_t offset = 0;
+		for(auto it = chunks.begin(); it != chunks.end(); it++)
+		{
+			dequeData.insert(dequeData.end(), stream.begin() + offset, stream.begin() + offset + *it);
+			offset += *it;
+			DequeFraming::RetrieveMsgs(dequeData, dequeMsgs);
+		}
+	}
+	auto dequeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<std::string> framerMsgs;
+	MsgFramer framer;
+	start = std::chrono::steady_clock::now();
+	{
+		size_t offset = 0;
+		for(auto it = chunks.begin(); it != chunks.end(); it++)
+		{
+			framer.Append(stream.data() + offset, *it);
+			offset += *it;
+			framer.RetrieveMsgs(framerMsgs);
+		}
+	}
+	auto framerTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if(dequeMsgs != framerMsgs) {
+		printf("MISMATCH: deque %lu messages, framer %lu messages\n", (unsigned long)dequeMsgs.size(), (unsigned long)framerMsgs.size());
+		rc = 1;
+	}
+
+	double size = stream.size() / (1024.0 * 1024.0);
+	printf("%.1f MB, %lu chunks, %lu messages\n", size, (unsigned long)chunks.size(), (unsigned long)framerMsgs.size());
+	printf("deque:     %.1f MB/s\n", size / dequeTime);
+	printf("MsgFramer: %.1f MB/s\n", size / framerTime);
+
+	return rc;
+}
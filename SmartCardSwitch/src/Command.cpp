@@ -124,6 +124,26 @@ std::string CommandDeviceQueryFuse::ToJsonCommandString()
 	return cmd;
 }
 
+///////////////////////////////////////////////////////////
+// CommandDeviceQueryStatus
+///////////////////////////////////////////////////////////
+std::string CommandDeviceQueryStatus::CommandKey()
+{
+	return std::string("device query status");
+}
+
+std::string CommandDeviceQueryStatus::ToJsonCommandString()
+{
+	std::string cmd;
+
+	cmd = "{";
+	cmd = cmd + "\"command\":\"device query status\",";
+	cmd = cmd + "\"commandId\":" + std::to_string(CommandId());
+	cmd += "}";
+
+	return cmd;
+}
+
 ///////////////////////////////////////////////////////
 // CommandBdcsPowerOn
 ///////////////////////////////////////////////////////
@@ -755,6 +775,138 @@ std::string CommandStepperMove::ToJsonCommandString()
 	return cmd;
 }
 
+///////////////////////////////////////////////////////////
+// CommandSteppersMove
+///////////////////////////////////////////////////////////
+CommandSteppersMove::CommandSteppersMove(const std::vector<Movement>& movements)
+{
+	_movements = movements;
+}
+
+std::string CommandSteppersMove::CommandKey()
+{
+	return std::string("steppers move");
+}
+
+std::string CommandSteppersMove::ToJsonCommandString()
+{
+	std::string cmd;
+
+	cmd = "{";
+	cmd = cmd + "\"command\":\"steppers move\",";
+	cmd = cmd + "\"commandId\":" + std::to_string(CommandId()) + ",";
+	cmd = cmd + "\"movements\":[";
+	for(auto it = _movements.begin(); it != _movements.end(); it++)
+	{
+		if(it != _movements.begin()) {
+			cmd += ",";
+		}
+		cmd = cmd + "{\"index\":" + std::to_string(it->stepperIndex) + ",";
+		cmd = cmd + "\"forward\":" + std::string(it->forward?"true":"false") + ",";
+		cmd = cmd + "\"steps\":" + std::to_string(it->steps) + ",";
+		cmd = cmd + "\"withPrevious\":" + std::string(it->withPrevious?"true":"false") + "}";
+	}
+	cmd += "]";
+	cmd += "}";
+
+	return cmd;
+}
+
+///////////////////////////////////////////////////////////
+// CommandMacroUpload
+///////////////////////////////////////////////////////////
+CommandMacroUpload::CommandMacroUpload(unsigned int macroId, const std::vector<std::string>& jsonSteps)
+{
+	_macroId = macroId;
+	_jsonSteps = jsonSteps;
+}
+
+std::string CommandMacroUpload::CommandKey()
+{
+	return std::string("macro upload");
+}
+
+std::string CommandMacroUpload::ToJsonCommandString()
+{
+	std::string cmd;
+
+	cmd = "{";
+	cmd = cmd + "\"command\":\"macro upload\",";
+	cmd = cmd + "\"commandId\":" + std::to_string(CommandId()) + ",";
+	cmd = cmd + "\"macroId\":" + std::to_string(_macroId) + ",";
+	cmd = cmd + "\"steps\":[";
+	for(auto it = _jsonSteps.begin(); it != _jsonSteps.end(); it++)
+	{
+		if(it != _jsonSteps.begin()) {
+			cmd += ",";
+		}
+		cmd += *it;
+	}
+	cmd += "]";
+	cmd += "}";
+
+	return cmd;
+}
+
+std::string CommandMacroUpload::SteppersMoveToStep(const std::vector<Movement>& movements)
+{
+	std::string cmd;
+
+	cmd = "{";
+	cmd = cmd + "\"command\":\"steppers move to\",";
+	cmd = cmd + "\"movements\":[";
+	for(auto it = movements.begin(); it != movements.end(); it++)
+	{
+		if(it != movements.begin()) {
+			cmd += ",";
+		}
+		cmd = cmd + "{\"index\":" + std::to_string(it->stepperIndex) + ",";
+		cmd = cmd + "\"position\":" + std::to_string(it->position) + ",";
+		cmd = cmd + "\"withPrevious\":" + std::string(it->withPrevious?"true":"false") + ",";
+		cmd = cmd + "\"parameter\":" + std::to_string(it->parameter) + "}";
+	}
+	cmd += "]";
+	cmd += "}";
+
+	return cmd;
+}
+
+///////////////////////////////////////////////////////////
+// CommandMacroRun
+///////////////////////////////////////////////////////////
+CommandMacroRun::CommandMacroRun(unsigned int macroId, const std::vector<long>& parameters)
+{
+	_macroId = macroId;
+	_parameters = parameters;
+}
+
+std::string CommandMacroRun::CommandKey()
+{
+	return std::string("macro run");
+}
+
+std::string CommandMacroRun::ToJsonCommandString()
+{
+	std::string cmd;
+
+	cmd = "{";
+	cmd = cmd + "\"command\":\"macro run\",";
+	cmd = cmd + "\"commandId\":" + std::to_string(CommandId()) + ",";
+	cmd = cmd + "\"macroId\":" + std::to_string(_macroId) + ",";
+	cmd = cmd + "\"parameters\":[";
+	for(auto it = _parameters.begin(); it != _parameters.end(); it++)
+	{
+		if(it != _parameters.begin()) {
+			cmd += ",";
+		}
+		cmd += std::to_string(*it);
+	}
+	cmd += "]";
+	cmd += "}";
+
+	return cmd;
+}
+
 /////////////////////////////////////////////////
 // CommandStepperForwardClockwise
 /////////////////////////////////////////////////
@@ -9,6 +9,7 @@
 #define COMMAND_H_
 
 #include <string>
+#include <vector>
 
 //base of all commands which are to be sent to DeviceAccessor object.
 class DeviceCommand
@@ -76,6 +77,14 @@ public:
 	virtual std::string ToJsonCommandString() override;
 };
 
+//power, fuse, BDCs, steppers and locators in one reply
+class CommandDeviceQueryStatus: public DeviceCommand
+{
+public:
+	virtual std::string CommandKey() override;
+	virtual std::string ToJsonCommandString() override;
+};
+
 class CommandBdcsPowerOn: public DeviceCommand
 {
 public:
@@ -340,6 +349,67 @@ private:
 	unsigned long _steps;
 };
 
+//a batch of stepper movements which are run by device in order,
+//a movement with withPrevious set starts together with the previous movement.
+class CommandSteppersMove: public DeviceCommand
+{
+public:
+	struct Movement
+	{
+		unsigned int stepperIndex;
+		bool forward;
+		unsigned long steps;
+		bool withPrevious;
+	};
+
+	CommandSteppersMove(const std::vector<Movement>& movements);
+
+	virtual std::string CommandKey() override;
+	virtual std::string ToJsonCommandString() override;
+
+private:
+	std::vector<Movement> _movements;
+};
+
+//steps are kept by device and run later with CommandMacroRun.
+//a step is JSON of an existing command, or of "steppers move to" which only exists in macro.
+class CommandMacroUpload: public DeviceCommand
+{
+public:
+	struct Movement
+	{
+		unsigned int stepperIndex;
+		long position;
+		bool withPrevious;
+		int parameter; //-1 if position isn't adjusted by macro parameter
+	};
+
+	CommandMacroUpload(unsigned int macroId, const std::vector<std::string>& jsonSteps);
+
+	virtual std::string CommandKey() override;
+	virtual std::string ToJsonCommandString() override;
+
+	//JSON of a step which moves steppers to absolute positions
+	static std::string SteppersMoveToStep(const std::vector<Movement>& movements);
+
+private:
+	unsigned int _macroId;
+	std::vector<std::string> _jsonSteps;
+};
+
+class CommandMacroRun: public DeviceCommand
+{
+public:
+	CommandMacroRun(unsigned int macroId, const std::vector<long>& parameters);
+
+	virtual std::string CommandKey() override;
+	virtual std::string ToJsonCommandString() override;
+
+private:
+	unsigned int _macroId;
+	std::vector<long> _parameters;
+};
+
 class CommandStepperForwardClockwise: public DeviceCommand
 {
 public:
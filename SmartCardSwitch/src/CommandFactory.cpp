@@ -43,6 +43,13 @@ std::shared_ptr<DeviceCommand> CommandFactory::DeviceQueryFuse()
 	return ptr;
 }
 
+std::shared_ptr<DeviceCommand> CommandFactory::DeviceQueryStatus()
+{
+	std::shared_ptr<DeviceCommand> ptr(new CommandDeviceQueryStatus());
+
+	return ptr;
+}
+
 std::shared_ptr<DeviceCommand> CommandFactory::BdcsPowerOn()
 {
 	std::shared_ptr<DeviceCommand> ptr(new CommandBdcsPowerOn());
@@ -206,6 +213,28 @@ std::shared_ptr<DeviceCommand> CommandFactory::StepperMove(unsigned int stepperI
 
 	return ptr;
 }
+
+std::shared_ptr<DeviceCommand> CommandFactory::SteppersMove(const std::vector<CommandSteppersMove::Movement>& movements)
+{
+	std::shared_ptr<DeviceCommand> ptr(new CommandSteppersMove(movements));
+
+	return ptr;
+}
+
+std::shared_ptr<DeviceCommand> CommandFactory::MacroUpload(unsigned int macroId, const std::vector<std::string>& jsonSteps)
+{
+	std::shared_ptr<DeviceCommand> ptr(new CommandMacroUpload(macroId, jsonSteps));
+
+	return ptr;
+}
+
+std::shared_ptr<DeviceCommand> CommandFactory::MacroRun(unsigned int macroId, const std::vector<long>& parameters)
+{
+	std::shared_ptr<DeviceCommand> ptr(new CommandMacroRun(macroId, parameters));
+
+	return ptr;
+}
+
 std::shared_ptr<DeviceCommand> CommandFactory::StepperForwardClockwise(unsigned int stepperIndex, bool forwardClockwise)
 {
 	std::shared_ptr<DeviceCommand> ptr(new CommandStepperForwardClockwise(stepperIndex, forwardClockwise));
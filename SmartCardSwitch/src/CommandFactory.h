@@ -21,6 +21,7 @@ public:
 	static std::shared_ptr<DeviceCommand> DeviceDelay(unsigned int clks);
 	static std::shared_ptr<DeviceCommand> DeviceQueryPower();
 	static std::shared_ptr<DeviceCommand> DeviceQueryFuse();
+	static std::shared_ptr<DeviceCommand> DeviceQueryStatus();
 	static std::shared_ptr<DeviceCommand> BdcsPowerOn();
 	static std::shared_ptr<DeviceCommand> BdcsPowerOff();
 	static std::shared_ptr<DeviceCommand> BdcsQueryPower();
@@ -49,6 +50,9 @@ public:
 	static std::shared_ptr<DeviceCommand> StepperQuery(unsigned int stepperIndex);
 	static std::shared_ptr<DeviceCommand> StepperSetState(unsigned int stepperIndex, unsigned int state);
 	static std::shared_ptr<DeviceCommand> StepperMove(unsigned int stepperIndex, unsigned long position, bool forward, unsigned long steps);
+	static std::shared_ptr<DeviceCommand> SteppersMove(const std::vector<CommandSteppersMove::Movement>& movements);
+	static std::shared_ptr<DeviceCommand> MacroUpload(unsigned int macroId, const std::vector<std::string>& jsonSteps);
+	static std::shared_ptr<DeviceCommand> MacroRun(unsigned int macroId, const std::vector<long>& parameters);
 	static std::shared_ptr<DeviceCommand> StepperForwardClockwise(unsigned int stepperIndex, bool forwardClockwise);
 	static std::shared_ptr<DeviceCommand> LocatorQuery(unsigned int locatorIndex);
 	static std::shared_ptr<DeviceCommand> OptPowerOn();
@@ -19,8 +19,9 @@ extern Logger * pLogger;
 extern CoordinateStorage * pCoordinateStorage;
 extern MovementConfiguration * pMovementConfiguration;
 
-CommandRunner::CommandRunner(): Task("CommandRunner")
+CommandRunner::CommandRunner(unsigned int maxPendingCommands): Task("CommandRunner")
 {
+	_maxPendingCommands = (maxPendingCommands > 0) ? maxPendingCommands : 1;
 	_userCommand.state = UserCommand::CommandState::IDLE;
 	//device power status
 	_userCommand.resultDevicePowerStatus = UserCommand::PowerStatus::UNKNOWN;
@@ -89,8 +90,20 @@ void CommandRunner::runTask()
 			}
 			else
 			{
-				Poco::ScopedLock<Poco::Mutex> lock(_mutex);
-				processFeedbacks();
+				std::deque<std::function<void(IResponseReceiver *)>> notifications;
+
+				{
+					Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+					processFeedbacks();
+					notifications.swap(_notifications);
+				}
+
+				for(auto it = notifications.begin(); it != notifications.end(); it++)
+				{
+					for(auto receiverIt = _cmdResponseReceiverArray.begin(); receiverIt != _cmdResponseReceiverArray.end(); receiverIt++) {
+						(*it)(*receiverIt);
+					}
+				}
 			}
 		}
 	}
@@ -98,6 +111,11 @@ void CommandRunner::runTask()
 	pLogger->LogInfo("CommandRunner::runTask exited");
 }
 
+void CommandRunner::notifyReceivers(std::function<void(IResponseReceiver *)> notification)
+{
+	_notifications.push_back(notification);
+}
+
 void CommandRunner::saveMovementConfig()
 {
 	for(unsigned int i=0; i<STEPPER_AMOUNT; i++)
@@ -129,18 +147,31 @@ void CommandRunner::saveMovementConfig()
 
 bool CommandRunner::isCorrespondingReply(const std::string& commandKey, unsigned short commandId)
 {
-	bool bCorrespondingReply = false;
+	CommandParameters command;
 
-	if(_userCommand.state != UserCommand::CommandState::COMMAND_SENT) {
-		pLogger->LogError("CommandRunner::isCorrespondingReply obsolete reply");
+	if(!isCorrespondingReply(commandKey, commandId, command)) {
+		return false;
 	}
-	else if(_userCommand.commandKey != commandKey) {
-		pLogger->LogError("CommandRunner::isCorrespondingReply command key doesn't match, original: '" + _userCommand.commandKey + "', key in reply: '" + commandKey + "'");
+	//reply handlers read parameters of the command from _userCommand
+	static_cast<CommandParameters&>(_userCommand) = command;
+
+	return true;
+}
+
+bool CommandRunner::isCorrespondingReply(const std::string& commandKey, unsigned short commandId, CommandParameters& command)
+{
+	bool bCorrespondingReply = false;
+	auto it = _pendingCommands.find(commandId);
+
+	if(it == _pendingCommands.end()) {
+		pLogger->LogError("CommandRunner::isCorrespondingReply obsolete reply, cmdId in reply: " + std::to_string(commandId));
 	}
-	else if((_userCommand.commandId & 0xffff) != commandId) {
-		pLogger->LogError("CommandRunner::isCorrespondingReply commandId doesn't match, original: " + std::to_string(_userCommand.commandId) + ", cmdId in reply: " + std::to_string(commandId));
+	else if(it->second.commandKey != commandKey) {
+		pLogger->LogError("CommandRunner::isCorrespondingReply command key doesn't match, original: '" + it->second.commandKey + "', key in reply: '" + commandKey + "'");
 	}
 	else {
+		command = it->second;
+		_pendingCommands.erase(it);
 		bCorrespondingReply = true;
 	}
 
@@ -168,13 +199,10 @@ void CommandRunner::onFeedbackDevicesGet(std::shared_ptr<ReplyTranslator::ReplyD
 
 	_userCommand.state = UserCommand::CommandState::SUCCEEDED;
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnDevicesGet(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultDevices);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnDevicesGet, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultDevices));
 }
 
 void CommandRunner::onFeedbackDeviceConnect(std::shared_ptr<ReplyTranslator::ReplyDeviceConnect> replyPtr)
@@ -194,12 +222,9 @@ void CommandRunner::onFeedbackDeviceConnect(std::shared_ptr<ReplyTranslator::Rep
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnDeviceConnect(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnDeviceConnect, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackDeviceDelay(std::shared_ptr<ReplyTranslator::ReplyDeviceDelay> replyPtr)
@@ -217,12 +242,9 @@ void CommandRunner::onFeedbackDeviceDelay(std::shared_ptr<ReplyTranslator::Reply
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnDeviceDelay(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnDeviceDelay, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackDeviceQueryPower(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryPower> replyPtr)
@@ -251,13 +273,10 @@ void CommandRunner::onFeedbackDeviceQueryPower(std::shared_ptr<ReplyTranslator::
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnDeviceQueryPower(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultDevicePowerStatus == UserCommand::PowerStatus::POWERED_ON);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnDeviceQueryPower, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultDevicePowerStatus == UserCommand::PowerStatus::POWERED_ON));
 }
 
 void CommandRunner::onFeedbackDeviceQueryFuse(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryFuse> replyPtr)
@@ -286,13 +305,129 @@ void CommandRunner::onFeedbackDeviceQueryFuse(std::shared_ptr<ReplyTranslator::R
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
+	notifyReceivers(std::bind(&IResponseReceiver::OnDeviceQueryFuse, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultDeviceFuseStatus == UserCommand::FuseStatus::FUSE_ON));
+}
+
+void CommandRunner::onFeedbackDeviceQueryStatus(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryStatus> replyPtr)
+{
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+		return;
+	}
+
+	bool success = false;
+	IResponseReceiver::StatusSnapshot status;
+
+	if(!replyPtr->errorInfo.empty()) {
+		pLogger->LogError("CommandRunner::onFeedbackDeviceQueryStatus error: " + replyPtr->errorInfo);
+	}
+	else if((replyPtr->bdcModes.size() != BDC_AMOUNT) ||
+			(replyPtr->steppers.size() != STEPPER_AMOUNT) ||
+			(replyPtr->lowInputs.size() != LOCATOR_AMOUNT))
 	{
-		auto pReceiver = *it;
-		pReceiver->OnDeviceQueryFuse(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultDeviceFuseStatus == UserCommand::FuseStatus::FUSE_ON);
+		pLogger->LogError("CommandRunner::onFeedbackDeviceQueryStatus wrong amount, bdcs: " + std::to_string(replyPtr->bdcModes.size()) +
+				", steppers: " + std::to_string(replyPtr->steppers.size()) +
+				", locators: " + std::to_string(replyPtr->lowInputs.size()));
 	}
+	else
+	{
+		pLogger->LogInfo("CommandRunner::onFeedbackDeviceQueryStatus powered: " + std::string(replyPtr->bPoweredOn?"true":"false") +
+				", fuse: " + std::string(replyPtr->bFuseOn?"true":"false") +
+				", bdcs powered: " + std::string(replyPtr->bBdcsPoweredOn?"true":"false") +
+				", steppers powered: " + std::string(replyPtr->bSteppersPowered?"true":"false"));
+
+		_userCommand.resultDevicePowerStatus = replyPtr->bPoweredOn ? UserCommand::PowerStatus::POWERED_ON : UserCommand::PowerStatus::POWERED_OFF;
+		_userCommand.resultDeviceFuseStatus = replyPtr->bFuseOn ? UserCommand::FuseStatus::FUSE_ON : UserCommand::FuseStatus::FUSE_OFF;
+		_userCommand.resultBdcsPowerStatus = replyPtr->bBdcsPoweredOn ? UserCommand::PowerStatus::POWERED_ON : UserCommand::PowerStatus::POWERED_OFF;
+		_userCommand.resultSteppersPowerStatus = replyPtr->bSteppersPowered ? UserCommand::PowerStatus::POWERED_ON : UserCommand::PowerStatus::POWERED_OFF;
+		status.bPoweredOn = replyPtr->bPoweredOn;
+		status.bFuseOn = replyPtr->bFuseOn;
+		status.bBdcsPoweredOn = replyPtr->bBdcsPoweredOn;
+		status.bSteppersPoweredOn = replyPtr->bSteppersPowered;
+
+		//BDCs
+		for(unsigned int i=0; i<BDC_AMOUNT; i++)
+		{
+			switch(replyPtr->bdcModes[i])
+			{
+				case ReplyTranslator::ReplyBdcQuery::BdcMode::COAST:
+					_userCommand.resultBdcStatus[i] = IResponseReceiver::BdcStatus::COAST;
+					break;
+				case ReplyTranslator::ReplyBdcQuery::BdcMode::REVERSE:
+					_userCommand.resultBdcStatus[i] = IResponseReceiver::BdcStatus::REVERSE;
+					break;
+				case ReplyTranslator::ReplyBdcQuery::BdcMode::FORWARD:
+					_userCommand.resultBdcStatus[i] = IResponseReceiver::BdcStatus::FORWARD;
+					break;
+				case ReplyTranslator::ReplyBdcQuery::BdcMode::BREAK:
+					_userCommand.resultBdcStatus[i] = IResponseReceiver::BdcStatus::BREAK;
+					break;
+				default:
+					_userCommand.resultBdcStatus[i] = IResponseReceiver::BdcStatus::UNKNOWN;
+					break;
+			}
+			status.bdcs.push_back(_userCommand.resultBdcStatus[i]);
+		}
+
+		//steppers, forward clockwise isn't kept by device.
+		for(unsigned int i=0; i<STEPPER_AMOUNT; i++)
+		{
+			auto& reply = replyPtr->steppers[i];
+			auto& local = _userCommand.resultStepperStatus[i];
+			IResponseReceiver::StepperStatus stepper;
+
+			local.state = reply.state;
+			local.enabled = reply.bEnabled ? UserCommand::StepperEnableStatus::ENABLED : UserCommand::StepperEnableStatus::DISABLED;
+			local.forward = reply.bForward ? UserCommand::StepperDirectionStatus::FORWORD : UserCommand::StepperDirectionStatus::REVERSE;
+			local.locatorIndex = reply.locatorIndex;
+			local.locatorLineNumberStart = reply.locatorLineNumberStart;
+			local.locatorLineNumberTerminal = reply.locatorLineNumberTerminal;
+			local.homeOffset = reply.homeOffset;
+			local.lowClks = reply.lowClks;
+			local.highClks = reply.highClks;
+			local.accelerationBuffer = reply.accelerationBuffer;
+			local.accelerationBufferDecrement = reply.accelerationBufferDecrement;
+			local.decelerationBuffer = reply.decelerationBuffer;
+			local.decelerationBufferIncrement = reply.decelerationBufferIncrement;
+
+			stepper.state = toStepperState(local.state);
+			stepper.bEnabled = reply.bEnabled;
+			stepper.bForward = reply.bForward;
+			stepper.bForwardClockwise = (local.forwardClockwise == UserCommand::StepperForwardClockwiseStatus::CLOCKWISE);
+			stepper.locatorIndex = local.locatorIndex;
+			stepper.locatorLineNumberStart = local.locatorLineNumberStart;
+			stepper.locatorLineNumberTerminal = local.locatorLineNumberTerminal;
+			stepper.homeOffset = local.homeOffset;
+			stepper.lowClks = local.lowClks;
+			stepper.highClks = local.highClks;
+			stepper.accelerationBuffer = local.accelerationBuffer;
+			stepper.accelerationBufferDecrement = local.accelerationBufferDecrement;
+			stepper.decelerationBuffer = local.decelerationBuffer;
+			stepper.decelerationBufferIncrement = local.decelerationBufferIncrement;
+			status.steppers.push_back(stepper);
+		}
+
+		//locators
+		for(unsigned int i=0; i<LOCATOR_AMOUNT; i++)
+		{
+			_userCommand.resultLocatorStatus[i] = replyPtr->lowInputs[i];
+			status.locators.push_back(replyPtr->lowInputs[i]);
+		}
+
+		success = true;
+	}
+
+	if(success) {
+		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
+	}
+	else {
+		_userCommand.state = UserCommand::CommandState::FAILED;
+	}
+
+	notifyReceivers(std::bind(&IResponseReceiver::OnDeviceQueryStatus, std::placeholders::_1,
+			_userCommand.commandId, success, status));
 }
 
 void CommandRunner::onFeedbackBdcsPowerOn(std::shared_ptr<ReplyTranslator::ReplyBdcsPowerOn> replyPtr)
@@ -314,12 +449,9 @@ void CommandRunner::onFeedbackBdcsPowerOn(std::shared_ptr<ReplyTranslator::Reply
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcsPowerOn(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcsPowerOn, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcsPowerOff(std::shared_ptr<ReplyTranslator::ReplyBdcsPowerOff> replyPtr)
@@ -341,12 +473,9 @@ void CommandRunner::onFeedbackBdcsPowerOff(std::shared_ptr<ReplyTranslator::Repl
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcsPowerOff(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcsPowerOff, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcsQueryPower(std::shared_ptr<ReplyTranslator::ReplyBdcsQueryPower> replyPtr)
@@ -382,13 +511,10 @@ void CommandRunner::onFeedbackBdcsQueryPower(std::shared_ptr<ReplyTranslator::Re
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcsQueryPower(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultBdcsPowerStatus == UserCommand::PowerStatus::POWERED_ON);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcsQueryPower, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultBdcsPowerStatus == UserCommand::PowerStatus::POWERED_ON));
 }
 
 void CommandRunner::onFeedbackBdcCoast(std::shared_ptr<ReplyTranslator::ReplyBdcCoast> replyPtr)
@@ -422,12 +548,9 @@ void CommandRunner::onFeedbackBdcCoast(std::shared_ptr<ReplyTranslator::ReplyBdc
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcCoast(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcCoast, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcReverse(std::shared_ptr<ReplyTranslator::ReplyBdcReverse> replyPtr)
@@ -460,12 +583,9 @@ void CommandRunner::onFeedbackBdcReverse(std::shared_ptr<ReplyTranslator::ReplyB
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcReverse(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcReverse, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcForward(std::shared_ptr<ReplyTranslator::ReplyBdcForward> replyPtr)
@@ -498,12 +618,9 @@ void CommandRunner::onFeedbackBdcForward(std::shared_ptr<ReplyTranslator::ReplyB
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcForward(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcForward, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcBreak(std::shared_ptr<ReplyTranslator::ReplyBdcBreak> replyPtr)
@@ -536,12 +653,9 @@ void CommandRunner::onFeedbackBdcBreak(std::shared_ptr<ReplyTranslator::ReplyBdc
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcBreak(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcBreak, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackBdcQuery(std::shared_ptr<ReplyTranslator::ReplyBdcQuery> replyPtr)
@@ -593,13 +707,10 @@ void CommandRunner::onFeedbackBdcQuery(std::shared_ptr<ReplyTranslator::ReplyBdc
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnBdcQuery(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultBdcStatus[replyPtr->index]);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnBdcQuery, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultBdcStatus[replyPtr->index]));
 }
 
 void CommandRunner::onFeedbackSteppersPowerOn(std::shared_ptr<ReplyTranslator::ReplySteppersPowerOn> replyPtr)
@@ -627,12 +738,9 @@ void CommandRunner::onFeedbackSteppersPowerOn(std::shared_ptr<ReplyTranslator::R
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnSteppersPowerOn(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnSteppersPowerOn, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackSteppersPowerOff(std::shared_ptr<ReplyTranslator::ReplySteppersPowerOff> replyPtr)
@@ -660,12 +768,9 @@ void CommandRunner::onFeedbackSteppersPowerOff(std::shared_ptr<ReplyTranslator::
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnSteppersPowerOff(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnSteppersPowerOff, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackSteppersQueryPower(std::shared_ptr<ReplyTranslator::ReplySteppersQueryPower> replyPtr)
@@ -708,13 +813,10 @@ void CommandRunner::onFeedbackSteppersQueryPower(std::shared_ptr<ReplyTranslator
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnSteppersQueryPower(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultSteppersPowerStatus == UserCommand::PowerStatus::POWERED_ON);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnSteppersQueryPower, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultSteppersPowerStatus == UserCommand::PowerStatus::POWERED_ON));
 }
 
 void CommandRunner::onFeedbackStepperQueryResolution(std::shared_ptr<ReplyTranslator::ReplyStepperQueryResolution> replyPtr)
@@ -742,13 +844,10 @@ void CommandRunner::onFeedbackStepperQueryResolution(std::shared_ptr<ReplyTransl
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperQueryResolution(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultStepperClkResolution);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperQueryResolution, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			_userCommand.resultStepperClkResolution));
 }
 
 void CommandRunner::onFeedbackStepperConfigStep(std::shared_ptr<ReplyTranslator::ReplyStepperConfigStep> replyPtr)
@@ -787,12 +886,9 @@ void CommandRunner::onFeedbackStepperConfigStep(std::shared_ptr<ReplyTranslator:
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperConfigStep(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperConfigStep, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperAccelerationBuffer(std::shared_ptr<ReplyTranslator::ReplyStepperAccelerationBuffer> replyPtr)
@@ -829,12 +925,9 @@ void CommandRunner::onFeedbackStepperAccelerationBuffer(std::shared_ptr<ReplyTra
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperAccelerationBuffer(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperAccelerationBuffer, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperAccelerationBufferDecrement(std::shared_ptr<ReplyTranslator::ReplyStepperAccelerationBufferDecrement> replyPtr)
@@ -871,12 +964,9 @@ void CommandRunner::onFeedbackStepperAccelerationBufferDecrement(std::shared_ptr
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperAccelerationBufferDecrement(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperAccelerationBufferDecrement, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperDecelerationBuffer(std::shared_ptr<ReplyTranslator::ReplyStepperDecelerationBuffer> replyPtr)
@@ -913,12 +1003,9 @@ void CommandRunner::onFeedbackStepperDecelerationBuffer(std::shared_ptr<ReplyTra
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperDecelerationBuffer(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperDecelerationBuffer, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperDecelerationBufferIncrement(std::shared_ptr<ReplyTranslator::ReplyStepperDecelerationBufferIncrement> replyPtr)
@@ -955,12 +1042,9 @@ void CommandRunner::onFeedbackStepperDecelerationBufferIncrement(std::shared_ptr
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperDecelerationBufferIncrement(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperDecelerationBufferIncrement, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperEnable(std::shared_ptr<ReplyTranslator::ReplyStepperEnable> replyPtr)
@@ -1002,12 +1086,9 @@ void CommandRunner::onFeedbackStepperEnable(std::shared_ptr<ReplyTranslator::Rep
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperEnable(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperEnable, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperForward(std::shared_ptr<ReplyTranslator::ReplyStepperForward> replyPtr)
@@ -1049,12 +1130,9 @@ void CommandRunner::onFeedbackStepperForward(std::shared_ptr<ReplyTranslator::Re
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperForward(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperForward, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperSteps(std::shared_ptr<ReplyTranslator::ReplyStepperSteps> replyPtr)
@@ -1089,17 +1167,16 @@ void CommandRunner::onFeedbackStepperSteps(std::shared_ptr<ReplyTranslator::Repl
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperSteps(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperSteps, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperRun(std::shared_ptr<ReplyTranslator::ReplyStepperRun> replyPtr)
 {
-	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+	//steppers of a concurrent movement run at the same time, parameters of this one are kept apart from _userCommand
+	CommandParameters command;
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId, command)) {
 		return;
 	}
 
@@ -1110,19 +1187,19 @@ void CommandRunner::onFeedbackStepperRun(std::shared_ptr<ReplyTranslator::ReplyS
 		if(replyPtr->index >= STEPPER_AMOUNT) {
 			pLogger->LogError("CommandRunner::onFeedbackStepperRun index out of range: " + std::to_string(replyPtr->index));
 		}
-		else if(replyPtr->index != _userCommand.stepperIndex) {
-			pLogger->LogError("CommandRunner::onFeedbackStepperRun wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(_userCommand.stepperIndex));
+		else if(replyPtr->index != command.stepperIndex) {
+			pLogger->LogError("CommandRunner::onFeedbackStepperRun wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(command.stepperIndex));
 		}
 		else
 		{
-			if(replyPtr->position == _userCommand.finalPosition) {
+			if(replyPtr->position == command.finalPosition) {
 				pLogger->LogInfo("CommandRunner::onFeedbackStepperRun succeed, index: " + std::to_string(replyPtr->index) + ", position: " + std::to_string(replyPtr->position));
 				success = true;
 			}
 			else {
 				pLogger->LogInfo("CommandRunner::onFeedbackStepperRun failed, index: " + std::to_string(replyPtr->index) +
 						", position: " + std::to_string(replyPtr->position) +
-						", expected position: " + std::to_string(_userCommand.finalPosition));
+						", expected position: " + std::to_string(command.finalPosition));
 				success = false;
 			}
 			_userCommand.resultStepperStatus[replyPtr->index].homeOffset = replyPtr->position;
@@ -1132,19 +1209,9 @@ void CommandRunner::onFeedbackStepperRun(std::shared_ptr<ReplyTranslator::ReplyS
 		pLogger->LogError("CommandRunner::onFeedbackStepperRun error: " + replyPtr->errorInfo);
 	}
 
-	if(success) {
-		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
-	}
-	else {
-		_userCommand.state = UserCommand::CommandState::FAILED;
-	}
-
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperRun(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperRun, std::placeholders::_1,
+			command.commandId,
+			success));
 }
 
 void CommandRunner::onFeedbackStepperConfigHome(std::shared_ptr<ReplyTranslator::ReplyStepperConfigHome> replyPtr)
@@ -1187,12 +1254,9 @@ void CommandRunner::onFeedbackStepperConfigHome(std::shared_ptr<ReplyTranslator:
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperConfigHome(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperConfigHome, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperMove(std::shared_ptr<ReplyTranslator::ReplyStepperMove> replyPtr)
@@ -1205,9 +1269,44 @@ void CommandRunner::onFeedbackStepperMove(std::shared_ptr<ReplyTranslator::Reply
 	_userCommand.state = UserCommand::CommandState::FAILED;
 }
 
+IResponseReceiver::StepperState CommandRunner::toStepperState(const std::string& state)
+{
+	IResponseReceiver::StepperState stepperState;
+
+	if(state == StepperStateApproachingHomeLocator) {
+		stepperState = IResponseReceiver::StepperState::ApproachingHomeLocator;
+	}
+	else if(state == StepperStateLeavingHomeLocator) {
+		stepperState = IResponseReceiver::StepperState::LeavingHomeLocator;
+	}
+	else if(state == StepperStateGoingHome) {
+		stepperState = IResponseReceiver::StepperState::GoingHome;
+	}
+	else if(state == StepperStateKnownPosition) {
+		stepperState = IResponseReceiver::StepperState::KnownPosition;
+	}
+	else if(state == StepperStateAccelerating) {
+		stepperState = IResponseReceiver::StepperState::Accelerating;
+	}
+	else if(state == StepperStateCruising) {
+		stepperState = IResponseReceiver::StepperState::Cruising;
+	}
+	else if(state == StepperStateDecelerating) {
+		stepperState = IResponseReceiver::StepperState::Decelerating;
+	}
+	else {
+		pLogger->LogError("CommandRunner::toStepperState unknown state string: " + state);
+		stepperState = IResponseReceiver::StepperState::Unknown;
+	}
+
+	return stepperState;
+}
+
 void CommandRunner::onFeedbackStepperQuery(std::shared_ptr<ReplyTranslator::ReplyStepperQuery> replyPtr)
 {
-	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+	//several of them can be waiting for reply, parameters of this one are kept apart from _userCommand
+	CommandParameters command;
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId, command)) {
 		return;
 	}
 
@@ -1218,8 +1317,8 @@ void CommandRunner::onFeedbackStepperQuery(std::shared_ptr<ReplyTranslator::Repl
 		if(replyPtr->index >= STEPPER_AMOUNT) {
 			pLogger->LogError("CommandRunner::onFeedbackStepperQuery index out of range: " + std::to_string(replyPtr->index));
 		}
-		else if(replyPtr->index != _userCommand.stepperIndex) {
-			pLogger->LogError("CommandRunner::onFeedbackStepperQuery wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(_userCommand.stepperIndex));
+		else if(replyPtr->index != command.stepperIndex) {
+			pLogger->LogError("CommandRunner::onFeedbackStepperQuery wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(command.stepperIndex));
 		}
 		else
 		{
@@ -1378,60 +1477,29 @@ void CommandRunner::onFeedbackStepperQuery(std::shared_ptr<ReplyTranslator::Repl
 	}
 
 	IResponseReceiver::StepperState stepperState;
+	auto& status = _userCommand.resultStepperStatus[command.stepperIndex];
 
 	if(success) {
-		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
-
-		if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateApproachingHomeLocator) {
-			stepperState = IResponseReceiver::StepperState::ApproachingHomeLocator;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateLeavingHomeLocator) {
-			stepperState = IResponseReceiver::StepperState::LeavingHomeLocator;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateGoingHome) {
-			stepperState = IResponseReceiver::StepperState::GoingHome;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateKnownPosition) {
-			stepperState = IResponseReceiver::StepperState::KnownPosition;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateAccelerating) {
-			stepperState = IResponseReceiver::StepperState::Accelerating;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateCruising) {
-			stepperState = IResponseReceiver::StepperState::Cruising;
-		}
-		else if(_userCommand.resultStepperStatus[replyPtr->index].state == StepperStateDecelerating) {
-			stepperState = IResponseReceiver::StepperState::Decelerating;
-		}
-		else {
-			pLogger->LogError("CommandRunner::onFeedbackStepperQuery unknown state string: " + _userCommand.resultStepperStatus[replyPtr->index].state);
-			stepperState = IResponseReceiver::StepperState::Unknown;
-		}
-	}
-	else {
-		_userCommand.state = UserCommand::CommandState::FAILED;
-	}
-
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperQuery(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				stepperState,
-				_userCommand.resultStepperStatus[replyPtr->index].enabled == UserCommand::StepperEnableStatus::ENABLED,
-				_userCommand.resultStepperStatus[replyPtr->index].forward == UserCommand::StepperDirectionStatus::FORWORD,
-				_userCommand.resultStepperStatus[replyPtr->index].forwardClockwise == UserCommand::StepperForwardClockwiseStatus::CLOCKWISE,
-				_userCommand.resultStepperStatus[replyPtr->index].locatorIndex,
-				_userCommand.resultStepperStatus[replyPtr->index].locatorLineNumberStart,
-				_userCommand.resultStepperStatus[replyPtr->index].locatorLineNumberTerminal,
-				_userCommand.resultStepperStatus[replyPtr->index].homeOffset,
-				_userCommand.resultStepperStatus[replyPtr->index].lowClks,
-				_userCommand.resultStepperStatus[replyPtr->index].highClks,
-				_userCommand.resultStepperStatus[replyPtr->index].accelerationBuffer,
-				_userCommand.resultStepperStatus[replyPtr->index].accelerationBufferDecrement,
-				_userCommand.resultStepperStatus[replyPtr->index].decelerationBuffer,
-				_userCommand.resultStepperStatus[replyPtr->index].decelerationBufferIncrement);
-	}
+		stepperState = toStepperState(status.state);
+	}
+
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperQuery, std::placeholders::_1,
+			command.commandId,
+			success,
+			stepperState,
+			status.enabled == UserCommand::StepperEnableStatus::ENABLED,
+			status.forward == UserCommand::StepperDirectionStatus::FORWORD,
+			status.forwardClockwise == UserCommand::StepperForwardClockwiseStatus::CLOCKWISE,
+			status.locatorIndex,
+			status.locatorLineNumberStart,
+			status.locatorLineNumberTerminal,
+			status.homeOffset,
+			status.lowClks,
+			status.highClks,
+			status.accelerationBuffer,
+			status.accelerationBufferDecrement,
+			status.decelerationBuffer,
+			status.decelerationBufferIncrement));
 }
 
 void CommandRunner::onFeedbackStepperSetState(std::shared_ptr<ReplyTranslator::ReplyStepperSetState> replyPtr)
@@ -1466,12 +1534,9 @@ void CommandRunner::onFeedbackStepperSetState(std::shared_ptr<ReplyTranslator::R
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperSetState(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperSetState, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackStepperForwardClockwise(std::shared_ptr<ReplyTranslator::ReplyStepperForwardClockwise> replyPtr)
@@ -1514,17 +1579,16 @@ void CommandRunner::onFeedbackStepperForwardClockwise(std::shared_ptr<ReplyTrans
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
-	{
-		auto pReceiver = *it;
-		pReceiver->OnStepperForwardClockwise(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED);
-	}
+	notifyReceivers(std::bind(&IResponseReceiver::OnStepperForwardClockwise, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
 }
 
 void CommandRunner::onFeedbackLocatorQuery(std::shared_ptr<ReplyTranslator::ReplyLocatorQuery> replyPtr)
 {
-	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+	//several of them can be waiting for reply, parameters of this one are kept apart from _userCommand
+	CommandParameters command;
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId, command)) {
 		return;
 	}
 
@@ -1535,13 +1599,13 @@ void CommandRunner::onFeedbackLocatorQuery(std::shared_ptr<ReplyTranslator::Repl
 		if(replyPtr->index >= LOCATOR_AMOUNT) {
 			pLogger->LogError("CommandRunner::onFeedbackLocatorQuery index out of range: " + std::to_string(replyPtr->index));
 		}
-		else if(replyPtr->index != _userCommand.locatorIndex) {
-			pLogger->LogError("CommandRunner::onFeedbackLocatorQuery wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(_userCommand.locatorIndex));
+		else if(replyPtr->index != command.locatorIndex) {
+			pLogger->LogError("CommandRunner::onFeedbackLocatorQuery wrong index: " + std::to_string(replyPtr->index) + "; should be: " + std::to_string(command.locatorIndex));
 		}
 		else
 		{
 			pLogger->LogInfo("CommandRunner::onFeedbackLocatorQuery succeed index: " + std::to_string(replyPtr->index) +
-					", locatorIndex: " + std::to_string(_userCommand.locatorIndex) +
+					", locatorIndex: " + std::to_string(command.locatorIndex) +
 					", lowInput: " + std::to_string(replyPtr->lowInput));
 
 			if(replyPtr->lowInput != _userCommand.resultLocatorStatus[replyPtr->index]) {
@@ -1556,6 +1620,57 @@ void CommandRunner::onFeedbackLocatorQuery(std::shared_ptr<ReplyTranslator::Repl
 		pLogger->LogError("CommandRunner::onFeedbackLocatorQuery error: " + replyPtr->errorInfo);
 	}
 
+	notifyReceivers(std::bind(&IResponseReceiver::OnLocatorQuery, std::placeholders::_1,
+			command.commandId,
+			success,
+			_userCommand.resultLocatorStatus[command.locatorIndex]));
+}
+
+void CommandRunner::onFeedbackSteppersMove(std::shared_ptr<ReplyTranslator::ReplySteppersMove> replyPtr)
+{
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+		return;
+	}
+
+	bool success = false;
+
+	if(replyPtr->errorInfo.empty())
+	{
+		if((replyPtr->indexes.size() != _userCommand.movements.size()) || (replyPtr->positions.size() != _userCommand.movements.size())) {
+			pLogger->LogError("CommandRunner::onFeedbackSteppersMove wrong movement amount: " + std::to_string(replyPtr->positions.size()) +
+					"; should be: " + std::to_string(_userCommand.movements.size()));
+		}
+		else
+		{
+			success = true;
+			for(unsigned int i=0; i<replyPtr->indexes.size(); i++)
+			{
+				auto& movement = _userCommand.movements[i];
+				unsigned int index = replyPtr->indexes[i];
+				unsigned long position = replyPtr->positions[i];
+
+				if(index != movement.index) {
+					pLogger->LogError("CommandRunner::onFeedbackSteppersMove wrong index: " + std::to_string(index) + "; should be: " + std::to_string(movement.index));
+					success = false;
+					break;
+				}
+				if(position != movement.finalPos) {
+					pLogger->LogInfo("CommandRunner::onFeedbackSteppersMove failed, index: " + std::to_string(index) +
+							", position: " + std::to_string(position) +
+							", expected position: " + std::to_string(movement.finalPos));
+					success = false;
+				}
+				_userCommand.resultStepperStatus[index].homeOffset = position;
+			}
+			if(success) {
+				pLogger->LogInfo("CommandRunner::onFeedbackSteppersMove succeed, movements: " + std::to_string(replyPtr->indexes.size()));
+			}
+		}
+	}
+	else {
+		pLogger->LogError("CommandRunner::onFeedbackSteppersMove error: " + replyPtr->errorInfo);
+	}
+
 	if(success) {
 		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
 	}
@@ -1563,13 +1678,72 @@ void CommandRunner::onFeedbackLocatorQuery(std::shared_ptr<ReplyTranslator::Repl
 		_userCommand.state = UserCommand::CommandState::FAILED;
 	}
 
-	for(auto it = _cmdResponseReceiverArray.begin(); it != _cmdResponseReceiverArray.end(); it++)
+	notifyReceivers(std::bind(&IResponseReceiver::OnSteppersMove, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
+}
+
+void CommandRunner::onFeedbackMacroUpload(std::shared_ptr<ReplyTranslator::ReplyMacroUpload> replyPtr)
+{
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+		return;
+	}
+
+	if(!replyPtr->errorInfo.empty()) {
+		pLogger->LogError("CommandRunner::onFeedbackMacroUpload error: " + replyPtr->errorInfo);
+		_userCommand.state = UserCommand::CommandState::FAILED;
+	}
+	else if(replyPtr->macroId != _userCommand.macroId) {
+		pLogger->LogError("CommandRunner::onFeedbackMacroUpload wrong macro: " + std::to_string(replyPtr->macroId) + "; should be: " + std::to_string(_userCommand.macroId));
+		_userCommand.state = UserCommand::CommandState::FAILED;
+	}
+	else {
+		pLogger->LogInfo("CommandRunner::onFeedbackMacroUpload succeed, macro: " + std::to_string(replyPtr->macroId));
+		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
+	}
+
+	notifyReceivers(std::bind(&IResponseReceiver::OnMacroUpload, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED));
+}
+
+void CommandRunner::onFeedbackMacroRun(std::shared_ptr<ReplyTranslator::ReplyMacroRun> replyPtr)
+{
+	if(!isCorrespondingReply(replyPtr->commandKey, replyPtr->commandId)) {
+		return;
+	}
+
+	bool success = false;
+
+	if(!replyPtr->errorInfo.empty()) {
+		pLogger->LogError("CommandRunner::onFeedbackMacroRun error: " + replyPtr->errorInfo);
+	}
+	else if(replyPtr->macroId != _userCommand.macroId) {
+		pLogger->LogError("CommandRunner::onFeedbackMacroRun wrong macro: " + std::to_string(replyPtr->macroId) + "; should be: " + std::to_string(_userCommand.macroId));
+	}
+	else if(replyPtr->positions.size() != STEPPER_AMOUNT) {
+		pLogger->LogError("CommandRunner::onFeedbackMacroRun wrong position amount: " + std::to_string(replyPtr->positions.size()));
+	}
+	else
 	{
-		auto pReceiver = *it;
-		pReceiver->OnLocatorQuery(_userCommand.commandId,
-				_userCommand.state == UserCommand::CommandState::SUCCEEDED,
-				_userCommand.resultLocatorStatus[replyPtr->index]);
+		for(unsigned int i=0; i<STEPPER_AMOUNT; i++) {
+			_userCommand.resultStepperStatus[i].homeOffset = replyPtr->positions[i];
+		}
+		pLogger->LogInfo("CommandRunner::onFeedbackMacroRun succeed, macro: " + std::to_string(replyPtr->macroId));
+		success = true;
 	}
+
+	if(success) {
+		_userCommand.state = UserCommand::CommandState::SUCCEEDED;
+	}
+	else {
+		_userCommand.state = UserCommand::CommandState::FAILED;
+	}
+
+	notifyReceivers(std::bind(&IResponseReceiver::OnMacroRun, std::placeholders::_1,
+			_userCommand.commandId,
+			_userCommand.state == UserCommand::CommandState::SUCCEEDED,
+			replyPtr->positions));
 }
 
 void CommandRunner::processFeedbacks()
@@ -1586,7 +1760,7 @@ void CommandRunner::processFeedbacks()
 		//retrieve feed back from beginning of _feedbacks
 		std::string feedback = _feedbacks.front();
 		_feedbacks.pop_front();
-		pLogger->LogInfo("CommandRunner::processFeedbacks dispose feedback: " + feedback);
+		pLogger->LogFormat("CommandRunner::processFeedbacks dispose feedback: %s", feedback);
 
 		//create a ReplyTranslater object.
 		ReplyTranslator translator(feedback);
@@ -1629,6 +1803,13 @@ void CommandRunner::processFeedbacks()
 			}
 			break;
 
+			case ReplyTranslator::ReplyType::DeviceQueryStatus:
+			{
+				auto replyPtr = translator.ToDeviceQueryStatus();
+				onFeedbackDeviceQueryStatus(replyPtr);
+			}
+			break;
+
 			case ReplyTranslator::ReplyType::OptPowerOn:
 			{
 				auto replyPtr = translator.ToOptPowerOn();
@@ -1824,6 +2005,27 @@ void CommandRunner::processFeedbacks()
 			}
 			break;
 
+			case ReplyTranslator::ReplyType::SteppersMove:
+			{
+				auto replyPtr = translator.ToSteppersMove();
+				onFeedbackSteppersMove(replyPtr);
+			}
+			break;
+
+			case ReplyTranslator::ReplyType::MacroUpload:
+			{
+				auto replyPtr = translator.ToMacroUpload();
+				onFeedbackMacroUpload(replyPtr);
+			}
+			break;
+
+			case ReplyTranslator::ReplyType::MacroRun:
+			{
+				auto replyPtr = translator.ToMacroRun();
+				onFeedbackMacroRun(replyPtr);
+			}
+			break;
+
 			default:
 			{
 				pLogger->LogError("CommandRunner::processFeedbacks unknown feedback: " + feedback);
@@ -1852,6 +2054,7 @@ unsigned long CommandRunner::sendCmdToDevice(std::shared_ptr<DeviceCommand>& cmd
 		//send out command
 		if(_pDeviceAccessor->SendCommand(_userCommand.jsonCommandString)) {
 			_userCommand.state = UserCommand::CommandState::COMMAND_SENT;
+			addPendingCommand();
 			cmdId = _userCommand.commandId;
 		}
 		else {
@@ -1862,6 +2065,25 @@ unsigned long CommandRunner::sendCmdToDevice(std::shared_ptr<DeviceCommand>& cmd
 	return cmdId;
 }
 
+void CommandRunner::addPendingCommand()
+{
+	if(_pendingCommands.size() >= _maxPendingCommands)
+	{
+		//the oldest command is regarded as lost
+		auto oldest = _pendingCommands.begin();
+		for(auto it = _pendingCommands.begin(); it != _pendingCommands.end(); it++)
+		{
+			if(it->second.commandId < oldest->second.commandId) {
+				oldest = it;
+			}
+		}
+		pLogger->LogError("CommandRunner::addPendingCommand no reply to command Id: " + std::to_string(oldest->second.commandId) + ", give it up");
+		_pendingCommands.erase(oldest);
+	}
+
+	_pendingCommands[_userCommand.commandId & 0xffff] = static_cast<const CommandParameters&>(_userCommand);
+}
+
 ICommandReception::CommandId CommandRunner::DevicesGet()
 {
 	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
@@ -1976,6 +2198,26 @@ ICommandReception::CommandId CommandRunner::DeviceQueryFuse()
 	return cmdId;
 }
 
+ICommandReception::CommandId CommandRunner::DeviceQueryStatus()
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	std::shared_ptr<DeviceCommand> cmdPtr (nullptr);
+	if(_userCommand.resultConnectedDeviceName.empty()) {
+		pLogger->LogError("CommandRunner::DeviceQueryStatus hasn't connected to any device");
+	}
+	else {
+		cmdPtr = CommandFactory::DeviceQueryStatus();
+		if(cmdPtr == nullptr) {
+			pLogger->LogError("CommandRunner::DeviceQueryStatus empty ptr returned from CommandFactory::DeviceQueryStatus");
+		}
+	}
+
+	ICommandReception::CommandId cmdId ;
+	cmdId = sendCmdToDevice(cmdPtr);
+	return cmdId;
+}
+
 ICommandReception::CommandId CommandRunner::OptPowerOn()
 {
 	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
@@ -2853,3 +3095,221 @@ ICommandReception::CommandId CommandRunner::SaveMovementConfig()
 	return 0;
 }
 
+
+ICommandReception::CommandId CommandRunner::SteppersMove(const std::vector<StepperMovement>& movements)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	std::shared_ptr<DeviceCommand> cmdPtr (nullptr);
+	if(_userCommand.resultConnectedDeviceName.empty()) {
+		pLogger->LogError("CommandRunner::SteppersMove hasn't connected to any device");
+	}
+	else if(movements.empty()) {
+		pLogger->LogError("CommandRunner::SteppersMove no movement");
+	}
+	else
+	{
+		std::vector<CommandSteppersMove::Movement> deviceMovements;
+
+		for(auto it = movements.begin(); it != movements.end(); it++)
+		{
+			if(it->index >= STEPPER_AMOUNT) {
+				pLogger->LogError("CommandRunner::SteppersMove invalid stepper index: " + std::to_string(it->index));
+				deviceMovements.clear();
+				break;
+			}
+
+			CommandSteppersMove::Movement movement;
+
+			movement.stepperIndex = it->index;
+			movement.forward = it->finalPos > it->initialPos;
+			movement.steps = movement.forward ? (it->finalPos - it->initialPos) : (it->initialPos - it->finalPos);
+			movement.withPrevious = it->withPrevious;
+			deviceMovements.push_back(movement);
+		}
+
+		if(!deviceMovements.empty())
+		{
+			cmdPtr = CommandFactory::SteppersMove(deviceMovements);
+			if(cmdPtr == nullptr) {
+				pLogger->LogError("CommandRunner::SteppersMove empty ptr returned from CommandFactory::SteppersMove");
+			}
+			else {
+				_userCommand.movements = movements;
+			}
+		}
+	}
+
+	ICommandReception::CommandId cmdId ;
+	cmdId = sendCmdToDevice(cmdPtr);
+	return cmdId;
+}
+
+bool CommandRunner::macroStepToJson(const MacroStep& step, std::string& json)
+{
+	std::shared_ptr<DeviceCommand> cmdPtr (nullptr);
+	auto& values = step.values;
+
+	switch(step.type)
+	{
+	case MacroStepType::DeviceDelay:
+		if(values.size() == 1) {
+			cmdPtr = CommandFactory::DeviceDelay(values[0]);
+		}
+		break;
+
+	case MacroStepType::BdcCoast:
+		if((values.size() == 1) && (values[0] < BDC_AMOUNT)) {
+			cmdPtr = CommandFactory::BdcOperation(values[0], CommandBdcOperation::BdcMode::BREAK, CommandBdcOperation::BdcMode::COAST, 0, 0, 0);
+		}
+		break;
+
+	case MacroStepType::BdcReverse:
+		if((values.size() == 4) && (values[0] < BDC_AMOUNT)) {
+			cmdPtr = CommandFactory::BdcOperation(values[0], CommandBdcOperation::BdcMode::BREAK, CommandBdcOperation::BdcMode::REVERSE, values[1], values[2], values[3]);
+		}
+		break;
+
+	case MacroStepType::BdcForward:
+		if((values.size() == 4) && (values[0] < BDC_AMOUNT)) {
+			cmdPtr = CommandFactory::BdcOperation(values[0], CommandBdcOperation::BdcMode::BREAK, CommandBdcOperation::BdcMode::FORWARD, values[1], values[2], values[3]);
+		}
+		break;
+
+	case MacroStepType::BdcBreak:
+		if((values.size() == 1) && (values[0] < BDC_AMOUNT)) {
+			cmdPtr = CommandFactory::BdcOperation(values[0], CommandBdcOperation::BdcMode::COAST, CommandBdcOperation::BdcMode::BREAK, 0, 0, 0);
+		}
+		break;
+
+	case MacroStepType::StepperConfigStep:
+		if((values.size() == 3) && (values[0] < STEPPER_AMOUNT)) {
+			cmdPtr = CommandFactory::StepperConfigStep(values[0], values[1], values[2]);
+		}
+		break;
+
+	case MacroStepType::StepperAccelerationBuffer:
+		if((values.size() == 2) && (values[0] < STEPPER_AMOUNT)) {
+			cmdPtr = CommandFactory::StepperAccelerationBuffer(values[0], values[1]);
+		}
+		break;
+
+	case MacroStepType::StepperAccelerationBufferDecrement:
+		if((values.size() == 2) && (values[0] < STEPPER_AMOUNT)) {
+			cmdPtr = CommandFactory::StepperAccelerationBufferDecrement(values[0], values[1]);
+		}
+		break;
+
+	case MacroStepType::StepperDecelerationBuffer:
+		if((values.size() == 2) && (values[0] < STEPPER_AMOUNT)) {
+			cmdPtr = CommandFactory::StepperDecelerationBuffer(values[0], values[1]);
+		}
+		break;
+
+	case MacroStepType::StepperDecelerationBufferIncrement:
+		if((values.size() == 2) && (values[0] < STEPPER_AMOUNT)) {
+			cmdPtr = CommandFactory::StepperDecelerationBufferIncrement(values[0], values[1]);
+		}
+		break;
+
+	case MacroStepType::SteppersMoveTo:
+	{
+		std::vector<CommandMacroUpload::Movement> movements;
+
+		for(auto it = step.movements.begin(); it != step.movements.end(); it++)
+		{
+			if(it->index >= STEPPER_AMOUNT) {
+				return false;
+			}
+
+			CommandMacroUpload::Movement movement;
+
+			movement.stepperIndex = it->index;
+			movement.position = it->position;
+			movement.withPrevious = it->withPrevious;
+			movement.parameter = it->parameter;
+			movements.push_back(movement);
+		}
+		if(movements.empty()) {
+			return false;
+		}
+		json = CommandMacroUpload::SteppersMoveToStep(movements);
+		return true;
+	}
+	}
+
+	if(cmdPtr == nullptr) {
+		return false;
+	}
+	json = cmdPtr->ToJsonCommandString();
+
+	return true;
+}
+
+ICommandReception::CommandId CommandRunner::MacroUpload(unsigned int macroId, const std::vector<MacroStep>& steps)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	std::shared_ptr<DeviceCommand> cmdPtr (nullptr);
+	if(_userCommand.resultConnectedDeviceName.empty()) {
+		pLogger->LogError("CommandRunner::MacroUpload hasn't connected to any device");
+	}
+	else if(steps.empty()) {
+		pLogger->LogError("CommandRunner::MacroUpload no step");
+	}
+	else
+	{
+		std::vector<std::string> jsonSteps;
+
+		for(unsigned int i=0; i<steps.size(); i++)
+		{
+			std::string json;
+
+			if(!macroStepToJson(steps[i], json)) {
+				pLogger->LogError("CommandRunner::MacroUpload invalid step: " + std::to_string(i));
+				jsonSteps.clear();
+				break;
+			}
+			jsonSteps.push_back(json);
+		}
+
+		if(!jsonSteps.empty())
+		{
+			cmdPtr = CommandFactory::MacroUpload(macroId, jsonSteps);
+			if(cmdPtr == nullptr) {
+				pLogger->LogError("CommandRunner::MacroUpload empty ptr returned from CommandFactory::MacroUpload");
+			}
+			else {
+				_userCommand.macroId = macroId;
+			}
+		}
+	}
+
+	ICommandReception::CommandId cmdId ;
+	cmdId = sendCmdToDevice(cmdPtr);
+	return cmdId;
+}
+
+ICommandReception::CommandId CommandRunner::MacroRun(unsigned int macroId, const std::vector<long>& parameters)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	std::shared_ptr<DeviceCommand> cmdPtr (nullptr);
+	if(_userCommand.resultConnectedDeviceName.empty()) {
+		pLogger->LogError("CommandRunner::MacroRun hasn't connected to any device");
+	}
+	else
+	{
+		cmdPtr = CommandFactory::MacroRun(macroId, parameters);
+		if(cmdPtr == nullptr) {
+			pLogger->LogError("CommandRunner::MacroRun empty ptr returned from CommandFactory::MacroRun");
+		}
+		else {
+			_userCommand.macroId = macroId;
+		}
+	}
+
+	ICommandReception::CommandId cmdId ;
+	cmdId = sendCmdToDevice(cmdPtr);
+	return cmdId;
+}
@@ -11,6 +11,8 @@
 #include <memory>
 #include <string>
 #include <deque>
+#include <functional>
+#include <unordered_map>
 #include "Poco/Task.h"
 #include "Poco/Mutex.h"
 #include "Poco/Event.h"
@@ -31,7 +33,11 @@
 class CommandRunner: public Poco::Task, public ICommandReception, public IDeviceObserver
 {
 public:
-	CommandRunner();
+	//default of max_pending_device_commands in configuration
+	static const unsigned int DEFAULT_MAX_PENDING_COMMANDS = 8;
+
+	//maxPendingCommands: amount of commands which can wait for reply at the same time
+	CommandRunner(unsigned int maxPendingCommands = DEFAULT_MAX_PENDING_COMMANDS);
 
 	void SetDevice(DeviceAccessor * pDeviceAccessor);
 	virtual void AddResponseReceiver(IResponseReceiver * p) override;
@@ -49,6 +55,7 @@ private:
 	virtual CommandId DeviceDelay(unsigned int clks) override;
 	virtual CommandId DeviceQueryPower() override;
 	virtual CommandId DeviceQueryFuse() override;
+	virtual CommandId DeviceQueryStatus() override;
 	virtual CommandId OptPowerOn() override;
 	virtual CommandId OptPowerOff() override;
 	virtual CommandId OptQueryPower() override;
@@ -83,6 +90,9 @@ private:
 	virtual CommandId StepperForwardClockwise(unsigned int index, bool bForwardClockwise) override;
 	virtual CommandId LocatorQuery(unsigned int index) override;
 	virtual CommandId SaveMovementConfig() override;
+	virtual CommandId SteppersMove(const std::vector<StepperMovement>& movements) override;
+	virtual CommandId MacroUpload(unsigned int macroId, const std::vector<MacroStep>& steps) override;
+	virtual CommandId MacroRun(unsigned int macroId, const std::vector<long>& parameters) override;
 
 private:
 	static const unsigned int BDC_AMOUNT = 6;
@@ -107,17 +117,24 @@ private:
 	std::deque<std::string> _feedbacks;
 	DeviceAccessor * _pDeviceAccessor;
 	std::vector<IResponseReceiver *> _cmdResponseReceiverArray;
+	//replies are delivered to receivers after _mutex is released, so that a receiver can send the next command
+	//while other replies are still being processed.
+	std::deque<std::function<void(IResponseReceiver *)>> _notifications;
+	void notifyReceivers(std::function<void(IResponseReceiver *)> notification);
 
 	unsigned long sendCmdToDevice(std::shared_ptr<DeviceCommand>& cmdPtr);
+	void addPendingCommand();
 	void saveMovementConfig();
 
 	void processFeedbacks();
+	IResponseReceiver::StepperState toStepperState(const std::string& state);
 	bool isCorrespondingReply(const std::string& command, unsigned short commandId);
 	void onFeedbackDevicesGet(std::shared_ptr<ReplyTranslator::ReplyDevicesGet> replyPtr);
 	void onFeedbackDeviceConnect(std::shared_ptr<ReplyTranslator::ReplyDeviceConnect> replyPtr);
 	void onFeedbackDeviceDelay(std::shared_ptr<ReplyTranslator::ReplyDeviceDelay> replyPtr);
 	void onFeedbackDeviceQueryPower(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryPower> replyPtr);
 	void onFeedbackDeviceQueryFuse(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryFuse> replyPtr);
+	void onFeedbackDeviceQueryStatus(std::shared_ptr<ReplyTranslator::ReplyDeviceQueryStatus> replyPtr);
 	void onFeedbackBdcsPowerOn(std::shared_ptr<ReplyTranslator::ReplyBdcsPowerOn> replyPtr);
 	void onFeedbackBdcsPowerOff(std::shared_ptr<ReplyTranslator::ReplyBdcsPowerOff> replyPtr);
 	void onFeedbackBdcsQueryPower(std::shared_ptr<ReplyTranslator::ReplyBdcsQueryPower> replyPtr);
@@ -145,10 +162,47 @@ private:
 	void onFeedbackStepperSetState(std::shared_ptr<ReplyTranslator::ReplyStepperSetState> replyPtr);
 	void onFeedbackStepperForwardClockwise(std::shared_ptr<ReplyTranslator::ReplyStepperForwardClockwise> replyPtr);
 	void onFeedbackLocatorQuery(std::shared_ptr<ReplyTranslator::ReplyLocatorQuery> replyPtr);
+	void onFeedbackSteppersMove(std::shared_ptr<ReplyTranslator::ReplySteppersMove> replyPtr);
+	void onFeedbackMacroUpload(std::shared_ptr<ReplyTranslator::ReplyMacroUpload> replyPtr);
+	void onFeedbackMacroRun(std::shared_ptr<ReplyTranslator::ReplyMacroRun> replyPtr);
+
+	//JSON of a macro step, false if step isn't valid.
+	bool macroStepToJson(const MacroStep& step, std::string& json);
+
+	// parameters of a command sent to device, they are needed again when its reply is processed.
+	struct CommandParameters
+	{
+		std::string commandKey;
+		unsigned long commandId;
+
+		int bdcIndex;
+		int stepperIndex;
+		int locatorIndex;
+		int lowClks;
+		int highClks;
+		int accelerationBuffer;
+		int accelerationBufferDecrement;
+		int decelerationBuffer;
+		int decelerationBufferIncrement;
+		int steps;
+		int initialPosition;
+		int finalPosition;
+		int locatorLineNumberStart;
+		int locatorLineNumberTerminal;
+		std::vector<StepperMovement> movements;
+		unsigned int macroId;
+	};
+
+	// commands waiting for reply, key is the low 16 bits of command id which is what device replies with.
+	unsigned int _maxPendingCommands;
+	std::unordered_map<unsigned short, CommandParameters> _pendingCommands;
+	//parameters of the replied command are returned instead of being copied to _userCommand
+	bool isCorrespondingReply(const std::string& command, unsigned short commandId, CommandParameters& parameters);
 
 	// "User" in the name is confusing because there is a "UserCommandRunner"
 	// The following names of struct and variable need to be changed to avoid this confusion.
-	struct UserCommand
+	// Parameters inherited from CommandParameters are those of the command being sent or replied.
+	struct UserCommand: public CommandParameters
 	{
 		enum class CommandState
 		{
@@ -212,24 +266,6 @@ private:
 		//command type
 		CommandState state;
 		std::string jsonCommandString;
-		std::string commandKey;
-		unsigned long commandId;
-
-		//command parameters
-		int bdcIndex;
-		int stepperIndex;
-		int locatorIndex;
-		int lowClks;
-		int highClks;
-		int accelerationBuffer;
-		int accelerationBufferDecrement;
-		int decelerationBuffer;
-		int decelerationBufferIncrement;
-		int steps;
-		int initialPosition;
-		int finalPosition;
-		int locatorLineNumberStart;
-		int locatorLineNumberTerminal;
 
 		//results
 		// DevicesGet
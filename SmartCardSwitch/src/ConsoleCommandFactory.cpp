@@ -5,6 +5,7 @@
  *      Author: user1
  */
 #include <stdio.h>
+#include <stdlib.h>
 #include "ConsoleCommandFactory.h"
 
 std::string ConsoleCommandFactory::GetHelp()
@@ -16,6 +17,7 @@ std::string ConsoleCommandFactory::GetHelp()
 	help = help + "DeviceQueryPower:------------------ " + "2" + "\r\n";
 	help = help + "DeviceQueryFuse:------------------- " + "3" + "\r\n";
 	help = help + "DeviceDelay:----------------------- " + "4 clks" + "\r\n";
+	help = help + "DeviceQueryStatus:----------------- " + "5" + "\r\n";
 	help = help + "OptPowerOn:------------------------ " + "20" + "\r\n";
 	help = help + "OptPowerOff:----------------------- " + "21" + "\r\n";
 	help = help + "OptQueryPower:--------------------- " + "22" + "\r\n";
@@ -47,6 +49,11 @@ std::string ConsoleCommandFactory::GetHelp()
 	help = help + "StepperMove:----------------------- " + "74 stepperIndex forward stepAmount" + "\r\n";
 	help = help + "StepperQuery: --------------------- " + "75 stepperIndex" + "\r\n";
 	help = help + "StepperSetState: ------------------ " + "76 stepperIndex state" + "\r\n";
+	help = help + "SteppersMove: --------------------- " + "78 stepperIndex initialPos finalPos withPrevious [stepperIndex initialPos finalPos withPrevious ...]" + "\r\n";
+	help = help + "MacroUpload: ---------------------- " + "79 macroId stepType valueAmount values [stepType valueAmount values ...]" + "\r\n";
+	help = help + "                                    " + "stepType is 4, 43~46, 64~68 with values of that command, or" + "\r\n";
+	help = help + "                                    " + "78 with values stepperIndex position withPrevious parameter [...], parameter -1 for none" + "\r\n";
+	help = help + "MacroRun: ------------------------- " + "80 macroId [parameter ...]" + "\r\n";
 	help = help + "LocatorQuery:---------------------- " + "90 locatorIndex" + "\r\n";
 	help = help + "BdcConfig:------------------------- " + "200 lowClks highClks cycles" + "\r\n";
 	help = help + "SaveMovementConfig:---------------- " + "300 type index" + "\r\n";
@@ -94,6 +101,7 @@ ConsoleCommandFactory::Type ConsoleCommandFactory::GetCmdType(const std::string&
 		case Type::DeviceQueryPower:
 		case Type::DeviceQueryFuse:
 		case Type::DeviceDelay:
+		case Type::DeviceQueryStatus:
 		case Type::OptPowerOn:
 		case Type::OptPowerOff:
 		case Type::OptQueryPower:
@@ -125,6 +133,9 @@ ConsoleCommandFactory::Type ConsoleCommandFactory::GetCmdType(const std::string&
 		case Type::StepperMove:
 		case Type::StepperQuery:
 		case Type::StepperSetState:
+		case Type::SteppersMove:
+		case Type::MacroUpload:
+		case Type::MacroRun:
 		case Type::LocatorQuery:
 		case Type::SaveMovementConfig:
 		case Type::SaveMovementConfigStepperBoundary:
@@ -304,3 +315,232 @@ bool ConsoleCommandFactory::GetParameterLocatorIndex(const std::string & console
 
 	return false;
 }
+
+bool ConsoleCommandFactory::GetParameterSteppersMove(const std::string & consoleCmd, std::vector<ICommandDataTypes::StepperMovement> & movements)
+{
+	const char * pCur = consoleCmd.c_str();
+	char * pEnd;
+	std::vector<long> dataArray;
+
+	for(;;)
+	{
+		long value = strtol(pCur, &pEnd, 10);
+
+		if(pEnd == pCur) {
+			break;
+		}
+		dataArray.push_back(value);
+		pCur = pEnd;
+	}
+
+	//type followed by groups of stepperIndex, initialPos, finalPos and withPrevious
+	if(dataArray.empty() || ((Type)dataArray[0] != Type::SteppersMove)) {
+		return false;
+	}
+	if((dataArray.size() < 5) || (((dataArray.size() - 1) % 4) != 0)) {
+		return false;
+	}
+
+	movements.clear();
+	for(unsigned int i=1; i<dataArray.size(); i+=4)
+	{
+		ICommandDataTypes::StepperMovement movement;
+
+		if((dataArray[i] < 0) || (dataArray[i+1] < 0) || (dataArray[i+2] < 0)) {
+			return false;
+		}
+		movement.index = dataArray[i];
+		movement.initialPos = dataArray[i+1];
+		movement.finalPos = dataArray[i+2];
+		movement.withPrevious = (dataArray[i+3] != 0) && (i > 1); //the first movement has nothing to go with
+		movements.push_back(movement);
+	}
+
+	return true;
+}
+
+void ConsoleCommandFactory::getNumbers(const std::string & consoleCmd, std::vector<long> & dataArray)
+{
+	const char * pCur = consoleCmd.c_str();
+	char * pEnd;
+
+	dataArray.clear();
+	for(;;)
+	{
+		long value = strtol(pCur, &pEnd, 10);
+
+		if(pEnd == pCur) {
+			break;
+		}
+		dataArray.push_back(value);
+		pCur = pEnd;
+	}
+}
+
+bool ConsoleCommandFactory::toMacroStepType(Type type, ICommandDataTypes::MacroStepType & stepType)
+{
+	switch(type)
+	{
+		case Type::DeviceDelay: stepType = ICommandDataTypes::MacroStepType::DeviceDelay; return true;
+		case Type::BdcCoast: stepType = ICommandDataTypes::MacroStepType::BdcCoast; return true;
+		case Type::BdcReverse: stepType = ICommandDataTypes::MacroStepType::BdcReverse; return true;
+		case Type::BdcForward: stepType = ICommandDataTypes::MacroStepType::BdcForward; return true;
+		case Type::BdcBreak: stepType = ICommandDataTypes::MacroStepType::BdcBreak; return true;
+		case Type::StepperConfigStep: stepType = ICommandDataTypes::MacroStepType::StepperConfigStep; return true;
+		case Type::StepperAccelerationBuffer: stepType = ICommandDataTypes::MacroStepType::StepperAccelerationBuffer; return true;
+		case Type::StepperAccelerationBufferDecrement: stepType = ICommandDataTypes::MacroStepType::StepperAccelerationBufferDecrement; return true;
+		case Type::StepperDecelerationBuffer: stepType = ICommandDataTypes::MacroStepType::StepperDecelerationBuffer; return true;
+		case Type::StepperDecelerationBufferIncrement: stepType = ICommandDataTypes::MacroStepType::StepperDecelerationBufferIncrement; return true;
+		case Type::SteppersMove: stepType = ICommandDataTypes::MacroStepType::SteppersMoveTo; return true;
+
+		default:
+			return false;
+	}
+}
+
+ConsoleCommandFactory::Type ConsoleCommandFactory::fromMacroStepType(ICommandDataTypes::MacroStepType stepType)
+{
+	switch(stepType)
+	{
+		case ICommandDataTypes::MacroStepType::DeviceDelay: return Type::DeviceDelay;
+		case ICommandDataTypes::MacroStepType::BdcCoast: return Type::BdcCoast;
+		case ICommandDataTypes::MacroStepType::BdcReverse: return Type::BdcReverse;
+		case ICommandDataTypes::MacroStepType::BdcForward: return Type::BdcForward;
+		case ICommandDataTypes::MacroStepType::BdcBreak: return Type::BdcBreak;
+		case ICommandDataTypes::MacroStepType::StepperConfigStep: return Type::StepperConfigStep;
+		case ICommandDataTypes::MacroStepType::StepperAccelerationBuffer: return Type::StepperAccelerationBuffer;
+		case ICommandDataTypes::MacroStepType::StepperAccelerationBufferDecrement: return Type::StepperAccelerationBufferDecrement;
+		case ICommandDataTypes::MacroStepType::StepperDecelerationBuffer: return Type::StepperDecelerationBuffer;
+		case ICommandDataTypes::MacroStepType::StepperDecelerationBufferIncrement: return Type::StepperDecelerationBufferIncrement;
+		case ICommandDataTypes::MacroStepType::SteppersMoveTo: return Type::SteppersMove;
+	}
+
+	return Type::Invalid;
+}
+
+//79 macroId stepType valueAmount values [stepType valueAmount values ...]
+//values of SteppersMoveTo are groups of stepperIndex, position, withPrevious and parameter.
+std::string ConsoleCommandFactory::CmdMacroUpload(unsigned int macroId, const std::vector<ICommandDataTypes::MacroStep>& steps)
+{
+	std::string cmd = "79 " + std::to_string(macroId);
+
+	for(auto it = steps.begin(); it != steps.end(); it++)
+	{
+		cmd = cmd + " " + std::to_string((int)fromMacroStepType(it->type));
+		if(it->type == ICommandDataTypes::MacroStepType::SteppersMoveTo)
+		{
+			cmd = cmd + " " + std::to_string(it->movements.size() * 4);
+			for(auto movementIt = it->movements.begin(); movementIt != it->movements.end(); movementIt++) {
+				cmd = cmd + " " + std::to_string(movementIt->index) + " " + std::to_string(movementIt->position) +
+						(movementIt->withPrevious?" 1 ":" 0 ") + std::to_string(movementIt->parameter);
+			}
+		}
+		else
+		{
+			cmd = cmd + " " + std::to_string(it->values.size());
+			for(auto valueIt = it->values.begin(); valueIt != it->values.end(); valueIt++) {
+				cmd = cmd + " " + std::to_string(*valueIt);
+			}
+		}
+	}
+
+	return cmd + "\r\n";
+}
+
+bool ConsoleCommandFactory::GetParameterMacroUpload(const std::string & consoleCmd, unsigned int & macroId, std::vector<ICommandDataTypes::MacroStep> & steps)
+{
+	std::vector<long> dataArray;
+
+	getNumbers(consoleCmd, dataArray);
+	if((dataArray.size() < 4) || ((Type)dataArray[0] != Type::MacroUpload) || (dataArray[1] < 0)) {
+		return false;
+	}
+
+	macroId = dataArray[1];
+	steps.clear();
+	for(unsigned int i=2; i<dataArray.size(); )
+	{
+		ICommandDataTypes::MacroStep step;
+
+		if((i + 1 >= dataArray.size()) || !toMacroStepType((Type)dataArray[i], step.type)) {
+			return false;
+		}
+
+		long amount = dataArray[i + 1];
+		i += 2;
+		if((amount < 0) || ((unsigned long)amount > dataArray.size() - i)) {
+			return false;
+		}
+
+		if(step.type == ICommandDataTypes::MacroStepType::SteppersMoveTo)
+		{
+			if((amount == 0) || ((amount % 4) != 0)) {
+				return false;
+			}
+			for(long j=0; j<amount; j+=4)
+			{
+				ICommandDataTypes::MacroMovement movement;
+
+				if((dataArray[i + j] < 0) || (dataArray[i + j + 3] < -1)) {
+					return false;
+				}
+				movement.index = dataArray[i + j];
+				movement.position = dataArray[i + j + 1];
+				movement.withPrevious = (dataArray[i + j + 2] != 0) && (j > 0); //the first movement has nothing to go with
+				movement.parameter = dataArray[i + j + 3];
+				step.movements.push_back(movement);
+			}
+		}
+		else
+		{
+			for(long j=0; j<amount; j++)
+			{
+				if(dataArray[i + j] < 0) {
+					return false;
+				}
+				step.values.push_back(dataArray[i + j]);
+			}
+		}
+		i += amount;
+		steps.push_back(step);
+	}
+
+	return true;
+}
+
+bool ConsoleCommandFactory::GetParameterMacroRun(const std::string & consoleCmd, unsigned int & macroId, std::vector<long> & parameters)
+{
+	std::vector<long> dataArray;
+
+	getNumbers(consoleCmd, dataArray);
+	if((dataArray.size() < 2) || ((Type)dataArray[0] != Type::MacroRun) || (dataArray[1] < 0)) {
+		return false;
+	}
+
+	macroId = dataArray[1];
+	parameters.assign(dataArray.begin() + 2, dataArray.end());
+
+	return true;
+}
+
+bool ConsoleCommandFactory::GetMacroStep(const std::string & consoleCmd, ICommandDataTypes::MacroStep & step)
+{
+	std::vector<long> dataArray;
+
+	getNumbers(consoleCmd, dataArray);
+	if(dataArray.empty() || ((Type)dataArray[0] == Type::SteppersMove) || !toMacroStepType((Type)dataArray[0], step.type)) {
+		return false;
+	}
+
+	step.values.clear();
+	step.movements.clear();
+	for(unsigned int i=1; i<dataArray.size(); i++)
+	{
+		if(dataArray[i] < 0) {
+			return false;
+		}
+		step.values.push_back(dataArray[i]);
+	}
+
+	return true;
+}
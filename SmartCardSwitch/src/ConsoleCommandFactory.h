@@ -9,6 +9,9 @@
 #define CONSOLECOMMANDFACTORY_H_
 
 #include <string>
+#include <vector>
+
+#include "ICommandReception.h"
 
 class ConsoleCommandFactory
 {
@@ -22,6 +25,7 @@ public:
 		DeviceQueryPower = 2,
 		DeviceQueryFuse = 3,
 		DeviceDelay = 4,
+		DeviceQueryStatus = 5,
 		OptPowerOn = 20,
 		OptPowerOff = 21,
 		OptQueryPower = 22,
@@ -54,6 +58,9 @@ public:
 		StepperQuery = 75,
 		StepperSetState = 76,
 		StepperForwardClockwise = 77,
+		SteppersMove = 78,
+		MacroUpload = 79,
+		MacroRun = 80,
 		LocatorQuery = 90,
 		SaveMovementConfig = 300,
 		SaveMovementConfigStepperBoundary = 301,
@@ -76,6 +83,7 @@ public:
 	static std::string CmdDeviceQueryPower() 				{ return std::string("2 \r\n"); }
 	static std::string CmdDeviceQueryFuse() 				{ return std::string("3 \r\n"); }
 	static std::string CmdDeviceDelay(unsigned int clks)	{ return std::string("4 ") + std::to_string(clks) + "\r\n"; }
+	static std::string CmdDeviceQueryStatus() 				{ return std::string("5 \r\n"); }
 	static std::string CmdOptPowerOn() 						{ return std::string("20 \r\n"); }
 	static std::string CmdOptPowerOff() 					{ return std::string("21 \r\n"); }
 	static std::string CmdOptQueryPower() 					{ return std::string("22 \r\n"); }
@@ -166,11 +174,45 @@ public:
 	static std::string CmdStepperForwardClockwise(unsigned int index, bool forwardClockwise) { return "77 " + std::to_string(index) + (forwardClockwise?" 1":" 0") + "\r\n"; }
 	static std::string CmdLocatorQuery(unsigned int index) 	{ return "90 " + std::to_string(index) + "\r\n"; }
 
+	static std::string CmdSteppersMove(const std::vector<ICommandDataTypes::StepperMovement>& movements)
+	{
+		std::string cmd = "78";
+
+		for(auto it = movements.begin(); it != movements.end(); it++) {
+			cmd = cmd + " " + std::to_string(it->index) + " " + std::to_string(it->initialPos) + " " + std::to_string(it->finalPos) + (it->withPrevious?" 1":" 0");
+		}
+		return cmd + "\r\n";
+	}
+
+	static std::string CmdMacroUpload(unsigned int macroId, const std::vector<ICommandDataTypes::MacroStep>& steps);
+
+	static std::string CmdMacroRun(unsigned int macroId, const std::vector<long>& parameters)
+	{
+		std::string cmd = "80 " + std::to_string(macroId);
+
+		for(auto it = parameters.begin(); it != parameters.end(); it++) {
+			cmd = cmd + " " + std::to_string(*it);
+		}
+		return cmd + "\r\n";
+	}
+
 	static Type GetCmdType(const std::string& consoleCmd);
 	static bool GetParameterStepperIndex(const std::string & consoleCmd, unsigned int & stepperIndex);
 	static bool GetParameterStepperSteps(const std::string & consoleCmd, unsigned int & steps);
 	static bool GetParameterStepperForward(const std::string & consoleCmd, bool & bForward);
 	static bool GetParameterLocatorIndex(const std::string & consoleCmd, unsigned int & locatorIndex);
+	//SteppersMove carries more parameters than other commands, it is parsed separately.
+	static bool GetParameterSteppersMove(const std::string & consoleCmd, std::vector<ICommandDataTypes::StepperMovement> & movements);
+	static bool GetParameterMacroUpload(const std::string & consoleCmd, unsigned int & macroId, std::vector<ICommandDataTypes::MacroStep> & steps);
+	static bool GetParameterMacroRun(const std::string & consoleCmd, unsigned int & macroId, std::vector<long> & parameters);
+	//macro step equivalent to a console command, false if the command cannot be a macro step.
+	//SteppersMove isn't converted here since its positions are relative to current ones.
+	static bool GetMacroStep(const std::string & consoleCmd, ICommandDataTypes::MacroStep & step);
+
+private:
+	static bool toMacroStepType(Type type, ICommandDataTypes::MacroStepType & stepType);
+	static Type fromMacroStepType(ICommandDataTypes::MacroStepType stepType);
+	static void getNumbers(const std::string & consoleCmd, std::vector<long> & dataArray);
 };
 
 
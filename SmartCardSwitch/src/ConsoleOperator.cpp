@@ -46,22 +46,57 @@ void ConsoleOperator::showHelp()
 
 void ConsoleOperator::prepareRunning()
 {
+	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
 	_bCmdSucceed = false;
 	_bCmdFinish = false;
 }
 
 void ConsoleOperator::waitCommandFinish()
 {
-	for(;;)
+	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+	//_cmdFinished is broadcast by the response callbacks after _bCmdFinish is set.
+	while(!_bCmdFinish)
 	{
-		{
-			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
-			if(_bCmdFinish) {
-				break;
-			}
+		if(_cmdKey == InvalidCommandId) {
+			//command wasn't sent out, no response will come.
+			_bCmdFinish = true;
+			_bCmdSucceed = false;
+			break;
 		}
-		sleep(1);
+		_cmdFinished.wait(_lowerMutex);
+	}
+}
+
+void ConsoleOperator::finishCommand()
+{
+	//_lowerMutex is locked by the response callback
+	_bCmdFinish = true;
+	_cmdFinished.broadcast();
+}
+
+void ConsoleOperator::addOverlappedCommand(ICommandReception::CommandId cmdId, unsigned int index)
+{
+	//_lowerMutex is locked by caller
+	if(_overlappedCommands.size() >= MAX_OVERLAPPED_COMMANDS) {
+		//the oldest one is never replied
+		_overlappedCommands.erase(_overlappedCommands.begin());
+	}
+	_overlappedCommands[cmdId] = index;
+}
+
+bool ConsoleOperator::takeOverlappedCommand(ICommandReception::CommandId cmdId, unsigned int & index)
+{
+	//_lowerMutex is locked by the response callback
+	auto it = _overlappedCommands.find(cmdId);
+	if(it == _overlappedCommands.end()) {
+		return false;
 	}
+	index = it->second;
+	_overlappedCommands.erase(it);
+
+	return true;
 }
 
 void ConsoleOperator::loadMovementConfig()
@@ -98,7 +133,10 @@ void ConsoleOperator::loadMovementConfig()
 		{
 			//load step
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperConfigStep(i, lowClks, highClks);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperConfigStep(i, lowClks, highClks);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config step for stepper: " + std::to_string(i));
@@ -109,7 +147,10 @@ void ConsoleOperator::loadMovementConfig()
 
 			//load acceleration buffer
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperAccelerationBuffer(i, accelerationBuffer);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperAccelerationBuffer(i, accelerationBuffer);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config accelerationBuffer for stepper: " + std::to_string(i));
@@ -120,7 +161,10 @@ void ConsoleOperator::loadMovementConfig()
 
 			//load acceleration buffer decrement
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperAccelerationBufferDecrement(i, accelerationBufferDecrement);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperAccelerationBufferDecrement(i, accelerationBufferDecrement);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config accelerationBufferDecrement for stepper: " + std::to_string(i));
@@ -131,7 +175,10 @@ void ConsoleOperator::loadMovementConfig()
 
 			//load deceleration buffer
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperDecelerationBuffer(i, decelerationBuffer);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperDecelerationBuffer(i, decelerationBuffer);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config decelerationBuffer for stepper: " + std::to_string(i));
@@ -142,7 +189,10 @@ void ConsoleOperator::loadMovementConfig()
 
 			//load deceleration buffer increment
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperDecelerationBufferIncrement(i, decelerationBufferIncrement);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperDecelerationBufferIncrement(i, decelerationBufferIncrement);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config decelerationBufferIncrement for stepper: " + std::to_string(i));
@@ -153,7 +203,10 @@ void ConsoleOperator::loadMovementConfig()
 
 			//load locator
 			prepareRunning();
-			_cmdKey = _pCommandReception->StepperConfigHome(i, locatorIndex, locatorLineNumberStart, locatorLineNumberTerminal);
+			{
+				Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+				_cmdKey = _pCommandReception->StepperConfigHome(i, locatorIndex, locatorLineNumberStart, locatorLineNumberTerminal);
+			}
 			waitCommandFinish();
 			if(_bCmdSucceed) {
 				pLogger->LogInfo("ConsoleOperator::loadMovementConfig succeeded in config locator for stepper: " + std::to_string(i));
@@ -263,6 +316,9 @@ void ConsoleOperator::stepperMove(const unsigned int index, const bool forward,
 		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 		_index = index;
 		_cmdKey = _pCommandReception->StepperQuery(index);
+		if(_cmdKey != InvalidCommandId) {
+			addOverlappedCommand(_cmdKey, index);
+		}
 	}
 	waitCommandFinish();
 	if(!_bCmdSucceed) {
@@ -549,6 +605,14 @@ bool ConsoleOperator::runConsoleCommand(const std::string& command, ICommandRece
 		}
 		break;
 
+		case ConsoleCommandFactory::Type::DeviceQueryStatus:
+		{
+			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+			_cmdKey = _pCommandReception->DeviceQueryStatus();
+			cmdId = _cmdKey;
+		}
+		break;
+
 		case ConsoleCommandFactory::Type::DeviceDelay:
 		{
 			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
@@ -870,6 +934,7 @@ bool ConsoleOperator::runConsoleCommand(const std::string& command, ICommandRece
 			if(_cmdKey != InvalidCommandId)
 			{
 				_steppers[index].homeOffset = finalPos;
+				addOverlappedCommand(_cmdKey, index);
 			}
 			cmdId = _cmdKey;
 		}
@@ -939,6 +1004,9 @@ bool ConsoleOperator::runConsoleCommand(const std::string& command, ICommandRece
 			_index = d1;
 
 			_cmdKey = _pCommandReception->StepperQuery(_index);
+			if(_cmdKey != InvalidCommandId) {
+				addOverlappedCommand(_cmdKey, _index);
+			}
 			cmdId = _cmdKey;
 		}
 		break;
@@ -964,6 +1032,78 @@ bool ConsoleOperator::runConsoleCommand(const std::string& command, ICommandRece
 			unsigned int index = d1;
 
 			_cmdKey = _pCommandReception->LocatorQuery(index);
+			if(_cmdKey != InvalidCommandId) {
+				addOverlappedCommand(_cmdKey, index);
+			}
+			cmdId = _cmdKey;
+		}
+		break;
+
+		case ConsoleCommandFactory::Type::SteppersMove:
+		{
+			std::vector<StepperMovement> movements;
+
+			if(!ConsoleCommandFactory::GetParameterSteppersMove(command, movements)) {
+				pLogger->LogError("ConsoleOperator::runConsoleCommand wrong movements: " + command);
+				break;
+			}
+			for(auto it = movements.begin(); it != movements.end(); it++)
+			{
+				if(it->index >= STEPPER_AMOUNT) {
+					pLogger->LogError("ConsoleOperator::runConsoleCommand stepper index out of range: " + std::to_string(it->index));
+					movements.clear();
+					break;
+				}
+			}
+			if(movements.empty()) {
+				break;
+			}
+
+			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+			_cmdKey = _pCommandReception->SteppersMove(movements);
+			if(_cmdKey != InvalidCommandId)
+			{
+				for(auto it = movements.begin(); it != movements.end(); it++) {
+					_steppers[it->index].homeOffset = it->finalPos;
+				}
+			}
+			cmdId = _cmdKey;
+		}
+		break;
+
+		case ConsoleCommandFactory::Type::MacroUpload:
+		{
+			unsigned int macroId;
+			std::vector<MacroStep> steps;
+
+			if(!ConsoleCommandFactory::GetParameterMacroUpload(command, macroId, steps)) {
+				pLogger->LogError("ConsoleOperator::runConsoleCommand wrong macro: " + command);
+				break;
+			}
+
+			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+			//steps are checked by CommandRunner
+			_cmdKey = _pCommandReception->MacroUpload(macroId, steps);
+			cmdId = _cmdKey;
+		}
+		break;
+
+		case ConsoleCommandFactory::Type::MacroRun:
+		{
+			unsigned int macroId;
+			std::vector<long> parameters;
+
+			if(!ConsoleCommandFactory::GetParameterMacroRun(command, macroId, parameters)) {
+				pLogger->LogError("ConsoleOperator::runConsoleCommand wrong macro parameters: " + command);
+				break;
+			}
+
+			Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+			//stepper positions are updated when the macro finishes.
+			_cmdKey = _pCommandReception->MacroRun(macroId, parameters);
 			cmdId = _cmdKey;
 		}
 		break;
@@ -1155,32 +1295,34 @@ ICommandReception::CommandId ConsoleOperator::RunConsoleCommand(const std::strin
 
 void ConsoleOperator::OnDevicesGet(CommandId key, bool bSuccess, const std::vector<std::string>& devices)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDevicesGet unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDevicesGet unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = false;
+		finishCommand();
+		_bCmdSucceed = false;
 
-	if(bSuccess != true) {
-		pLogger->LogError("ConsoleOperator::OnDevicesGet failed");
-		return;
-	}
+		if(bSuccess != true) {
+			pLogger->LogError("ConsoleOperator::OnDevicesGet failed");
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnDevicesGet devices amount: " + std::to_string(devices.size()));
-	for(unsigned int i = 0; i < devices.size(); i++) {
-		pLogger->LogInfo("ConsoleOperator::OnDevicesGet " + std::to_string(i) + ": " + devices[i]);
-	}
+		pLogger->LogInfo("ConsoleOperator::OnDevicesGet devices amount: " + std::to_string(devices.size()));
+		for(unsigned int i = 0; i < devices.size(); i++) {
+			pLogger->LogInfo("ConsoleOperator::OnDevicesGet " + std::to_string(i) + ": " + devices[i]);
+		}
 
-	_devices = devices;
-	_cmdKey = InvalidCommandId;
-	_bCmdSucceed = true;
+		_devices = devices;
+		_cmdKey = InvalidCommandId;
+		_bCmdSucceed = true;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDevicesGet(key, bSuccess, devices);
@@ -1189,19 +1331,21 @@ void ConsoleOperator::OnDevicesGet(CommandId key, bool bSuccess, const std::vect
 
 void ConsoleOperator::OnDeviceConnect(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDeviceConnect unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDeviceConnect unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDeviceConnect(key, bSuccess);
@@ -1210,19 +1354,21 @@ void ConsoleOperator::OnDeviceConnect(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnDeviceQueryPower(CommandId key, bool bSuccess, bool bPowered)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDeviceQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDeviceQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDeviceQueryPower(key, bSuccess, bPowered);
@@ -1231,40 +1377,91 @@ void ConsoleOperator::OnDeviceQueryPower(CommandId key, bool bSuccess, bool bPow
 
 void ConsoleOperator::OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFuseOn)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDeviceQueryFuse unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDeviceQueryFuse unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDeviceQueryFuse(key, bSuccess, bFuseOn);
 	}
 }
 
-void ConsoleOperator::OnDeviceDelay(CommandId key, bool bSuccess)
+void ConsoleOperator::OnDeviceQueryStatus(CommandId key, bool bSuccess, const StatusSnapshot& status)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDeviceQueryStatus unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+
+		if(_bCmdSucceed)
+		{
+			for(unsigned int i=0; (i<status.steppers.size()) && (i<_steppers.size()); i++)
+			{
+				auto& stepper = status.steppers[i];
+
+				_steppers[i].state = stepper.state;
+				_steppers[i].enabled = stepper.bEnabled;
+				_steppers[i].forward = stepper.bForward;
+				_steppers[i].forwardClockwise = stepper.bForwardClockwise;
+
+				_steppers[i].locatorIndex = stepper.locatorIndex;
+				_steppers[i].locatorLineNumberStart = stepper.locatorLineNumberStart;
+				_steppers[i].locatorLineNumberTerminal = stepper.locatorLineNumberTerminal;
+				_steppers[i].homeOffset = stepper.homeOffset;
+				_steppers[i].lowClks = stepper.lowClks;
+				_steppers[i].highClks = stepper.highClks;
+				_steppers[i].accelerationBuffer = stepper.accelerationBuffer;
+				_steppers[i].accelerationBufferDecrement = stepper.accelerationBufferDecrement;
+				_steppers[i].decelerationBuffer = stepper.decelerationBuffer;
+				_steppers[i].decelerationBufferIncrement = stepper.decelerationBufferIncrement;
+			}
+		}
 	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDeviceDelay unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
+
+	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
+		(*it)->OnDeviceQueryStatus(key, bSuccess, status);
 	}
+}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+void ConsoleOperator::OnDeviceDelay(CommandId key, bool bSuccess)
+{
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDeviceDelay unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDeviceDelay(key, bSuccess);
@@ -1273,19 +1470,21 @@ void ConsoleOperator::OnDeviceDelay(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnOptPowerOn(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnOptPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnOptPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnOptPowerOn(key, bSuccess);
@@ -1294,19 +1493,21 @@ void ConsoleOperator::OnOptPowerOn(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnOptPowerOff(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnOptPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnOptPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnOptPowerOff(key, bSuccess);
@@ -1315,19 +1516,21 @@ void ConsoleOperator::OnOptPowerOff(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnOptQueryPower(CommandId key, bool bSuccess, bool bPowered)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnOptQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnOptQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnOptQueryPower(key, bSuccess, bPowered);
@@ -1336,19 +1539,21 @@ void ConsoleOperator::OnOptQueryPower(CommandId key, bool bSuccess, bool bPowere
 
 void ConsoleOperator::OnDcmPowerOn(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDcmPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDcmPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDcmPowerOn(key, bSuccess);
@@ -1357,19 +1562,21 @@ void ConsoleOperator::OnDcmPowerOn(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnDcmPowerOff(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDcmPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDcmPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDcmPowerOff(key, bSuccess);
@@ -1378,19 +1585,21 @@ void ConsoleOperator::OnDcmPowerOff(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnDcmQueryPower(CommandId key, bool bSuccess, bool bPowered)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnDcmQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnDcmQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnDcmQueryPower(key, bSuccess, bPowered);
@@ -1399,19 +1608,21 @@ void ConsoleOperator::OnDcmQueryPower(CommandId key, bool bSuccess, bool bPowere
 
 void ConsoleOperator::OnBdcsPowerOn(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcsPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcsPowerOn unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcsPowerOn(key, bSuccess);
@@ -1420,19 +1631,21 @@ void ConsoleOperator::OnBdcsPowerOn(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnBdcsPowerOff(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcsPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcsPowerOff unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcsPowerOff(key, bSuccess);
@@ -1441,19 +1654,21 @@ void ConsoleOperator::OnBdcsPowerOff(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnBdcsQueryPower(CommandId key, bool bSuccess, bool bPowered)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcsQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcsQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcsQueryPower(key, bSuccess, bPowered);
@@ -1462,19 +1677,21 @@ void ConsoleOperator::OnBdcsQueryPower(CommandId key, bool bSuccess, bool bPower
 
 void ConsoleOperator::OnBdcCoast(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcCoast unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcCoast unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcCoast(key, bSuccess);
@@ -1483,19 +1700,21 @@ void ConsoleOperator::OnBdcCoast(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnBdcReverse(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcReverse unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcReverse unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcReverse(key, bSuccess);
@@ -1504,19 +1723,21 @@ void ConsoleOperator::OnBdcReverse(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnBdcForward(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcForward unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcForward unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcForward(key, bSuccess);
@@ -1525,19 +1746,21 @@ void ConsoleOperator::OnBdcForward(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnBdcBreak(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnBdcBreak unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnBdcBreak unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnBdcBreak(key, bSuccess);
@@ -1554,7 +1777,7 @@ void ConsoleOperator::OnBdcQuery(CommandId key, bool bSuccess, BdcStatus status)
 		return;
 	}
 
-	_bCmdFinish = true;
+	finishCommand();
 	_bCmdSucceed = bSuccess;
 	_cmdKey = InvalidCommandId;
 
@@ -1574,7 +1797,7 @@ void ConsoleOperator::OnSteppersPowerOn(CommandId key, bool bSuccess)
 		return;
 	}
 
-	_bCmdFinish = true;
+	finishCommand();
 	_bCmdSucceed = bSuccess;
 	_cmdKey = InvalidCommandId;
 
@@ -1593,7 +1816,7 @@ void ConsoleOperator::OnSteppersPowerOff(CommandId key, bool bSuccess)
 		return;
 	}
 
-	_bCmdFinish = true;
+	finishCommand();
 	_bCmdSucceed = bSuccess;
 	_cmdKey = InvalidCommandId;
 
@@ -1604,19 +1827,21 @@ void ConsoleOperator::OnSteppersPowerOff(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnSteppersQueryPower(CommandId key, bool bSuccess, bool bPowered)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnSteppersQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnSteppersQueryPower unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnSteppersQueryPower(key, bSuccess, bPowered);
@@ -1625,19 +1850,21 @@ void ConsoleOperator::OnSteppersQueryPower(CommandId key, bool bSuccess, bool bP
 
 void ConsoleOperator::OnStepperQueryResolution(CommandId key, bool bSuccess, unsigned long resolutionUs)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperQueryResolution unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperQueryResolution unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	_bCmdFinish = true;
-	_bCmdSucceed = bSuccess;
-	_cmdKey = InvalidCommandId;
+		finishCommand();
+		_bCmdSucceed = bSuccess;
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperQueryResolution(key, bSuccess, resolutionUs);
@@ -1646,20 +1873,22 @@ void ConsoleOperator::OnStepperQueryResolution(CommandId key, bool bSuccess, uns
 
 void ConsoleOperator::OnStepperConfigStep(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperConfigStep unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperConfigStep unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperConfigStep finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperConfigStep finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperConfigStep(key, bSuccess);
@@ -1668,20 +1897,22 @@ void ConsoleOperator::OnStepperConfigStep(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnStepperAccelerationBuffer(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperAccelerationBuffer unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperAccelerationBuffer unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperAccelerationBuffer finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperAccelerationBuffer finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperAccelerationBuffer(key, bSuccess);
@@ -1690,20 +1921,22 @@ void ConsoleOperator::OnStepperAccelerationBuffer(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnStepperAccelerationBufferDecrement(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperAccelerationBufferDecrement unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperAccelerationBufferDecrement unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperAccelerationBufferDecrement finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperAccelerationBufferDecrement finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperAccelerationBufferDecrement(key, bSuccess);
@@ -1712,20 +1945,22 @@ void ConsoleOperator::OnStepperAccelerationBufferDecrement(CommandId key, bool b
 
 void ConsoleOperator::OnStepperDecelerationBuffer(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperDecelerationBuffer unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperDecelerationBuffer unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperDecelerationBuffer finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperDecelerationBuffer finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperDecelerationBuffer(key, bSuccess);
@@ -1734,20 +1969,22 @@ void ConsoleOperator::OnStepperDecelerationBuffer(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnStepperDecelerationBufferIncrement(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperDecelerationBufferIncrement unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperDecelerationBufferIncrement unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperDecelerationBufferIncrement finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperDecelerationBufferIncrement finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperDecelerationBufferIncrement(key, bSuccess);
@@ -1756,64 +1993,149 @@ void ConsoleOperator::OnStepperDecelerationBufferIncrement(CommandId key, bool b
 
 void ConsoleOperator::OnStepperRun(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+		unsigned int index;
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
+		//compound stepperMove waits for its run with _cmdKey only
+		if(!takeOverlappedCommand(key, index) && (_cmdKey != key)) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperRun unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnStepperRun finished");
+		if(_cmdKey == key) {
+			_bCmdSucceed = bSuccess;
+			finishCommand();
+			_cmdKey = InvalidCommandId;
+		}
 	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperRun unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
+
+	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
+		(*it)->OnStepperRun(key, bSuccess);
 	}
+}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperRun finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+void ConsoleOperator::OnSteppersMove(CommandId key, bool bSuccess)
+{
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnSteppersMove unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnSteppersMove finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
-		(*it)->OnStepperRun(key, bSuccess);
+		(*it)->OnSteppersMove(key, bSuccess);
 	}
 }
 
-void ConsoleOperator::OnStepperConfigHome(CommandId key, bool bSuccess)
+void ConsoleOperator::OnMacroUpload(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnMacroUpload unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnMacroUpload finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
 	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperConfigHome unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
+
+	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
+		(*it)->OnMacroUpload(key, bSuccess);
 	}
+}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperConfigHome finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+void ConsoleOperator::OnMacroRun(CommandId key, bool bSuccess, const std::vector<unsigned long>& positions)
+{
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnMacroRun unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnMacroRun finished");
+		if(bSuccess)
+		{
+			for(unsigned int i=0; (i<positions.size()) && (i<STEPPER_AMOUNT); i++) {
+				_steppers[i].homeOffset = positions[i];
+			}
+		}
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
-		(*it)->OnStepperConfigHome(key, bSuccess);
+		(*it)->OnMacroRun(key, bSuccess, positions);
 	}
 }
 
-void ConsoleOperator::OnStepperEnable(CommandId key, bool bSuccess)
+void ConsoleOperator::OnStepperConfigHome(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperConfigHome unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnStepperConfigHome finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
 	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperEnable unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
+
+	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
+		(*it)->OnStepperConfigHome(key, bSuccess);
 	}
+}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperEnable finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+void ConsoleOperator::OnStepperEnable(CommandId key, bool bSuccess)
+{
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperEnable unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
+
+		pLogger->LogInfo("ConsoleOperator::OnStepperEnable finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperEnable(key, bSuccess);
@@ -1822,20 +2144,22 @@ void ConsoleOperator::OnStepperEnable(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnStepperForward(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperForward unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperForward unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperForward finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperForward finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperForward(key, bSuccess);
@@ -1844,20 +2168,22 @@ void ConsoleOperator::OnStepperForward(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnStepperSteps(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperSteps unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperSteps unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperSteps finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperSteps finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperSteps(key, bSuccess);
@@ -1880,37 +2206,39 @@ void ConsoleOperator::OnStepperQuery(CommandId key, bool bSuccess,
 									unsigned long decelerationBuffer,
 									unsigned long decelerationBufferIncrement)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+		unsigned int index;
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperQuery unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(!takeOverlappedCommand(key, index)) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperQuery unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperQuery finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
+		pLogger->LogInfo("ConsoleOperator::OnStepperQuery finished");
+		if(_cmdKey == key) {
+			_bCmdSucceed = bSuccess;
+			finishCommand();
+		}
 
-	if(_bCmdSucceed)
-	{
-		_steppers[_index].state = state;
-		_steppers[_index].enabled = bEnabled;
-		_steppers[_index].forward = bForward;
-		_steppers[_index].forwardClockwise = bForwardClockwise;
-
-		_steppers[_index].locatorIndex = locatorIndex;
-		_steppers[_index].locatorLineNumberStart = locatorLineNumberStart;
-		_steppers[_index].locatorLineNumberTerminal = locatorLineNumberTerminal;
-		_steppers[_index].homeOffset = homeOffset;
-		_steppers[_index].lowClks = lowClks;
-		_steppers[_index].highClks = highClks;
-		_steppers[_index].accelerationBuffer = accelerationBuffer;
-		_steppers[_index].accelerationBufferDecrement = accelerationBufferDecrement;
-		_steppers[_index].decelerationBuffer = decelerationBuffer;
-		_steppers[_index].decelerationBufferIncrement = decelerationBufferIncrement;
+		if(bSuccess)
+		{
+			_steppers[index].state = state;
+			_steppers[index].enabled = bEnabled;
+			_steppers[index].forward = bForward;
+			_steppers[index].forwardClockwise = bForwardClockwise;
+
+			_steppers[index].locatorIndex = locatorIndex;
+			_steppers[index].locatorLineNumberStart = locatorLineNumberStart;
+			_steppers[index].locatorLineNumberTerminal = locatorLineNumberTerminal;
+			_steppers[index].homeOffset = homeOffset;
+			_steppers[index].lowClks = lowClks;
+			_steppers[index].highClks = highClks;
+			_steppers[index].accelerationBuffer = accelerationBuffer;
+			_steppers[index].accelerationBufferDecrement = accelerationBufferDecrement;
+			_steppers[index].decelerationBuffer = decelerationBuffer;
+			_steppers[index].decelerationBufferIncrement = decelerationBufferIncrement;
+		}
 	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
@@ -1934,20 +2262,22 @@ void ConsoleOperator::OnStepperQuery(CommandId key, bool bSuccess,
 
 void ConsoleOperator::OnStepperForwardClockwise(CommandId key, bool bSuccess)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnStepperForwardClockwise unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(_cmdKey == InvalidCommandId) {
+			return;
+		}
+		if(_cmdKey != key) {
+			pLogger->LogDebug("ConsoleOperator::OnStepperForwardClockwise unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnStepperForwardClockwise finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnStepperForwardClockwise finished");
+		_bCmdSucceed = bSuccess;
+		finishCommand();
+		_cmdKey = InvalidCommandId;
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnStepperForwardClockwise(key, bSuccess);
@@ -1956,20 +2286,22 @@ void ConsoleOperator::OnStepperForwardClockwise(CommandId key, bool bSuccess)
 
 void ConsoleOperator::OnLocatorQuery(CommandId key, bool bSuccess, unsigned int lowInput)
 {
-	Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+	{
+		Poco::ScopedLock<Poco::Mutex> lowerLock(_lowerMutex);
+		unsigned int index;
 
-	if(_cmdKey == InvalidCommandId) {
-		return;
-	}
-	if(_cmdKey != key) {
-		pLogger->LogDebug("ConsoleOperator::OnLocatorQuery unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
-		return;
-	}
+		if(!takeOverlappedCommand(key, index)) {
+			pLogger->LogDebug("ConsoleOperator::OnLocatorQuery unexpected cmdKey: " + std::to_string(key) + ", expected: " + std::to_string(_cmdKey));
+			return;
+		}
 
-	pLogger->LogInfo("ConsoleOperator::OnLocatorQuery finished");
-	_bCmdSucceed = bSuccess;
-	_bCmdFinish = true;
-	_cmdKey = InvalidCommandId;
+		pLogger->LogInfo("ConsoleOperator::OnLocatorQuery finished, index: " + std::to_string(index));
+		if(_cmdKey == key) {
+			_bCmdSucceed = bSuccess;
+			finishCommand();
+			_cmdKey = InvalidCommandId;
+		}
+	}
 
 	for(auto it=_observerPtrArray.begin(); it!=_observerPtrArray.end(); it++) {
 		(*it)->OnLocatorQuery(key, bSuccess, lowInput);
@@ -11,9 +11,11 @@
 #include <string>
 #include <deque>
 #include <vector>
+#include <map>
 
 #include "Poco/Task.h"
 #include "Poco/Mutex.h"
+#include "Poco/Condition.h"
 #include "Poco/Event.h"
 #include "Poco/Runnable.h"
 #include "Poco/Thread.h"
@@ -48,6 +50,7 @@ private:
 	virtual void OnDeviceConnect(CommandId key, bool bSuccess) override;
 	virtual void OnDeviceQueryPower(CommandId key, bool bSuccess, bool bPowered) override;
 	virtual void OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFuseOn) override;
+	virtual void OnDeviceQueryStatus(CommandId key, bool bSuccess, const StatusSnapshot& status) override;
 	virtual void OnDeviceDelay(CommandId key, bool bSuccess)  override;
 	virtual void OnOptPowerOn(CommandId key, bool bSuccess)  override;
 	virtual void OnOptPowerOff(CommandId key, bool bSuccess)  override;
@@ -76,6 +79,9 @@ private:
 	virtual void OnStepperForward(CommandId key, bool bSuccess) override;
 	virtual void OnStepperSteps(CommandId key, bool bSuccess) override;
 	virtual void OnStepperRun(CommandId key, bool bSuccess) override;
+	virtual void OnSteppersMove(CommandId key, bool bSuccess) override;
+	virtual void OnMacroUpload(CommandId key, bool bSuccess) override;
+	virtual void OnMacroRun(CommandId key, bool bSuccess, const std::vector<unsigned long>& positions) override;
 	virtual void OnStepperConfigHome(CommandId key, bool bSuccess) override;
 	virtual void OnStepperQuery(CommandId key, bool bSuccess,
 									StepperState state,
@@ -107,7 +113,7 @@ private:
 	std::deque<char> _input;
 
 	Poco::Mutex _upperMutex; //make sure that only ONE console command from console or UserCommandRunner is processed at any time.
-	Poco::Mutex _lowerMutex; //synchronize interactions between this object and CommandRunner object.
+	Poco::Mutex _lowerMutex; //synchronize interactions between this object and CommandRunner object, observers are notified without it.
 
 	std::vector<IResponseReceiver *> _observerPtrArray;
 
@@ -115,6 +121,7 @@ private:
 	ICommandReception::CommandId _cmdKey;
 	unsigned int _index;
 	bool _bCmdFinish;
+	Poco::Condition _cmdFinished; //signaled with _lowerMutex when _bCmdFinish is set.
 	bool _bCmdSucceed;
 	std::vector<std::string> _devices;
 	struct StepperData
@@ -148,12 +155,21 @@ private:
 	};
 	std::vector<BdcData> _bdcs;
 
+	//commands sent without waiting for the reply to the previous one, their replies are forwarded by command id.
+	//value is the index of stepper or locator.
+	const unsigned int MAX_OVERLAPPED_COMMANDS = 32;
+	std::map<ICommandReception::CommandId, unsigned int> _overlappedCommands;
+	void addOverlappedCommand(ICommandReception::CommandId cmdId, unsigned int index);
+	bool takeOverlappedCommand(ICommandReception::CommandId cmdId, unsigned int & index);
+
 	bool runConsoleCommand(const std::string& command, ICommandReception::CommandId & cmdId);
 
 	std::string getConsoleCommand();
 	void showHelp();
 	void prepareRunning();
 	void waitCommandFinish();
+	//mark command as finished and wake up waitCommandFinish
+	void finishCommand();
 
 	enum MovementType
 	{
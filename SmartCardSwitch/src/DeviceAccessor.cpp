@@ -115,7 +115,7 @@ void DeviceAccessor::onIncoming()
 {
 	std::vector<std::string> jsons;
 
-	MsgPackager::RetrieveMsgs(_incoming, jsons);
+	_incoming.RetrieveMsgs(jsons);
 
 	//notify observers
 	for(auto it=jsons.begin(); it!=jsons.end(); it++) {
@@ -197,9 +197,7 @@ void DeviceAccessor::runTask()
 					}
 					else {
 						//save content read to incoming queue
-						for(int i=0; i<amount; i++) {
-							_incoming.push_back(buffer[i]);
-						}
+						_incoming.Append(buffer, amount);
 						//process incoming data
 						onIncoming();
 					}
@@ -221,7 +219,7 @@ void DeviceAccessor::runTask()
 					pLogger->LogInfo("DeviceAccessor::runTask disconnect from " + _socketAddress.toString());
 					_socket.close();
 					_connected = false;
-					_incoming.clear();
+					_incoming.Clear();
 
 					//notify observers of device disconnection
 					std::string disconnection(MSG_DEVICE_DISCONNECTED);
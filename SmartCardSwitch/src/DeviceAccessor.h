@@ -14,6 +14,7 @@
 #include "Poco/Mutex.h"
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/Net/StreamSocket.h"
+#include "MsgPackager.h"
 
 
 class IDeviceObserver
@@ -62,7 +63,7 @@ private:
 
 	Poco::Net::SocketAddress _socketAddress;
 	Poco::Net::StreamSocket _socket;
-	std::deque<unsigned char> _incoming; //incoming data from socket
+	MsgFramer _incoming; //incoming data from socket
 	std::deque<unsigned char> _outgoing; //outgoing data to socket
 
 	std::vector<IDeviceObserver*> _observerPtrArray;
@@ -9,6 +9,7 @@
 #define ICOMMANDRECEPTION_H_
 
 #include <string>
+#include <vector>
 
 #include "CoordinateStorage.h"
 #include "MovementConfiguration.h"
@@ -42,6 +43,79 @@ public:
 		Decelerating
 	};
 
+	//one stepper movement in a batch of movements
+	struct StepperMovement
+	{
+		unsigned int index;
+		unsigned int initialPos;
+		unsigned int finalPos;
+		bool withPrevious; //starts together with the previous movement instead of after it
+	};
+
+	//commands which can be a step of macro
+	enum class MacroStepType
+	{
+		DeviceDelay,
+		BdcCoast,
+		BdcReverse,
+		BdcForward,
+		BdcBreak,
+		StepperConfigStep,
+		StepperAccelerationBuffer,
+		StepperAccelerationBufferDecrement,
+		StepperDecelerationBuffer,
+		StepperDecelerationBufferIncrement,
+		SteppersMoveTo
+	};
+
+	//movement to an absolute position, macro parameter is added to position if parameter isn't -1.
+	struct MacroMovement
+	{
+		unsigned int index;
+		long position;
+		bool withPrevious;
+		int parameter;
+	};
+
+	//values are arguments of the command in the same order as ICommandReception,
+	//movements are used by SteppersMoveTo only.
+	struct MacroStep
+	{
+		MacroStepType type;
+		std::vector<unsigned long> values;
+		std::vector<MacroMovement> movements;
+	};
+
+	struct StepperStatus
+	{
+		StepperState state;
+		bool bEnabled;
+		bool bForward;
+		bool bForwardClockwise;
+		unsigned int locatorIndex;
+		unsigned int locatorLineNumberStart;
+		unsigned int locatorLineNumberTerminal;
+		unsigned long homeOffset;
+		unsigned long lowClks;
+		unsigned long highClks;
+		unsigned long accelerationBuffer;
+		unsigned long accelerationBufferDecrement;
+		unsigned long decelerationBuffer;
+		unsigned long decelerationBufferIncrement;
+	};
+
+	//whole device status replied by one device command
+	struct StatusSnapshot
+	{
+		bool bPoweredOn;
+		bool bFuseOn;
+		bool bBdcsPoweredOn;
+		bool bSteppersPoweredOn;
+		std::vector<BdcStatus> bdcs;
+		std::vector<StepperStatus> steppers;
+		std::vector<unsigned int> locators; //low input of each locator
+	};
+
 };
 
 class IResponseReceiver: public ICommandDataTypes
@@ -54,6 +128,7 @@ public:
 	virtual void OnDeviceDelay(CommandId key, bool bSuccess)  {}
 	virtual void OnDeviceQueryPower(CommandId key, bool bSuccess, bool bPowered)  {}
 	virtual void OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFuseOn)  {}
+	virtual void OnDeviceQueryStatus(CommandId key, bool bSuccess, const StatusSnapshot& status)  {}
 	virtual void OnDeviceQueryHomeState(CommandId key, bool homePositioned) {}
 	virtual void OnDeviceGoHome(CommandId key, bool bSuccess) {}
 	virtual void OnOptPowerOn(CommandId key, bool bSuccess)  {}
@@ -85,6 +160,10 @@ public:
 	virtual void OnStepperRun(CommandId key, bool bSuccess) {}
 	virtual void OnStepperConfigHome(CommandId key, bool bSuccess) {}
 	virtual void OnStepperMove(CommandId key, bool bSuccess) {}
+	virtual void OnSteppersMove(CommandId key, bool bSuccess) {}
+	virtual void OnMacroUpload(CommandId key, bool bSuccess) {}
+	//positions of all steppers after the last step
+	virtual void OnMacroRun(CommandId key, bool bSuccess, const std::vector<unsigned long>& positions) {}
 	virtual void OnStepperQuery(CommandId key, bool bSuccess,
 								StepperState state,
 								bool bEnabled,
@@ -118,6 +197,7 @@ public:
 	virtual CommandId DeviceDelay(unsigned int clks) = 0;
 	virtual CommandId DeviceQueryPower() = 0;
 	virtual CommandId DeviceQueryFuse() = 0;
+	virtual CommandId DeviceQueryStatus() = 0;
 	virtual CommandId OptPowerOn() = 0;
 	virtual CommandId OptPowerOff() = 0;
 	virtual CommandId OptQueryPower() = 0;
@@ -147,6 +227,13 @@ public:
 	virtual CommandId StepperRun(unsigned int index, unsigned short intialPos, unsigned short finalPos) = 0;
 	virtual CommandId StepperConfigHome(unsigned int index, unsigned int locatorIndex, unsigned int lineNumberStart, unsigned int lineNumberTerminal) = 0;
 	virtual CommandId StepperMove(unsigned int index, unsigned short steps) = 0;
+	//movements run in the order given, a movement with withPrevious set starts together with the previous one.
+	//a group of concurrent movements finishes before the next group starts, reply comes after the last group.
+	virtual CommandId SteppersMove(const std::vector<StepperMovement>& movements) = 0;
+	//device keeps the steps of macro and runs them when MacroRun is received,
+	//reply of MacroRun comes after the last step.
+	virtual CommandId MacroUpload(unsigned int macroId, const std::vector<MacroStep>& steps) = 0;
+	virtual CommandId MacroRun(unsigned int macroId, const std::vector<long>& parameters) = 0;
 	virtual CommandId StepperSetState(unsigned int index, StepperState state) = 0;
 	virtual CommandId StepperForwardClockwise(unsigned int index, bool bForwardClockwise) = 0;
 	virtual CommandId StepperQuery(unsigned int index) = 0;
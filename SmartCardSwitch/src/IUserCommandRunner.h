@@ -10,46 +10,56 @@
 
 #include <string>
 
-class IUserCommandDataType
+/**
+ * Type of user command.
+ * Name of each user command is defined in the command table in UserCommandTable.h,
+ * the table must have exactly one entry for each type, it is checked at compile time.
+ */
+enum class UserCommandType
 {
-public:
-	const std::string UserCmdConnectDevice = "connect device";
-	const std::string UserCmdCheckResetPressed = "check reset pressed";
-	const std::string UserCmdCheckResetReleased = "check reset released";
-	const std::string UserCmdResetDevice = "reset device";
-	const std::string UserCmdAdjustStepperW = "adjust stepper w";
-	const std::string UserCmdFinishStepperWAdjustment = "finish stepper w adjustment";
-	const std::string UserCmdTapSmartCard = "tap smart card";
-	const std::string UserCmdPressPedKey = "press PED key";
-	const std::string UserCmdPressSoftKey = "press soft key";
-	const std::string UserCmdPressAssistKey = "press assist key";
-	const std::string UserCmdTouchScreen = "touch screen";
-	const std::string UserCmdBackToHome = "back to home";
-	const std::string UserCmdPowerOnOpt = "power on opt";
-	const std::string UserCmdPowerOffOpt = "power off opt";
-	const std::string UserCmdPowerOnDcm = "power on dcm";
-	const std::string UserCmdPowerOffDcm = "power off dcm";
+	Invalid = -1,
+	ConnectDevice,
+	CheckResetPressed,
+	CheckResetReleased,
+	ResetDevice,
+	AdjustStepperW,
+	FinishStepperWAdjustment,
+	TapSmartCard,
+	PressPedKey,
+	PressSoftKey,
+	PressAssistKey,
+	TouchScreen,
+	BackToHome,
+	PowerOnOpt,
+	PowerOffOpt,
+	PowerOnDcm,
+	PowerOffDcm,
 
 	//use either power commands or sub commands to insert, remove, swipe smart card or tap bar code.
-	const std::string UserCmdReturnSmartCard = "return smart card";
+	ReturnSmartCard,
 	//power commands
-	const std::string UserCmdInsertSmartCard = "insert smart card";
-	const std::string UserCmdRemoveSmartCard = "remove smart card";
-	const std::string UserCmdSwipeSmartCard = "swipe smart card";
-	const std::string UserCmdTapBarCode = "tap bar code";
+	InsertSmartCard,
+	RemoveSmartCard,
+	SwipeSmartCard,
+	TapBarCode,
 	//sub commands
-	const std::string UserCmdCardFromBayToSmartCardGate = "move card from bay to smartCardGate";
-	const std::string UserCmdCardFromSmartCardGateToSmartCardReaderGate = "move card from smartCardGate to smartCardReaderGate";
-	const std::string UserCmdCardFromSmartCardReaderGateToSmartCardReader = "move card from smartCardReaderGate to smartCardReader";
-	const std::string UserCmdCardFromSmartCardReaderToSmartCardReaderGate = "move card from smartCardReader to smartCardReaderGate";
-	const std::string UserCmdCardFromSmartCardReaderGateToSmartCardGate = "move card from smartCardReaderGate to smartCardGate";
-	const std::string UserCmdCardFromSmartCardGateToBarcodeReaderGate = "move card from smartCardGate to barcodeReaderGate";
-	const std::string UserCmdCardFromBarcodeReaderGateToBarcodeReader = "move card from barcodeReaderGate to barcodeReader";
-	const std::string UserCmdCardBarcodeToExtraPosition = "move card barcode to extra position";
-	const std::string UserCmdCardFromBarcodeReaderToBarcodeReaderGate = "move card from barcodeReader to barcodeReaderGate";
-	const std::string UserCmdCardFromBarcodeReaderGateToSmartCardGate = "move card from barcodeReaderGate to smartCardGate";
-	const std::string UserCmdCardFromSmartCardGateToBay = "move card from smartCardGate to bay";
+	CardFromBayToSmartCardGate,
+	CardFromSmartCardGateToSmartCardReaderGate,
+	CardFromSmartCardReaderGateToSmartCardReader,
+	CardFromSmartCardReaderToSmartCardReaderGate,
+	CardFromSmartCardReaderGateToSmartCardGate,
+	CardFromSmartCardGateToBarcodeReaderGate,
+	CardFromBarcodeReaderGateToBarcodeReader,
+	CardBarcodeToExtraPosition,
+	CardFromBarcodeReaderToBarcodeReaderGate,
+	CardFromBarcodeReaderGateToSmartCardGate,
+	CardFromSmartCardGateToBay,
+	Last = CardFromSmartCardGateToBay //keep it same as the last user command type
+};
 
+class IUserCommandDataType
+{
+public:
 	const std::string ErrorDeviceNotAvailable = "device hans't been connected";
 	const std::string ErrorDeviceNotPowered = "device is not powered";
 	const std::string ErrorResetIsNotPressed = "reset is not pressed";
@@ -248,6 +248,90 @@ void ReplyTranslator::parseReply(Poco::JSON::Object::Ptr objectPtr, const std::s
 
 		_deviceQueryFusePtr = ptr;
 	}
+	else if(command == strCommandDeviceQueryStatus)
+	{
+		_type = ReplyType::DeviceQueryStatus;
+
+		std::shared_ptr<ReplyDeviceQueryStatus> ptr (new ReplyDeviceQueryStatus);
+		//common attributes
+		ptr->originalString = _reply;
+		ptr->commandKey = commandKey;
+		ptr->commandId = commandId;
+		ptr->errorInfo = errorInfo;
+		//specific attributes
+		if(errorInfo.empty())
+		{
+			std::string power = ds["power"].toString();
+			std::string fuse = ds["fuse"].toString();
+			std::string bdcsPower = ds["bdcsPower"].toString();
+			std::string steppersPower = ds["steppersPower"].toString();
+
+			ptr->bPoweredOn = (power == "powered on");
+			ptr->bFuseOn = (fuse == "main fuse is on");
+			ptr->bBdcsPoweredOn = (bdcsPower == "BDCs are powered on");
+			ptr->bSteppersPowered = (steppersPower == "steppers are powered on");
+
+			for(unsigned int i=0; i<ds["bdcs"].size(); i++)
+			{
+				std::string state = ds["bdcs"][i].toString();
+
+				if(state == "coast") {
+					ptr->bdcModes.push_back(ReplyBdcQuery::BdcMode::COAST);
+				}
+				else if(state == "reverse") {
+					ptr->bdcModes.push_back(ReplyBdcQuery::BdcMode::REVERSE);
+				}
+				else if(state == "forward") {
+					ptr->bdcModes.push_back(ReplyBdcQuery::BdcMode::FORWARD);
+				}
+				else if(state == "break") {
+					ptr->bdcModes.push_back(ReplyBdcQuery::BdcMode::BREAK);
+				}
+				else {
+					pLogger->LogError("ReplyTranslator::parseReply wrong bdc state in status: " + state);
+					ptr->errorInfo = "wrong bdc status";
+				}
+			}
+
+			for(unsigned int i=0; i<ds["steppers"].size(); i++)
+			{
+				auto stepper = ds["steppers"][i];
+				ReplyStepperQuery status;
+
+				status.index = stepper["index"];
+				status.state = stepper["state"].toString();
+				status.bEnabled = stepper["enabled"];
+				status.bForward = stepper["forward"];
+				status.locatorIndex = stepper["locatorIndex"];
+				status.locatorLineNumberStart = stepper["locatorLineNumberStart"];
+				status.locatorLineNumberTerminal = stepper["locatorLineNumberTerminal"];
+				status.homeOffset = stepper["homeOffset"];
+				status.lowClks = stepper["lowClks"];
+				status.highClks = stepper["highClks"];
+				status.accelerationBuffer = stepper["accelerationBuffer"];
+				status.accelerationBufferDecrement = stepper["accelerationBufferDecrement"];
+				status.decelerationBuffer = stepper["decelerationBuffer"];
+				status.decelerationBufferIncrement = stepper["decelerationBufferIncrement"];
+				ptr->steppers.push_back(status);
+			}
+
+			for(unsigned int i=0; i<ds["locators"].size(); i++) {
+				unsigned int lowInput = ds["locators"][i];
+				ptr->lowInputs.push_back(lowInput);
+			}
+
+			if((power != "powered on") && (power != "powered off")) {
+				pLogger->LogError("ReplyTranslator::parseReply unknown device power status: " + power);
+				ptr->errorInfo = "unknown device power status";
+			}
+			else if((fuse != "main fuse is on") && (fuse != "main fuse is off")) {
+				pLogger->LogError("ReplyTranslator::parseReply unknown device fuse status: " + fuse);
+				ptr->errorInfo = "unknown device fuse status";
+			}
+		}
+
+		_deviceQueryStatusPtr = ptr;
+	}
 	else if(command == strCommandOptPowerOn)
 	{
 		_type = ReplyType::OptPowerOn;
@@ -871,6 +955,69 @@ void ReplyTranslator::parseReply(Poco::JSON::Object::Ptr objectPtr, const std::s
 
 		_locatorQueryPtr = ptr;
 	}
+	else if(command == strCommandSteppersMove)
+	{
+		_type = ReplyType::SteppersMove;
+
+		std::shared_ptr<ReplySteppersMove> ptr (new ReplySteppersMove);
+		//common attributes
+		ptr->originalString = _reply;
+		ptr->commandKey = commandKey;
+		ptr->commandId = commandId;
+		ptr->errorInfo = errorInfo;
+		//specific attributes
+		if(errorInfo.empty()) {
+			auto size = ds["positions"].size();
+
+			for(unsigned int i=0; i<size; i++) {
+				unsigned int index = ds["positions"][i]["index"];
+				unsigned long position = ds["positions"][i]["position"];
+
+				ptr->indexes.push_back(index);
+				ptr->positions.push_back(position);
+			}
+		}
+
+		_steppersMovePtr = ptr;
+	}
+	else if(command == strCommandMacroUpload)
+	{
+		_type = ReplyType::MacroUpload;
+
+		std::shared_ptr<ReplyMacroUpload> ptr (new ReplyMacroUpload);
+		//common attributes
+		ptr->originalString = _reply;
+		ptr->commandKey = commandKey;
+		ptr->commandId = commandId;
+		ptr->errorInfo = errorInfo;
+		//specific attributes
+		ptr->macroId = ds["macroId"];
+
+		_macroUploadPtr = ptr;
+	}
+	else if(command == strCommandMacroRun)
+	{
+		_type = ReplyType::MacroRun;
+
+		std::shared_ptr<ReplyMacroRun> ptr (new ReplyMacroRun);
+		//common attributes
+		ptr->originalString = _reply;
+		ptr->commandKey = commandKey;
+		ptr->commandId = commandId;
+		ptr->errorInfo = errorInfo;
+		//specific attributes
+		ptr->macroId = ds["macroId"];
+		if(errorInfo.empty()) {
+			auto size = ds["positions"].size();
+
+			for(unsigned int i=0; i<size; i++) {
+				unsigned long position = ds["positions"][i];
+				ptr->positions.push_back(position);
+			}
+		}
+
+		_macroRunPtr = ptr;
+	}
 	else
 	{
 		throw Poco::Exception("ReplyTranslator::parseReply unknown reply");
@@ -912,6 +1059,11 @@ std::shared_ptr<ReplyTranslator::ReplyDeviceQueryFuse> ReplyTranslator::ToDevice
 	return _deviceQueryFusePtr;
 }
 
+std::shared_ptr<ReplyTranslator::ReplyDeviceQueryStatus> ReplyTranslator::ToDeviceQueryStatus()
+{
+	return _deviceQueryStatusPtr;
+}
+
 std::shared_ptr<ReplyTranslator::ReplyOptPowerOn> ReplyTranslator::ToOptPowerOn()
 {
 	return _optPowerOnPtr;
@@ -1067,6 +1219,21 @@ std::shared_ptr<ReplyTranslator::ReplyLocatorQuery> ReplyTranslator::ToLocatorQu
 	return _locatorQueryPtr;
 }
 
+std::shared_ptr<ReplyTranslator::ReplySteppersMove> ReplyTranslator::ToSteppersMove()
+{
+	return _steppersMovePtr;
+}
+
+std::shared_ptr<ReplyTranslator::ReplyMacroUpload> ReplyTranslator::ToMacroUpload()
+{
+	return _macroUploadPtr;
+}
+
+std::shared_ptr<ReplyTranslator::ReplyMacroRun> ReplyTranslator::ToMacroRun()
+{
+	return _macroRunPtr;
+}
+
 std::shared_ptr<ReplyTranslator::EventDevicePower> ReplyTranslator::ToDevicePower()
 {
 	return _devicePowerPtr;
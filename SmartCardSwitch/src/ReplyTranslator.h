@@ -25,6 +25,7 @@ public:
 		DeviceDelay,
 		DeviceQueryPower,
 		DeviceQueryFuse,
+		DeviceQueryStatus,
 		OptPowerOn,
 		OptPowerOff,
 		OptQueryPower,
@@ -58,6 +59,9 @@ public:
 		StepperSetState,
 		StepperForwardClockwise,
 		LocatorQuery,
+		SteppersMove,
+		MacroUpload,
+		MacroRun,
 		//events
 		DevicePower = 10000,
 		DeviceConnection,
@@ -246,6 +250,25 @@ public:
 		unsigned long position;
 	};
 
+	struct ReplyMacroUpload: ReplyCommon
+	{
+		unsigned int macroId;
+	};
+
+	struct ReplyMacroRun: ReplyCommon
+	{
+		unsigned int macroId;
+		//position of each stepper after the last step
+		std::vector<unsigned long> positions;
+	};
+
+	struct ReplySteppersMove: ReplyCommon
+	{
+		//position of each moved stepper, in the order of movements
+		std::vector<unsigned int> indexes;
+		std::vector<unsigned long> positions;
+	};
+
 	struct ReplyStepperQuery: ReplyCommon
 	{
 		unsigned int index;
@@ -282,6 +305,17 @@ public:
 		unsigned int lowInput;
 	};
 
+	struct ReplyDeviceQueryStatus: ReplyCommon
+	{
+		bool bPoweredOn;
+		bool bFuseOn;
+		bool bBdcsPoweredOn;
+		bool bSteppersPowered;
+		std::vector<ReplyBdcQuery::BdcMode> bdcModes;
+		std::vector<ReplyStepperQuery> steppers; //only specific attributes are filled
+		std::vector<unsigned int> lowInputs;
+	};
+
 	struct EventDevicePower
 	{
 		std::string originalString;
@@ -318,6 +352,7 @@ public:
 	std::shared_ptr<ReplyTranslator::ReplyDeviceDelay> ToDeviceDelay();
 	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryPower> ToDeviceQueryPower();
 	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryFuse> ToDeviceQueryFuse();
+	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryStatus> ToDeviceQueryStatus();
 	std::shared_ptr<ReplyTranslator::ReplyOptPowerOn> ToOptPowerOn();
 	std::shared_ptr<ReplyTranslator::ReplyOptPowerOff> ToOptPowerOff();
 	std::shared_ptr<ReplyTranslator::ReplyDcmPowerOn> ToDcmPowerOn();
@@ -349,6 +384,9 @@ public:
 	std::shared_ptr<ReplyTranslator::ReplyStepperSetState> ToStepperSetState();
 	std::shared_ptr<ReplyTranslator::ReplyStepperForwardClockwise> ToStepperForwardClockwise();
 	std::shared_ptr<ReplyTranslator::ReplyLocatorQuery> ToLocatorQuery();
+	std::shared_ptr<ReplyTranslator::ReplySteppersMove> ToSteppersMove();
+	std::shared_ptr<ReplyTranslator::ReplyMacroUpload> ToMacroUpload();
+	std::shared_ptr<ReplyTranslator::ReplyMacroRun> ToMacroRun();
 	//std::shared_ptr<ReplyTranslator::Reply> To();
 	std::shared_ptr<ReplyTranslator::EventDevicePower> ToDevicePower();
 	std::shared_ptr<ReplyTranslator::EventDeviceConnection> ToDeviceConnection();
@@ -368,6 +406,7 @@ private:
 	const std::string strCommandDeviceDelay = "device delay";
 	const std::string strCommandDeviceQueryPower = "device query power";
 	const std::string strCommandDeviceQueryFuse = "device query fuse";
+	const std::string strCommandDeviceQueryStatus = "device query status";
 	const std::string strCommandOptPowerOn = "opt power on";
 	const std::string strCommandOptPowerOff = "opt power off";
 	const std::string strCommandDcmPowerOn = "dcm power on";
@@ -399,6 +438,9 @@ private:
 	const std::string strCommandStepperSetState = "stepper set state";
 	const std::string strCommandStepperForwardClockwise = "stepper forward clockwise";
 	const std::string strCommandLocatorQuery = "locator query";
+	const std::string strCommandSteppersMove = "steppers move";
+	const std::string strCommandMacroUpload = "macro upload";
+	const std::string strCommandMacroRun = "macro run";
 	//events
 	const std::string strEventDevicePower = "device power";
 	const std::string strEventDeviceConnection = "device connection";
@@ -410,6 +452,7 @@ private:
 	std::shared_ptr<ReplyTranslator::ReplyDeviceDelay> _deviceDelayPtr;
 	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryPower> _deviceQueryPowerPtr;
 	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryFuse> _deviceQueryFusePtr;
+	std::shared_ptr<ReplyTranslator::ReplyDeviceQueryStatus> _deviceQueryStatusPtr;
 	std::shared_ptr<ReplyTranslator::ReplyOptPowerOn> _optPowerOnPtr;
 	std::shared_ptr<ReplyTranslator::ReplyOptPowerOff> _optPowerOffPtr;
 	std::shared_ptr<ReplyTranslator::ReplyDcmPowerOn> _dcmPowerOnPtr;
@@ -441,6 +484,9 @@ private:
 	std::shared_ptr<ReplyTranslator::ReplyStepperSetState> _stepperSetStatePtr;
 	std::shared_ptr<ReplyTranslator::ReplyStepperForwardClockwise> _stepperForwardClockwisePtr;
 	std::shared_ptr<ReplyTranslator::ReplyLocatorQuery> _locatorQueryPtr;
+	std::shared_ptr<ReplyTranslator::ReplySteppersMove> _steppersMovePtr;
+	std::shared_ptr<ReplyTranslator::ReplyMacroUpload> _macroUploadPtr;
+	std::shared_ptr<ReplyTranslator::ReplyMacroRun> _macroRunPtr;
 	std::shared_ptr<ReplyTranslator::EventDevicePower> _devicePowerPtr;
 	std::shared_ptr<ReplyTranslator::EventDeviceConnection> _deviceConnectionPtr;
 	std::shared_ptr<ReplyTranslator::EventProxyConnection> _proxyConnectionPtr;
@@ -129,6 +129,7 @@ protected:
 		std::string logFile;
 		std::string logFileSize;
 		std::string logFileAmount;
+		bool logBinary = false;
 		std::string coordinatePathFile;
 		std::string movementConfigurationPathFile;
 
@@ -140,6 +141,7 @@ protected:
 			logFile = config().getString("log_file_name", "SmartCardSwitchLog");
 			logFileSize = config().getString("log_file_size", "1M");
 			logFileAmount = config().getString("log_file_amount", "10");
+			logBinary = config().getBool("log_binary", false);
 		}
 		catch(Poco::Exception& e)
 		{
@@ -150,7 +152,7 @@ protected:
 			logger().error("Config unknown exception");
 		}
 
-		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount);
+		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount, logBinary);
 		pLogger->CopyToConsole(true);
 		tmLogger.start(pLogger); //tmLogger takes the ownership of pLogger.
 		pLogger->LogInfo("**** SmartCardSwitch V1.0.0 ****");
@@ -192,7 +194,8 @@ protected:
 			pDeviceAccessor->Init(socketAddress);
 
 			//CommandRunner
-			pCommandRunner = new CommandRunner;
+			unsigned int maxPendingCommands = config().getUInt("max_pending_device_commands", CommandRunner::DEFAULT_MAX_PENDING_COMMANDS);
+			pCommandRunner = new CommandRunner(maxPendingCommands);
 
 			//ConsoleOperator
 			pConsoleOperator = new ConsoleOperator(pCommandRunner);
@@ -207,7 +210,9 @@ protected:
 			unsigned int autoBackToHomeSeconds = config().getUInt("auto_back_to_home_seconds", 300);
 			Poco::Net::SocketAddress userListenerAddress(userProxyListenerIp + ":" + userPorxyListenerPort);
 			pUserProxy = new UserProxy(deviceToConnect, locatorNumberForReset, lineNumberForReset, autoBackToHome, autoBackToHomeSeconds);
-			pUserCommandRunner = new UserCommandRunner;
+			bool useSteppersMove = config().getBool("use_steppers_move", false);
+			bool useDeviceMacros = config().getBool("use_device_macros", false);
+			pUserCommandRunner = new UserCommandRunner(useSteppersMove, useDeviceMacros, maxPendingCommands);
 			pUserListener = new UserListener(pUserProxy);
 			pUserListener->Bind(userListenerAddress);
 
@@ -216,7 +221,8 @@ protected:
 			unsigned int webServerMaxQueue = config().getInt("web_server_max_queue", 128);
 			unsigned int webServerMaxThreads = config().getInt("web_server_max_threads", 16);
 			std::string webServerFilesFolder = config().getString("web_server_folder", "wrongFolder");
-			pWebServer = new WebServer(webServerPort, webServerMaxQueue, webServerMaxThreads, webServerFilesFolder);
+			bool webServerQueryDeviceStatus = config().getBool("web_server_query_device_status", false);
+			pWebServer = new WebServer(webServerPort, webServerMaxQueue, webServerMaxThreads, webServerFilesFolder, webServerQueryDeviceStatus, maxPendingCommands);
 
 			//couple tasks:
 			// command flow: UserProxy >> UserCommandRunner >> ConsoleOperator >> CommandRunner >> DeviceAccessor
@@ -5,12 +5,15 @@
  *      Author: mikez
  */
 
+#include <algorithm>
+
 #include "Poco/Exception.h"
 #include "Poco/JSON/Parser.h"
 #include "Poco/JSON/Object.h"
 #include "Poco/JSON/JSONException.h"
 
 #include "UserCommandRunner.h"
+#include "UserCommandTable.h"
 #include "Logger.h"
 #include "CoordinateStorage.h"
 #include "MovementConfiguration.h"
@@ -19,15 +22,25 @@ extern Logger * pLogger;
 extern CoordinateStorage * pCoordinateStorage;
 extern MovementConfiguration * pMovementConfiguration;
 
-UserCommandRunner::UserCommandRunner() : Task("UserCommandRunner")
+UserCommandRunner::UserCommandRunner(bool useSteppersMove, bool useDeviceMacros, unsigned int maxPendingCommands) : Task("UserCommandRunner")
 {
+	_useSteppersMove = useSteppersMove;
+	//one is left to commands from web server
+	_maxPendingCommands = (maxPendingCommands > 1) ? (maxPendingCommands - 1) : 1;
+	_stepperRunFailed = false;
+	_useDeviceMacros = useDeviceMacros;
 	_deviceHomePositioned = false;
 	_clampState = ClampState::Released;
 	_currentPosition = CoordinateStorage::Type::Home;
 	_userCommand.state = CommandState::Idle;
+	_userCommand.type = UserCommandType::Invalid;
 	_userCommand.cardState = CardState::InBay;
 	_consoleCommand.state = CommandState::Idle;
 	_pConsoleOperator = nullptr;
+	_motionPlanning = false;
+	_concurrentMovement = false;
+	_concurrentGroupStart = 0;
+	_macroRecording = false;
 }
 
 void UserCommandRunner::notifyObservers(const std::string& cmdId, CommandState state, const std::string& errorInfo)
@@ -185,73 +198,78 @@ void UserCommandRunner::finishUserCommand(CommandState consoleCmdState, const st
 		userCmdResult = CommandState::Succeeded;
 
 		//check result of console commands to know if user command is fulfilled.
-		if(_userCommand.command == UserCmdConnectDevice)
-		{
-			finishUserCommandConnectDevice(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdCheckResetPressed)
-		{
-			finishUserCommandCheckResetPressed(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdCheckResetReleased)
-		{
-			finishUserCommandCheckResetReleased(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdResetDevice)
-		{
-			finishUserCommandResetDevice(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdInsertSmartCard)
-		{
-			finishUserCommandInsertSmartCard(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdRemoveSmartCard)
-		{
-			finishUserCommandRemoveSmartCard(userCmdResult, error);
-		}
-		else if(_userCommand.command == UserCmdCardFromBayToSmartCardGate)
-		{
-			_userCommand.cardState = CardState::InSmartCardGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToSmartCardReaderGate)
-		{
-			_userCommand.cardState = CardState::InSmartCardReaderGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardReader)
-		{
-			_userCommand.cardState = CardState::InSmartCardReader;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderToSmartCardReaderGate)
-		{
-			_userCommand.cardState = CardState::InSmartCardReaderGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardGate)
-		{
-			_userCommand.cardState = CardState::InSmartCardGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToBarcodeReaderGate)
-		{
-			_userCommand.cardState = CardState::InBarcodeReaderGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToBarcodeReader)
-		{
-			_userCommand.cardState = CardState::InBarcodeReader;
-		}
-		else if(_userCommand.command == UserCmdCardBarcodeToExtraPosition)
-		{
-			_userCommand.cardState = CardState::InBarcodeReader;
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderToBarcodeReaderGate)
-		{
-			_userCommand.cardState = CardState::InBarcodeReaderGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToSmartCardGate)
-		{
-			_userCommand.cardState = CardState::InSmartCardGate;
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToBay)
+		switch(_userCommand.type)
 		{
-			_userCommand.cardState = CardState::InBay;
+			case UserCommandType::ConnectDevice:
+				finishUserCommandConnectDevice(userCmdResult, error);
+				break;
+
+			case UserCommandType::CheckResetPressed:
+				finishUserCommandCheckResetPressed(userCmdResult, error);
+				break;
+
+			case UserCommandType::CheckResetReleased:
+				finishUserCommandCheckResetReleased(userCmdResult, error);
+				break;
+
+			case UserCommandType::ResetDevice:
+				finishUserCommandResetDevice(userCmdResult, error);
+				break;
+
+			case UserCommandType::InsertSmartCard:
+				finishUserCommandInsertSmartCard(userCmdResult, error);
+				break;
+
+			case UserCommandType::RemoveSmartCard:
+				finishUserCommandRemoveSmartCard(userCmdResult, error);
+				break;
+
+			case UserCommandType::CardFromBayToSmartCardGate:
+				_userCommand.cardState = CardState::InSmartCardGate;
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToSmartCardReaderGate:
+				_userCommand.cardState = CardState::InSmartCardReaderGate;
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderGateToSmartCardReader:
+				_userCommand.cardState = CardState::InSmartCardReader;
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderToSmartCardReaderGate:
+				_userCommand.cardState = CardState::InSmartCardReaderGate;
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderGateToSmartCardGate:
+				_userCommand.cardState = CardState::InSmartCardGate;
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToBarcodeReaderGate:
+				_userCommand.cardState = CardState::InBarcodeReaderGate;
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderGateToBarcodeReader:
+				_userCommand.cardState = CardState::InBarcodeReader;
+				break;
+
+			case UserCommandType::CardBarcodeToExtraPosition:
+				_userCommand.cardState = CardState::InBarcodeReader;
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderToBarcodeReaderGate:
+				_userCommand.cardState = CardState::InBarcodeReaderGate;
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderGateToSmartCardGate:
+				_userCommand.cardState = CardState::InSmartCardGate;
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToBay:
+				_userCommand.cardState = CardState::InBay;
+				break;
+
+			default:
+				break; //no further check
 		}
 	}
 
@@ -290,6 +308,7 @@ void UserCommandRunner::executeUserCmdConnectDevice()
 {
 	std::string cmd;
 
+	clearMacros(); //macros are lost if device restarts
 	cmd = ConsoleCommandFactory::CmdDevicesGet();
 	runConsoleCommand(cmd);
 	cmd = ConsoleCommandFactory::CmdDeviceConnect(0);//only one device at the moment.
@@ -380,6 +399,7 @@ void UserCommandRunner::executeUserCmdResetDevice()
 	const unsigned int w = 3;
 	const unsigned int v = 4;
 
+	clearMacros(); //coordinates and movement configuration may have changed
 
 	//power on steppers
 	cmd = ConsoleCommandFactory::CmdSteppersPowerOn();
@@ -842,38 +862,206 @@ void UserCommandRunner::moveStepper(unsigned int index, unsigned int initialPos,
 	if(index >= STEPPER_AMOUNT) {
 		throwError("UserCommandRunner::moveStepper stepper index out of range: " + std::to_string(index));
 	}
-	if(_consoleCommand.resultSteppers[index].homeOffset != initialPos)
+
+	unsigned int currentPos = plannedPosition(index);
+
+	if(currentPos != initialPos)
 	{
 		char buf[256];
 
-		sprintf(buf, "UserCommandRunner::moveStepper wrong initialPos: %d in stepper %d, should be %d", initialPos, index, _consoleCommand.resultSteppers[index].homeOffset);
+		sprintf(buf, "UserCommandRunner::moveStepper wrong initialPos: %d in stepper %d, should be %d", initialPos, index, currentPos);
 		throwError(std::string(buf));
 	}
 	if(initialPos == finalPos) {
 		return;
 	}
 
-	std::string cmd;
-	bool forward = (finalPos > initialPos);
-	unsigned int steps;
+	StepperMovement movement;
 
-	if(forward) {
-		steps = finalPos - initialPos;
+	movement.index = index;
+	movement.initialPos = initialPos;
+	movement.finalPos = finalPos;
+	movement.withPrevious = false;
+
+	if(_motionPlanning)
+	{
+		if(_concurrentMovement)
+		{
+			for(unsigned int i=_concurrentGroupStart; i<_motionPlan.size(); i++)
+			{
+				if(_motionPlan[i].index == index) {
+					throwError("UserCommandRunner::moveStepper stepper moves twice in concurrent movement: " + std::to_string(index));
+				}
+			}
+			movement.withPrevious = (_concurrentGroupStart < _motionPlan.size());
+		}
+		_motionPlan.push_back(movement);
+		return;
 	}
-	else {
-		steps = initialPos - finalPos;
+
+	std::vector<StepperMovement> movements(1, movement);
+	runStepperMovements(movements);
+}
+
+void UserCommandRunner::runStepperMovements(const std::vector<StepperMovement>& movements)
+{
+	//macro steps are recorded from "steppers move"
+	if(_useSteppersMove || _macroRecording)
+	{
+		//direction, steps and run of all movements are carried by one device command.
+		std::string cmd = ConsoleCommandFactory::CmdSteppersMove(movements);
+		runConsoleCommand(cmd);
+		return;
 	}
 
-	cmd = ConsoleCommandFactory::CmdStepperForward(index, forward);
-	runConsoleCommand(cmd);
-	cmd = ConsoleCommandFactory::CmdStepperSteps(index, steps);
-	runConsoleCommand(cmd);
-	cmd = ConsoleCommandFactory::CmdStepperRun(index, initialPos, finalPos);
-	runConsoleCommand(cmd);
+	//firmware without "steppers move": direction and steps are set one movement after another,
+	//runs of movements which start at the same time are sent together.
+	for(auto it = movements.begin(); it != movements.end(); )
+	{
+		std::vector<StepperMovement> group;
+
+		do
+		{
+			std::string cmd;
+			bool forward = (it->finalPos > it->initialPos);
+			unsigned int steps;
+
+			if(forward) {
+				steps = it->finalPos - it->initialPos;
+			}
+			else {
+				steps = it->initialPos - it->finalPos;
+			}
+
+			cmd = ConsoleCommandFactory::CmdStepperForward(it->index, forward);
+			runConsoleCommand(cmd);
+			cmd = ConsoleCommandFactory::CmdStepperSteps(it->index, steps);
+			runConsoleCommand(cmd);
+
+			group.push_back(*it);
+			it++;
+		} while((it != movements.end()) && it->withPrevious);
+
+		runSteppers(group);
+	}
+}
+
+void UserCommandRunner::runSteppers(const std::vector<StepperMovement>& movements)
+{
+	std::string errorInfo;
+
+	//no more than _maxPendingCommands runs wait for reply at the same time
+	for(unsigned int first=0; (first<movements.size()) && errorInfo.empty(); first+=_maxPendingCommands)
+	{
+		unsigned int last = std::min((unsigned int)movements.size(), first + _maxPendingCommands);
+
+		//_consoleCommandMutex is held while sending so that a reply can't come before its command id is recorded
+		Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex);
+
+		_stepperRuns.clear();
+		_stepperRunFailed = false;
+		for(unsigned int i=first; i<last; i++)
+		{
+			auto& movement = movements[i];
+			std::string cmd = ConsoleCommandFactory::CmdStepperRun(movement.index, movement.initialPos, movement.finalPos);
+			auto cmdId = _pConsoleOperator->RunConsoleCommand(cmd);
+
+			pLogger->LogFormat("UserCommandRunner::runSteppers stepper %u command Id: %lu", movement.index, cmdId);
+			if(cmdId == ICommandReception::ICommandDataTypes::InvalidCommandId) {
+				errorInfo = "UserCommandRunner::runSteppers failed to run stepper: " + std::to_string(movement.index);
+				break;
+			}
+			_stepperRuns[cmdId] = movement.index;
+		}
+
+		//wait for replies to all runs sent, OnStepperRun removes replied ones
+		while(!_stepperRuns.empty()) {
+			_consoleCommandFinished.wait(_consoleCommandMutex);
+		}
+		if(_stepperRunFailed && errorInfo.empty()) {
+			errorInfo = "UserCommandRunner::runSteppers failed in running steppers";
+		}
+	}
+
+	if(!errorInfo.empty()) {
+		//throw exception to terminate the current USER command
+		throwError(errorInfo);
+	}
+}
+
+unsigned int UserCommandRunner::plannedPosition(unsigned int index)
+{
+	unsigned int position = _consoleCommand.resultSteppers[index].homeOffset;
+
+	if(_motionPlanning)
+	{
+		for(auto it = _motionPlan.begin(); it != _motionPlan.end(); it++)
+		{
+			if(it->index == index) {
+				position = it->finalPos;
+			}
+		}
+	}
+
+	return position;
+}
+
+void UserCommandRunner::beginMotionPlan()
+{
+	_motionPlan.clear();
+	_motionPlanning = true;
+	_concurrentMovement = false;
+}
+
+void UserCommandRunner::beginConcurrentMovement()
+{
+	_concurrentMovement = true;
+	_concurrentGroupStart = _motionPlan.size();
+}
+
+void UserCommandRunner::endConcurrentMovement()
+{
+	_concurrentMovement = false;
+}
+
+void UserCommandRunner::runMotionPlan()
+{
+	std::vector<StepperMovement> movements;
+
+	movements.swap(_motionPlan);
+	_motionPlanning = false;
+	_concurrentMovement = false;
+
+	if(movements.empty()) {
+		return;
+	}
+
+	pLogger->LogInfo("UserCommandRunner::runMotionPlan movements: " + std::to_string(movements.size()));
+	runStepperMovements(movements);
 }
 
 void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsigned int fromZ, unsigned int fromW,
 				unsigned int toX, unsigned int toY, unsigned int toZ, unsigned int toW)
+{
+	beginMotionPlan();
+	try
+	{
+		planGateToGate(fromX, fromY, fromZ, fromW, toX, toY, toZ, toW);
+	}
+	catch(...)
+	{
+		_motionPlanning = false;
+		_concurrentMovement = false;
+		_motionPlan.clear();
+		throw;
+	}
+	runMotionPlan();
+}
+
+// Z and the split W moves around the smart card reader change clearance, they run on their own.
+// X, Y and W moves next to each other keep clearance and run concurrently.
+void UserCommandRunner::planGateToGate(unsigned int fromX, unsigned int fromY, unsigned int fromZ, unsigned int fromW,
+				unsigned int toX, unsigned int toY, unsigned int toZ, unsigned int toW)
 {
 	{
 		char buf[256];
@@ -908,9 +1096,11 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 			case Position::SmartCardGate:
 			{
 				moveStepperZ(fromZ, toZ);
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperW(fromW, toW);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 			}
 			break;
 
@@ -929,9 +1119,11 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 				int curV = currentV();
 
 				moveStepperV(curV, 0);
+				beginConcurrentMovement();
 				moveStepperX(fromX, toX);
 				moveStepperW(fromW, toW);
 				moveStepperY(fromY, toY);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 			}
 			break;
@@ -953,26 +1145,32 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 
 			case Position::BarCodeReaderGate:
 			{
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperW(fromW, toW);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 			}
 			break;
 
 			case Position::ContactlessReaderGate:
 			{
+				beginConcurrentMovement();
 				moveStepperW(fromW, toW);
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 			}
 			break;
 
 			case Position::TouchScreenGate:
 			{
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 				moveStepperW(fromW, toW);
 			}
@@ -994,8 +1192,10 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 
 				moveStepperW(fromW, tmpW);
 				moveStepperZ(fromZ, toZ);
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperW(tmpW, toW);
 			}
 			break;
@@ -1005,8 +1205,10 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 
 			case Position::TouchScreenGate:
 			{
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 				moveStepperW(fromW, toW);
 			}
@@ -1025,9 +1227,11 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 			case Position::SmartCardGate:
 			{
 				moveStepperZ(fromZ, toZ);
+				beginConcurrentMovement();
 				moveStepperX(fromX, toX);
 				moveStepperY(fromY, toY);
 				moveStepperW(fromW, toW);
+				endConcurrentMovement();
 			}
 			break;
 
@@ -1044,9 +1248,11 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 			case Position::SmartCardGate:
 			{
 				moveStepperZ(fromZ, toZ);
+				beginConcurrentMovement();
 				moveStepperX(fromX, toX);
 				moveStepperY(fromY, toY);
 				moveStepperW(fromW, toW);
+				endConcurrentMovement();
 			}
 			break;
 
@@ -1062,9 +1268,11 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 		{
 			case Position::SmartCardReaderGate:
 			{
+				beginConcurrentMovement();
 				moveStepperW(fromW, toW);
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 				moveStepperZ(fromZ, toZ);
 			}
 			break;
@@ -1073,8 +1281,10 @@ void UserCommandRunner::gateToGate(unsigned int fromX, unsigned int fromY, unsig
 			{
 				moveStepperW(fromW, toW);
 				moveStepperZ(fromZ, toZ);
+				beginConcurrentMovement();
 				moveStepperY(fromY, toY);
 				moveStepperX(fromX, toX);
+				endConcurrentMovement();
 			}
 			break;
 
@@ -1583,6 +1793,171 @@ void UserCommandRunner::powerOnDcm(bool on, unsigned int index)
 	runConsoleCommand(cmd);
 }
 
+void UserCommandRunner::clearMacros()
+{
+	if(!_macroIds.empty()) {
+		pLogger->LogInfo("UserCommandRunner::clearMacros macros: " + std::to_string(_macroIds.size()));
+	}
+	_macroIds.clear();
+}
+
+void UserCommandRunner::recordMacroStep(const std::string& cmd)
+{
+	MacroStep step;
+
+	if(ConsoleCommandFactory::GetCmdType(cmd) == ConsoleCommandFactory::Type::SteppersMove)
+	{
+		std::vector<StepperMovement> movements;
+
+		if(!ConsoleCommandFactory::GetParameterSteppersMove(cmd, movements)) {
+			throwError("UserCommandRunner::recordMacroStep invalid steppers move: " + cmd);
+		}
+
+		step.type = MacroStepType::SteppersMoveTo;
+		for(auto it = movements.begin(); it != movements.end(); it++)
+		{
+			MacroMovement movement;
+
+			if(it->index >= STEPPER_AMOUNT) {
+				throwError("UserCommandRunner::recordMacroStep stepper index out of range: " + std::to_string(it->index));
+			}
+
+			movement.index = it->index;
+			movement.position = it->finalPos;
+			movement.withPrevious = it->withPrevious;
+			movement.parameter = -1;
+			if(it->index == STEPPER_V) {
+				movement.parameter = 0;
+				movement.position -= _macroParameters[0];
+			}
+			else if(it->index == STEPPER_W) {
+				movement.parameter = 1;
+				movement.position -= _macroParameters[1];
+			}
+			step.movements.push_back(movement);
+
+			//following commands of the flow depend on the position after this movement
+			auto& stepperData = _consoleCommand.resultSteppers[it->index];
+			stepperData.state = StepperState::KnownPosition;
+			stepperData.forward = (it->finalPos > it->initialPos);
+			stepperData.homeOffset = it->finalPos;
+			stepperData.targetPosition = 0;
+		}
+
+		//consecutive movements run one after another in the same step
+		if(!_macroSteps.empty() && (_macroSteps.back().type == MacroStepType::SteppersMoveTo))
+		{
+			auto& lastMovements = _macroSteps.back().movements;
+			lastMovements.insert(lastMovements.end(), step.movements.begin(), step.movements.end());
+			return;
+		}
+	}
+	else if(!ConsoleCommandFactory::GetMacroStep(cmd, step)) {
+		throwError("UserCommandRunner::recordMacroStep command cannot be a macro step: " + cmd);
+	}
+
+	_macroSteps.push_back(step);
+}
+
+void UserCommandRunner::runAsMacro(void (UserCommandRunner::*sequence)())
+{
+	int cardOffset;
+	ConsoleCommand::StepperStatus steppers[STEPPER_AMOUNT];
+	ConsoleCommand::StepperStatus recordedSteppers[STEPPER_AMOUNT];
+
+	if(!_useDeviceMacros) {
+		(this->*sequence)();
+		return;
+	}
+
+	if(!pCoordinateStorage->GetSmartCardOffset(_userCommand.smartCardNumber, cardOffset)) {
+		throwError("UserCommandRunner::runAsMacro failed to retrieve smart card offset: " + std::to_string(_userCommand.smartCardNumber));
+	}
+	_macroParameters.clear();
+	_macroParameters.push_back(cardOffset);
+	_macroParameters.push_back(pCoordinateStorage->GetWAdjustment());
+
+	//record the flow, stepper status changed by recording is restored afterwards
+	for(int i=0; i<STEPPER_AMOUNT; i++) {
+		steppers[i] = _consoleCommand.resultSteppers[i];
+	}
+	_macroSteps.clear();
+	_macroRecording = true;
+	try
+	{
+		(this->*sequence)();
+	}
+	catch(...)
+	{
+		_macroRecording = false;
+		for(int i=0; i<STEPPER_AMOUNT; i++) {
+			_consoleCommand.resultSteppers[i] = steppers[i];
+		}
+		throw;
+	}
+	_macroRecording = false;
+	for(int i=0; i<STEPPER_AMOUNT; i++) {
+		recordedSteppers[i] = _consoleCommand.resultSteppers[i];
+		_consoleCommand.resultSteppers[i] = steppers[i];
+	}
+
+	if(_macroSteps.empty()) {
+		return;
+	}
+
+	//upload the steps unless device has them already
+	unsigned int macroId;
+	std::string content = ConsoleCommandFactory::CmdMacroUpload(0, _macroSteps);
+	auto it = _macroIds.find(content);
+
+	if(it != _macroIds.end()) {
+		macroId = it->second;
+	}
+	else
+	{
+		if(_macroIds.size() >= MACRO_AMOUNT) {
+			clearMacros(); //overwrite macros from the first one
+		}
+		macroId = _macroIds.size();
+		try
+		{
+			runConsoleCommand(ConsoleCommandFactory::CmdMacroUpload(macroId, _macroSteps));
+		}
+		catch(Poco::Exception& e)
+		{
+			//nothing has moved, firmware doesn't support macros.
+			pLogger->LogError("UserCommandRunner::runAsMacro macro upload is rejected, device macros are disabled");
+			_useDeviceMacros = false;
+			clearMacros();
+			(this->*sequence)();
+			return;
+		}
+		_macroIds[content] = macroId;
+	}
+
+	try
+	{
+		runConsoleCommand(ConsoleCommandFactory::CmdMacroRun(macroId, _macroParameters));
+	}
+	catch(...)
+	{
+		clearMacros(); //device state is unknown
+		throw;
+	}
+
+	//device must stop where the recorded flow ends
+	for(int i=0; i<STEPPER_AMOUNT; i++)
+	{
+		if((recordedSteppers[i].state == StepperState::KnownPosition) &&
+			(_consoleCommand.resultSteppers[i].homeOffset != recordedSteppers[i].homeOffset))
+		{
+			throwError("UserCommandRunner::runAsMacro stepper " + std::to_string(i) + " stopped at " +
+					std::to_string(_consoleCommand.resultSteppers[i].homeOffset) + " instead of " +
+					std::to_string(recordedSteppers[i].homeOffset));
+		}
+	}
+}
+
 void UserCommandRunner::executeUserCmdInsertSmartCard()
 {
 	//check if smart card slot is empty
@@ -1590,6 +1965,11 @@ void UserCommandRunner::executeUserCmdInsertSmartCard()
 		throwError("UserCommandRunner::executeUserCmdInsertSmartCard card in smart card reader");
 	}
 
+	runAsMacro(&UserCommandRunner::insertSmartCard);
+}
+
+void UserCommandRunner::insertSmartCard()
+{
 	toSmartCardGate();
 	openClamp();
 	moveSmartCardCarriage(_userCommand.smartCardNumber);
@@ -1733,6 +2113,11 @@ void UserCommandRunner::executeUserCmdRemoveSmartCard()
 		throwError("UserCommandRunner::expandUserCmdRemoveSmartCard no card in smart card reader");
 	}
 
+	runAsMacro(&UserCommandRunner::removeSmartCard);
+}
+
+void UserCommandRunner::removeSmartCard()
+{
 	toSmartCardReaderGate();
 	openClamp();
 	gate_smartCardReader_withoutCard();
@@ -1753,6 +2138,11 @@ void UserCommandRunner::executeUserCmdSwipeSmartCard()
 		throwError("UserCommandRunner::expandUserCmdSwipeSmartCard card in smart card reader");
 	}
 
+	runAsMacro(&UserCommandRunner::swipeSmartCard);
+}
+
+void UserCommandRunner::swipeSmartCard()
+{
 	toSmartCardGate();
 	openClamp();
 	moveSmartCardCarriage(_userCommand.smartCardNumber);
@@ -1831,6 +2221,19 @@ void UserCommandRunner::contactlessReader_gate()
 void UserCommandRunner::executeUserCmdTapSmartCard()
 {
 	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ######");
+	runAsMacro(&UserCommandRunner::tapSmartCard);
+}
+
+void UserCommandRunner::logTapStep(const char * pStep)
+{
+	//steps being recorded aren't run yet
+	if(!_macroRecording) {
+		pLogger->LogInfo(std::string("UserCommandRunner::executeUserCmdTapSmartCard ###### ") + pStep);
+	}
+}
+
+void UserCommandRunner::tapSmartCard()
+{
 	toSmartCardGate();
 	openClamp();
 	moveSmartCardCarriage(_userCommand.smartCardNumber);
@@ -1840,15 +2243,15 @@ void UserCommandRunner::executeUserCmdTapSmartCard()
 	pullDownSmartCardArm();
 	releaseSmartCardArm();
 	smartCard_gate_withCard(_userCommand.smartCardNumber);
-	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ###### toContactlessReaderGate");
+	logTapStep("toContactlessReaderGate");
 	toContactlessReaderGate();
-	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ###### gate_contactlessReader");
+	logTapStep("gate_contactlessReader");
 	gate_contactlessReader();
-	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ###### deviceDelay");
+	logTapStep("deviceDelay");
 	deviceDelay(_userCommand.downPeriod);
-	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ###### contactlessReader_gate");
+	logTapStep("contactlessReader_gate");
 	contactlessReader_gate();
-	pLogger->LogInfo("UserCommandRunner::executeUserCmdTapSmartCard ###### toSmartCardGate");
+	logTapStep("toSmartCardGate");
 	toSmartCardGate();
 	gate_smartCard_withCard(_userCommand.smartCardNumber);
 	openClamp();
@@ -2821,120 +3224,162 @@ void UserCommandRunner::RunCommand(const std::string& jsonCmd, std::string& erro
 		_userCommand.command = ds["userCommand"].toString();
 		_userCommand.commandId = ds["commandId"].toString();
 
-		//parse specific data in user command
-		if(_userCommand.command == UserCmdConnectDevice) {
-			parseUserCmdConnectDevice(ds);
-		}
-		else if(_userCommand.command == UserCmdCheckResetPressed) {
-			parseUserCmdCheckResetPressed(ds);
-		}
-		else if(_userCommand.command == UserCmdCheckResetReleased) {
-			parseUserCmdCheckResetReleased(ds);
-		}
-		else if(_userCommand.command == UserCmdResetDevice) {
-			parseUserCmdResetDevice(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromBayToSmartCardGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdAdjustStepperW) {
-			parseUserCmdAjustStepperW(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToBay) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdFinishStepperWAdjustment) {
-			parseUserCmdFinishStepperWAdjustment(ds);
-		}
+		auto pUserCommandName = UserCommandTable::Find(_userCommand.command);
+		_userCommand.type = (pUserCommandName == nullptr) ? UserCommandType::Invalid : pUserCommandName->type;
+
 		//stop other command if stepper w hasn't been adjusted.
-		else if(_userCommand.wAdjusted == false) {
+		if((pUserCommandName != nullptr) && pUserCommandName->stepperWAdjusted && (_userCommand.wAdjusted == false)) {
 			errorInfo = ErrorStepperWNotAdjusted;
 			pLogger->LogError("UserCommandRunner::RunCommand " + errorInfo);
 			return;
 		}
-		else if(_userCommand.command == UserCmdInsertSmartCard) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdRemoveSmartCard) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdSwipeSmartCard) {
-			parseUserCmdSwipeSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdTapSmartCard) {
-			parseUserCmdTapSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdTapBarCode) {
-			parseUserCmdBarCode(ds);
-		}
-		else if(_userCommand.command == UserCmdPressPedKey) {
-			parseUserCmdPedKeys(ds);
-		}
-		else if(_userCommand.command == UserCmdPressSoftKey) {
-			parseUserCmdSoftKeys(ds);
-		}
-		else if(_userCommand.command == UserCmdPressAssistKey) {
-			parseUserCmdAdaKeys(ds);
-		}
-		else if(_userCommand.command == UserCmdTouchScreen) {
-			parseUserCmdTouchScreenKeys(ds);
-		}
-		else if(_userCommand.command == UserCmdBackToHome)
+
+		//parse specific data in user command
+		switch(_userCommand.type)
 		{
-			if(_userCommand.cardState != CardState::InBay)
-			{
-				//there is a card on its way, cannot back to home
-				errorInfo = ErrorCardIsBeingAccessed;
-				pLogger->LogError("UserCommandRunner::RunCommand " + errorInfo);
-				return;
-			}
-		}
-		else if(_userCommand.command == UserCmdPowerOnOpt) {
-			//no further parameters to parse
-		}
-		else if(_userCommand.command == UserCmdPowerOffOpt) {
-			//no further parameters to parse
-		}
-		else if(_userCommand.command == UserCmdPowerOnDcm) {
-			parseUserCmdDcm(ds);
-		}
-		else if(_userCommand.command == UserCmdPowerOffDcm) {
-			parseUserCmdDcm(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToSmartCardReaderGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardReader) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderToSmartCardReaderGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromSmartCardGateToBarcodeReaderGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToBarcodeReader) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardBarcodeToExtraPosition) {
-			parseUserCmdBarcodeToExtraPosition(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderToBarcodeReaderGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToSmartCardGate) {
-			parseUserCmdSmartCard(ds);
-		}
-		else if(_userCommand.command == UserCmdReturnSmartCard) {
-			;
-		}
-		else {
-			errorInfo = ErrorUnSupportedCommand;
-			pLogger->LogError("UserCommandRunner::RunCommand unsupported command, denied: " + jsonCmd);
-			return;
+			case UserCommandType::ConnectDevice:
+				parseUserCmdConnectDevice(ds);
+				break;
+
+			case UserCommandType::CheckResetPressed:
+				parseUserCmdCheckResetPressed(ds);
+				break;
+
+			case UserCommandType::CheckResetReleased:
+				parseUserCmdCheckResetReleased(ds);
+				break;
+
+			case UserCommandType::ResetDevice:
+				parseUserCmdResetDevice(ds);
+				break;
+
+			case UserCommandType::CardFromBayToSmartCardGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::AdjustStepperW:
+				parseUserCmdAjustStepperW(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToBay:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::FinishStepperWAdjustment:
+				parseUserCmdFinishStepperWAdjustment(ds);
+				break;
+
+			case UserCommandType::InsertSmartCard:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::RemoveSmartCard:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::SwipeSmartCard:
+				parseUserCmdSwipeSmartCard(ds);
+				break;
+
+			case UserCommandType::TapSmartCard:
+				parseUserCmdTapSmartCard(ds);
+				break;
+
+			case UserCommandType::TapBarCode:
+				parseUserCmdBarCode(ds);
+				break;
+
+			case UserCommandType::PressPedKey:
+				parseUserCmdPedKeys(ds);
+				break;
+
+			case UserCommandType::PressSoftKey:
+				parseUserCmdSoftKeys(ds);
+				break;
+
+			case UserCommandType::PressAssistKey:
+				parseUserCmdAdaKeys(ds);
+				break;
+
+			case UserCommandType::TouchScreen:
+				parseUserCmdTouchScreenKeys(ds);
+				break;
+
+			case UserCommandType::BackToHome:
+			{
+				if(_userCommand.cardState != CardState::InBay)
+				{
+					//there is a card on its way, cannot back to home
+					errorInfo = ErrorCardIsBeingAccessed;
+					pLogger->LogError("UserCommandRunner::RunCommand " + errorInfo);
+					return;
+				}
+			}
+			break;
+
+			case UserCommandType::PowerOnOpt:
+				//no further parameters to parse
+				break;
+
+			case UserCommandType::PowerOffOpt:
+				//no further parameters to parse
+				break;
+
+			case UserCommandType::PowerOnDcm:
+				parseUserCmdDcm(ds);
+				break;
+
+			case UserCommandType::PowerOffDcm:
+				parseUserCmdDcm(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToSmartCardReaderGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderGateToSmartCardReader:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderToSmartCardReaderGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardReaderGateToSmartCardGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromSmartCardGateToBarcodeReaderGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderGateToBarcodeReader:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardBarcodeToExtraPosition:
+				parseUserCmdBarcodeToExtraPosition(ds);
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderToBarcodeReaderGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::CardFromBarcodeReaderGateToSmartCardGate:
+				parseUserCmdSmartCard(ds);
+				break;
+
+			case UserCommandType::ReturnSmartCard:
+				//no further parameters to parse
+				break;
+
+			case UserCommandType::Invalid:
+			{
+				errorInfo = ErrorUnSupportedCommand;
+				pLogger->LogError("UserCommandRunner::RunCommand unsupported command, denied: " + jsonCmd);
+				return;
+			}
+			break;
 		}
 
 		cmdParseError = false;
@@ -2994,11 +3439,11 @@ void UserCommandRunner::OnDevicesGet(CommandId key, bool bSuccess, const std::ve
 			_consoleCommand.resultDevices.push_back(*it);
 		}
 
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDevicesGet failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3016,11 +3461,11 @@ void UserCommandRunner::OnDeviceConnect(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDeviceConnect successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDeviceConnect failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3039,12 +3484,12 @@ void UserCommandRunner::OnDeviceQueryPower(CommandId key, bool bSuccess, bool bP
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDeviceConnect successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultDevicePowered = bPowered;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDeviceConnect failure command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultDevicePowered = false;
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3063,12 +3508,12 @@ void UserCommandRunner::OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFu
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDeviceQueryFuse successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultDeviceFuseOk = bFuseOn;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDeviceQueryFuse failure command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultDeviceFuseOk = false;
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3086,11 +3531,11 @@ void UserCommandRunner::OnDeviceDelay(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDeviceDelay successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDeviceDelay failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3109,11 +3554,11 @@ void UserCommandRunner::OnOptPowerOn(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnOptPowerOn successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultOptPowered = true;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnOptPowerOn failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3131,12 +3576,12 @@ void UserCommandRunner::OnOptPowerOff(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnOptPowerOff successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 		_consoleCommand.resultOptPowered = false;
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnOptPowerOff failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3155,12 +3600,12 @@ void UserCommandRunner::OnOptQueryPower(CommandId key, bool bSuccess, bool bPowe
 	{
 		pLogger->LogInfo("UserCommandRunner::OnOptQueryPower successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultOptPowered = bPowered;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnOptQueryPower failure command Id: " + std::to_string(_consoleCommand.cmdId));
 		//_consoleCommand.resultOptIsPowered = false;
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3178,11 +3623,11 @@ void UserCommandRunner::OnDcmPowerOn(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDcmPowerOn successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDcmPowerOn failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3200,11 +3645,11 @@ void UserCommandRunner::OnDcmPowerOff(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnDcmPowerOff successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnDcmPowerOff failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3223,11 +3668,11 @@ void UserCommandRunner::OnBdcsPowerOn(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcsPowerOn successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultBdcsPowered = true;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcsPowerOn failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3246,11 +3691,11 @@ void UserCommandRunner::OnBdcsPowerOff(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcsPowerOff successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultBdcsPowered = false;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcsPowerOff failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3269,11 +3714,11 @@ void UserCommandRunner::OnBdcsQueryPower(CommandId key, bool bSuccess, bool bPow
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcsQueryPower successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultBdcsPowered = bPowered;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcsQueryPower failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3291,11 +3736,11 @@ void UserCommandRunner::OnBdcCoast(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcCoast successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcCoast failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3313,11 +3758,11 @@ void UserCommandRunner::OnBdcReverse(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcReverse successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcReverse failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3335,11 +3780,11 @@ void UserCommandRunner::OnBdcForward(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcForward successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcForward failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3357,11 +3802,11 @@ void UserCommandRunner::OnBdcBreak(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcBreak successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcBreak failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3379,11 +3824,11 @@ void UserCommandRunner::OnBdcQuery(CommandId key, bool bSuccess, BdcStatus statu
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnBdcQuery successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnBdcQuery failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3402,11 +3847,11 @@ void UserCommandRunner::OnSteppersPowerOn(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnSteppersPowerOn successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppersPowered = true;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnSteppersPowerOn failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3425,11 +3870,11 @@ void UserCommandRunner::OnSteppersPowerOff(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnSteppersPowerOff successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppersPowered = false;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnSteppersPowerOff failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3448,11 +3893,11 @@ void UserCommandRunner::OnSteppersQueryPower(CommandId key, bool bSuccess, bool
 	{
 		pLogger->LogInfo("UserCommandRunner::OnSteppersQueryPower successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppersPowered = bPowered;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnSteppersQueryPower failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3470,11 +3915,11 @@ void UserCommandRunner::OnStepperConfigStep(CommandId key, bool bSuccess)
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperConfigStep successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperConfigStep failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3492,11 +3937,11 @@ void UserCommandRunner::OnStepperAccelerationBuffer(CommandId key, bool bSuccess
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperAccelerationBuffer successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperAccelerationBuffer failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3514,11 +3959,11 @@ void UserCommandRunner::OnStepperAccelerationBufferDecrement(CommandId key, bool
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperAccelerationBufferDecrement successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperAccelerationBufferDecrement failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3536,11 +3981,11 @@ void UserCommandRunner::OnStepperDecelerationBuffer(CommandId key, bool bSuccess
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperDecelerationBuffer successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperDecelerationBuffer failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3558,11 +4003,11 @@ void UserCommandRunner::OnStepperDecelerationBufferIncrement(CommandId key, bool
 	if(bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperDecelerationBufferIncrement successful command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperDecelerationBufferIncrement failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3581,11 +4026,11 @@ void UserCommandRunner::OnStepperEnable(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperEnable successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppers[_consoleCommand.stepperIndex].enabled = true;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperEnable failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3604,11 +4049,11 @@ void UserCommandRunner::OnStepperForward(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperForward successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppers[_consoleCommand.stepperIndex].forward = _consoleCommand.stepperForward;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperForward failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3633,30 +4078,39 @@ void UserCommandRunner::OnStepperSteps(CommandId key, bool bSuccess)
 		else {
 			_consoleCommand.resultSteppers[_consoleCommand.stepperIndex].targetPosition = _consoleCommand.resultSteppers[_consoleCommand.stepperIndex].homeOffset - _consoleCommand.steps;
 		}
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperSteps failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
 void UserCommandRunner::OnStepperRun(CommandId key, bool bSuccess)
 {
 	Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
+	unsigned int index;
+	auto run = _stepperRuns.find(key);
 
-	if(_consoleCommand.state != CommandState::OnGoing) {
-		return;
+	if(run != _stepperRuns.end()) {
+		index = run->second;
 	}
-	if(_consoleCommand.cmdId != key) {
-		return;
+	else
+	{
+		if(_consoleCommand.state != CommandState::OnGoing) {
+			return;
+		}
+		if(_consoleCommand.cmdId != key) {
+			return;
+		}
+		index = _consoleCommand.stepperIndex;
 	}
 
 	if(bSuccess)
 	{
-		pLogger->LogInfo("UserCommandRunner::OnStepperRun successful command Id: " + std::to_string(_consoleCommand.cmdId));
+		pLogger->LogInfo("UserCommandRunner::OnStepperRun successful command Id: " + std::to_string(key));
 
-		auto& stepperData = _consoleCommand.resultSteppers[_consoleCommand.stepperIndex];
+		auto& stepperData = _consoleCommand.resultSteppers[index];
 		switch(stepperData.state)
 		{
 			case StepperState::ApproachingHomeLocator:
@@ -3687,7 +4141,6 @@ void UserCommandRunner::OnStepperRun(CommandId key, bool bSuccess)
 			}
 			break;
 		}
-		_consoleCommand.state = CommandState::Succeeded;
 
 		{
 			char buffer[256];
@@ -3702,8 +4155,65 @@ void UserCommandRunner::OnStepperRun(CommandId key, bool bSuccess)
 		}
 	}
 	else {
-		pLogger->LogError("UserCommandRunner::OnStepperRun failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		pLogger->LogError("UserCommandRunner::OnStepperRun failure command Id: " + std::to_string(key));
+	}
+
+	if(run != _stepperRuns.end())
+	{
+		//runSteppers is woken up when all of its runs are replied
+		if(!bSuccess) {
+			_stepperRunFailed = true;
+		}
+		_stepperRuns.erase(run);
+		_consoleCommandFinished.broadcast();
+	}
+	else {
+		finishConsoleCommand(bSuccess ? CommandState::Succeeded : CommandState::Failed);
+	}
+}
+
+void UserCommandRunner::OnSteppersMove(CommandId key, bool bSuccess)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
+
+	if(_consoleCommand.state != CommandState::OnGoing) {
+		return;
+	}
+	if(_consoleCommand.cmdId != key) {
+		return;
+	}
+
+	if(bSuccess)
+	{
+		pLogger->LogInfo("UserCommandRunner::OnSteppersMove successful command Id: " + std::to_string(_consoleCommand.cmdId));
+
+		for(auto it = _consoleCommand.movements.begin(); it != _consoleCommand.movements.end(); it++)
+		{
+			auto& stepperData = _consoleCommand.resultSteppers[it->index];
+
+			stepperData.state = StepperState::KnownPosition;
+			stepperData.forward = (it->finalPos > it->initialPos);
+			stepperData.homeOffset = it->finalPos;
+			stepperData.targetPosition = 0;
+		}
+		finishConsoleCommand(CommandState::Succeeded);
+
+		{
+			char buffer[256];
+
+			sprintf(buffer, "UserCommandRunner::OnSteppersMove offsets: %d, %d, %d, %d, %d",
+					_consoleCommand.resultSteppers[0].homeOffset,
+					_consoleCommand.resultSteppers[1].homeOffset,
+					_consoleCommand.resultSteppers[2].homeOffset,
+					_consoleCommand.resultSteppers[3].homeOffset,
+					_consoleCommand.resultSteppers[4].homeOffset);
+
+			pLogger->LogInfo(buffer);
+		}
+	}
+	else {
+		pLogger->LogError("UserCommandRunner::OnSteppersMove failure command Id: " + std::to_string(_consoleCommand.cmdId));
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3723,11 +4233,11 @@ void UserCommandRunner::OnStepperConfigHome(CommandId key, bool bSuccess)
 		pLogger->LogInfo("UserCommandRunner::OnStepperConfigHome successful command Id: " + std::to_string(_consoleCommand.cmdId));
 
 		_consoleCommand.resultSteppers[_consoleCommand.stepperIndex].state = StepperState::ApproachingHomeLocator;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperConfigHome failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3770,11 +4280,11 @@ void UserCommandRunner::OnStepperQuery(CommandId key, bool bSuccess,
 		stepperData.locatorLineNumberTerminal = locatorLineNumberTerminal;
 		stepperData.homeOffset = homeOffset;
 
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperQuery failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3793,11 +4303,11 @@ void UserCommandRunner::OnStepperForwardClockwise(CommandId key, bool bSuccess)
 	{
 		pLogger->LogInfo("UserCommandRunner::OnStepperForwardClockwise successful command Id: " + std::to_string(_consoleCommand.cmdId));
 		_consoleCommand.resultSteppers[_consoleCommand.stepperIndex].forwardClockwise = _consoleCommand.stepperForwardClockwise;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnStepperForwardClockwise failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3817,11 +4327,67 @@ void UserCommandRunner::OnLocatorQuery(CommandId key, bool bSuccess, unsigned in
 		pLogger->LogInfo("UserCommandRunner::OnLocatorQuery successful command Id: " + std::to_string(_consoleCommand.cmdId));
 
 		_consoleCommand.resultLocators[_consoleCommand.locatorIndex] = lowInput;
-		_consoleCommand.state = CommandState::Succeeded;
+		finishConsoleCommand(CommandState::Succeeded);
 	}
 	else {
 		pLogger->LogError("UserCommandRunner::OnLocatorQuery failure command Id: " + std::to_string(_consoleCommand.cmdId));
-		_consoleCommand.state = CommandState::Failed;
+		finishConsoleCommand(CommandState::Failed);
+	}
+}
+
+void UserCommandRunner::OnMacroUpload(CommandId key, bool bSuccess)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
+
+	if(_consoleCommand.state != CommandState::OnGoing) {
+		return;
+	}
+	if(_consoleCommand.cmdId != key) {
+		return;
+	}
+
+	if(bSuccess)
+	{
+		pLogger->LogInfo("UserCommandRunner::OnMacroUpload successful command Id: " + std::to_string(_consoleCommand.cmdId));
+		finishConsoleCommand(CommandState::Succeeded);
+	}
+	else {
+		pLogger->LogError("UserCommandRunner::OnMacroUpload failure command Id: " + std::to_string(_consoleCommand.cmdId));
+		finishConsoleCommand(CommandState::Failed);
+	}
+}
+
+void UserCommandRunner::OnMacroRun(CommandId key, bool bSuccess, const std::vector<unsigned long>& positions)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
+
+	if(_consoleCommand.state != CommandState::OnGoing) {
+		return;
+	}
+	if(_consoleCommand.cmdId != key) {
+		return;
+	}
+
+	if(bSuccess && (positions.size() == STEPPER_AMOUNT))
+	{
+		pLogger->LogInfo("UserCommandRunner::OnMacroRun successful command Id: " + std::to_string(_consoleCommand.cmdId));
+
+		for(int i=0; i<STEPPER_AMOUNT; i++)
+		{
+			auto& stepperData = _consoleCommand.resultSteppers[i];
+
+			if(stepperData.homeOffset != positions[i]) {
+				stepperData.forward = (positions[i] > stepperData.homeOffset);
+			}
+			stepperData.state = StepperState::KnownPosition;
+			stepperData.homeOffset = positions[i];
+			stepperData.targetPosition = 0;
+		}
+		finishConsoleCommand(CommandState::Succeeded);
+	}
+	else {
+		pLogger->LogError("UserCommandRunner::OnMacroRun failure command Id: " + std::to_string(_consoleCommand.cmdId));
+		finishConsoleCommand(CommandState::Failed);
 	}
 }
 
@@ -3851,6 +4417,16 @@ void UserCommandRunner::setConsoleCommandParameter(const std::string & cmd)
 	if(ConsoleCommandFactory::GetParameterLocatorIndex(cmd, locatorIndex)) {
 		_consoleCommand.locatorIndex = locatorIndex;
 	}
+
+	//movements are applied to resultSteppers when SteppersMove succeeds.
+	ConsoleCommandFactory::GetParameterSteppersMove(cmd, _consoleCommand.movements);
+}
+
+void UserCommandRunner::finishConsoleCommand(CommandState state)
+{
+	//_consoleCommandMutex is locked by the response callback
+	_consoleCommand.state = state;
+	_consoleCommandFinished.broadcast();
 }
 
 void UserCommandRunner::runConsoleCommand(const std::string& cmd)
@@ -3866,7 +4442,12 @@ void UserCommandRunner::runConsoleCommand(const std::string& cmd)
 		}
 	}
 
-	pLogger->LogInfo("UserCommandRunner::runConsoleCommand ------ " + cmdToLog);
+	if(_macroRecording) {
+		recordMacroStep(cmd);
+		return;
+	}
+
+	pLogger->LogFormat("UserCommandRunner::runConsoleCommand ------ %s", cmdToLog);
 
 	{
 		Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
@@ -3882,7 +4463,7 @@ void UserCommandRunner::runConsoleCommand(const std::string& cmd)
 		_consoleCommand.state = CommandState::OnGoing; //change state here to give a correct state if callback comes instantly.
 		setConsoleCommandParameter(cmd);
 		_consoleCommand.cmdId = _pConsoleOperator->RunConsoleCommand(cmd);
-		pLogger->LogInfo("UserCommandRunner::runConsoleCommand command Id: " + std::to_string(_consoleCommand.cmdId));
+		pLogger->LogFormat("UserCommandRunner::runConsoleCommand command Id: %lu", _consoleCommand.cmdId);
 		if(_consoleCommand.cmdId == ICommandReception::ICommandDataTypes::InvalidCommandId)
 		{
 			_consoleCommand.state = CommandState::Idle;
@@ -3893,19 +4474,14 @@ void UserCommandRunner::runConsoleCommand(const std::string& cmd)
 	}
 
 	//wait for console command result
-	for(;;)
 	{
-		{
-			Poco::ScopedLock<Poco::Mutex> consoleLock(_consoleCommandMutex);
-			consoleCmdState = _consoleCommand.state;
-		}
+		Poco::ScopedLock<Poco::Mutex> consoleLock(_consoleCommandMutex);
 
-		if(consoleCmdState != CommandState::OnGoing) {
-			break;
-		}
-		else {
-			sleep(10);
+		//_consoleCommandFinished is broadcast by the response callbacks once the state is final.
+		while(_consoleCommand.state == CommandState::OnGoing) {
+			_consoleCommandFinished.wait(_consoleCommandMutex);
 		}
+		consoleCmdState = _consoleCommand.state;
 	}
 
 	//check console command result
@@ -3914,7 +4490,7 @@ void UserCommandRunner::runConsoleCommand(const std::string& cmd)
 		Poco::ScopedLock<Poco::Mutex> lock(_consoleCommandMutex); //lock console cmd mutex
 
 		if(consoleCmdState == CommandState::Succeeded) {
-			pLogger->LogInfo("UserCommandRunner::runConsoleCommand succeeded in console command: " + cmdToLog);
+			pLogger->LogFormat("UserCommandRunner::runConsoleCommand succeeded in console command: %s", cmdToLog);
 		}
 		else if(consoleCmdState == CommandState::Failed) {
 			errorInfo = "UserCommandRunner::runConsoleCommand failed in console command: " + cmdToLog;
@@ -3973,240 +4549,292 @@ void UserCommandRunner::runTask()
 			try
 			{
 				//expand USER command to CONSOLE commands
-				if(_userCommand.command == UserCmdConnectDevice) {
-					executeUserCmdConnectDevice();
-				}
-				else if(_userCommand.command == UserCmdCheckResetPressed) {
-					executeUserCmdCheckResetPressed();
-				}
-				else if(_userCommand.command == UserCmdCheckResetReleased) {
-					executeUserCmdCheckResetReleased();
-				}
-				else if(_userCommand.command == UserCmdResetDevice) {
-					executeUserCmdResetDevice();
-				}
-				else if(_userCommand.command == UserCmdAdjustStepperW) {
-					executeUserCmdAdjustStepperW();
-				}
-				else if(_userCommand.command == UserCmdFinishStepperWAdjustment) {
-					executeUserCmdFinishStepperWAdjustment();
-				}
-				else if(_userCommand.command == UserCmdInsertSmartCard)
-				{
-					if(_userCommand.cardState != CardState::InBay) {
-						errorInfo = ErrorSmartCardReaderSlotOccupied;
-					}
-					else {
-						executeUserCmdInsertSmartCard();
-					}
-				}
-				else if(_userCommand.command == UserCmdRemoveSmartCard)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardReader) {
-						errorInfo = ErrorSmartCardReaderEmpty;
-					}
-					else {
-						executeUserCmdRemoveSmartCard();
-					}
-				}
-				else if(_userCommand.command == UserCmdSwipeSmartCard)
+				switch(_userCommand.type)
 				{
-					if(_userCommand.cardState != CardState::InBay) {
-						errorInfo = ErrorSmartCardReaderSlotOccupied;
-					}
-					else {
-						executeUserCmdSwipeSmartCard();
-					}
-				}
-				else if(_userCommand.command == UserCmdTapSmartCard) {
-					executeUserCmdTapSmartCard();
-				}
-				else if(_userCommand.command == UserCmdTapBarCode) {
-					executeUserCmdTapBarCode();
-				}
-				else if(_userCommand.command == UserCmdPressPedKey) {
-					executeUserCmdPressPedKey();
-				}
-				else if(_userCommand.command == UserCmdPressSoftKey) {
-					executeUserCmdPressSoftKey();
-				}
-				else if(_userCommand.command == UserCmdPressAssistKey) {
-					executeUserCmdPressAssistKey();
-				}
-				else if(_userCommand.command == UserCmdTouchScreen) {
-					executeUserCmdTouchScreen();
-				}
-				else if(_userCommand.command == UserCmdBackToHome) {
-					toHome();
-				}
-				else if(_userCommand.command == UserCmdPowerOnOpt) {
-					powerOnOpt(true);
-				}
-				else if(_userCommand.command == UserCmdPowerOffOpt) {
-					powerOnOpt(false);
-				}
-				else if(_userCommand.command == UserCmdPowerOnDcm) {
-					powerOnDcm(true, _userCommand.dcmIndex);
-				}
-				else if(_userCommand.command == UserCmdPowerOffDcm) {
-					powerOnDcm(false, _userCommand.dcmIndex);
-				}
-				else if(_userCommand.command == UserCmdCardFromBayToSmartCardGate)
-				{
-					if(_userCommand.cardState != CardState::InBay) {
-						errorInfo = ErrorSmartCardHasBeenFetched;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmdPullUpSmartCard();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardGateToSmartCardReaderGate)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardGate) {
-						errorInfo = ErrorSmartCardNotInSmartCardGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_SmartCardGate_to_SmartCardReaderGate();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardReader)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardReaderGate) {
-						errorInfo = ErrorSmartCardNotInSmartCardReaderGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardReader();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardReaderToSmartCardReaderGate)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardReader) {
-						errorInfo = ErrorSmartCardReaderEmpty;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_SmartCardReader_to_SmartCardReaderGate();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardReaderGateToSmartCardGate)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardReaderGate) {
-						errorInfo = ErrorSmartCardNotInSmartCardReaderGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardGate();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardGateToBarcodeReaderGate)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardGate) {
-						errorInfo = ErrorSmartCardNotInSmartCardGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_SmartCardGate_to_BarcodeReaderGate();
-					}
-				}
-				else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToBarcodeReader)
-				{
-					if(_userCommand.cardState != CardState::InBarcodeReaderGate) {
-						errorInfo = ErrorSmartCardNotInBarcodeReaderGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-					}
-					else {
-						executeUserCmd_Card_from_BarcodeReaderGate_to_BarcodeReader();
+					case UserCommandType::ConnectDevice:
+						executeUserCmdConnectDevice();
+						break;
+
+					case UserCommandType::CheckResetPressed:
+						executeUserCmdCheckResetPressed();
+						break;
+
+					case UserCommandType::CheckResetReleased:
+						executeUserCmdCheckResetReleased();
+						break;
+
+					case UserCommandType::ResetDevice:
+						executeUserCmdResetDevice();
+						break;
+
+					case UserCommandType::AdjustStepperW:
+						executeUserCmdAdjustStepperW();
+						break;
+
+					case UserCommandType::FinishStepperWAdjustment:
+						executeUserCmdFinishStepperWAdjustment();
+						break;
+
+					case UserCommandType::InsertSmartCard:
+					{
+						if(_userCommand.cardState != CardState::InBay) {
+							errorInfo = ErrorSmartCardReaderSlotOccupied;
+						}
+						else {
+							executeUserCmdInsertSmartCard();
+						}
 					}
-				}
-				else if(_userCommand.command == UserCmdCardBarcodeToExtraPosition)
-				{
-					if(_userCommand.cardState != CardState::InBarcodeReader) {
-						errorInfo = ErrorSmartCardNotInBarcodeReader;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+					break;
+
+					case UserCommandType::RemoveSmartCard:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardReader) {
+							errorInfo = ErrorSmartCardReaderEmpty;
+						}
+						else {
+							executeUserCmdRemoveSmartCard();
+						}
 					}
-					else {
-						executeUserCmd_Card_barcode_to_extraPosition();
+					break;
+
+					case UserCommandType::SwipeSmartCard:
+					{
+						if(_userCommand.cardState != CardState::InBay) {
+							errorInfo = ErrorSmartCardReaderSlotOccupied;
+						}
+						else {
+							executeUserCmdSwipeSmartCard();
+						}
 					}
-				}
-				else if(_userCommand.command == UserCmdCardFromBarcodeReaderToBarcodeReaderGate)
-				{
-					if(_userCommand.cardState != CardState::InBarcodeReader) {
-						errorInfo = ErrorSmartCardNotInBarcodeReader;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+					break;
+
+					case UserCommandType::TapSmartCard:
+						executeUserCmdTapSmartCard();
+						break;
+
+					case UserCommandType::TapBarCode:
+						executeUserCmdTapBarCode();
+						break;
+
+					case UserCommandType::PressPedKey:
+						executeUserCmdPressPedKey();
+						break;
+
+					case UserCommandType::PressSoftKey:
+						executeUserCmdPressSoftKey();
+						break;
+
+					case UserCommandType::PressAssistKey:
+						executeUserCmdPressAssistKey();
+						break;
+
+					case UserCommandType::TouchScreen:
+						executeUserCmdTouchScreen();
+						break;
+
+					case UserCommandType::BackToHome:
+						toHome();
+						break;
+
+					case UserCommandType::PowerOnOpt:
+						powerOnOpt(true);
+						break;
+
+					case UserCommandType::PowerOffOpt:
+						powerOnOpt(false);
+						break;
+
+					case UserCommandType::PowerOnDcm:
+						powerOnDcm(true, _userCommand.dcmIndex);
+						break;
+
+					case UserCommandType::PowerOffDcm:
+						powerOnDcm(false, _userCommand.dcmIndex);
+						break;
+
+					case UserCommandType::CardFromBayToSmartCardGate:
+					{
+						if(_userCommand.cardState != CardState::InBay) {
+							errorInfo = ErrorSmartCardHasBeenFetched;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmdPullUpSmartCard();
+						}
 					}
-					else {
-						executeUserCmd_Card_from_BarcodeReader_to_BarcodeReaderGate();
+					break;
+
+					case UserCommandType::CardFromSmartCardGateToSmartCardReaderGate:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardGate) {
+							errorInfo = ErrorSmartCardNotInSmartCardGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmd_Card_from_SmartCardGate_to_SmartCardReaderGate();
+						}
 					}
-				}
-				else if(_userCommand.command == UserCmdCardFromBarcodeReaderGateToSmartCardGate)
-				{
-					if(_userCommand.cardState != CardState::InBarcodeReaderGate) {
-						errorInfo = ErrorSmartCardNotInBarcodeReaderGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+					break;
+
+					case UserCommandType::CardFromSmartCardReaderGateToSmartCardReader:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardReaderGate) {
+							errorInfo = ErrorSmartCardNotInSmartCardReaderGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardReader();
+						}
 					}
-					else {
-						executeUserCmd_Card_from_BarcodeReaderGate_to_SmartCardGate();
+					break;
+
+					case UserCommandType::CardFromSmartCardReaderToSmartCardReaderGate:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardReader) {
+							errorInfo = ErrorSmartCardReaderEmpty;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmd_Card_from_SmartCardReader_to_SmartCardReaderGate();
+						}
 					}
-				}
-				else if(_userCommand.command == UserCmdCardFromSmartCardGateToBay)
-				{
-					if(_userCommand.cardState != CardState::InSmartCardGate) {
-						errorInfo = ErrorSmartCardNotInSmartCardGate;
-						pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+					break;
+
+					case UserCommandType::CardFromSmartCardReaderGateToSmartCardGate:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardReaderGate) {
+							errorInfo = ErrorSmartCardNotInSmartCardReaderGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardGate();
+						}
 					}
-					else {
-						executeUserCmdPutBackSmartCard();
+					break;
+
+					case UserCommandType::CardFromSmartCardGateToBarcodeReaderGate:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardGate) {
+							errorInfo = ErrorSmartCardNotInSmartCardGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
+							executeUserCmd_Card_from_SmartCardGate_to_BarcodeReaderGate();
+						}
 					}
-				}
-				else if(_userCommand.command == UserCmdReturnSmartCard)
-				{
-					switch(_userCommand.cardState)
+					break;
+
+					case UserCommandType::CardFromBarcodeReaderGateToBarcodeReader:
 					{
-						case CardState::InBarcodeReader:
-						case CardState::InBarcodeReaderGate:
-						case CardState::InSmartCardReader:
-						case CardState::InSmartCardReaderGate:
-						case CardState::InSmartCardGate:
-						case CardState::InBay:
-							break; //legal state
-						default:
-						{
-							errorInfo = ErrorSmartCardNotInPredefinedPosition;
+						if(_userCommand.cardState != CardState::InBarcodeReaderGate) {
+							errorInfo = ErrorSmartCardNotInBarcodeReaderGate;
 							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
-							break;
+						}
+						else {
+							executeUserCmd_Card_from_BarcodeReaderGate_to_BarcodeReader();
 						}
 					}
+					break;
 
-					if(errorInfo.empty())
+					case UserCommandType::CardBarcodeToExtraPosition:
 					{
-						if(_userCommand.cardState == CardState::InSmartCardReader) {
-							executeUserCmd_Card_from_SmartCardReader_to_SmartCardReaderGate();
-							_userCommand.cardState = CardState::InSmartCardReaderGate;
+						if(_userCommand.cardState != CardState::InBarcodeReader) {
+							errorInfo = ErrorSmartCardNotInBarcodeReader;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
 						}
-						if(_userCommand.cardState == CardState::InSmartCardReaderGate) {
-							executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardGate();
-							_userCommand.cardState = CardState::InSmartCardGate;
+						else {
+							executeUserCmd_Card_barcode_to_extraPosition();
 						}
-						if(_userCommand.cardState == CardState::InBarcodeReader) {
+					}
+					break;
+
+					case UserCommandType::CardFromBarcodeReaderToBarcodeReaderGate:
+					{
+						if(_userCommand.cardState != CardState::InBarcodeReader) {
+							errorInfo = ErrorSmartCardNotInBarcodeReader;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
 							executeUserCmd_Card_from_BarcodeReader_to_BarcodeReaderGate();
-							_userCommand.cardState = CardState::InBarcodeReaderGate;
 						}
-						if(_userCommand.cardState == CardState::InBarcodeReaderGate) {
+					}
+					break;
+
+					case UserCommandType::CardFromBarcodeReaderGateToSmartCardGate:
+					{
+						if(_userCommand.cardState != CardState::InBarcodeReaderGate) {
+							errorInfo = ErrorSmartCardNotInBarcodeReaderGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
 							executeUserCmd_Card_from_BarcodeReaderGate_to_SmartCardGate();
-							_userCommand.cardState = CardState::InSmartCardGate;
 						}
-						if(_userCommand.cardState == CardState::InSmartCardGate) {
+					}
+					break;
+
+					case UserCommandType::CardFromSmartCardGateToBay:
+					{
+						if(_userCommand.cardState != CardState::InSmartCardGate) {
+							errorInfo = ErrorSmartCardNotInSmartCardGate;
+							pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+						}
+						else {
 							executeUserCmdPutBackSmartCard();
-							_userCommand.cardState = CardState::InBay;
 						}
 					}
-				}
-				else {
-					errorInfo = "UserCommandRunner::runTask unknown user command: " + _userCommand.command;
-					pLogger->LogError(errorInfo);
+					break;
+
+					case UserCommandType::ReturnSmartCard:
+					{
+						switch(_userCommand.cardState)
+						{
+							case CardState::InBarcodeReader:
+							case CardState::InBarcodeReaderGate:
+							case CardState::InSmartCardReader:
+							case CardState::InSmartCardReaderGate:
+							case CardState::InSmartCardGate:
+							case CardState::InBay:
+								break; //legal state
+							default:
+							{
+								errorInfo = ErrorSmartCardNotInPredefinedPosition;
+								pLogger->LogError("UserCommandRunner::runTask cardState: " + std::to_string((int)_userCommand.cardState));
+								break;
+							}
+						}
+
+						if(errorInfo.empty())
+						{
+							if(_userCommand.cardState == CardState::InSmartCardReader) {
+								executeUserCmd_Card_from_SmartCardReader_to_SmartCardReaderGate();
+								_userCommand.cardState = CardState::InSmartCardReaderGate;
+							}
+							if(_userCommand.cardState == CardState::InSmartCardReaderGate) {
+								executeUserCmd_Card_from_SmartCardReaderGate_to_SmartCardGate();
+								_userCommand.cardState = CardState::InSmartCardGate;
+							}
+							if(_userCommand.cardState == CardState::InBarcodeReader) {
+								executeUserCmd_Card_from_BarcodeReader_to_BarcodeReaderGate();
+								_userCommand.cardState = CardState::InBarcodeReaderGate;
+							}
+							if(_userCommand.cardState == CardState::InBarcodeReaderGate) {
+								executeUserCmd_Card_from_BarcodeReaderGate_to_SmartCardGate();
+								_userCommand.cardState = CardState::InSmartCardGate;
+							}
+							if(_userCommand.cardState == CardState::InSmartCardGate) {
+								executeUserCmdPutBackSmartCard();
+								_userCommand.cardState = CardState::InBay;
+							}
+						}
+					}
+					break;
+
+					case UserCommandType::Invalid:
+					{
+						errorInfo = "UserCommandRunner::runTask unknown user command: " + _userCommand.command;
+						pLogger->LogError(errorInfo);
+					}
+					break;
 				}
 			}
 			catch(Poco::Exception & e)
@@ -11,9 +11,11 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <map>
 
 #include "Poco/Task.h"
 #include "Poco/Event.h"
+#include "Poco/Condition.h"
 #include "Poco/Dynamic/Var.h"
 
 #include "CoordinateStorage.h"
@@ -32,7 +34,10 @@
 class UserCommandRunner: public Poco::Task, public IUserCommandRunner, public IResponseReceiver
 {
 public:
-	UserCommandRunner();
+	//useSteppersMove: firmware supports "steppers move" (C 64), movements are sent in one device command
+	//useDeviceMacros: firmware supports macros (C 65 and C 66), smart card flows are uploaded and run as macros
+	//maxPendingCommands: amount of device commands which can wait for reply at the same time
+	UserCommandRunner(bool useSteppersMove, bool useDeviceMacros, unsigned int maxPendingCommands);
 
 	void AddObserver(IUserCommandRunnerObserver * pObserver);
 
@@ -80,6 +85,7 @@ private:
 	virtual void OnStepperRun(CommandId key, bool bSuccess) override;
 	virtual void OnStepperConfigHome(CommandId key, bool bSuccess) override;
 	virtual void OnStepperMove(CommandId key, bool bSuccess) override {}
+	virtual void OnSteppersMove(CommandId key, bool bSuccess) override;
 	virtual void OnStepperQuery(CommandId key, bool bSuccess,
 								StepperState state,
 								bool bEnabled,
@@ -99,6 +105,8 @@ private:
 	virtual void OnStepperSetState(CommandId key, bool bSuccess) override {}
 	virtual void OnStepperForwardClockwise(CommandId key, bool bSuccess) override;
 	virtual void OnLocatorQuery(CommandId key, bool bSuccess, unsigned int lowInput) override;
+	virtual void OnMacroUpload(CommandId key, bool bSuccess) override;
+	virtual void OnMacroRun(CommandId key, bool bSuccess, const std::vector<unsigned long>& positions) override;
 
 private:
 	static const int STEPPER_AMOUNT = 5;
@@ -109,6 +117,7 @@ private:
 	const unsigned int STEPPER_Y = 1;
 	const unsigned int STEPPER_Z = 2;
 	const unsigned int STEPPER_W = 3;
+	const unsigned int STEPPER_V = 4;
 
 	////////////////////////////////////////
 	// user command related data and functions
@@ -144,6 +153,7 @@ private:
 	{
 		CommandState state;
 		std::string command;
+		UserCommandType type;
 		std::string commandId;
 
 		//----user command parameters----
@@ -271,7 +281,8 @@ private:
 							unsigned int decelerationBuffer,
 							unsigned int decelerationBufferIncrement);
 
-	//append commands to move stepper index from initialPos to finalPos.
+	//move stepper index from initialPos to finalPos.
+	//the movement is appended to motion plan if a motion plan is ongoing.
 	void moveStepper(unsigned int index, unsigned int initialPos, unsigned int finalPos);
 	void moveStepperX(unsigned int initialPos, unsigned int finalPos) { moveStepper(0, initialPos, finalPos); }
 	void moveStepperY(unsigned int initialPos, unsigned int finalPos) { moveStepper(1, initialPos, finalPos); }
@@ -279,6 +290,25 @@ private:
 	void moveStepperW(unsigned int initialPos, unsigned int finalPos) { moveStepper(3, initialPos, finalPos); }
 	void moveStepperV(unsigned int initialPos, unsigned int finalPos) { moveStepper(4, initialPos, finalPos); }
 
+	//run movements with "steppers move" if firmware supports it, with forward/steps/run of each stepper otherwise.
+	bool _useSteppersMove;
+	void runStepperMovements(const std::vector<StepperMovement>& movements);
+	//send "stepper run" of all movements without waiting for reply in between, then wait for all of them.
+	unsigned int _maxPendingCommands;
+	void runSteppers(const std::vector<StepperMovement>& movements);
+
+	//motion plan: movements between beginMotionPlan and runMotionPlan are sent to device together.
+	bool _motionPlanning;
+	std::vector<StepperMovement> _motionPlan;
+	void beginMotionPlan();
+	void runMotionPlan();
+	unsigned int plannedPosition(unsigned int index);
+	//movements planned between beginConcurrentMovement and endConcurrentMovement start at the same time.
+	bool _concurrentMovement;
+	unsigned int _concurrentGroupStart;
+	void beginConcurrentMovement();
+	void endConcurrentMovement();
+
 	//smart card bay
 	void moveSmartCardCarriage(unsigned int cardNumber);
 	void pushUpSmartCardArm();
@@ -331,6 +361,8 @@ private:
 	//from Gate to Gate
 	void gateToGate(unsigned int fromX, unsigned int fromY, unsigned int fromZ, unsigned int fromW,
 					unsigned int toX, unsigned int toY, unsigned int toZ, unsigned int toW);
+	void planGateToGate(unsigned int fromX, unsigned int fromY, unsigned int fromZ, unsigned int fromW,
+					unsigned int toX, unsigned int toY, unsigned int toZ, unsigned int toW);
 	void toHome();
 	void toSmartCardGate();
 	void toPedKeyGate();
@@ -344,6 +376,26 @@ private:
 	void powerOnOpt(bool on);
 	void powerOnDcm(bool on, unsigned int index);
 
+	//macro: console commands of a smart card flow are recorded instead of being sent,
+	//the recorded steps are uploaded to device once and run with a single console command afterwards.
+	//positions of stepper V and W are relative to macro parameters 0 (smart card offset) and 1 (W adjustment),
+	//so one macro serves all smart cards as long as coordinates and movement configuration stay the same.
+	static const unsigned int MACRO_AMOUNT = 8; //macros kept by device
+	bool _useDeviceMacros; //cleared if device rejects macro upload, flows are run command by command then
+	bool _macroRecording;
+	std::vector<MacroStep> _macroSteps;
+	std::vector<long> _macroParameters;
+	std::map<std::string, unsigned int> _macroIds; //recorded steps to id of uploaded macro
+	void runAsMacro(void (UserCommandRunner::*sequence)());
+	void recordMacroStep(const std::string& cmd);
+	void clearMacros();
+	//smart card flows run as macros
+	void insertSmartCard();
+	void removeSmartCard();
+	void swipeSmartCard();
+	void tapSmartCard();
+	void logTapStep(const char * pStep);
+
 	std::vector<IUserCommandRunnerObserver *> _observerPtrArray;
 
 	//////////////////////////////////////
@@ -351,6 +403,7 @@ private:
 	//////////////////////////////////////
 
 	Poco::Mutex _consoleCommandMutex;
+	Poco::Condition _consoleCommandFinished; //signaled with _consoleCommandMutex when console command succeeds or fails.
 	struct ConsoleCommand
 	{
 		ICommandReception::CommandId cmdId;
@@ -362,6 +415,7 @@ private:
 		bool stepperForward;
 		bool stepperForwardClockwise;
 		unsigned int locatorIndex;
+		std::vector<StepperMovement> movements;
 
 		//command results
 		std::vector<std::string> resultDevices;
@@ -386,10 +440,15 @@ private:
 		unsigned char resultLocators[LOCATOR_AMOUNT];
 	};
 	ConsoleCommand _consoleCommand;
+	//runs sent by runSteppers which wait for reply, key is command id, value is stepper index.
+	std::map<ICommandReception::CommandId, unsigned int> _stepperRuns;
+	bool _stepperRunFailed;
 
 	void throwError(const std::string& errorInfo);
 	void setConsoleCommandParameter(const std::string & cmd);
 	void runConsoleCommand(const std::string& cmd);
+	//set final state of console command and wake up runConsoleCommand
+	void finishConsoleCommand(CommandState state);
 
 	ConsoleOperator * _pConsoleOperator;
 };
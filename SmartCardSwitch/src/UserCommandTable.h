@@ -0,0 +1,111 @@
+/*
+ * UserCommandTable.h
+ */
+
+#ifndef USERCOMMANDTABLE_H_
+#define USERCOMMANDTABLE_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "IUserCommandRunner.h"
+
+/**
+ * Names of user commands and their types.
+ * It is used by UserCommandRunner and by proxy/tools/CommandDispatchBenchmark.
+ */
+namespace UserCommandTable
+{
+	struct UserCommandName
+	{
+		const char * name;
+		UserCommandType type;
+		bool stepperWAdjusted; //command is denied until stepper W is adjusted
+	};
+
+	//the only place where user command names are defined.
+	//entries must be sorted by name and cover every UserCommandType, static_asserts below check it at compile time.
+	constexpr UserCommandName userCommandNames[] = {
+		{"adjust stepper w", UserCommandType::AdjustStepperW, false},
+		{"back to home", UserCommandType::BackToHome, true},
+		{"check reset pressed", UserCommandType::CheckResetPressed, false},
+		{"check reset released", UserCommandType::CheckResetReleased, false},
+		{"connect device", UserCommandType::ConnectDevice, false},
+		{"finish stepper w adjustment", UserCommandType::FinishStepperWAdjustment, false},
+		{"insert smart card", UserCommandType::InsertSmartCard, true},
+		{"move card barcode to extra position", UserCommandType::CardBarcodeToExtraPosition, true},
+		{"move card from barcodeReader to barcodeReaderGate", UserCommandType::CardFromBarcodeReaderToBarcodeReaderGate, true},
+		{"move card from barcodeReaderGate to barcodeReader", UserCommandType::CardFromBarcodeReaderGateToBarcodeReader, true},
+		{"move card from barcodeReaderGate to smartCardGate", UserCommandType::CardFromBarcodeReaderGateToSmartCardGate, true},
+		{"move card from bay to smartCardGate", UserCommandType::CardFromBayToSmartCardGate, false},
+		{"move card from smartCardGate to barcodeReaderGate", UserCommandType::CardFromSmartCardGateToBarcodeReaderGate, true},
+		{"move card from smartCardGate to bay", UserCommandType::CardFromSmartCardGateToBay, false},
+		{"move card from smartCardGate to smartCardReaderGate", UserCommandType::CardFromSmartCardGateToSmartCardReaderGate, true},
+		{"move card from smartCardReader to smartCardReaderGate", UserCommandType::CardFromSmartCardReaderToSmartCardReaderGate, true},
+		{"move card from smartCardReaderGate to smartCardGate", UserCommandType::CardFromSmartCardReaderGateToSmartCardGate, true},
+		{"move card from smartCardReaderGate to smartCardReader", UserCommandType::CardFromSmartCardReaderGateToSmartCardReader, true},
+		{"power off dcm", UserCommandType::PowerOffDcm, true},
+		{"power off opt", UserCommandType::PowerOffOpt, true},
+		{"power on dcm", UserCommandType::PowerOnDcm, true},
+		{"power on opt", UserCommandType::PowerOnOpt, true},
+		{"press PED key", UserCommandType::PressPedKey, true},
+		{"press assist key", UserCommandType::PressAssistKey, true},
+		{"press soft key", UserCommandType::PressSoftKey, true},
+		{"remove smart card", UserCommandType::RemoveSmartCard, true},
+		{"reset device", UserCommandType::ResetDevice, false},
+		{"return smart card", UserCommandType::ReturnSmartCard, true},
+		{"swipe smart card", UserCommandType::SwipeSmartCard, true},
+		{"tap bar code", UserCommandType::TapBarCode, true},
+		{"tap smart card", UserCommandType::TapSmartCard, true},
+		{"touch screen", UserCommandType::TouchScreen, true},
+	};
+	constexpr unsigned int USER_COMMAND_NAME_AMOUNT = sizeof(userCommandNames) / sizeof(userCommandNames[0]);
+
+	constexpr int compareName(const char * pName1, const char * pName2)
+	{
+		return (*pName1 != *pName2) ? ((unsigned char)*pName1 - (unsigned char)*pName2) :
+				((*pName1 == 0) ? 0 : compareName(pName1 + 1, pName2 + 1));
+	}
+
+	constexpr bool isSorted(unsigned int index)
+	{
+		return (index + 1 >= USER_COMMAND_NAME_AMOUNT) ||
+				((compareName(userCommandNames[index].name, userCommandNames[index + 1].name) < 0) && isSorted(index + 1));
+	}
+
+	constexpr bool hasType(int type, unsigned int index)
+	{
+		return (index < USER_COMMAND_NAME_AMOUNT) && (((int)userCommandNames[index].type == type) || hasType(type, index + 1));
+	}
+
+	constexpr bool hasAllTypes(int type)
+	{
+		return (type > (int)UserCommandType::Last) || (hasType(type, 0) && hasAllTypes(type + 1));
+	}
+
+	static_assert(isSorted(0), "userCommandNames isn't sorted by name or has duplicated names");
+	static_assert(USER_COMMAND_NAME_AMOUNT == (unsigned int)UserCommandType::Last + 1, "userCommandNames doesn't match UserCommandType");
+	static_assert(hasAllTypes(0), "a UserCommandType is missing in userCommandNames");
+
+	//nullptr if name is unknown, hash index is built from userCommandNames at the first lookup.
+	inline const UserCommandName * Find(const std::string& name)
+	{
+		static const std::unordered_map<std::string, const UserCommandName *> userCommands(
+				[]() {
+					std::unordered_map<std::string, const UserCommandName *> commands;
+					for(unsigned int i=0; i<USER_COMMAND_NAME_AMOUNT; i++) {
+						commands[userCommandNames[i].name] = &userCommandNames[i];
+					}
+					return commands;
+				}());
+
+		auto it = userCommands.find(name);
+		if(it == userCommands.end()) {
+			return nullptr;
+		}
+
+		return it->second;
+	}
+}
+
+#endif /* USERCOMMANDTABLE_H_ */
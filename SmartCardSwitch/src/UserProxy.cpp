@@ -621,12 +621,10 @@ void UserProxy::runTask()
 							pLogger->LogInfo("UserProxy::runTask content: " + content);
 						}
 
-						for(int i=0; i<amount; i++) {
-							_input.push_back(buffer[i]);
-						}
+						_input.Append(buffer, amount);
 
 						std::vector<std::string> cmds;
-						MsgPackager::RetrieveMsgs(_input, cmds);
+						_input.RetrieveMsgs(cmds);
 
 						if(cmds.size() > 1) {
 							pLogger->LogError("UserProxy::runTask multiple user commands arrived: " + std::to_string(cmds.size()));
@@ -763,7 +761,7 @@ void UserProxy::runTask()
 				_sockets[0].close();
 				_sockets.clear();
 				_output.clear();
-				_input.clear();
+				_input.Clear();
 			}
 		}
 	}
@@ -16,6 +16,7 @@
 
 #include "IUserCommandRunner.h"
 #include "UserListener.h"
+#include "MsgPackager.h"
 
 
 /**
@@ -84,7 +85,7 @@ private:
 	bool sendCheckResetReleasedCommand();
 	bool sendDeviceResetCommand();
 
-	std::deque<unsigned char> _input;
+	MsgFramer _input;
 	std::deque<unsigned char> _output;
 
 	std::string createErrorInfo(const std::string& info, const std::string cmdId);
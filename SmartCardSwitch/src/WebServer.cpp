@@ -4,6 +4,7 @@
  *  Created on: Jan 3, 2019
  *      Author: mikez
  */
+#include <algorithm>
 #include "Poco/ThreadPool.h"
 #include "Poco/Net/HTTPServerParams.h"
 #include "Poco/Net/ServerSocket.h"
@@ -959,12 +960,15 @@ void ScsRequestHandler::handleRequest(Poco::Net::HTTPServerRequest& request, Poc
  *  WebServer
  */
 
-WebServer::WebServer(unsigned int port, unsigned int maxQueue, unsigned int maxThread, const std::string & filesFolder): Task("WebServer")
+WebServer::WebServer(unsigned int port, unsigned int maxQueue, unsigned int maxThread, const std::string & filesFolder, bool queryDeviceStatus, unsigned int maxPendingCommands): Task("WebServer")
 {
 	_port = port;
 	_maxQueue = maxQueue;
 	_maxThread = maxThread;
 	_filesFolder = filesFolder;
+	_queryDeviceStatus = queryDeviceStatus;
+	_maxPendingCommands = (maxPendingCommands > 1) ? (maxPendingCommands - 1) : 1;
+	_queriesRunning = false;
 	_pConsoleOperator = nullptr;
 
 	_consoleCommand.state  = CommandState::Idle;
@@ -1088,6 +1092,65 @@ void WebServer::OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFuseOn)
 	}
 }
 
+void WebServer::OnDeviceQueryStatus(CommandId key, bool bSuccess, const StatusSnapshot& status)
+{
+	if(key == InvalidCommandId) {
+		return;
+	}
+
+	Poco::ScopedLock<Poco::Mutex> lock(_replyMutex); //synchronize console command and reply
+
+	if(_consoleCommand.state != CommandState::OnGoing) {
+		return;
+	}
+	if(_consoleCommand.cmdId != key) {
+		return;
+	}
+
+	if(bSuccess)
+	{
+		_consoleCommand.resultDevicePowered = status.bPoweredOn;
+		_consoleCommand.resultDeviceFuseOk = status.bFuseOn;
+		_consoleCommand.resultBdcsPowered = status.bBdcsPoweredOn;
+		_consoleCommand.resultSteppersPowered = status.bSteppersPoweredOn;
+
+		for(unsigned int i=0; (i<status.bdcs.size()) && (i<BDC_AMOUNT); i++) {
+			_consoleCommand.resultBdcStatus[i] = status.bdcs[i];
+		}
+		for(unsigned int i=0; (i<status.steppers.size()) && (i<STEPPER_AMOUNT); i++)
+		{
+			auto& stepper = status.steppers[i];
+			auto& data = _consoleCommand.resultSteppers[i];
+
+			data.state = stepper.state;
+			data.forward = stepper.bForward;
+			data.forwardClockwise = stepper.bForwardClockwise;
+			data.enabled = stepper.bEnabled;
+			data.locatorIndex = stepper.locatorIndex;
+			data.locatorLineNumberStart = stepper.locatorLineNumberStart;
+			data.locatorLineNumberTerminal = stepper.locatorLineNumberTerminal;
+			data.homeOffset = stepper.homeOffset;
+			data.lowClks = stepper.lowClks;
+			data.highClks = stepper.highClks;
+			data.accelerationBuffer = stepper.accelerationBuffer;
+			data.accelerationBufferDecrement = stepper.accelerationBufferDecrement;
+			data.decelerationBuffer = stepper.decelerationBuffer;
+			data.decelerationBufferIncrement = stepper.decelerationBufferIncrement;
+			if(data.homeOffset > data.maximum) {
+				data.maximum = data.homeOffset;
+			}
+		}
+		for(unsigned int i=0; (i<status.locators.size()) && (i<LOCATOR_AMOUNT); i++) {
+			_consoleCommand.resultLocators[i] = status.locators[i];
+		}
+
+		_consoleCommand.state = CommandState::Succeeded;
+	}
+	else {
+		_consoleCommand.state = CommandState::Failed;
+	}
+}
+
 void WebServer::OnDeviceDelay(CommandId key, bool bSuccess)
 {
 
@@ -1736,6 +1799,34 @@ void WebServer::OnStepperQuery(CommandId key, bool bSuccess,
 
 	Poco::ScopedLock<Poco::Mutex> lock(_replyMutex); //synchronize console command and reply
 
+	if(_queriesRunning)
+	{
+		auto& query = _pendingQueries[key];
+
+		if(bSuccess)
+		{
+			query.stepper.state = state;
+			query.stepper.forward = bForward;
+			query.stepper.forwardClockwise = bForwardClockwise;
+			query.stepper.enabled = bEnabled;
+			query.stepper.locatorIndex = locatorIndex;
+			query.stepper.locatorLineNumberStart = locatorLineNumberStart;
+			query.stepper.locatorLineNumberTerminal = locatorLineNumberTerminal;
+			query.stepper.homeOffset = homeOffset;
+			query.stepper.lowClks = lowClks;
+			query.stepper.highClks = highClks;
+			query.stepper.accelerationBuffer = accelerationBuffer;
+			query.stepper.accelerationBufferDecrement = accelerationBufferDecrement;
+			query.stepper.decelerationBuffer = decelerationBuffer;
+			query.stepper.decelerationBufferIncrement = decelerationBufferIncrement;
+			query.state = CommandState::Succeeded;
+		}
+		else {
+			query.state = CommandState::Failed;
+		}
+		return;
+	}
+
 	if(_consoleCommand.state != CommandState::OnGoing) {
 		return;
 	}
@@ -1810,6 +1901,20 @@ void WebServer::OnLocatorQuery(CommandId key, bool bSuccess, unsigned int lowInp
 
 	Poco::ScopedLock<Poco::Mutex> lock(_replyMutex); //synchronize console command and reply
 
+	if(_queriesRunning)
+	{
+		auto& query = _pendingQueries[key];
+
+		if(bSuccess) {
+			query.locator = lowInput;
+			query.state = CommandState::Succeeded;
+		}
+		else {
+			query.state = CommandState::Failed;
+		}
+		return;
+	}
+
 	if(_consoleCommand.state != CommandState::OnGoing) {
 		return;
 	}
@@ -2193,81 +2298,194 @@ bool WebServer::PowerOn(const std::string& target, bool on, std::string & errorI
 bool WebServer::Query(std::string & errorInfo)
 {
 	errorInfo.clear();
-	std::string cmd;
 
 	Poco::ScopedLock<Poco::Mutex> lock(_webServerMutex); //one command at a time
 
+	if(!_queryDeviceStatus) {
+		return queryItems(errorInfo);
+	}
+
+	//power, fuse, BDCs, steppers and locators are replied together.
+	std::string cmd = ConsoleCommandFactory::CmdDeviceQueryStatus();
+	runConsoleCommand(cmd, errorInfo);
+	if(errorInfo.empty()) {
+		return true;
+	}
+
+	pLogger->LogError("WebServer::Query failed in device query status: " + errorInfo + ", query items one by one");
+	if(!queryItems(errorInfo)) {
+		return false;
+	}
+	//device is working but firmware doesn't know "device query status"
+	pLogger->LogInfo("WebServer::Query device query status is disabled");
+	_queryDeviceStatus = false;
+
+	return true;
+}
+
+bool WebServer::queryItems(std::string & errorInfo)
+{
+	errorInfo.clear();
+	std::string cmd;
+
 	cmd = ConsoleCommandFactory::CmdDeviceQueryPower();
 	runConsoleCommand(cmd, errorInfo);
 	if(!errorInfo.empty()) {
-		pLogger->LogError("WebServer::Query failed in device query power: " + errorInfo);
+		pLogger->LogError("WebServer::queryItems failed in device query power: " + errorInfo);
 		return false;
 	}
 
 	cmd = ConsoleCommandFactory::CmdDeviceQueryFuse();
 	runConsoleCommand(cmd, errorInfo);
 	if(!errorInfo.empty()) {
-		pLogger->LogError("WebServer::Query failed in device query fuse: " + errorInfo);
+		pLogger->LogError("WebServer::queryItems failed in device query fuse: " + errorInfo);
 		return false;
 	}
 
 //	cmd = ConsoleCommandFactory::CmdOptQueryPower();
 //	runConsoleCommand(cmd, errorInfo);
 //	if(!errorInfo.empty()) {
-//		pLogger->LogError("WebServer::Query failed in opt query power: " + errorInfo);
+//		pLogger->LogError("WebServer::queryItems failed in opt query power: " + errorInfo);
 //		return false;
 //	}
 
 	cmd = ConsoleCommandFactory::CmdBdcsQueryPower();
 	runConsoleCommand(cmd, errorInfo);
 	if(!errorInfo.empty()) {
-		pLogger->LogError("WebServer::Query failed in bdc query power: " + errorInfo);
+		pLogger->LogError("WebServer::queryItems failed in bdc query power: " + errorInfo);
 		return false;
 	}
 
 //	cmd = ConsoleCommandFactory::CmdDcmQueryPower();
 //	runConsoleCommand(cmd, errorInfo);
 //	if(!errorInfo.empty()) {
-//		pLogger->LogError("WebServer::Query failed in dcm query power: " + errorInfo);
+//		pLogger->LogError("WebServer::queryItems failed in dcm query power: " + errorInfo);
 //		return false;
 //	}
 
 	cmd = ConsoleCommandFactory::CmdSteppersQueryPower();
 	runConsoleCommand(cmd, errorInfo);
 	if(!errorInfo.empty()) {
-		pLogger->LogError("WebServer::Query failed in stepper query power: " + errorInfo);
+		pLogger->LogError("WebServer::queryItems failed in stepper query power: " + errorInfo);
 		return false;
 	}
 
-	for(unsigned int i=0; i<LOCATOR_AMOUNT; i++)
-	{
-		_consoleCommand.locatorIndex = i;
-		cmd = ConsoleCommandFactory::CmdLocatorQuery(i);
-		runConsoleCommand(cmd, errorInfo);
-		if(!errorInfo.empty()) {
-			pLogger->LogError("WebServer::Query failed in locator query: " + std::to_string(i) + "; error:" + errorInfo);
-			return false;
-		}
+	if(!runQueries(false, LOCATOR_AMOUNT, errorInfo)) {
+		pLogger->LogError("WebServer::queryItems failed in locator query: " + errorInfo);
+		return false;
 	}
 
-	for(unsigned int i=0; i<STEPPER_AMOUNT; i++)
+	if(!runQueries(true, STEPPER_AMOUNT, errorInfo)) {
+		pLogger->LogError("WebServer::queryItems failed in stepper query: " + errorInfo);
+		return false;
+	}
+
+	for(unsigned int i=0; i<BDC_AMOUNT; i++)
 	{
-		_consoleCommand.stepperIndex = i;
-		cmd = ConsoleCommandFactory::CmdStepperQuery(i);
+		_consoleCommand.bdcIndex = i;
+		cmd = ConsoleCommandFactory::CmdBdcQuery(i);
 		runConsoleCommand(cmd, errorInfo);
 		if(!errorInfo.empty()) {
-			pLogger->LogError("WebServer::Query failed in stepper query: " + std::to_string(i) + "; error:" + errorInfo);
+			pLogger->LogError("WebServer::queryItems failed in bdc query: " + std::to_string(i) + "; error:" + errorInfo);
 			return false;
 		}
 	}
 
-	for(unsigned int i=0; i<BDC_AMOUNT; i++)
+	return true;
+}
+
+bool WebServer::runQueries(bool stepper, unsigned int amount, std::string & errorInfo)
+{
+	errorInfo.clear();
+
+	//no more than _maxPendingCommands queries wait for reply at the same time
+	for(unsigned int first=0; first<amount; first+=_maxPendingCommands)
 	{
-		_consoleCommand.bdcIndex = i;
-		cmd = ConsoleCommandFactory::CmdBdcQuery(i);
-		runConsoleCommand(cmd, errorInfo);
+		unsigned int last = std::min(amount, first + _maxPendingCommands);
+
+		{
+			Poco::ScopedLock<Poco::Mutex> lock(_replyMutex);
+			_pendingQueries.clear();
+			_queriesRunning = true;
+		}
+
+		//send queries, _replyMutex isn't held because replies to the sent ones may come in the meantime
+		for(unsigned int i=first; i<last; i++)
+		{
+			std::string cmd = stepper ? ConsoleCommandFactory::CmdStepperQuery(i) : ConsoleCommandFactory::CmdLocatorQuery(i);
+			auto cmdId = _pConsoleOperator->RunConsoleCommand(cmd);
+			if(cmdId == InvalidCommandId) {
+				errorInfo = "failure in running query " + std::to_string(i);
+				pLogger->LogError("WebServer::runQueries failed to start " + std::string(stepper ? "stepper" : "locator") + " query: " + std::to_string(i));
+				break;
+			}
+
+			Poco::ScopedLock<Poco::Mutex> lock(_replyMutex);
+			auto& query = _pendingQueries[cmdId];
+			query.sent = true;
+			query.index = i;
+			if(query.state == CommandState::Idle) {
+				query.state = CommandState::OnGoing;
+			}
+		}
+
+		//wait for replies to all queries sent
+		for(;;)
+		{
+			bool onGoing = false;
+			{
+				Poco::ScopedLock<Poco::Mutex> lock(_replyMutex);
+				for(auto it=_pendingQueries.begin(); it!=_pendingQueries.end(); it++)
+				{
+					if(it->second.sent && (it->second.state == CommandState::OnGoing)) {
+						onGoing = true;
+						break;
+					}
+				}
+			}
+
+			if(onGoing) {
+				sleep(10);
+			}
+			else {
+				break;
+			}
+		}
+
+		//check results
+		Poco::ScopedLock<Poco::Mutex> lock(_replyMutex);
+		for(auto it=_pendingQueries.begin(); it!=_pendingQueries.end(); it++)
+		{
+			auto& query = it->second;
+
+			if(!query.sent) {
+				continue;
+			}
+			if(query.state != CommandState::Succeeded)
+			{
+				pLogger->LogError("WebServer::runQueries failed in " + std::string(stepper ? "stepper" : "locator") + " query: " + std::to_string(query.index));
+				if(errorInfo.empty()) {
+					errorInfo = "failed in query " + std::to_string(query.index);
+				}
+			}
+			else if(stepper)
+			{
+				auto& data = _consoleCommand.resultSteppers[query.index];
+				unsigned int targetPosition = data.targetPosition;
+				unsigned int maximum = std::max(data.maximum, query.stepper.homeOffset);
+
+				data = query.stepper;
+				data.targetPosition = targetPosition;
+				data.maximum = maximum;
+			}
+			else {
+				_consoleCommand.resultLocators[query.index] = query.locator;
+			}
+		}
+		_pendingQueries.clear();
+		_queriesRunning = false;
+
 		if(!errorInfo.empty()) {
-			pLogger->LogError("WebServer::Query failed in bdc query: " + std::to_string(i) + "; error:" + errorInfo);
 			return false;
 		}
 	}
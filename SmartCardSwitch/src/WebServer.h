@@ -9,6 +9,7 @@
 #define WEBSERVER_H_
 
 #include <string>
+#include <map>
 #include <vector>
 #include <deque>
 
@@ -180,7 +181,10 @@ private:
 class WebServer: public Poco::Task, public IResponseReceiver
 {
 public:
-	WebServer(unsigned int port, unsigned int maxQueue, unsigned int maxThread, const std::string & filesFolder);
+	//queryDeviceStatus: firmware supports "device query status" (C 5), Query sends it instead of the queries of each item
+	//maxPendingCommands: amount of device commands which can wait for reply at the same time,
+	//one of them is left to commands from UserCommandRunner.
+	WebServer(unsigned int port, unsigned int maxQueue, unsigned int maxThread, const std::string & filesFolder, bool queryDeviceStatus, unsigned int maxPendingCommands);
 
 	void SetConsoleOperator(ConsoleOperator * pCO) { _pConsoleOperator = pCO; }
 
@@ -229,6 +233,7 @@ private:
 	virtual void OnDeviceConnect(CommandId key, bool bSuccess) override;
 	virtual void OnDeviceQueryPower(CommandId key, bool bSuccess, bool bPowered)  override;
 	virtual void OnDeviceQueryFuse(CommandId key, bool bSuccess, bool bFuseOn) override;
+	virtual void OnDeviceQueryStatus(CommandId key, bool bSuccess, const StatusSnapshot& status) override;
 	virtual void OnDeviceDelay(CommandId key, bool bSuccess)  override;
  	virtual void OnOptPowerOn(CommandId key, bool bSuccess)  override;
 	virtual void OnOptPowerOff(CommandId key, bool bSuccess)   override;
@@ -351,16 +356,34 @@ private:
 	};
 	ConsoleCommand _consoleCommand;
 
+	//a stepper or locator query sent by runQueries, its result is kept here until all queries are replied.
+	struct PendingQuery
+	{
+		bool sent = false; //false if reply comes before runQueries records the command id, or it is a reply to others
+		unsigned int index = 0;
+		CommandState state = CommandState::Idle;
+		ConsoleCommand::StepperStatus stepper;
+		unsigned char locator = 0;
+	};
+	bool _queriesRunning;
+	std::map<ICommandReception::CommandId, PendingQuery> _pendingQueries; //key is command id
+
 	unsigned int _port;
 	unsigned int _maxQueue;
 	unsigned int _maxThread;
 	std::string _filesFolder;
+	bool _queryDeviceStatus; //cleared when device fails in "device query status" but answers queries of each item
+	unsigned int _maxPendingCommands;
 
 	std::string _defaultPageContent;
 
 	ConsoleOperator * _pConsoleOperator;
 
 	void runConsoleCommand(const std::string & cmd, std::string & errorInfo);
+	//query power, fuse, BDCs, steppers and locators one by one
+	bool queryItems(std::string & errorInfo);
+	//send queries of steppers or locators without waiting for reply in between, then wait for all of them.
+	bool runQueries(bool stepper, unsigned int amount, std::string & errorInfo);
 };
 
 #endif /* WEBSERVER_H_ */
@@ -69,7 +69,7 @@ std::string CommandRunner::execDeviceCommand(const std::vector<unsigned char> &
 	unsigned char buffer[1024];
 	bool bException = false;
 	int amount;
-	std::deque<unsigned char> deviceReply;
+	MsgFramer deviceReply;
 
 	try
 	{
@@ -156,13 +156,11 @@ std::string CommandRunner::execDeviceCommand(const std::vector<unsigned char> &
 					else
 					{
 						pLogger->LogInfo("CommandRunner::execDeviceCommand received " + std::to_string(amount) + " bytes");
-						for(int i=0; i<amount; i++) {
-							deviceReply.push_back(buffer[i]);
-						}
+						deviceReply.Append(buffer, amount);
 
 						std::vector<std::string> replies;
 						//try to retrieve a reply
-						MsgPackager::RetrieveMsgs(deviceReply, replies);
+						deviceReply.RetrieveMsgs(replies);
 						if(!replies.empty()) {
 							reply = replies[0];
 							break;
@@ -575,7 +573,7 @@ void CommandRunner::onCommand(StreamSocket & socket, const std::string & cmd)
 		Poco::Timestamp receivingStart;
 		Poco::Timespan timedSpan (10000); //10 milliseconds
 		bool bTimeout = false;
-		std::deque<unsigned char> deviceBytes;
+		MsgFramer deviceBytes;
 		std::string commandReply;
 
 		for(;;)
@@ -609,11 +607,9 @@ void CommandRunner::onCommand(StreamSocket & socket, const std::string & cmd)
 
 						pLogger->LogInfo("CommandRunner::onCommand " + std::to_string(amount) + " bytes arrived");
 
-						for(int i=0; i<amount; i++) {
-							deviceBytes.push_back(buffer[i]);
-						}
+						deviceBytes.Append(buffer, amount);
 
-						MsgPackager::RetrieveMsgs(deviceBytes, cmdReplies);
+						deviceBytes.RetrieveMsgs(cmdReplies);
 						if(cmdReplies.empty()) {
 							continue;
 						}
@@ -831,15 +827,11 @@ void CommandRunner::pollClientSockets()
 				{
 					pLogger->LogInfo("CommandRunner::pollClientSockets bytes amount: " + std::to_string(amount));
 
-					std::deque<unsigned char> queue;
+					MsgFramer queue;
 					std::vector<std::string> commands;
 
-					for(int i=0; i<amount; i++)
-					{
-						queue.push_back(buf[i]);
-					}
-
-					MsgPackager::RetrieveMsgs(queue, commands);
+					queue.Append(buf, amount);
+					queue.RetrieveMsgs(commands);
 					if(commands.empty())
 					{
 						pLogger->LogError("CommandRunner::pollClientSockets no valid command in :");
@@ -177,7 +177,7 @@ bool WebServer::PressKey(unsigned int keyIndex, std::string & errorInfo)
 	std::vector<unsigned char> cmdPkg;
 	bool bException = false;
 	std::string reply;
-	std::deque<unsigned char> replyPkg;
+	MsgFramer replyPkg;
 
 	jsonCmd = "{";
 	jsonCmd += "\"userCommand\":\"press key\",";
@@ -244,12 +244,10 @@ bool WebServer::PressKey(unsigned int keyIndex, std::string & errorInfo)
 					else
 					{
 						pLogger->LogInfo("WebServer::PressKey " + std::to_string(size) + " bytes arrived");
-						for(int i=0; i<size; i++) {
-							replyPkg.push_back(buffer[i]);
-						}
+						replyPkg.Append(buffer, size);
 					}
 
-					MsgPackager::RetrieveMsgs(replyPkg, replies);
+					replyPkg.RetrieveMsgs(replies);
 					pLogger->LogInfo("WebServer::PressKey " + std::to_string(replies.size()) + " replies arrived");
 					if(!replies.empty()) {
 						reply = replies[0];
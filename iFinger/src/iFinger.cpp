@@ -122,6 +122,7 @@ protected:
 		std::string logFile;
 		std::string logFileSize;
 		std::string logFileAmount;
+		bool logBinary = false;
 		std::string coordinatePathFile;
 		std::string movementConfigurationPathFile;
 
@@ -133,6 +134,7 @@ protected:
 			logFile = config().getString("log_file_name", "iFingerLog");
 			logFileSize = config().getString("log_file_size", "1M");
 			logFileAmount = config().getString("log_file_amount", "10");
+			logBinary = config().getBool("log_binary", false);
 		}
 		catch(Poco::Exception& e)
 		{
@@ -143,7 +145,7 @@ protected:
 			logger().error("Config unknown exception");
 		}
 
-		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount);
+		pLogger = new Logger(logFolder, logFile, logFileSize, logFileAmount, logBinary);
 		pLogger->CopyToConsole(true);
 		tmLogger.start(pLogger); //tmLogger takes the ownership of pLogger.
 		pLogger->LogInfo("**** iFinger V1.0.0 ****");
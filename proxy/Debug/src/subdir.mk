@@ -10,7 +10,9 @@ CPP_SRCS += \
 ../src/CListener.cpp \
 ../src/CSocketManager.cpp \
 ../src/CommandTranslater.cpp \
+../src/FirmwareReply.cpp \
 ../src/LinuxComDevice.cpp \
+../src/LinuxComEngine.cpp \
 ../src/ProxyLogger.cpp \
 ../src/ReplyFactory.cpp \
 ../src/ReplyTranslater.cpp \
@@ -24,7 +26,9 @@ OBJS += \
 ./src/CListener.o \
 ./src/CSocketManager.o \
 ./src/CommandTranslater.o \
+./src/FirmwareReply.o \
 ./src/LinuxComDevice.o \
+./src/LinuxComEngine.o \
 ./src/ProxyLogger.o \
 ./src/ReplyFactory.o \
 ./src/ReplyTranslater.o \
@@ -38,7 +42,9 @@ CPP_DEPS += \
 ./src/CListener.d \
 ./src/CSocketManager.d \
 ./src/CommandTranslater.d \
+./src/FirmwareReply.d \
 ./src/LinuxComDevice.d \
+./src/LinuxComEngine.d \
 ./src/ProxyLogger.d \
 ./src/ReplyFactory.d \
 ./src/ReplyTranslater.d \
@@ -16,6 +16,14 @@ void CDataExchange::_initOutputStageAckPacket(unsigned char packetId)
 // acknowledge data packet received in input stage
 void CDataExchange::_ackInputStageDataPacket(unsigned char packetId) 
 {
+	if(_scsWindowStage.state == SCS_WINDOW_ACTIVE)
+	{
+		//ACK is cumulative, the latest one replaces the pending one.
+		_initOutputStageAckPacket(packetId);
+		_scsWindowStage.ackPending = true;
+		return;
+	}
+
 	switch(_scsOutputStage.state)
 	{
 		case SCS_OUTPUT_IDLE:
@@ -50,9 +58,66 @@ void CDataExchange::_ackInputStageDataPacket(unsigned char packetId)
 // be called when a ACK packet is received in input stage
 void CDataExchange::_on_inputStageAckPacketComplete(unsigned char packetId)
 {
+	_scsWindowStage.linkUp = true;
+
+	if(_scsWindowStage.state == SCS_WINDOW_ACTIVE)
+	{
+		//release the acknowledged packet and all packets sent before it.
+		for(unsigned char i=0; i<_scsWindowStage.slotAmount; i++)
+		{
+			unsigned char index = (_scsWindowStage.oldestSlot + i) % SCS_WINDOW_MAX_SIZE;
+
+			if(_scsWindowStage.slots[index].pktBuffer[1] == packetId)
+			{
+				_scsWindowStage.oldestSlot = (index + 1) % SCS_WINDOW_MAX_SIZE;
+				_scsWindowStage.slotAmount -= i + 1;
+				break;
+			}
+		}
+		return;
+	}
+
 	_scsOutputStage.ackedDataPktId = packetId;
 }
 
+// be called when a window negotiation packet is received in input stage
+void CDataExchange::_on_inputStageWindowPacketComplete(unsigned char windowSize)
+{
+	if((windowSize & SCS_WINDOW_REPLY_FLAG) == 0)
+	{
+		//the other side requests a window
+		if(windowSize > _scsWindowStage.requestedSize) {
+			windowSize = _scsWindowStage.requestedSize;
+		}
+		_scsWindowStage.replySize = windowSize;
+		_scsWindowStage.replyPending = true;
+
+		if((windowSize > 1) && (_scsWindowStage.state != SCS_WINDOW_ACTIVE)) {
+			_scsWindowStage.size = windowSize;
+			_scsWindowStage.state = SCS_WINDOW_AGREED;
+		}
+		return;
+	}
+
+	windowSize &= ~SCS_WINDOW_REPLY_FLAG;
+	if(_scsWindowStage.state != SCS_WINDOW_NEGOTIATING) {
+		printString("ERROR: unexpected window packet\r\n");
+		return;
+	}
+	if(windowSize < 2) {
+		//firmware can only exchange packets one by one.
+		printString("ERROR: window refused\r\n");
+		_scsWindowStage.state = SCS_WINDOW_REFUSED;
+		return;
+	}
+
+	if(windowSize > _scsWindowStage.requestedSize) {
+		windowSize = _scsWindowStage.requestedSize;
+	}
+	_scsWindowStage.size = windowSize;
+	_scsWindowStage.state = SCS_WINDOW_AGREED;
+}
+
 // be called when a Data packet is received in input stage
 void CDataExchange::_on_inputStageDataPacketComplete(void)
 {
@@ -87,6 +152,14 @@ void CDataExchange::_on_inputStageDataPacketComplete(void)
 			if(expectedPacketId == SCS_INVALID_PACKET_ID) {
 				expectedPacketId = 1;
 			}
+			if((packetId != expectedPacketId) &&
+				(_scsWindowStage.state == SCS_WINDOW_ACTIVE) &&
+				(_packetIdDistance(packetId, _scsInputStage.prevDataPktId) <= SCS_WINDOW_MAX_SIZE))
+			{
+				//this packet has been received successfully, but its ACK was lost.
+				_ackInputStageDataPacket(_scsInputStage.prevDataPktId);
+				return;
+			}
 			if(packetId != expectedPacketId) {
 				printString("ERROR: unexpected host packetId "); 
 				printHex(packetId);
@@ -121,7 +194,7 @@ void CDataExchange::_processScsInputStage(void)
 	{
 		if(_getChar(&c)) 
 		{
-			if((c == SCS_DATA_PACKET_TAG) || (c == SCS_ACK_PACKET_TAG))
+			if((c == SCS_DATA_PACKET_TAG) || (c == SCS_ACK_PACKET_TAG) || (c == SCS_WINDOW_PACKET_TAG))
 			{
 				_scsInputStage.state = SCS_INPUT_RECEIVING;
 				_scsInputStage.timeStamp = counter_get();
@@ -220,6 +293,39 @@ void CDataExchange::_processScsInputStage(void)
 					//do nothing, wait until complete packet is received.
 				}
 			}
+			else if(pktType == SCS_WINDOW_PACKET_TAG)
+			{
+				if(_scsInputStage.byteAmount == SCS_WINDOW_PACKET_LENGTH)
+				{
+					//a complete window negotiation packet is received
+					unsigned char crcLow, crcHigh;
+
+					_calculateCrc16(_scsInputStage.packetBuffer, 2, &crcLow, &crcHigh);
+
+					if((crcLow == _scsInputStage.packetBuffer[2]) && (crcHigh == _scsInputStage.packetBuffer[3]))
+					{
+						unsigned char windowSize = _scsInputStage.packetBuffer[1];
+						printString("> W "); printHex(windowSize); printString("\r\n");
+						_on_inputStageWindowPacketComplete(windowSize);
+					}
+					else
+					{
+						printString("ERROR: corrupted input window packet\r\n");
+					}
+					_scsInputStage.state = SCS_INPUT_IDLE; //change to IDLE state.
+				}
+				else if(_scsInputStage.byteAmount > SCS_WINDOW_PACKET_LENGTH)
+				{
+					// shouldn't occur
+					printString("ERROR: wrong input window packet length ");
+					printHex(_scsInputStage.byteAmount);
+					printString("\r\n");
+					_scsInputStage.state = SCS_INPUT_IDLE; //change to IDLE state.
+				}
+				else {
+					//do nothing, wait until complete packet is received.
+				}
+			}
 			else
 			{
 				//shouldn't occur
@@ -248,43 +354,72 @@ void CDataExchange::_processScsInputStage(void)
 	}
 }
 
-//handle SCS_OUTPUT_IDLE.
-// read data to host from APP's outputBuffer.
-void CDataExchange::_processScsOutputStageIdle(void)
+// id of the next data packet to be sent
+unsigned char CDataExchange::_nextDataPktId(void)
+{
+	if(_scsOutputStage.currentDataPktId == SCS_INVALID_PACKET_ID) {
+		_scsOutputStage.currentDataPktId = 0;
+	}
+	else {
+		_scsOutputStage.currentDataPktId++;
+		if(_scsOutputStage.currentDataPktId == SCS_INVALID_PACKET_ID) {
+			_scsOutputStage.currentDataPktId = 1; //turn around
+		}
+	}
+
+	return _scsOutputStage.currentDataPktId;
+}
+
+// steps from fromId to toId in the packet id sequence 0, 1 ... 0xFE, 1 ... 0xFE
+unsigned char CDataExchange::_packetIdDistance(unsigned char fromId, unsigned char toId)
+{
+	if((fromId == SCS_INVALID_PACKET_ID) || (toId == SCS_INVALID_PACKET_ID) || (toId == 0)) {
+		return SCS_INVALID_PACKET_ID;
+	}
+	if(fromId == 0) {
+		return toId;
+	}
+
+	return (toId + SCS_INVALID_PACKET_ID - 1 - fromId) % (SCS_INVALID_PACKET_ID - 1);
+}
+
+// read data to host from APP's outputBuffer, and packetize it in pPacket.
+// return value: length of the packet, 0 if no data needs to be sent.
+unsigned char CDataExchange::_fillDataPacket(unsigned char * pPacket)
 {
-	unsigned char * pPacket = _scsOutputStage.dataPktBuffer;
 	unsigned short size = _readOutputBuffer(pPacket + 3, SCS_DATA_MAX_LENGTH);
 	unsigned char crcLow, crcHigh;
 	
 	if(size == 0) {
-		return; //no APP data need to be sent to host
+		return 0; //no APP data need to be sent to host
 	}
 	if(size > SCS_DATA_MAX_LENGTH) {
 		//shouldn't occur
 		printString("ERROR: too much data read from APP's output buffer\r\n");
-		return;
+		return 0;
 	}
 	
 	//fill the packet staff
 	pPacket[0] = SCS_DATA_PACKET_TAG; //tag
 	//packet id
-	if(_scsOutputStage.currentDataPktId == SCS_INVALID_PACKET_ID) {
-		_scsOutputStage.currentDataPktId = 0;
-		pPacket[1] = 0;
-	}
-	else {
-		_scsOutputStage.currentDataPktId++;
-		if(_scsOutputStage.currentDataPktId == SCS_INVALID_PACKET_ID) {
-			_scsOutputStage.currentDataPktId = 1; //turn around
-		}
-		pPacket[1] = _scsOutputStage.currentDataPktId;
-	}
+	pPacket[1] = _nextDataPktId();
 	//length
 	pPacket[2] = (unsigned char)size;
 	//CRC
 	_calculateCrc16(pPacket, size + 3, &crcLow, &crcHigh);
 	pPacket[3+size] = crcLow;
 	pPacket[4+size] = crcHigh;
+
+	return size + SCS_DATA_PACKET_STAFF_LENGTH;
+}
+
+//handle SCS_OUTPUT_IDLE.
+// read data to host from APP's outputBuffer.
+void CDataExchange::_processScsOutputStageIdle(void)
+{
+	if(_fillDataPacket(_scsOutputStage.dataPktBuffer) == 0) {
+		return;
+	}
 	
 	_scsOutputStage.dataPktSendingIndex = 0;
 	_scsOutputStage.ackedDataPktId = SCS_INVALID_PACKET_ID;
@@ -292,9 +427,136 @@ void CDataExchange::_processScsOutputStageIdle(void)
 	_scsOutputStage.state = SCS_OUTPUT_SENDING_DATA;	
 }
 
+// negotiate window size with firmware between two stop-and-wait data packets
+void CDataExchange::_processScsWindowNegotiation(void)
+{
+	if(_scsWindowStage.replyPending)
+	{
+		unsigned char packet[SCS_WINDOW_PACKET_LENGTH];
+		unsigned char crcLow, crcHigh;
+
+		packet[0] = SCS_WINDOW_PACKET_TAG;
+		packet[1] = _scsWindowStage.replySize | SCS_WINDOW_REPLY_FLAG;
+		_calculateCrc16(packet, 2, &crcLow, &crcHigh);
+		packet[2] = crcLow;
+		packet[3] = crcHigh;
+		_putChars(packet, SCS_WINDOW_PACKET_LENGTH);
+
+		_scsWindowStage.replyPending = false;
+		printString("< W "); printHex(packet[1]); printString("\r\n");
+	}
+
+	switch(_scsWindowStage.state)
+	{
+		case SCS_WINDOW_UNNEGOTIATED:
+		case SCS_WINDOW_NEGOTIATING:
+		{
+			if(!_scsWindowStage.linkUp || (_scsOutputStage.state != SCS_OUTPUT_IDLE)) {
+				break; //wait until firmware is alive and no data packet is in flight
+			}
+			if((_scsWindowStage.state == SCS_WINDOW_NEGOTIATING) &&
+				(counter_diff(_scsWindowStage.negotiationTimeStamp) <= SCS_WINDOW_NEGOTIATION_TIMEOUT))
+			{
+				break; //wait for reply
+			}
+			if(_scsWindowStage.negotiationAttempts >= SCS_WINDOW_NEGOTIATION_ATTEMPTS) {
+				//firmware doesn't support window, keep stop-and-wait
+				printString("ERROR: window negotiation timed out\r\n");
+				_scsWindowStage.state = SCS_WINDOW_REFUSED;
+				break;
+			}
+
+			unsigned char packet[SCS_WINDOW_PACKET_LENGTH];
+			unsigned char crcLow, crcHigh;
+
+			packet[0] = SCS_WINDOW_PACKET_TAG;
+			packet[1] = _scsWindowStage.requestedSize;
+			_calculateCrc16(packet, 2, &crcLow, &crcHigh);
+			packet[2] = crcLow;
+			packet[3] = crcHigh;
+			_putChars(packet, SCS_WINDOW_PACKET_LENGTH);
+
+			_scsWindowStage.negotiationAttempts++;
+			_scsWindowStage.negotiationTimeStamp = counter_get();
+			_scsWindowStage.state = SCS_WINDOW_NEGOTIATING;
+			printString("< W "); printHex(packet[1]); printString("\r\n");
+		}
+		break;
+		case SCS_WINDOW_AGREED:
+		{
+			if(_scsOutputStage.state == SCS_OUTPUT_IDLE)
+			{
+				//the last stop-and-wait packet has been acknowledged.
+				_scsWindowStage.oldestSlot = 0;
+				_scsWindowStage.slotAmount = 0;
+				_scsWindowStage.ackPending = false;
+				_scsWindowStage.state = SCS_WINDOW_ACTIVE;
+			}
+		}
+		break;
+		default:
+		{
+			//nothing to do
+		}
+		break;
+	}
+}
+
+//send out ACK, timed out packets and new packets in windowed exchange
+void CDataExchange::_processScsOutputStageWindowed(void)
+{
+	//ACK goes first so that firmware can release its packets as early as possible
+	if(_scsWindowStage.ackPending)
+	{
+		_putChars(_scsOutputStage.ackPktBuffer, SCS_ACK_PACKET_LENGTH);
+		_scsWindowStage.ackPending = false;
+		printString("< A "); printHex(_scsOutputStage.ackPktBuffer[1]); printString("\r\n");
+	}
+
+	//each packet in flight has its own timer.
+	//firmware drops packets following a lost one, so the timed out packet and all packets after it are sent again.
+	bool resending = false;
+	for(unsigned char i=0; i<_scsWindowStage.slotAmount; i++)
+	{
+		SCS_Window_Slot * pSlot = _scsWindowStage.slots + ((_scsWindowStage.oldestSlot + i) % SCS_WINDOW_MAX_SIZE);
+
+		if(!resending && (counter_diff(pSlot->timeStamp) > _scsOutputTimeout))
+		{
+			resending = true;
+			printString("ERROR: host ACK time out, "); printHex(pSlot->pktBuffer[1]); printString("\r\n");
+		}
+		if(resending)
+		{
+			_putChars(pSlot->pktBuffer, pSlot->pktBuffer[2] + SCS_DATA_PACKET_STAFF_LENGTH);
+			pSlot->timeStamp = counter_get();
+		}
+	}
+
+	//fill the window with new packets
+	while(_scsWindowStage.slotAmount < _scsWindowStage.size)
+	{
+		SCS_Window_Slot * pSlot = _scsWindowStage.slots + ((_scsWindowStage.oldestSlot + _scsWindowStage.slotAmount) % SCS_WINDOW_MAX_SIZE);
+		unsigned char packetLength = _fillDataPacket(pSlot->pktBuffer);
+
+		if(packetLength == 0) {
+			break; //no APP data need to be sent
+		}
+		_putChars(pSlot->pktBuffer, packetLength);
+		pSlot->timeStamp = counter_get();
+		_scsWindowStage.slotAmount++;
+		printString("< D "); printHex(pSlot->pktBuffer[1]); printString("\r\n");
+	}
+}
+
 //send out data in output stage as much as possible
 void CDataExchange::_processScsOutputStage(void)
 {
+	_processScsWindowNegotiation();
+	if(_scsWindowStage.state == SCS_WINDOW_ACTIVE) {
+		_processScsOutputStageWindowed();
+		return;
+	}
+
 	switch(_scsOutputStage.state)
 	{
 		case SCS_OUTPUT_IDLE:
@@ -441,6 +703,18 @@ void CDataExchange::initScsDataExchange(void)
 	_scsOutputStage.state = SCS_OUTPUT_IDLE;
 	_scsOutputStage.currentDataPktId = SCS_INVALID_PACKET_ID;
 	_scsOutputStage.ackedDataPktId = SCS_INVALID_PACKET_ID;
+
+	//window, disabled until SetWindowSize() is called
+	_scsWindowStage.state = SCS_WINDOW_DISABLED;
+	_scsWindowStage.requestedSize = 1;
+	_scsWindowStage.size = 1;
+	_scsWindowStage.negotiationAttempts = 0;
+	_scsWindowStage.linkUp = false;
+	_scsWindowStage.oldestSlot = 0;
+	_scsWindowStage.slotAmount = 0;
+	_scsWindowStage.ackPending = false;
+	_scsWindowStage.replySize = 1;
+	_scsWindowStage.replyPending = false;
 	
 	//monitor
 	_monitorOutputBufferConsumerIndex = 0;
@@ -536,17 +810,30 @@ CDataExchange::CDataExchange()
 	initScsDataExchange();
 }
 
-unsigned int CDataExchange::SendCommand(unsigned char * pData, unsigned int length)
+void CDataExchange::SetWindowSize(unsigned char size)
 {
-	if(incomingCmdData.size() > 0xFFFF) {
-		return 0;
+	if(size > SCS_WINDOW_MAX_SIZE) {
+		size = SCS_WINDOW_MAX_SIZE;
+	}
+	if(size < 1) {
+		size = 1;
 	}
 
-	for(int i=0; i<length; i++) {
-		incomingCmdData.push_back(pData[i]);
+	_scsWindowStage.requestedSize = size;
+	_scsWindowStage.state = (size > 1) ? SCS_WINDOW_UNNEGOTIATED : SCS_WINDOW_DISABLED;
+}
+
+unsigned int CDataExchange::SendCommand(const unsigned char * pData, unsigned int length, unsigned char terminator)
+{
+	//command is accepted as a whole, terminator is never separated from it.
+	if(incomingCmdData.size() + length + 1 > 0xFFFF) {
+		return 0;
 	}
 
-	return length;
+	incomingCmdData.insert(incomingCmdData.end(), pData, pData + length);
+	incomingCmdData.push_back(terminator);
+
+	return length + 1;
 }
 
 void CDataExchange::ClearCommand()
@@ -554,11 +841,9 @@ void CDataExchange::ClearCommand()
 	incomingCmdData.clear();
 }
 
-void CDataExchange::OnPacketReply(unsigned char * pData, unsigned int length)
+void CDataExchange::OnPacketReply(const unsigned char * pData, unsigned int length)
 {
-	for(int i=0; i<length; i++) {
-		incomingPacketData.push_back(pData[i]);
-	}
+	incomingPacketData.insert(incomingPacketData.end(), pData, pData + length);
 }
 
 bool CDataExchange::_calculateCrc16(unsigned char * pData, unsigned char length, unsigned char * pCrcLow, unsigned char * pCrcHigh)
@@ -18,15 +18,25 @@ public:
     CDataExchange();
     void Poll();
 
+    /**
+     * Request a sliding window of several outstanding data packets.
+     * The window is negotiated with the firmware once the link is up; if the firmware
+     * doesn't answer or refuses, stop-and-wait exchange is kept.
+     * Parameters:
+     * 		size: amount of packets which can be in flight, 1 disables the window
+     */
+    void SetWindowSize(unsigned char size);
+
     /**
      * Send a command string to the device.
      * Parameters:
      * 		pData: address of the command
      * 		length: length of command
+     * 		terminator: appended to the command
      * Return value:
-     * 		amount of bytes accepted.
+     * 		amount of bytes accepted, 0 if there isn't room for the whole command.
      */
-    unsigned int SendCommand(unsigned char * pData, unsigned int length);
+    unsigned int SendCommand(const unsigned char * pData, unsigned int length, unsigned char terminator);
     /**
      * delete any content which hasn't beeen sent.
      */
@@ -45,7 +55,7 @@ public:
      */
     void ConsumeCmdReply(unsigned int length);
 
-    void OnPacketReply(unsigned char * pData, unsigned int length);
+    void OnPacketReply(const unsigned char * pData, unsigned int length);
     unsigned int GetPacketData(unsigned char * pBuffer, unsigned int length);
     void ConsumePacketData(unsigned int length);
 
@@ -79,6 +89,23 @@ private:
         crcHigh		// 1 byte                                           
     */
     /************************************************************************/
+    #define SCS_WINDOW_PACKET_TAG 0xCC
+    /************************************************************************/
+    /*
+    Window negotiation packet structure:
+        0xCC		// 1 byte
+        windowSize	// 1 byte: 1 to SCS_WINDOW_MAX_SIZE, bit 7 is set in reply
+        crcLow      // 1 byte
+        crcHigh		// 1 byte
+
+    Host requests its window size, firmware replies with the window size it accepts.
+    Firmware not knowing this tag ignores the packet, and host keeps stop-and-wait.
+    In windowed exchange packets are still accepted in order only, and an ACK
+    acknowledges the packet of its id and all the packets sent before it.
+    A packet which has been received already is answered with an ACK of the latest
+    received packet id.
+    */
+    /************************************************************************/
     #define SCS_DATA_PACKET_STAFF_LENGTH 5 //tag, id, dataLength, crcLow, crcHigh
     #define SCS_DATA_MAX_LENGTH (SCS_PACKET_MAX_LENGTH - SCS_DATA_PACKET_STAFF_LENGTH)
     #define SCS_ACK_PACKET_LENGTH 4
@@ -86,6 +113,11 @@ private:
     #define SCS_DATA_OUTPUT_TIMEOUT 200 //milliseconds
     #define SCS_INITIAL_PACKET_ID 0 //this id is used only once at the launch of application
     #define SCS_INVALID_PACKET_ID 0xFF
+    #define SCS_WINDOW_PACKET_LENGTH 4
+    #define SCS_WINDOW_MAX_SIZE 8
+    #define SCS_WINDOW_REPLY_FLAG 0x80
+    #define SCS_WINDOW_NEGOTIATION_TIMEOUT 500 //milliseconds
+    #define SCS_WINDOW_NEGOTIATION_ATTEMPTS 3
 
     enum SCS_Input_Stage_State
     {
@@ -126,10 +158,46 @@ private:
         unsigned char ackPktSendingIndex; //index of byte to be sent
     };
 
+    enum SCS_Window_Stage_State
+    {
+        SCS_WINDOW_DISABLED = 0,
+        SCS_WINDOW_UNNEGOTIATED,
+        SCS_WINDOW_NEGOTIATING,
+        SCS_WINDOW_AGREED,
+        SCS_WINDOW_ACTIVE,
+        SCS_WINDOW_REFUSED
+    };
+
+    struct SCS_Window_Slot
+    {
+        unsigned char pktBuffer[SCS_PACKET_MAX_LENGTH];
+        unsigned short timeStamp; //when the packet was sent last time
+    };
+
+    struct SCS_Window_Stage
+    {
+        enum SCS_Window_Stage_State state;
+        unsigned char requestedSize;
+        unsigned char size; //negotiated window size
+        unsigned char negotiationAttempts;
+        unsigned short negotiationTimeStamp;
+        bool linkUp; //firmware has acknowledged a data packet
+        //packets in flight, from the oldest one
+        SCS_Window_Slot slots[SCS_WINDOW_MAX_SIZE];
+        unsigned char oldestSlot;
+        unsigned char slotAmount;
+        //acknowledge packet to be sent
+        bool ackPending;
+        //reply to window request of the other side
+        unsigned char replySize;
+        bool replyPending;
+    };
+
     SCS_Input_Stage _scsInputStage;
     unsigned short _scsInputTimeOut;
     SCS_Output_Stage _scsOutputStage;
     unsigned short _scsOutputTimeout;
+    SCS_Window_Stage _scsWindowStage;
 
     #define MONITOR_OUTPUT_BUFFER_LENGTH_MASK 0xFF
     unsigned char _monitorOutputBuffer[MONITOR_OUTPUT_BUFFER_LENGTH_MASK + 1];
@@ -143,6 +211,12 @@ private:
     void _on_inputStageAckPacketComplete(unsigned char packetId);
     void _on_inputStageDataPacketComplete(void);
     void _processScsOutputStageIdle(void);
+    unsigned char _nextDataPktId(void);
+    unsigned char _fillDataPacket(unsigned char * pPacket);
+    unsigned char _packetIdDistance(unsigned char fromId, unsigned char toId);
+    void _on_inputStageWindowPacketComplete(unsigned char windowSize);
+    void _processScsWindowNegotiation(void);
+    void _processScsOutputStageWindowed(void);
 
 	void _processScsInputStage();
 	void _processScsOutputStage();
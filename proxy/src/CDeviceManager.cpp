@@ -4,6 +4,7 @@
  *  Created on: Sep 17, 2018
  *      Author: user1
  */
+#include <string.h>
 #include "CDeviceManager.h"
 #include "Poco/JSON/Parser.h"
 #include "Poco/Dynamic/Var.h"
@@ -14,14 +15,19 @@
 #if defined(_WIN32) || defined(_WIN64)
 #include "WinComDevice.h"
 #else
-#include "LinuxComDevice.h"
+#include "LinuxComEngine.h"
 #endif
 
 extern ProxyLogger * pLogger;
+#if defined(_WIN32) || defined(_WIN64)
+#else
+extern LinuxComEngine * pComEngine;
+#endif
 
 CDeviceManager::CDeviceManager() : Task("CDeviceManager")
 {
 	_pObserver = NULL;
+	_dataExchangeWindow = 1;
 }
 
 CDeviceManager::~CDeviceManager() {
@@ -35,29 +41,28 @@ void CDeviceManager::SetObserver(IDeviceObserver * pObserver)
 	_pObserver = pObserver;
 }
 
-void CDeviceManager::SendCommand(const std::string& deviceName, const std::string& command)
+void CDeviceManager::SendCommand(const std::string& deviceName, const char * pCommand, unsigned int length)
 {
-	for(auto it=command.begin(); it!=command.end(); it++) {
-		if((*it < ' ') || (*it > '~')) {
-			pLogger->LogError("CDeviceManager::SendCommand illegal character in command: " + deviceName + ":" + command);
+	for(unsigned int i=0; i<length; i++) {
+		if((pCommand[i] < ' ') || (pCommand[i] > '~')) {
+			pLogger->LogError("CDeviceManager::SendCommand illegal character in command: " + deviceName + ":" + std::string(pCommand, length));
 			return;
 		}
 	}
 
-	lockMutex("CDeviceManager::SendCommand", "enqueue command: " + deviceName + " : " + command);
+	lockMutex("CDeviceManager::SendCommand", deviceName);
 
 	auto it = _devices.begin();
 	for(; it != _devices.end(); it++) {
 		if(it->state == DeviceState::ACTIVE) {
 			if(it->deviceName == deviceName) {
-				pLogger->LogDebug("CDeviceManager enqueue command: " + deviceName + ":" + command);
-				enqueueCommand(*it, command);
+				enqueueCommand(*it, pCommand, length);
 				break;
 			}
 		}
 	}
 	if(it == _devices.end()) {
-		pLogger->LogError("CDeviceManager::SendCommand failed in sending: " + deviceName + ":" + command);
+		pLogger->LogError("CDeviceManager::SendCommand failed in sending: " + deviceName + ":" + std::string(pCommand, length));
 	}
 
 	unlockMutex();
@@ -82,6 +87,21 @@ void CDeviceManager::AddDeviceFile(const std::string & deviceFilePath)
 	}
 }
 
+void CDeviceManager::SetDataExchangeWindow(int windowSize)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	//limited before it is narrowed to a byte
+	if(windowSize > SCS_WINDOW_MAX_SIZE) {
+		windowSize = SCS_WINDOW_MAX_SIZE;
+	}
+	if(windowSize < 1) {
+		windowSize = 1;
+	}
+	_dataExchangeWindow = windowSize;
+	pLogger->LogInfo("CDeviceManager::SetDataExchangeWindow window size: " + std::to_string(windowSize));
+}
+
 void CDeviceManager::lockMutex(const std::string & functionName, const std::string & purpose)
 {
 	do
@@ -191,14 +211,9 @@ void CDeviceManager::onReply(struct Device& device, const std::string& reply)
 }
 
 //read data from device
-void CDeviceManager::onDeviceCanBeRead(struct Device& device, std::deque<unsigned char> & reply)
+void CDeviceManager::onDeviceCanBeRead(struct Device& device, const unsigned char * pData, unsigned int length)
 {
-	for(; reply.empty() == false; )
-	{
-		unsigned char c = reply.front();
-		device.dataExchange.OnPacketReply(&c, 1);
-		reply.pop_front();
-	}
+	device.dataExchange.OnPacketReply(pData, length);
 }
 
 void CDeviceManager::enqueueCommand(struct Device& device, const char * pCommand)
@@ -207,43 +222,42 @@ void CDeviceManager::enqueueCommand(struct Device& device, const char * pCommand
 		return;
 	}
 
-	std::string command(pCommand);
-	enqueueCommand(device, command);
+	enqueueCommand(device, pCommand, strlen(pCommand));
 }
 
-void CDeviceManager::enqueueCommand(struct Device& device, const std::string command)
+void CDeviceManager::enqueueCommand(struct Device& device, const std::string& command)
 {
-	std::vector<unsigned char> array;
+	enqueueCommand(device, command.data(), command.size());
+}
 
-	if(command.size() < 1) {
+void CDeviceManager::enqueueCommand(struct Device& device, const char * pCommand, unsigned int length)
+{
+	if(length < 1) {
 		pLogger->LogError("CDeviceManager::enqueueCommand empty command to device: " + device.fileName);
 		return;
 	}
 
-	pLogger->LogDebug("CDeviceManager::enqueueCommand enqueue command: " + device.fileName + " : " + command);
-	for(auto it=command.begin(); it!=command.end(); it++)
-	{
-		array.push_back(*it);
+	if(pLogger->IsTraceEnabled()) {
+		pLogger->LogTrace("CDeviceManager::enqueueCommand enqueue command: " + device.fileName + " : " + std::string(pCommand, length));
+	}
+	if(device.dataExchange.SendCommand((const unsigned char *)pCommand, length, COMMAND_TERMINATER) == 0) {
+		pLogger->LogError("CDeviceManager::enqueueCommand command buffer is full: " + device.fileName);
 	}
-	array.push_back(COMMAND_TERMINATER);
-
-	device.dataExchange.SendCommand(array.data(), array.size());
 }
 
 //write a command to device
 void CDeviceManager::onDeviceCanBeWritten(struct Device& device, ILowlevelDevice * pLowlevelDevice)
 {
 	unsigned char buffer[256];
-	int size;
-	std::vector<unsigned char> data;
+	unsigned int size;
 	std::string info;
 
 	size = device.dataExchange.GetPacketData(buffer, 256);
-	for(int i=0; i<size; i++) {
-		data.push_back(buffer[i]);
+	if(size == 0) {
+		return;
 	}
 
-	if(pLowlevelDevice->SendData(data, info) == true) {
+	if(pLowlevelDevice->SendData(buffer, size, info) == true) {
 		device.dataExchange.ConsumePacketData(size);
 	}
 	else {
@@ -287,6 +301,7 @@ void CDeviceManager::onLowlevelDeviceState(const std::string & deviceName, const
 
 			device.fileName = deviceName;
 			device.state = DeviceState::OPENED;
+			device.dataExchange.SetWindowSize(_dataExchangeWindow);
 
 			_devices.push_back(device);
 		}
@@ -329,7 +344,7 @@ void CDeviceManager::onLowlevelDeviceWritable(const std::string & deviceName, IL
 	unlockMutex();
 }
 
-void CDeviceManager::onLowlevelDeviceReply(const std::string & deviceName, std::deque<unsigned char> & data)
+void CDeviceManager::onLowlevelDeviceReply(const std::string & deviceName, const unsigned char * pData, unsigned int length)
 {
 	lockMutex("CDeviceManager::onLowlevelDeviceReply", deviceName);
 
@@ -337,7 +352,7 @@ void CDeviceManager::onLowlevelDeviceReply(const std::string & deviceName, std::
 	{
 		if(deviceName == it->fileName)
 		{
-			onDeviceCanBeRead(*it, data);
+			onDeviceCanBeRead(*it, pData, length);
 			break;
 		}
 	}
@@ -394,6 +409,20 @@ void CDeviceManager::pollDevices()
 
 		deviceIt->dataExchange.Poll();
 
+		//ask low level device for writing if there is data for device
+		if(deviceIt->dataExchange.GetPacketData(buffer, 1) > 0)
+		{
+			auto lowlevelIt = _lowlevelDevices.find(deviceIt->fileName);
+			if(lowlevelIt != _lowlevelDevices.end()) {
+				lowlevelIt->second->RequestWriting();
+			}
+		}
+		else
+		{
+			//nothing to write, device isn't expected to be writable
+			deviceIt->writeStamp.update();
+		}
+
 		//get reply to command
 		for(;;)
 		{
@@ -506,28 +535,28 @@ void CDeviceManager::runTask()
 
 	//launch low level devices
 	{
-		std::vector<ILowlevelDevice *> taskVector;
 		for(unsigned int i=0; i<_deviceFiles.size(); i++)
 		{
-			ILowlevelDevice * pLowlevelDevice = nullptr;
-
 #if defined(_WIN32) || defined(_WIN64)
-			pLowlevelDevice = new WinComDevice(_deviceFiles[i], this);
+			auto pLowlevelDevice = new WinComDevice(_deviceFiles[i], this);
 #else
-			pLowlevelDevice = new LinuxComDevice(_deviceFiles[i], this);
+			auto pLowlevelDevice = new LinuxComDevice(_deviceFiles[i], this);
 #endif
 
 			if(pLowlevelDevice == nullptr) {
 				pLogger->LogError("CDeviceManager::runTask() failed to launch: " + _deviceFiles[i]);
+				continue;
 			}
-			else {
-				taskVector.push_back(pLowlevelDevice);
-			}
-		}
 
-		for(unsigned int i=0; i<taskVector.size(); i++)
-		{
-			_tm.start(taskVector[i]);
+			lockMutex("CDeviceManager::runTask", "add low level device");
+			_lowlevelDevices[_deviceFiles[i]] = pLowlevelDevice;
+			unlockMutex();
+
+#if defined(_WIN32) || defined(_WIN64)
+			_tm.start(pLowlevelDevice);
+#else
+			pComEngine->AddDevice(pLowlevelDevice);
+#endif
 		}
 	}
 
@@ -559,8 +588,29 @@ void CDeviceManager::runTask()
 	}
 
 	pLogger->LogInfo("CDeviceManager::runTask stopping low level devices...");
+#if defined(_WIN32) || defined(_WIN64)
 	_tm.cancelAll();
 	_tm.joinAll();
+	//devices are deleted by task manager
+	lockMutex("CDeviceManager::runTask", "clear low level devices");
+	_lowlevelDevices.clear();
+	unlockMutex();
+#else
+	{
+		std::map<std::string, ILowlevelDevice *> lowlevelDevices;
+
+		lockMutex("CDeviceManager::runTask", "clear low level devices");
+		lowlevelDevices.swap(_lowlevelDevices);
+		unlockMutex();
+
+		for(auto it = lowlevelDevices.begin(); it != lowlevelDevices.end(); it++)
+		{
+			auto pLowlevelDevice = static_cast<LinuxComDevice *>(it->second);
+			pComEngine->RemoveDevice(pLowlevelDevice);
+			delete pLowlevelDevice;
+		}
+	}
+#endif
 
 	pLogger->LogInfo("CDeviceManager::runTask exited");
 }
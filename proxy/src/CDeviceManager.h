@@ -37,14 +37,17 @@ public:
 
 	void SetObserver(IDeviceObserver * pObserver);
 	void AddDeviceFile(const std::string & deviceFilePath);
+	// amount of data packets which can be in flight to a device, 1 means stop-and-wait
+	// it is limited to 1 to SCS_WINDOW_MAX_SIZE.
+	void SetDataExchangeWindow(int windowSize);
 
 private:
 	// Called by DeviceSocketMapping object to send a command to device.
-	virtual void SendCommand(const std::string& deviceName, const std::string& command) override;
+	virtual void SendCommand(const std::string& deviceName, const char * pCommand, unsigned int length) override;
 
 	virtual void onLowlevelDeviceState(const std::string & deviceName, const LowlevelDeviceState state, const std::string & info) override;
 	virtual void onLowlevelDeviceWritable(const std::string & deviceName, ILowlevelDevice * pLowlevelDevice) override;
-	virtual void onLowlevelDeviceReply(const std::string & deviceName, std::deque<unsigned char> & data) override;
+	virtual void onLowlevelDeviceReply(const std::string & deviceName, const unsigned char * pData, unsigned int length) override;
 
 	void runTask();
 
@@ -69,6 +72,7 @@ private:
 	};
 
 	std::vector<std::string> _deviceFiles;
+	unsigned char _dataExchangeWindow;
 
 	struct Device
 	{
@@ -92,18 +96,20 @@ private:
 	};
 
 	std::vector<struct Device> _devices;
+	std::map<std::string, ILowlevelDevice *> _lowlevelDevices; //low level devices indexed by device file name
 
 	void lockMutex(const std::string & functionName, const std::string & purpose);
 	void unlockMutex();
 
 	void onReply(struct Device& device, const std::string& reply);
-	void onDeviceCanBeRead(struct Device& device, std::deque<unsigned char> & reply);
+	void onDeviceCanBeRead(struct Device& device, const unsigned char * pData, unsigned int length);
 	void onDeviceCanBeWritten(struct Device& device, ILowlevelDevice * pLowlevelDevice);
 	void onDeviceError(struct Device& device, const std::string & errorInfo);
 	void pollDevices();
 
 	void enqueueCommand(struct Device& device, const char * pCommand);
-	void enqueueCommand(struct Device& device, const std::string command);
+	void enqueueCommand(struct Device& device, const std::string& command);
+	void enqueueCommand(struct Device& device, const char * pCommand, unsigned int length);
 
 	IDeviceObserver * _pObserver;
 	Poco::TaskManager _tm;
@@ -7,45 +7,32 @@
 
 #if defined(_WIN32) || defined(_WIN64)
 #else
-#include "LinuxComDevice.h"
+#include "LinuxComEngine.h"
 #endif
 
 #include "ProxyLogger.h"
 #include "CDeviceMonitor.h"
 
 extern ProxyLogger * pLogger;
+#if defined(_WIN32) || defined(_WIN64)
+#else
+extern LinuxComEngine * pComEngine;
+#endif
 
 CDeviceMonitor::CDeviceMonitor(const std::string& filePath): Task("CDeviceMonitor")
 {
 	_deviceFile = filePath;
 }
 
-void CDeviceMonitor::onMonitorCanBeRead(std::deque<unsigned char> & reply)
+void CDeviceMonitor::onMonitorCanBeRead(const unsigned char * pData, unsigned int length)
 {
-	memset(_buffer, 0, BUFFER_LENGTH);
-
-	int amount = 0;
-	for(unsigned int i=0; (i<BUFFER_LENGTH) && (!reply.empty()); i++) {
-		_buffer[i] = reply[0];
-		reply.pop_front();
-		amount++;
-	}
-
-	if(amount == 0) {
+	if(length == 0) {
 		pLogger->LogError("CDeviceMonitor::onMonitorCanBeRead ERROR: EOF is returned " + _deviceFile);
 	}
 	else
 	{
-		pLogger->LogInfo("CDeviceMonitor::onMonitorCanBeRead " + std::to_string(amount) + " bytes from: " + _deviceFile);
-//		for(int i=0; i<amount; i++)
-//		{
-//			char buf[32];
-//
-//			sprintf(buf, "%02x,", _buffer[i]);
-//			outputStr = outputStr + std::string(buf);
-//		}
-//		pLogger->LogInfo("CDeviceMonitor::onMonitorCanBeRead hex content: " + outputStr);
-		pLogger->LogInfo("CDeviceMonitor::onMonitorCanBeRead " + _deviceFile + ", char content: " + std::string((char *)_buffer));
+		//monitor output is what the monitor is for, it is always logged.
+		pLogger->LogInfo("CDeviceMonitor::onMonitorCanBeRead " + _deviceFile + " " + std::to_string(length) + " bytes, char content: " + std::string((const char *)pData, length));
 	}
 }
 
@@ -61,10 +48,10 @@ void CDeviceMonitor::onLowlevelDeviceWritable(const std::string & deviceName, IL
 
 }
 
-void CDeviceMonitor::onLowlevelDeviceReply(const std::string & deviceName, std::deque<unsigned char> & data)
+void CDeviceMonitor::onLowlevelDeviceReply(const std::string & deviceName, const unsigned char * pData, unsigned int length)
 {
 	if(deviceName == _deviceFile) {
-		onMonitorCanBeRead(data);
+		onMonitorCanBeRead(pData, length);
 	}
 	else {
 		pLogger->LogError("CDeviceMonitor::onLowlevelDeviceReply wrong monitor name: " + deviceName);
@@ -74,8 +61,6 @@ void CDeviceMonitor::onLowlevelDeviceReply(const std::string & deviceName, std::
 
 void CDeviceMonitor::runTask()
 {
-	bool monitorOpened = false;
-
 	pLogger->LogInfo("CDeviceMonitor::runTask start");
 
 	if(_deviceFile.empty()) {
@@ -83,24 +68,13 @@ void CDeviceMonitor::runTask()
 	}
 	else
 	{
-		ILowlevelDevice * pLowlevelDevice = nullptr;
-
 #if defined(_WIN32) || defined(_WIN64)
+		pLogger->LogError("CDeviceMonitor::runTask() monitor isn't supported: " + _deviceFile);
 #else
-		pLowlevelDevice = new LinuxComDevice(_deviceFile, this);
-#endif
+		auto pLowlevelDevice = new LinuxComDevice(_deviceFile, this);
 
-		if(pLowlevelDevice == nullptr) {
-			pLogger->LogError("CDeviceMonitor::runTask() failed to launch: " + _deviceFile);
-		}
-		else {
-			_tm.start(pLowlevelDevice);
-			monitorOpened =  true;
-		}
-	}
-
-	if(monitorOpened)
-	{
+		//monitor device file is served in LinuxComEngine's thread
+		pComEngine->AddDevice(pLowlevelDevice);
 		while(1)
 		{
 			if(isCancelled()) {
@@ -113,8 +87,9 @@ void CDeviceMonitor::runTask()
 		}
 
 		pLogger->LogInfo("CDeviceMonitor::runTask() stopping low level device " + _deviceFile);
-		_tm.cancelAll();
-		_tm.joinAll();
+		pComEngine->RemoveDevice(pLowlevelDevice);
+		delete pLowlevelDevice;
+#endif
 	}
 
 	pLogger->LogInfo("CDeviceMonitor::runTask exited");
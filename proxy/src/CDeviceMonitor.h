@@ -12,7 +12,6 @@
 #include <deque>
 #include <string>
 #include "Poco/Task.h"
-#include "Poco/TaskManager.h"
 #include "Poco/Mutex.h"
 #include "Poco/Timestamp.h"
 #include "ILowlevelDevice.h"
@@ -27,15 +26,11 @@ private:
 
 	virtual void onLowlevelDeviceState(const std::string & deviceName, const LowlevelDeviceState state, const std::string & info) override;
 	virtual void onLowlevelDeviceWritable(const std::string & deviceName, ILowlevelDevice * pLowlevelDevice) override;
-	virtual void onLowlevelDeviceReply(const std::string & deviceName, std::deque<unsigned char> & data) override;
+	virtual void onLowlevelDeviceReply(const std::string & deviceName, const unsigned char * pData, unsigned int length) override;
 
-	void onMonitorCanBeRead(std::deque<unsigned char> & reply);
+	void onMonitorCanBeRead(const unsigned char * pData, unsigned int length);
 
 	std::string _deviceFile;
-	static const int BUFFER_LENGTH = 1024;
-	unsigned char _buffer[BUFFER_LENGTH];
-
-	Poco::TaskManager _tm;
 };
 
 #endif /* CDEVICEMONITOR_H_ */
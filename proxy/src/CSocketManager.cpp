@@ -6,6 +6,12 @@
  */
 
 #include <stddef.h>
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 #include "Poco/Timespan.h"
 #include "Poco/Net/Socket.h"
 #include "Poco/Net/NetException.h"
@@ -21,11 +27,69 @@ CSocketManager::CSocketManager():Task("SocketManager")
 {
 	_pDevice = NULL;
 	_lastSocketId = STARTING_SOCKET_ID;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	_wakeupFd = -1;
+	_epollFd = epoll_create1(0);
+	if(_epollFd < 0) {
+		pLogger->LogError("CSocketManager::CSocketManager failed to create epoll, errno: " + std::to_string(errno));
+	}
+	else
+	{
+		_wakeupFd = eventfd(0, EFD_NONBLOCK);
+		if(_wakeupFd < 0) {
+			pLogger->LogError("CSocketManager::CSocketManager failed to create eventfd, errno: " + std::to_string(errno));
+		}
+		else
+		{
+			struct epoll_event event;
+
+			event.events = EPOLLIN;
+			event.data.u64 = INVALID_SOCKET_ID;
+			if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeupFd, &event) != 0) {
+				pLogger->LogError("CSocketManager::CSocketManager failed to watch eventfd, errno: " + std::to_string(errno));
+			}
+		}
+
+		if(_wakeupFd < 0) {
+			//socket loop falls back to polling
+			::close(_epollFd);
+			_epollFd = -1;
+		}
+	}
+#endif
 }
 
 CSocketManager::~CSocketManager()
 {
-	// TODO Auto-generated destructor stub
+#if !defined(_WIN32) && !defined(_WIN64)
+	if(_wakeupFd >= 0) {
+		::close(_wakeupFd);
+	}
+	if(_epollFd >= 0) {
+		::close(_epollFd);
+	}
+#endif
+}
+
+void CSocketManager::cancel()
+{
+	Task::cancel();
+	wakeup();
+}
+
+void CSocketManager::wakeup()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if(_wakeupFd >= 0)
+	{
+		uint64_t value = 1;
+
+		if(::write(_wakeupFd, &value, sizeof(value)) != sizeof(value)) {
+			//counter is saturated, socket loop will wake up anyway.
+		}
+	}
+#endif
 }
 
 void CSocketManager::SetDevice(IDevice * pDevice)
@@ -74,6 +138,8 @@ void CSocketManager::OnDeviceUnplugged(const std::string& deviceName)
 	lockMutex("CSocketManager::OnDeviceUnplugged", "");
 	_unpluggedDevices.push_back(deviceName);
 	unlockMutex();
+
+	wakeup();
 }
 
 void CSocketManager::OnDeviceReply(const std::string& deviceName, const std::string& reply)
@@ -90,6 +156,9 @@ void CSocketManager::OnDeviceReply(const std::string& deviceName, const std::str
 	}
 
 	unlockMutex();
+
+	//reply is sent to socket as soon as it arrives.
+	wakeup();
 }
 
 void CSocketManager::onDeviceUnpluged(long long socketId)
@@ -226,12 +295,17 @@ void CSocketManager::AddSocket(StreamSocket& socket)
 	pLogger->LogInfo("CSocketManager::AddSocket socket received: " + socket.peerAddress().toString() + " socketId: " + std::to_string(wrapper.socketId));
 
 	_sockets.push_back(wrapper);
+#if !defined(_WIN32) && !defined(_WIN64)
+	watchSocket(wrapper);
+#endif
 
 	unlockMutex();
+
+	wakeup();
 }
 
 //retrieve commands from data
-void CSocketManager::retrieveCommands(std::deque<unsigned char>& data, std::vector<std::string>& jsonCommands)
+void CSocketManager::retrieveCommands(MsgFramer& data, std::vector<std::string>& jsonCommands)
 {
 	CommandFactory::RetrieveCommand(data, jsonCommands);
 }
@@ -264,6 +338,10 @@ void CSocketManager::onCommand(struct SocketWrapper& socketWrapper, const std::s
 		onCommandDeviceQueryFuse(socketWrapper, translator.GetCommandDeviceQueryFuse());
 		break;
 
+	case CommandType::DeviceQueryStatus:
+		onCommandDeviceQueryStatus(socketWrapper, translator.GetCommandDeviceQueryStatus());
+		break;
+
 	case CommandType::OptPowerOn:
 		onCommandOptPowerOn(socketWrapper, translator.GetCommandOptPowerOn());
 		break;
@@ -396,10 +474,19 @@ void CSocketManager::onCommand(struct SocketWrapper& socketWrapper, const std::s
 		onCommandSolenoidActivate(socketWrapper, translator.GetCommandSolenoidActivate());
 		break;
 
-	case CommandType::Invalid:
+	case CommandType::SteppersMove:
+		onCommandSteppersMove(socketWrapper, translator.GetCommandSteppersMove());
+		break;
+
+	case CommandType::MacroUpload:
+		onCommandMacroUpload(socketWrapper, translator.GetCommandMacroUpload());
 		break;
 
-	default:
+	case CommandType::MacroRun:
+		onCommandMacroRun(socketWrapper, translator.GetCommandMacroRun());
+		break;
+
+	case CommandType::Invalid:
 		break;
 	}
 }
@@ -474,16 +561,23 @@ void CSocketManager::onCommandDeviceConnect(struct SocketWrapper& socketWrapper,
 	}
 }
 
-void CSocketManager::sendTranslatedCommandToDevice(long long socketId, const std::string& cmdString)
+void CSocketManager::sendCommandTextToDevice(long long socketId, const DeviceCommandText& text)
 {
+	if(text.Overflow()) {
+		pLogger->LogError("CSocketManager::"  + std::string(__FUNCTION__) + " command is too long, socketId: " + std::to_string(socketId));
+		return;
+	}
+
 	auto deviceIt = _deviceMap.begin();
 	for(; deviceIt!=_deviceMap.end(); deviceIt++)
 	{
 		if(deviceIt->second.socketId == socketId)
 		{
-			pLogger->LogInfo("CSocketManager::"  + std::string(__FUNCTION__) + " " + cmdString + " >> " + deviceIt->first);
 			auto& deviceName = deviceIt->first;
-			_pDevice->SendCommand(deviceName, cmdString);
+			if(pLogger->IsTraceEnabled()) {
+				pLogger->LogTrace("CSocketManager::"  + std::string(__FUNCTION__) + " " + text.ToString() + " >> " + deviceName);
+			}
+			_pDevice->SendCommand(deviceName, text.Data(), text.Length());
 			break;
 		}
 	}
@@ -499,7 +593,7 @@ void CSocketManager::onCommandDeviceDelay(struct SocketWrapper& socketWrapper, s
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandDeviceQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryPower> cmdPtr)
@@ -509,7 +603,7 @@ void CSocketManager::onCommandDeviceQueryPower(struct SocketWrapper& socketWrapp
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandDeviceQueryFuse(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryFuse> cmdPtr)
@@ -519,7 +613,17 @@ void CSocketManager::onCommandDeviceQueryFuse(struct SocketWrapper& socketWrappe
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
+}
+
+void CSocketManager::onCommandDeviceQueryStatus(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryStatus> cmdPtr)
+{
+	if(cmdPtr == nullptr) {
+		pLogger->LogError("CSocketManager::"  + std::string(__FUNCTION__) + " failed in translating JSON");
+		return;
+	}
+
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcsPowerOn(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsPowerOn> cmdPtr)
@@ -529,7 +633,7 @@ void CSocketManager::onCommandBdcsPowerOn(struct SocketWrapper& socketWrapper, s
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcsPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsPowerOff> cmdPtr)
@@ -539,7 +643,7 @@ void CSocketManager::onCommandBdcsPowerOff(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcsQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsQueryPower> cmdPtr)
@@ -549,7 +653,7 @@ void CSocketManager::onCommandBdcsQueryPower(struct SocketWrapper& socketWrapper
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcCoast(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcCoast> cmdPtr)
@@ -559,7 +663,7 @@ void CSocketManager::onCommandBdcCoast(struct SocketWrapper& socketWrapper, std:
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcReverse(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcReverse> cmdPtr)
@@ -569,7 +673,7 @@ void CSocketManager::onCommandBdcReverse(struct SocketWrapper& socketWrapper, st
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcForward(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcForward> cmdPtr)
@@ -579,7 +683,7 @@ void CSocketManager::onCommandBdcForward(struct SocketWrapper& socketWrapper, st
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcBreak(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcBreak> cmdPtr)
@@ -589,7 +693,7 @@ void CSocketManager::onCommandBdcBreak(struct SocketWrapper& socketWrapper, std:
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandBdcQuery(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcQuery> cmdPtr)
@@ -599,7 +703,7 @@ void CSocketManager::onCommandBdcQuery(struct SocketWrapper& socketWrapper, std:
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandSteppersPowerOn(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSteppersPowerOn> cmdPtr)
@@ -609,7 +713,7 @@ void CSocketManager::onCommandSteppersPowerOn(struct SocketWrapper& socketWrappe
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandSteppersPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSteppersPowerOff> cmdPtr)
@@ -619,7 +723,7 @@ void CSocketManager::onCommandSteppersPowerOff(struct SocketWrapper& socketWrapp
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandSteppersQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSteppersQueryPower> cmdPtr)
@@ -629,7 +733,7 @@ void CSocketManager::onCommandSteppersQueryPower(struct SocketWrapper& socketWra
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperQueryResolution(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperQueryResolution> cmdPtr)
@@ -639,7 +743,7 @@ void CSocketManager::onCommandStepperQueryResolution(struct SocketWrapper& socke
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperConfigStep(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperConfigStep> cmdPtr)
@@ -649,7 +753,7 @@ void CSocketManager::onCommandStepperConfigStep(struct SocketWrapper& socketWrap
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperAccelerationBuffer(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperAccelerationBuffer> cmdPtr)
@@ -659,7 +763,7 @@ void CSocketManager::onCommandStepperAccelerationBuffer(struct SocketWrapper& so
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperAccelerationBufferDecrement(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperAccelerationBufferDecrement> cmdPtr)
@@ -669,7 +773,7 @@ void CSocketManager::onCommandStepperAccelerationBufferDecrement(struct SocketWr
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperDecelerationBuffer(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperDecelerationBuffer> cmdPtr)
@@ -679,7 +783,7 @@ void CSocketManager::onCommandStepperDecelerationBuffer(struct SocketWrapper& so
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperDecelerationBufferIncrement(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperDecelerationBufferIncrement> cmdPtr)
@@ -689,7 +793,7 @@ void CSocketManager::onCommandStepperDecelerationBufferIncrement(struct SocketWr
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperEnable(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperEnable> cmdPtr)
@@ -699,7 +803,7 @@ void CSocketManager::onCommandStepperEnable(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperForward(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperForward> cmdPtr)
@@ -709,7 +813,7 @@ void CSocketManager::onCommandStepperForward(struct SocketWrapper& socketWrapper
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperSteps(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperSteps> cmdPtr)
@@ -719,7 +823,7 @@ void CSocketManager::onCommandStepperSteps(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperRun(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperRun> cmdPtr)
@@ -729,7 +833,7 @@ void CSocketManager::onCommandStepperRun(struct SocketWrapper& socketWrapper, st
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperConfigHome(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperConfigHome> cmdPtr)
@@ -739,7 +843,7 @@ void CSocketManager::onCommandStepperConfigHome(struct SocketWrapper& socketWrap
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperQuery(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperQuery> cmdPtr)
@@ -749,7 +853,7 @@ void CSocketManager::onCommandStepperQuery(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperSetState(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperSetState> cmdPtr)
@@ -759,7 +863,7 @@ void CSocketManager::onCommandStepperSetState(struct SocketWrapper& socketWrappe
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandStepperForwardClockwise(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandStepperForwardClockwise> cmdPtr)
@@ -769,7 +873,7 @@ void CSocketManager::onCommandStepperForwardClockwise(struct SocketWrapper& sock
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandLocatorQuery(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandLocatorQuery> cmdPtr)
@@ -779,7 +883,7 @@ void CSocketManager::onCommandLocatorQuery(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandSolenoidActivate(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSolenoidActivate> cmdPtr)
@@ -789,7 +893,37 @@ void CSocketManager::onCommandSolenoidActivate(struct SocketWrapper& socketWrapp
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
+}
+
+void CSocketManager::onCommandSteppersMove(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSteppersMove> cmdPtr)
+{
+	if(cmdPtr == nullptr) {
+		pLogger->LogError("CSocketManager::"  + std::string(__FUNCTION__) + " failed in translating JSON");
+		return;
+	}
+
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
+}
+
+void CSocketManager::onCommandMacroUpload(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandMacroUpload> cmdPtr)
+{
+	if(cmdPtr == nullptr) {
+		pLogger->LogError("CSocketManager::"  + std::string(__FUNCTION__) + " failed in translating JSON");
+		return;
+	}
+
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
+}
+
+void CSocketManager::onCommandMacroRun(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandMacroRun> cmdPtr)
+{
+	if(cmdPtr == nullptr) {
+		pLogger->LogError("CSocketManager::"  + std::string(__FUNCTION__) + " failed in translating JSON");
+		return;
+	}
+
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandOptPowerOn(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandOptPowerOn> cmdPtr)
@@ -799,7 +933,7 @@ void CSocketManager::onCommandOptPowerOn(struct SocketWrapper& socketWrapper, st
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandOptPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandOptPowerOff> cmdPtr)
@@ -809,7 +943,7 @@ void CSocketManager::onCommandOptPowerOff(struct SocketWrapper& socketWrapper, s
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandOptQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandOptQueryPower> cmdPtr)
@@ -819,7 +953,7 @@ void CSocketManager::onCommandOptQueryPower(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandDcmPowerOn(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDcmPowerOn> cmdPtr)
@@ -829,7 +963,7 @@ void CSocketManager::onCommandDcmPowerOn(struct SocketWrapper& socketWrapper, st
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandDcmPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDcmPowerOff> cmdPtr)
@@ -839,7 +973,7 @@ void CSocketManager::onCommandDcmPowerOff(struct SocketWrapper& socketWrapper, s
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 void CSocketManager::onCommandDcmQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDcmQueryPower> cmdPtr)
@@ -849,7 +983,7 @@ void CSocketManager::onCommandDcmQueryPower(struct SocketWrapper& socketWrapper,
 		return;
 	}
 
-	sendTranslatedCommandToDevice(socketWrapper.socketId, cmdPtr->ToString());
+	sendTranslatedCommandToDevice(socketWrapper.socketId, *cmdPtr);
 }
 
 
@@ -891,9 +1025,7 @@ void CSocketManager::onSocketReadable(struct SocketWrapper& socketWrapper)
 					pLogger->LogInfo(buf);
 
 					receivingError = false;
-					for(int i=0; i<dataRead; i++) {
-						socketWrapper.incoming.push_back(buffer[i]); //save data to incoming stage.
-					}
+					socketWrapper.incoming.Append(buffer, dataRead); //save data to incoming stage.
 				}
 			}
 			catch(Poco::TimeoutException& e)
@@ -930,7 +1062,7 @@ void CSocketManager::onSocketReadable(struct SocketWrapper& socketWrapper)
 	if(socketWrapper.state == SocketState::TO_BE_CLOSED) {
 		return;
 	}
-	if(socketWrapper.incoming.size() < 1) {
+	if(socketWrapper.incoming.Empty()) {
 		return; //no input in incoming stage.
 	}
 
@@ -1175,8 +1307,116 @@ void CSocketManager::pollSockets()
 	}
 }
 
+#if !defined(_WIN32) && !defined(_WIN64)
+void CSocketManager::watchSocket(struct SocketWrapper& socketWrapper)
+{
+	if(_epollFd < 0) {
+		return;
+	}
+
+	//edge triggered: onSocketReadable and onSocketWritable go on until socket would block.
+	struct epoll_event event;
+
+	event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	event.data.u64 = socketWrapper.socketId;
+	if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, socketWrapper.socket.impl()->sockfd(), &event) != 0) {
+		pLogger->LogError("CSocketManager::watchSocket failed to watch socket: " + std::to_string(socketWrapper.socketId) + ", errno: " + std::to_string(errno));
+	}
+}
+
+//write pending replies/events to sockets.
+//socket which cannot accept all data is written again when EPOLLOUT arrives.
+void CSocketManager::flushSockets()
+{
+	lockMutex("CSocketManager::flushSockets", "write socket");
+
+	for(auto it = _sockets.begin(); it != _sockets.end(); it++)
+	{
+		if((it->state == SocketState::ACTIVE) && !it->outgoing.empty()) {
+			onSocketWritable(*it);
+		}
+	}
+
+	unlockMutex();
+}
+
+void CSocketManager::runReactor()
+{
+	struct epoll_event events[EPOLL_EVENT_AMOUNT];
+
+	pLogger->LogInfo("CSocketManager::runReactor starts");
+
+	while(!isCancelled())
+	{
+		int amount = epoll_wait(_epollFd, events, EPOLL_EVENT_AMOUNT, EPOLL_WAIT_TIMEOUT);
+
+		if(amount < 0)
+		{
+			if(errno != EINTR) {
+				pLogger->LogError("CSocketManager::runReactor epoll_wait failed, errno: " + std::to_string(errno));
+				sleep(10);
+			}
+			continue;
+		}
+
+		for(int i=0; i<amount; i++)
+		{
+			long socketId = (long)events[i].data.u64;
+			struct SocketWrapper * pWrapper = nullptr;
+
+			if(socketId == INVALID_SOCKET_ID)
+			{
+				uint64_t value;
+
+				//reset eventfd counter
+				if(::read(_wakeupFd, &value, sizeof(value)) != sizeof(value)) {
+					//already reset
+				}
+				continue;
+			}
+
+			lockMutex("CSocketManager::runReactor", "find socket");
+			for(auto wrapperIt = _sockets.begin(); wrapperIt != _sockets.end(); wrapperIt++)
+			{
+				if(wrapperIt->socketId == socketId) {
+					pWrapper = &(*wrapperIt);
+					break;
+				}
+			}
+			if((pWrapper != nullptr) && (events[i].events & (EPOLLERR | EPOLLHUP))) {
+				onSocketError(*pWrapper);
+				pWrapper = nullptr;
+			}
+			if((pWrapper != nullptr) && (events[i].events & EPOLLOUT)) {
+				onSocketWritable(*pWrapper);
+			}
+			unlockMutex();
+
+			if((pWrapper != nullptr) && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+				onSocketReadable(*pWrapper);
+			}
+		}
+		cleanupSockets();
+
+		processUnpluggedDevice();
+		processReplies();
+		flushSockets();
+		cleanupSockets();
+	}
+}
+#endif
+
 void CSocketManager::runTask()
 {
+#if !defined(_WIN32) && !defined(_WIN64)
+	if(_epollFd >= 0)
+	{
+		runReactor();
+		pLogger->LogInfo("CSocketManager::runTask exited");
+		return;
+	}
+#endif
+
 	while(1)
 	{
 		if(isCancelled()) {
@@ -19,6 +19,7 @@
 #include "IDevice.h"
 #include "ISocketDeposit.h"
 #include "CommandTranslater.h"
+#include "CommandFactory.h"
 
 
 using Poco::Net::StreamSocket;
@@ -40,6 +41,9 @@ public:
 	//couple the socket manager to device instance.
 	void SetDevice(IDevice * pDevice);
 
+	//wake up socket loop so that it can exit.
+	virtual void cancel() override;
+
 private:
 	//IDeviceObserver
 	virtual void OnDeviceInserted(const std::string& deviceName) override;
@@ -71,7 +75,7 @@ private:
 		long socketId = INVALID_SOCKET_ID;
 		StreamSocket socket;
 		enum SocketState state;
-		std::deque<unsigned char> incoming;//reception stage to save partial command from socket
+		MsgFramer incoming;//reception stage to save partial command from socket
 		std::deque<unsigned char> outgoing;//sending stage for formatted outgoing reply
 	};
 	std::vector<struct SocketWrapper> _sockets;
@@ -99,7 +103,7 @@ private:
 	void unlockMutex();
 
 	//retrieve commands from data
-	void retrieveCommands(std::deque<unsigned char>& data, std::vector<std::string>& commands);
+	void retrieveCommands(MsgFramer& data, std::vector<std::string>& commands);
 	//JSON command processors
 	void onCommand(struct SocketWrapper& socketWrapper, const std::string& command);
 	void onCommandDevicesGet(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDevicesGet> cmdPtr);
@@ -107,6 +111,7 @@ private:
 	void onCommandDeviceDelay(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceDelay> cmdPtr);
 	void onCommandDeviceQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryPower> cmdPtr);
 	void onCommandDeviceQueryFuse(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryFuse> cmdPtr);
+	void onCommandDeviceQueryStatus(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDeviceQueryStatus> cmdPtr);
 	void onCommandBdcsPowerOn(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsPowerOn> cmdPtr);
 	void onCommandBdcsPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsPowerOff> cmdPtr);
 	void onCommandBdcsQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandBdcsQueryPower> cmdPtr);
@@ -140,7 +145,18 @@ private:
 	void onCommandDcmPowerOff(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDcmPowerOff> cmdPtr);
 	void onCommandDcmQueryPower(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandDcmQueryPower> cmdPtr);
 	void onCommandSolenoidActivate(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSolenoidActivate> cmdPtr);
-	void sendTranslatedCommandToDevice(long long socketId, const std::string& cmdString);
+	void onCommandSteppersMove(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandSteppersMove> cmdPtr);
+	void onCommandMacroUpload(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandMacroUpload> cmdPtr);
+	void onCommandMacroRun(struct SocketWrapper& socketWrapper, std::shared_ptr<CommandMacroRun> cmdPtr);
+	//encode command on stack and send it to the device bonded to socket
+	template<typename Command> void sendTranslatedCommandToDevice(long long socketId, Command& command)
+	{
+		DeviceCommandText text;
+
+		command.Encode(text);
+		sendCommandTextToDevice(socketId, text);
+	}
+	void sendCommandTextToDevice(long long socketId, const DeviceCommandText& text);
 
 	long long newSocketId() { return ++_lastSocketId; }
 
@@ -150,6 +166,20 @@ private:
 	void onSocketError(struct SocketWrapper& socketWrapper);
 	void pollSockets();
 	void cleanupSockets();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	//event driven socket loop
+	static const int EPOLL_EVENT_AMOUNT = 16;
+	static const int EPOLL_WAIT_TIMEOUT = 1000; //milliseconds, only to check cancellation in case wake-up fails
+	int _epollFd;
+	int _wakeupFd; //eventfd to wake up socket loop when replies/sockets arrive
+
+	void watchSocket(struct SocketWrapper& socketWrapper);
+	void flushSockets();
+	void runReactor();
+#endif
+	//notify socket loop of new reply or socket
+	void wakeup();
 };
 
 #endif /* CSOCKETMANAGER_H_ */
@@ -5,8 +5,94 @@
  *      Author: user1
  */
 
+#include <stdlib.h>
+#include <sstream>
+#include <unordered_map>
 #include "CommandTranslater.h"
 
+namespace
+{
+	struct CommandName
+	{
+		const char * name;
+		CommandType type;
+	};
+
+	//the only place where JSON command names are defined.
+	//entries must be sorted by name and cover every CommandType, static_asserts below check it at compile time.
+	constexpr CommandName commandNames[] = {
+		{"bdc break", CommandType::BdcBreak},
+		{"bdc coast", CommandType::BdcCoast},
+		{"bdc forward", CommandType::BdcForward},
+		{"bdc query", CommandType::BdcQuery},
+		{"bdc reverse", CommandType::BdcReverse},
+		{"bdcs power off", CommandType::BdcsPowerOff},
+		{"bdcs power on", CommandType::BdcsPowerOn},
+		{"bdcs query power", CommandType::BdcsQueryPower},
+		{"dcm power off", CommandType::DcmPowerOff},
+		{"dcm power on", CommandType::DcmPowerOn},
+		{"dcm query power", CommandType::DcmQueryPower},
+		{"device connect", CommandType::DeviceConnect},
+		{"device delay", CommandType::DeviceDelay},
+		{"device query fuse", CommandType::DeviceQueryFuse},
+		{"device query power", CommandType::DeviceQueryPower},
+		{"device query status", CommandType::DeviceQueryStatus},
+		{"devices get", CommandType::DevicesGet},
+		{"locator query", CommandType::LocatorQuery},
+		{"macro run", CommandType::MacroRun},
+		{"macro upload", CommandType::MacroUpload},
+		{"opt power off", CommandType::OptPowerOff},
+		{"opt power on", CommandType::OptPowerOn},
+		{"opt query power", CommandType::OptQueryPower},
+		{"solenoid activate", CommandType::SolenoidActivate},
+		{"stepper acceleration buffer", CommandType::StepperAccelerationBuffer},
+		{"stepper acceleration buffer decrement", CommandType::StepperAccelerationBufferDecrement},
+		{"stepper config home", CommandType::StepperConfigHome},
+		{"stepper config step", CommandType::StepperConfigStep},
+		{"stepper deceleration buffer", CommandType::StepperDecelerationBuffer},
+		{"stepper deceleration buffer increment", CommandType::StepperDecelerationBufferIncrement},
+		{"stepper enable", CommandType::StepperEnable},
+		{"stepper forward", CommandType::StepperForward},
+		{"stepper forward clockwise", CommandType::StepperForwardClockwise},
+		{"stepper query", CommandType::StepperQuery},
+		{"stepper query resolution", CommandType::StepperQueryResolution},
+		{"stepper run", CommandType::StepperRun},
+		{"stepper set state", CommandType::StepperSetState},
+		{"stepper steps", CommandType::StepperSteps},
+		{"steppers move", CommandType::SteppersMove},
+		{"steppers power off", CommandType::SteppersPowerOff},
+		{"steppers power on", CommandType::SteppersPowerOn},
+		{"steppers query power", CommandType::SteppersQueryPower},
+	};
+	constexpr unsigned int COMMAND_NAME_AMOUNT = sizeof(commandNames) / sizeof(commandNames[0]);
+
+	constexpr int compareName(const char * pName1, const char * pName2)
+	{
+		return (*pName1 != *pName2) ? ((unsigned char)*pName1 - (unsigned char)*pName2) :
+				((*pName1 == 0) ? 0 : compareName(pName1 + 1, pName2 + 1));
+	}
+
+	constexpr bool isSorted(unsigned int index)
+	{
+		return (index + 1 >= COMMAND_NAME_AMOUNT) ||
+				((compareName(commandNames[index].name, commandNames[index + 1].name) < 0) && isSorted(index + 1));
+	}
+
+	constexpr bool hasType(int type, unsigned int index)
+	{
+		return (index < COMMAND_NAME_AMOUNT) && ((commandNames[index].type == type) || hasType(type, index + 1));
+	}
+
+	constexpr bool hasAllTypes(int type)
+	{
+		return (type > CommandType::CommandTypeLast) || (hasType(type, 0) && hasAllTypes(type + 1));
+	}
+}
+
+static_assert(isSorted(0), "commandNames isn't sorted by name or has duplicated names");
+static_assert(COMMAND_NAME_AMOUNT == CommandType::CommandTypeLast + 1, "commandNames doesn't match CommandType");
+static_assert(hasAllTypes(0), "a CommandType is missing in commandNames");
+
 CommandTranslator::CommandTranslator(std::string jsonCmd)
 {
 	this->_jsonCmd = jsonCmd;
@@ -18,6 +104,26 @@ std::string CommandTranslator::JsonCommand()
 	return _jsonCmd;
 }
 
+CommandType CommandTranslator::ToType(const std::string& command)
+{
+	//hash index is built from commandNames at the first lookup, a lookup costs one hash and one comparison.
+	static const std::unordered_map<std::string, CommandType> commandTypes(
+			[]() {
+				std::unordered_map<std::string, CommandType> types;
+				for(unsigned int i=0; i<COMMAND_NAME_AMOUNT; i++) {
+					types[commandNames[i].name] = commandNames[i].type;
+				}
+				return types;
+			}());
+
+	auto it = commandTypes.find(command);
+	if(it == commandTypes.end()) {
+		return CommandType::Invalid;
+	}
+
+	return it->second;
+}
+
 CommandType CommandTranslator::Type()
 {
 	bool exceptionOccur = false;
@@ -58,126 +164,9 @@ CommandType CommandTranslator::Type()
 	}
 	else
 	{
-		if(command == strCommandDevicesGet) {
-			_type = CommandType::DevicesGet;
-		}
-		else if(command == strCommandDeviceConnect) {
-			_type = CommandType::DeviceConnect;
-		}
-		else if(command == strCommandDeviceDelay) {
-			_type = CommandType::DeviceDelay;
-		}
-		else if(command == strCommandDeviceQueryPower) {
-			_type = CommandType::DeviceQueryPower;
-		}
-		else if(command == strCommandDeviceQueryFuse) {
-			_type = CommandType::DeviceQueryFuse;
-		}
-		else if(command == strCommandBdcsPowerOn) {
-			_type = CommandType::BdcsPowerOn;
-		}
-		else if(command == strCommandBdcsPowerOff) {
-			_type = CommandType::BdcsPowerOff;
-		}
-		else if(command == strCommandBdcsQueryPower) {
-			_type = CommandType::BdcsQueryPower;
-		}
-		else if(command == strCommandBdcCoast) {
-			_type = CommandType::BdcCoast;
-		}
-		else if(command == strCommandBdcReverse) {
-			_type = CommandType::BdcReverse;
-		}
-		else if(command == strCommandBdcForward) {
-			_type = CommandType::BdcForward;
-		}
-		else if(command == strCommandBdcBreak) {
-			_type = CommandType::BdcBreak;
-		}
-		else if(command == strCommandBdcQuery) {
-			_type = CommandType::BdcQuery;
-		}
-		else if(command == strCommandSteppersPowerOn) {
-			_type = CommandType::SteppersPowerOn;
-		}
-		else if(command == strCommandSteppersPowerOff) {
-			_type = CommandType::SteppersPowerOff;
-		}
-		else if(command == strCommandSteppersQueryPower) {
-			_type = CommandType::SteppersQueryPower;
-		}
-		else if(command == strCommandStepperQueryResolution) {
-			_type = CommandType::StepperQueryResolution;
-		}
-		else if(command == strCommandStepperConfigStep) {
-			_type = CommandType::StepperConfigStep;
-		}
-		else if(command == strCommandStepperAccelerationBuffer) {
-			_type = CommandType::StepperAccelerationBuffer;
-		}
-		else if(command == strCommandStepperAccelerationBufferDecrement) {
-			_type = CommandType::StepperAccelerationBufferDecrement;
-		}
-		else if(command == strCommandStepperAccelerationBufferDecrement) {
-			_type = CommandType::StepperAccelerationBufferDecrement;
-		}
-		else if(command == strCommandStepperDecelerationBuffer) {
-			_type = CommandType::StepperDecelerationBuffer;
-		}
-		else if(command == strCommandStepperDecelerationBufferIncrement) {
-			_type = CommandType::StepperDecelerationBufferIncrement;
-		}
-		else if(command == strCommandStepperEnable) {
-			_type = CommandType::StepperEnable;
-		}
-		else if(command == strCommandStepperForward) {
-			_type = CommandType::StepperForward;
-		}
-		else if(command == strCommandStepperSteps) {
-			_type = CommandType::StepperSteps;
-		}
-		else if(command == strCommandStepperRun) {
-			_type = CommandType::StepperRun;
-		}
-		else if(command == strCommandStepperConfigHome) {
-			_type = CommandType::StepperConfigHome;
-		}
-		else if(command == strCommandStepperQuery) {
-			_type = CommandType::StepperQuery;
-		}
-		else if(command == strCommandStepperSetState) {
-			_type = CommandType::StepperSetState;
-		}
-		else if(command == strCommandStepperForwardClockwise) {
-			_type = CommandType::StepperForwardClockwise;
-		}
-		else if(command == strCommandLocatorQuery) {
-			_type = CommandType::LocatorQuery;
-		}
-		else if(command == strCommandOptPowerOn) {
-			_type = CommandType::OptPowerOn;
-		}
-		else if(command == strCommandOptPowerOff) {
-			_type = CommandType::OptPowerOff;
-		}
-		else if(command == strCommandOptQueryPower) {
-			_type = CommandType::OptQueryPower;
-		}
-		else if(command == strCommandDcmPowerOn) {
-			_type = CommandType::DcmPowerOn;
-		}
-		else if(command == strCommandDcmPowerOff) {
-			_type = CommandType::DcmPowerOff;
-		}
-		else if(command == strCommandDcmQueryPower) {
-			_type = CommandType::DcmQueryPower;
-		}
-		else if(command == strCommandSolenoidActivate) {
-			_type = CommandType::SolenoidActivate;
-		}
-		else {
+		_type = ToType(command);
+		if(_type == CommandType::Invalid) {
 			pLogger->LogError("CommandTranslator::CommandType unknown command in " + _jsonCmd);
-			_type = CommandType::Invalid;
 		}
 	}
 
@@ -200,12 +189,12 @@ std::shared_ptr<CommandDevicesGet> CommandTranslator::GetCommandDevicesGet()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDevicesGet invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDevicesGet) {
+			else if(ToType(command) != CommandType::DevicesGet) {
 				pLogger->LogError("CommandTranslator::GetCommandDevicesGet wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandDevicesGet> p(new CommandDevicesGet(commandId));
+				auto p = std::make_shared<CommandDevicesGet>(commandId);
 				return p;
 			}
 		}
@@ -242,13 +231,13 @@ std::shared_ptr<CommandDeviceConnect> CommandTranslator::GetCommandDeviceConnect
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceConnect invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDeviceConnect) {
+			else if(ToType(command) != CommandType::DeviceConnect) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceConnect wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				std::string deviceName = objectPtr->getValue<std::string>("device");
-				std::shared_ptr<CommandDeviceConnect> p(new CommandDeviceConnect(commandId, deviceName));
+				auto p = std::make_shared<CommandDeviceConnect>(commandId, deviceName);
 				return p;
 			}
 		}
@@ -286,12 +275,12 @@ std::shared_ptr<CommandDeviceQueryPower> CommandTranslator::GetCommandDeviceQuer
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryPower invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDeviceQueryPower) {
+			else if(ToType(command) != CommandType::DeviceQueryPower) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryPower wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandDeviceQueryPower> p(new CommandDeviceQueryPower(commandId));
+				auto p = std::make_shared<CommandDeviceQueryPower>(commandId);
 				return p;
 			}
 		}
@@ -328,12 +317,12 @@ std::shared_ptr<CommandDeviceQueryFuse> CommandTranslator::GetCommandDeviceQuery
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryFuse invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDeviceQueryFuse) {
+			else if(ToType(command) != CommandType::DeviceQueryFuse) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryFuse wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandDeviceQueryFuse> p(new CommandDeviceQueryFuse(commandId));
+				auto p = std::make_shared<CommandDeviceQueryFuse>(commandId);
 				return p;
 			}
 		}
@@ -354,6 +343,48 @@ std::shared_ptr<CommandDeviceQueryFuse> CommandTranslator::GetCommandDeviceQuery
 	return nullptr;
 }
 
+std::shared_ptr<CommandDeviceQueryStatus> CommandTranslator::GetCommandDeviceQueryStatus()
+{
+	try
+	{
+		Poco::JSON::Parser parser;
+		Poco::Dynamic::Var result = parser.parse(_jsonCmd);
+		Poco::JSON::Object::Ptr objectPtr = result.extract<Poco::JSON::Object::Ptr>();
+
+		if(objectPtr->has(std::string("command")))
+		{
+			std::string command = objectPtr->getValue<std::string>("command");
+			unsigned long commandId = objectPtr->getValue<unsigned long>("commandId");
+
+			if(command.size() < 1) {
+				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryStatus invalid command in " + _jsonCmd);
+			}
+			else if(ToType(command) != CommandType::DeviceQueryStatus) {
+				pLogger->LogError("CommandTranslator::GetCommandDeviceQueryStatus wrong command in " + _jsonCmd);
+			}
+			else
+			{
+				auto p = std::make_shared<CommandDeviceQueryStatus>(commandId);
+				return p;
+			}
+		}
+		else
+		{
+			pLogger->LogError("CommandTranslator::GetCommandDeviceQueryStatus no command in " + _jsonCmd);
+		}
+	}
+	catch(Poco::Exception& e)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandDeviceQueryStatus exception occurs: " + e.displayText() + " in " + _jsonCmd);
+	}
+	catch(...)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandDeviceQueryStatus unknown exception in " + _jsonCmd);
+	}
+
+	return nullptr;
+}
+
 std::shared_ptr<CommandDeviceDelay> CommandTranslator::GetCommandDeviceDelay()
 {
 	try
@@ -371,12 +402,12 @@ std::shared_ptr<CommandDeviceDelay> CommandTranslator::GetCommandDeviceDelay()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceDelay invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDeviceDelay) {
+			else if(ToType(command) != CommandType::DeviceDelay) {
 				pLogger->LogError("CommandTranslator::GetCommandDeviceDelay wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandDeviceDelay> p(new CommandDeviceDelay(commandId, clks));
+				auto p = std::make_shared<CommandDeviceDelay>(commandId, clks);
 				return p;
 			}
 		}
@@ -413,12 +444,12 @@ std::shared_ptr<CommandBdcsPowerOn> CommandTranslator::GetCommandBdcsPowerOn()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsPowerOn invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcsPowerOn) {
+			else if(ToType(command) != CommandType::BdcsPowerOn) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsPowerOn wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandBdcsPowerOn> p(new CommandBdcsPowerOn(commandId));
+				auto p = std::make_shared<CommandBdcsPowerOn>(commandId);
 				return p;
 			}
 		}
@@ -455,12 +486,12 @@ std::shared_ptr<CommandBdcsPowerOff> CommandTranslator::GetCommandBdcsPowerOff()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsPowerOff invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcsPowerOff) {
+			else if(ToType(command) != CommandType::BdcsPowerOff) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsPowerOff wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandBdcsPowerOff> p(new CommandBdcsPowerOff(commandId));
+				auto p = std::make_shared<CommandBdcsPowerOff>(commandId);
 				return p;
 			}
 		}
@@ -497,12 +528,12 @@ std::shared_ptr<CommandBdcsQueryPower> CommandTranslator::GetCommandBdcsQueryPow
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsQueryPower invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcsQueryPower) {
+			else if(ToType(command) != CommandType::BdcsQueryPower) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcsQueryPower wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandBdcsQueryPower> p(new CommandBdcsQueryPower(commandId));
+				auto p = std::make_shared<CommandBdcsQueryPower>(commandId);
 				return p;
 			}
 		}
@@ -539,13 +570,13 @@ std::shared_ptr<CommandBdcCoast> CommandTranslator::GetCommandBdcCoast()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcCoast invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcCoast) {
+			else if(ToType(command) != CommandType::BdcCoast) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcCoast wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
-				std::shared_ptr<CommandBdcCoast> p(new CommandBdcCoast(index, commandId));
+				auto p = std::make_shared<CommandBdcCoast>(index, commandId);
 				return p;
 			}
 		}
@@ -582,7 +613,7 @@ std::shared_ptr<CommandBdcReverse> CommandTranslator::GetCommandBdcReverse()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcReverse invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcReverse) {
+			else if(ToType(command) != CommandType::BdcReverse) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcReverse wrong command in " + _jsonCmd);
 			}
 			else
@@ -591,7 +622,7 @@ std::shared_ptr<CommandBdcReverse> CommandTranslator::GetCommandBdcReverse()
 				int lowClks = objectPtr->getValue<int>("lowClks");
 				int highClks = objectPtr->getValue<int>("highClks");
 				int cycles = objectPtr->getValue<int>("cycles");
-				std::shared_ptr<CommandBdcReverse> p(new CommandBdcReverse(index, lowClks, highClks, cycles, commandId));
+				auto p = std::make_shared<CommandBdcReverse>(index, lowClks, highClks, cycles, commandId);
 				return p;
 			}
 		}
@@ -628,7 +659,7 @@ std::shared_ptr<CommandBdcForward> CommandTranslator::GetCommandBdcForward()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcForward invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcForward) {
+			else if(ToType(command) != CommandType::BdcForward) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcForward wrong command in " + _jsonCmd);
 			}
 			else
@@ -637,7 +668,7 @@ std::shared_ptr<CommandBdcForward> CommandTranslator::GetCommandBdcForward()
 				int lowClks = objectPtr->getValue<int>("lowClks");
 				int highClks = objectPtr->getValue<int>("highClks");
 				int cycles = objectPtr->getValue<int>("cycles");
-				std::shared_ptr<CommandBdcForward> p(new CommandBdcForward(index, lowClks, highClks, cycles, commandId));
+				auto p = std::make_shared<CommandBdcForward>(index, lowClks, highClks, cycles, commandId);
 				return p;
 			}
 		}
@@ -674,13 +705,13 @@ std::shared_ptr<CommandBdcBreak> CommandTranslator::GetCommandBdcBreak()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcBreak invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcBreak) {
+			else if(ToType(command) != CommandType::BdcBreak) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcBreak wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
-				std::shared_ptr<CommandBdcBreak> p(new CommandBdcBreak(index, commandId));
+				auto p = std::make_shared<CommandBdcBreak>(index, commandId);
 				return p;
 			}
 		}
@@ -717,13 +748,13 @@ std::shared_ptr<CommandBdcQuery> CommandTranslator::GetCommandBdcQuery()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcQuery invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandBdcQuery) {
+			else if(ToType(command) != CommandType::BdcQuery) {
 				pLogger->LogError("CommandTranslator::GetCommandBdcQuery wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
-				std::shared_ptr<CommandBdcQuery> p(new CommandBdcQuery(index, commandId));
+				auto p = std::make_shared<CommandBdcQuery>(index, commandId);
 				return p;
 			}
 		}
@@ -760,12 +791,12 @@ std::shared_ptr<CommandSteppersPowerOn> CommandTranslator::GetCommandSteppersPow
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersPowerOn invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandSteppersPowerOn) {
+			else if(ToType(command) != CommandType::SteppersPowerOn) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersPowerOn wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandSteppersPowerOn> p(new CommandSteppersPowerOn(commandId));
+				auto p = std::make_shared<CommandSteppersPowerOn>(commandId);
 				return p;
 			}
 		}
@@ -802,12 +833,12 @@ std::shared_ptr<CommandSteppersPowerOff> CommandTranslator::GetCommandSteppersPo
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersPowerOff invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandSteppersPowerOff) {
+			else if(ToType(command) != CommandType::SteppersPowerOff) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersPowerOff wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandSteppersPowerOff> p(new CommandSteppersPowerOff(commandId));
+				auto p = std::make_shared<CommandSteppersPowerOff>(commandId);
 				return p;
 			}
 		}
@@ -844,12 +875,12 @@ std::shared_ptr<CommandSteppersQueryPower> CommandTranslator::GetCommandSteppers
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersQueryPower invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandSteppersQueryPower) {
+			else if(ToType(command) != CommandType::SteppersQueryPower) {
 				pLogger->LogError("CommandTranslator::GetCommandSteppersQueryPower wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandSteppersQueryPower> p(new CommandSteppersQueryPower(commandId));
+				auto p = std::make_shared<CommandSteppersQueryPower>(commandId);
 				return p;
 			}
 		}
@@ -886,12 +917,12 @@ std::shared_ptr<CommandStepperQueryResolution> CommandTranslator::GetCommandStep
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperQueryResolution invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperQueryResolution) {
+			else if(ToType(command) != CommandType::StepperQueryResolution) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperQueryResolution wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandStepperQueryResolution> p(new CommandStepperQueryResolution(commandId));
+				auto p = std::make_shared<CommandStepperQueryResolution>(commandId);
 				return p;
 			}
 		}
@@ -928,7 +959,7 @@ std::shared_ptr<CommandStepperConfigStep> CommandTranslator::GetCommandStepperCo
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperConfigStep invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperConfigStep) {
+			else if(ToType(command) != CommandType::StepperConfigStep) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperConfigStep wrong command in " + _jsonCmd);
 			}
 			else
@@ -937,7 +968,7 @@ std::shared_ptr<CommandStepperConfigStep> CommandTranslator::GetCommandStepperCo
 				int lowClks = objectPtr->getValue<int>("lowClks");
 				int highClks = objectPtr->getValue<int>("highClks");
 
-				std::shared_ptr<CommandStepperConfigStep> p(new CommandStepperConfigStep(index, lowClks, highClks, commandId));
+				auto p = std::make_shared<CommandStepperConfigStep>(index, lowClks, highClks, commandId);
 				return p;
 			}
 		}
@@ -974,7 +1005,7 @@ std::shared_ptr<CommandStepperAccelerationBuffer> CommandTranslator::GetCommandS
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandAccelerationBuffer invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperAccelerationBuffer) {
+			else if(ToType(command) != CommandType::StepperAccelerationBuffer) {
 				pLogger->LogError("CommandTranslator::GetCommandAccelerationBuffer wrong command in " + _jsonCmd);
 			}
 			else
@@ -982,7 +1013,7 @@ std::shared_ptr<CommandStepperAccelerationBuffer> CommandTranslator::GetCommandS
 				int index = objectPtr->getValue<int>("index");
 				int value = objectPtr->getValue<int>("value");
 
-				std::shared_ptr<CommandStepperAccelerationBuffer> p(new CommandStepperAccelerationBuffer(index, value, commandId));
+				auto p = std::make_shared<CommandStepperAccelerationBuffer>(index, value, commandId);
 				return p;
 			}
 		}
@@ -1019,7 +1050,7 @@ std::shared_ptr<CommandStepperAccelerationBufferDecrement> CommandTranslator::Ge
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperAccelerationBufferDecrement invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperAccelerationBufferDecrement) {
+			else if(ToType(command) != CommandType::StepperAccelerationBufferDecrement) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperAccelerationBufferDecrement wrong command in " + _jsonCmd);
 			}
 			else
@@ -1027,7 +1058,7 @@ std::shared_ptr<CommandStepperAccelerationBufferDecrement> CommandTranslator::Ge
 				int index = objectPtr->getValue<int>("index");
 				int value = objectPtr->getValue<int>("value");
 
-				std::shared_ptr<CommandStepperAccelerationBufferDecrement> p(new CommandStepperAccelerationBufferDecrement(index, value, commandId));
+				auto p = std::make_shared<CommandStepperAccelerationBufferDecrement>(index, value, commandId);
 				return p;
 			}
 		}
@@ -1064,7 +1095,7 @@ std::shared_ptr<CommandStepperDecelerationBuffer> CommandTranslator::GetCommandS
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperDecelerationBuffer invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperDecelerationBuffer) {
+			else if(ToType(command) != CommandType::StepperDecelerationBuffer) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperDecelerationBuffer wrong command in " + _jsonCmd);
 			}
 			else
@@ -1072,7 +1103,7 @@ std::shared_ptr<CommandStepperDecelerationBuffer> CommandTranslator::GetCommandS
 				int index = objectPtr->getValue<int>("index");
 				int value = objectPtr->getValue<int>("value");
 
-				std::shared_ptr<CommandStepperDecelerationBuffer> p(new CommandStepperDecelerationBuffer(index, value,  commandId));
+				auto p = std::make_shared<CommandStepperDecelerationBuffer>(index, value,  commandId);
 				return p;
 			}
 		}
@@ -1109,7 +1140,7 @@ std::shared_ptr<CommandStepperDecelerationBufferIncrement> CommandTranslator::Ge
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperDecelerationBufferIncrement invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperDecelerationBufferIncrement) {
+			else if(ToType(command) != CommandType::StepperDecelerationBufferIncrement) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperDecelerationBufferIncrement wrong command in " + _jsonCmd);
 			}
 			else
@@ -1117,7 +1148,7 @@ std::shared_ptr<CommandStepperDecelerationBufferIncrement> CommandTranslator::Ge
 				int index = objectPtr->getValue<int>("index");
 				int value = objectPtr->getValue<int>("value");
 
-				std::shared_ptr<CommandStepperDecelerationBufferIncrement> p(new CommandStepperDecelerationBufferIncrement(index, value, commandId));
+				auto p = std::make_shared<CommandStepperDecelerationBufferIncrement>(index, value, commandId);
 				return p;
 			}
 		}
@@ -1154,7 +1185,7 @@ std::shared_ptr<CommandStepperEnable> CommandTranslator::GetCommandStepperEnable
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperEnable invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperEnable) {
+			else if(ToType(command) != CommandType::StepperEnable) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperEnable wrong command in " + _jsonCmd);
 			}
 			else
@@ -1162,7 +1193,7 @@ std::shared_ptr<CommandStepperEnable> CommandTranslator::GetCommandStepperEnable
 				int index = objectPtr->getValue<int>("index");
 				bool enable = objectPtr->getValue<bool>("enable");
 
-				std::shared_ptr<CommandStepperEnable> p(new CommandStepperEnable(index, enable, commandId));
+				auto p = std::make_shared<CommandStepperEnable>(index, enable, commandId);
 				return p;
 			}
 		}
@@ -1199,7 +1230,7 @@ std::shared_ptr<CommandStepperForward> CommandTranslator::GetCommandStepperForwa
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperForward invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperForward) {
+			else if(ToType(command) != CommandType::StepperForward) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperForward wrong command in " + _jsonCmd);
 			}
 			else
@@ -1207,7 +1238,7 @@ std::shared_ptr<CommandStepperForward> CommandTranslator::GetCommandStepperForwa
 				int index = objectPtr->getValue<int>("index");
 				bool forward = objectPtr->getValue<bool>("forward");
 
-				std::shared_ptr<CommandStepperForward> p(new CommandStepperForward(index, forward, commandId));
+				auto p = std::make_shared<CommandStepperForward>(index, forward, commandId);
 				return p;
 			}
 		}
@@ -1244,7 +1275,7 @@ std::shared_ptr<CommandStepperSteps> CommandTranslator::GetCommandStepperSteps()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperSteps invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperSteps) {
+			else if(ToType(command) != CommandType::StepperSteps) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperSteps wrong command in " + _jsonCmd);
 			}
 			else
@@ -1252,7 +1283,7 @@ std::shared_ptr<CommandStepperSteps> CommandTranslator::GetCommandStepperSteps()
 				int index = objectPtr->getValue<int>("index");
 				int value = objectPtr->getValue<int>("value");
 
-				std::shared_ptr<CommandStepperSteps> p(new CommandStepperSteps(index, value, commandId));
+				auto p = std::make_shared<CommandStepperSteps>(index, value, commandId);
 				return p;
 			}
 		}
@@ -1289,14 +1320,14 @@ std::shared_ptr<CommandStepperRun> CommandTranslator::GetCommandStepperRun()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperRun invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperRun) {
+			else if(ToType(command) != CommandType::StepperRun) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperRun wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandStepperRun> p(new CommandStepperRun(index, commandId));
+				auto p = std::make_shared<CommandStepperRun>(index, commandId);
 				return p;
 			}
 		}
@@ -1333,7 +1364,7 @@ std::shared_ptr<CommandStepperConfigHome> CommandTranslator::GetCommandStepperCo
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperConfigHome invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperConfigHome) {
+			else if(ToType(command) != CommandType::StepperConfigHome) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperConfigHome wrong command in " + _jsonCmd);
 			}
 			else
@@ -1343,7 +1374,7 @@ std::shared_ptr<CommandStepperConfigHome> CommandTranslator::GetCommandStepperCo
 				int lineNumberStart = objectPtr->getValue<int>("lineNumberStart");
 				int lineNumberTerminal = objectPtr->getValue<int>("lineNumberTerminal");
 
-				std::shared_ptr<CommandStepperConfigHome> p(new CommandStepperConfigHome(stepperIndex, locatorIndex, lineNumberStart, lineNumberTerminal, commandId));
+				auto p = std::make_shared<CommandStepperConfigHome>(stepperIndex, locatorIndex, lineNumberStart, lineNumberTerminal, commandId);
 				return p;
 			}
 		}
@@ -1380,14 +1411,14 @@ std::shared_ptr<CommandStepperQuery> CommandTranslator::GetCommandStepperQuery()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperQuery invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperQuery) {
+			else if(ToType(command) != CommandType::StepperQuery) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperQuery wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int stepperIndex = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandStepperQuery> p(new CommandStepperQuery(stepperIndex, commandId));
+				auto p = std::make_shared<CommandStepperQuery>(stepperIndex, commandId);
 				return p;
 			}
 		}
@@ -1424,7 +1455,7 @@ std::shared_ptr<CommandStepperForwardClockwise> CommandTranslator::GetCommandSte
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperForwardClockwise invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperForwardClockwise) {
+			else if(ToType(command) != CommandType::StepperForwardClockwise) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperForwardClockwise wrong command in " + _jsonCmd);
 			}
 			else
@@ -1432,7 +1463,7 @@ std::shared_ptr<CommandStepperForwardClockwise> CommandTranslator::GetCommandSte
 				int stepperIndex = objectPtr->getValue<int>("index");
 				int clockwise = objectPtr->getValue<int>("forwardClockwise");
 
-				std::shared_ptr<CommandStepperForwardClockwise> p(new CommandStepperForwardClockwise(stepperIndex, (clockwise != 0), commandId));
+				auto p = std::make_shared<CommandStepperForwardClockwise>(stepperIndex, (clockwise != 0), commandId);
 				return p;
 			}
 		}
@@ -1469,7 +1500,7 @@ std::shared_ptr<CommandStepperSetState> CommandTranslator::GetCommandStepperSetS
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperSetState invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandStepperSetState) {
+			else if(ToType(command) != CommandType::StepperSetState) {
 				pLogger->LogError("CommandTranslator::GetCommandStepperSetState wrong command in " + _jsonCmd);
 			}
 			else
@@ -1477,7 +1508,7 @@ std::shared_ptr<CommandStepperSetState> CommandTranslator::GetCommandStepperSetS
 				int stepperIndex = objectPtr->getValue<int>("index");
 				int state = objectPtr->getValue<int>("state");
 
-				std::shared_ptr<CommandStepperSetState> p(new CommandStepperSetState(stepperIndex, state, commandId));
+				auto p = std::make_shared<CommandStepperSetState>(stepperIndex, state, commandId);
 				return p;
 			}
 		}
@@ -1514,14 +1545,14 @@ std::shared_ptr<CommandLocatorQuery> CommandTranslator::GetCommandLocatorQuery()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandLocatorQuery invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandLocatorQuery) {
+			else if(ToType(command) != CommandType::LocatorQuery) {
 				pLogger->LogError("CommandTranslator::GetCommandLocatorQuery wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandLocatorQuery> p(new CommandLocatorQuery(index, commandId));
+				auto p = std::make_shared<CommandLocatorQuery>(index, commandId);
 				return p;
 			}
 		}
@@ -1558,12 +1589,12 @@ std::shared_ptr<CommandOptPowerOn> CommandTranslator::GetCommandOptPowerOn()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandOptPowerOn invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandOptPowerOn) {
+			else if(ToType(command) != CommandType::OptPowerOn) {
 				pLogger->LogError("CommandTranslator::GetCommandOptPowerOn wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandOptPowerOn> p(new CommandOptPowerOn(commandId));
+				auto p = std::make_shared<CommandOptPowerOn>(commandId);
 				return p;
 			}
 		}
@@ -1600,12 +1631,12 @@ std::shared_ptr<CommandOptPowerOff> CommandTranslator::GetCommandOptPowerOff()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandOptPowerOff invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandOptPowerOff) {
+			else if(ToType(command) != CommandType::OptPowerOff) {
 				pLogger->LogError("CommandTranslator::GetCommandOptPowerOff wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandOptPowerOff> p(new CommandOptPowerOff(commandId));
+				auto p = std::make_shared<CommandOptPowerOff>(commandId);
 				return p;
 			}
 		}
@@ -1642,12 +1673,12 @@ std::shared_ptr<CommandOptQueryPower> CommandTranslator::GetCommandOptQueryPower
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandOptQueryPower invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandOptQueryPower) {
+			else if(ToType(command) != CommandType::OptQueryPower) {
 				pLogger->LogError("CommandTranslator::GetCommandOptQueryPower wrong command in " + _jsonCmd);
 			}
 			else
 			{
-				std::shared_ptr<CommandOptQueryPower> p(new CommandOptQueryPower(commandId));
+				auto p = std::make_shared<CommandOptQueryPower>(commandId);
 				return p;
 			}
 		}
@@ -1684,14 +1715,14 @@ std::shared_ptr<CommandDcmPowerOn> CommandTranslator::GetCommandDcmPowerOn()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmPowerOn invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDcmPowerOn) {
+			else if(ToType(command) != CommandType::DcmPowerOn) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmPowerOn wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandDcmPowerOn> p(new CommandDcmPowerOn(index, commandId));
+				auto p = std::make_shared<CommandDcmPowerOn>(index, commandId);
 				return p;
 			}
 		}
@@ -1728,14 +1759,14 @@ std::shared_ptr<CommandDcmPowerOff> CommandTranslator::GetCommandDcmPowerOff()
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmPowerOff invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDcmPowerOff) {
+			else if(ToType(command) != CommandType::DcmPowerOff) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmPowerOff wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandDcmPowerOff> p(new CommandDcmPowerOff(index, commandId));
+				auto p = std::make_shared<CommandDcmPowerOff>(index, commandId);
 				return p;
 			}
 		}
@@ -1772,14 +1803,14 @@ std::shared_ptr<CommandDcmQueryPower> CommandTranslator::GetCommandDcmQueryPower
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmQueryPower invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandDcmQueryPower) {
+			else if(ToType(command) != CommandType::DcmQueryPower) {
 				pLogger->LogError("CommandTranslator::GetCommandDcmQueryPower wrong command in " + _jsonCmd);
 			}
 			else
 			{
 				int index = objectPtr->getValue<int>("index");
 
-				std::shared_ptr<CommandDcmQueryPower> p(new CommandDcmQueryPower(index, commandId));
+				auto p = std::make_shared<CommandDcmQueryPower>(index, commandId);
 				return p;
 			}
 		}
@@ -1816,7 +1847,7 @@ std::shared_ptr<CommandSolenoidActivate> CommandTranslator::GetCommandSolenoidAc
 			if(command.size() < 1) {
 				pLogger->LogError("CommandTranslator::GetCommandSolenoidActivate invalid command in " + _jsonCmd);
 			}
-			else if(command != strCommandSolenoidActivate) {
+			else if(ToType(command) != CommandType::SolenoidActivate) {
 				pLogger->LogError("CommandTranslator::GetCommandSolenoidActivate wrong command in " + _jsonCmd);
 			}
 			else
@@ -1825,7 +1856,7 @@ std::shared_ptr<CommandSolenoidActivate> CommandTranslator::GetCommandSolenoidAc
 				unsigned int lowClks = objectPtr->getValue<unsigned int>("lowClks");
 				unsigned int highClks = objectPtr->getValue<unsigned int>("highClks");
 
-				std::shared_ptr<CommandSolenoidActivate> p(new CommandSolenoidActivate(index, lowClks, highClks, commandId));
+				auto p = std::make_shared<CommandSolenoidActivate>(index, lowClks, highClks, commandId);
 				return p;
 			}
 		}
@@ -1845,3 +1876,298 @@ std::shared_ptr<CommandSolenoidActivate> CommandTranslator::GetCommandSolenoidAc
 
 	return nullptr;
 }
+
+std::shared_ptr<CommandSteppersMove> CommandTranslator::GetCommandSteppersMove()
+{
+	try
+	{
+		Poco::JSON::Parser parser;
+		Poco::Dynamic::Var result = parser.parse(_jsonCmd);
+		Poco::JSON::Object::Ptr objectPtr = result.extract<Poco::JSON::Object::Ptr>();
+
+		if(objectPtr->has(std::string("command")))
+		{
+			std::string command = objectPtr->getValue<std::string>("command");
+			unsigned long commandId = objectPtr->getValue<unsigned long>("commandId");
+
+			if(command.size() < 1) {
+				pLogger->LogError("CommandTranslator::GetCommandSteppersMove invalid command in " + _jsonCmd);
+			}
+			else if(ToType(command) != CommandType::SteppersMove) {
+				pLogger->LogError("CommandTranslator::GetCommandSteppersMove wrong command in " + _jsonCmd);
+			}
+			else
+			{
+				Poco::JSON::Array::Ptr arrayPtr = objectPtr->getArray("movements");
+				std::vector<CommandSteppersMove::Movement> movements;
+
+				if(arrayPtr.isNull() || (arrayPtr->size() < 1)) {
+					pLogger->LogError("CommandTranslator::GetCommandSteppersMove no movement in " + _jsonCmd);
+					return nullptr;
+				}
+				for(unsigned int i=0; i<arrayPtr->size(); i++)
+				{
+					Poco::JSON::Object::Ptr movementPtr = arrayPtr->getObject(i);
+					CommandSteppersMove::Movement movement;
+
+					movement.index = movementPtr->getValue<unsigned int>("index");
+					movement.forward = movementPtr->getValue<bool>("forward");
+					movement.steps = movementPtr->getValue<unsigned long>("steps");
+					movement.withPrevious = false;
+					if(movementPtr->has("withPrevious")) {
+						movement.withPrevious = movementPtr->getValue<bool>("withPrevious");
+					}
+					movements.push_back(movement);
+				}
+
+				auto p = std::make_shared<CommandSteppersMove>(movements, commandId);
+				return p;
+			}
+		}
+		else
+		{
+			pLogger->LogError("CommandTranslator::GetCommandSteppersMove no command in " + _jsonCmd);
+		}
+	}
+	catch(Poco::Exception& e)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandSteppersMove exception occurs: " + e.displayText() + " in " + _jsonCmd);
+	}
+	catch(...)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandSteppersMove unknown exception in " + _jsonCmd);
+	}
+
+	return nullptr;
+}
+
+template<typename Command> bool CommandTranslator::toMacroStep(std::shared_ptr<Command> cmdPtr, std::vector<long>& step)
+{
+	DeviceCommandText text;
+	std::string str;
+	const char * pCur;
+	char * pEnd;
+
+	if(cmdPtr == nullptr) {
+		return false;
+	}
+	cmdPtr->Encode(text);
+	if(text.Overflow()) {
+		return false;
+	}
+
+	//"C commandNumber arguments commandId", command id is dropped.
+	str = text.ToString();
+	pCur = str.c_str() + 1;
+	step.clear();
+	for(;;)
+	{
+		long value = strtol(pCur, &pEnd, 10);
+
+		if(pEnd == pCur) {
+			break;
+		}
+		step.push_back(value);
+		pCur = pEnd;
+	}
+	if(step.size() < 2) {
+		return false;
+	}
+	step.pop_back();
+
+	return true;
+}
+
+bool CommandTranslator::getMacroStepSteppersMoveTo(Poco::JSON::Object::Ptr& stepPtr, std::vector<long>& step)
+{
+	Poco::JSON::Array::Ptr arrayPtr = stepPtr->getArray("movements");
+
+	if(arrayPtr.isNull() || (arrayPtr->size() < 1)) {
+		return false;
+	}
+
+	step.clear();
+	step.push_back(CommandMacroUpload::STEPPERS_MOVE_TO);
+	step.push_back(arrayPtr->size());
+	for(unsigned int i=0; i<arrayPtr->size(); i++)
+	{
+		Poco::JSON::Object::Ptr movementPtr = arrayPtr->getObject(i);
+		long flags = 0;
+		int parameter = -1;
+
+		if(movementPtr->has("withPrevious") && movementPtr->getValue<bool>("withPrevious")) {
+			flags |= 1;
+		}
+		if(movementPtr->has("parameter")) {
+			parameter = movementPtr->getValue<int>("parameter");
+		}
+		if((parameter < -1) || (parameter > 126)) {
+			return false;
+		}
+		flags |= (parameter + 1) << 1;
+
+		step.push_back(movementPtr->getValue<unsigned int>("index"));
+		step.push_back(flags);
+		step.push_back(movementPtr->getValue<long>("position"));
+	}
+
+	return true;
+}
+
+//only commands which need no reply data can be a step of macro.
+bool CommandTranslator::getMacroStep(Poco::JSON::Object::Ptr& stepPtr, std::vector<long>& step)
+{
+	std::ostringstream stream;
+	std::string command = stepPtr->getValue<std::string>("command");
+
+	if(command == "steppers move to") {
+		return getMacroStepSteppersMoveTo(stepPtr, step);
+	}
+
+	stepPtr->stringify(stream);
+	CommandTranslator translator(stream.str());
+
+	switch(ToType(command))
+	{
+	case CommandType::DeviceDelay:
+		return toMacroStep(translator.GetCommandDeviceDelay(), step);
+	case CommandType::BdcCoast:
+		return toMacroStep(translator.GetCommandBdcCoast(), step);
+	case CommandType::BdcReverse:
+		return toMacroStep(translator.GetCommandBdcReverse(), step);
+	case CommandType::BdcForward:
+		return toMacroStep(translator.GetCommandBdcForward(), step);
+	case CommandType::BdcBreak:
+		return toMacroStep(translator.GetCommandBdcBreak(), step);
+	case CommandType::StepperConfigStep:
+		return toMacroStep(translator.GetCommandStepperConfigStep(), step);
+	case CommandType::StepperAccelerationBuffer:
+		return toMacroStep(translator.GetCommandStepperAccelerationBuffer(), step);
+	case CommandType::StepperAccelerationBufferDecrement:
+		return toMacroStep(translator.GetCommandStepperAccelerationBufferDecrement(), step);
+	case CommandType::StepperDecelerationBuffer:
+		return toMacroStep(translator.GetCommandStepperDecelerationBuffer(), step);
+	case CommandType::StepperDecelerationBufferIncrement:
+		return toMacroStep(translator.GetCommandStepperDecelerationBufferIncrement(), step);
+
+	default:
+		pLogger->LogError("CommandTranslator::getMacroStep command can't be a macro step: " + command);
+		return false;
+	}
+}
+
+std::shared_ptr<CommandMacroUpload> CommandTranslator::GetCommandMacroUpload()
+{
+	try
+	{
+		Poco::JSON::Parser parser;
+		Poco::Dynamic::Var result = parser.parse(_jsonCmd);
+		Poco::JSON::Object::Ptr objectPtr = result.extract<Poco::JSON::Object::Ptr>();
+
+		if(objectPtr->has(std::string("command")))
+		{
+			std::string command = objectPtr->getValue<std::string>("command");
+			unsigned long commandId = objectPtr->getValue<unsigned long>("commandId");
+
+			if(command.size() < 1) {
+				pLogger->LogError("CommandTranslator::GetCommandMacroUpload invalid command in " + _jsonCmd);
+			}
+			else if(ToType(command) != CommandType::MacroUpload) {
+				pLogger->LogError("CommandTranslator::GetCommandMacroUpload wrong command in " + _jsonCmd);
+			}
+			else
+			{
+				unsigned int macroId = objectPtr->getValue<unsigned int>("macroId");
+				Poco::JSON::Array::Ptr arrayPtr = objectPtr->getArray("steps");
+				std::vector<std::vector<long>> steps;
+
+				if(arrayPtr.isNull() || (arrayPtr->size() < 1)) {
+					pLogger->LogError("CommandTranslator::GetCommandMacroUpload no step in " + _jsonCmd);
+					return nullptr;
+				}
+				for(unsigned int i=0; i<arrayPtr->size(); i++)
+				{
+					Poco::JSON::Object::Ptr stepPtr = arrayPtr->getObject(i);
+					std::vector<long> step;
+
+					if(stepPtr.isNull() || !getMacroStep(stepPtr, step)) {
+						pLogger->LogError("CommandTranslator::GetCommandMacroUpload invalid step " + std::to_string(i) + " in " + _jsonCmd);
+						return nullptr;
+					}
+					steps.push_back(step);
+				}
+
+				auto p = std::make_shared<CommandMacroUpload>(macroId, steps, commandId);
+				return p;
+			}
+		}
+		else
+		{
+			pLogger->LogError("CommandTranslator::GetCommandMacroUpload no command in " + _jsonCmd);
+		}
+	}
+	catch(Poco::Exception& e)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandMacroUpload exception occurs: " + e.displayText() + " in " + _jsonCmd);
+	}
+	catch(...)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandMacroUpload unknown exception in " + _jsonCmd);
+	}
+
+	return nullptr;
+}
+
+std::shared_ptr<CommandMacroRun> CommandTranslator::GetCommandMacroRun()
+{
+	try
+	{
+		Poco::JSON::Parser parser;
+		Poco::Dynamic::Var result = parser.parse(_jsonCmd);
+		Poco::JSON::Object::Ptr objectPtr = result.extract<Poco::JSON::Object::Ptr>();
+
+		if(objectPtr->has(std::string("command")))
+		{
+			std::string command = objectPtr->getValue<std::string>("command");
+			unsigned long commandId = objectPtr->getValue<unsigned long>("commandId");
+
+			if(command.size() < 1) {
+				pLogger->LogError("CommandTranslator::GetCommandMacroRun invalid command in " + _jsonCmd);
+			}
+			else if(ToType(command) != CommandType::MacroRun) {
+				pLogger->LogError("CommandTranslator::GetCommandMacroRun wrong command in " + _jsonCmd);
+			}
+			else
+			{
+				unsigned int macroId = objectPtr->getValue<unsigned int>("macroId");
+				std::vector<long> parameters;
+
+				if(objectPtr->has("parameters"))
+				{
+					Poco::JSON::Array::Ptr arrayPtr = objectPtr->getArray("parameters");
+
+					for(unsigned int i=0; !arrayPtr.isNull() && (i<arrayPtr->size()); i++) {
+						parameters.push_back(arrayPtr->getElement<long>(i));
+					}
+				}
+
+				auto p = std::make_shared<CommandMacroRun>(macroId, parameters, commandId);
+				return p;
+			}
+		}
+		else
+		{
+			pLogger->LogError("CommandTranslator::GetCommandMacroRun no command in " + _jsonCmd);
+		}
+	}
+	catch(Poco::Exception& e)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandMacroRun exception occurs: " + e.displayText() + " in " + _jsonCmd);
+	}
+	catch(...)
+	{
+		pLogger->LogError("CommandTranslator::GetCommandMacroRun unknown exception in " + _jsonCmd);
+	}
+
+	return nullptr;
+}
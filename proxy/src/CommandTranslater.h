@@ -10,12 +10,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "Poco/Format.h"
 #include "Poco/JSON/Parser.h"
 #include "Poco/Dynamic/Var.h"
 #include "Poco/JSON/Object.h"
 #include "Poco/JSON/JSONException.h"
 #include "ProxyLogger.h"
+#include "DeviceCommandText.h"
 
 extern ProxyLogger * pLogger;
 
@@ -27,6 +29,7 @@ enum CommandType
 	DeviceDelay,
 	DeviceQueryPower,
 	DeviceQueryFuse,
+	DeviceQueryStatus,
 	OptPowerOn,
 	OptPowerOff,
 	OptQueryPower,
@@ -59,7 +62,11 @@ enum CommandType
 	StepperSetState,
 	StepperForwardClockwise,
 	LocatorQuery,
-	SolenoidActivate
+	SolenoidActivate,
+	SteppersMove,
+	MacroUpload,
+	MacroRun,
+	CommandTypeLast = MacroRun //keep it same as the last command type
 };
 
 //{
@@ -127,10 +134,10 @@ public:
 	CommandType Type() { return CommandType::DeviceQueryPower; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 2 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(2);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -152,10 +159,36 @@ public:
 	CommandType Type() { return CommandType::DeviceQueryFuse; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
+	{
+		text.Begin(3);
+		text.Append(_commandId & 0xffff);
+	}
+
+private:
+	unsigned long _commandId;
+};
+
+//{
+//	"command":"device query status",
+//	"commandId":1
+//}
+// device replies power, fuse, BDCs, steppers and locators status in one go.
+class CommandDeviceQueryStatus
+{
+public:
+	CommandDeviceQueryStatus(unsigned long commandId)
 	{
-		std::string cmd = "C 3 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		_commandId = commandId;
+	}
+
+	CommandType Type() { return CommandType::DeviceQueryStatus; }
+	unsigned long CommandId() { return _commandId; }
+
+	void Encode(DeviceCommandText& text)
+	{
+		text.Begin(5);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -179,12 +212,11 @@ public:
 	CommandType Type() { return CommandType::DeviceDelay; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 4 %d %ld", _clks,  _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(4);
+		text.Append(_clks);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -229,10 +261,10 @@ public:
 	CommandType Type() { return CommandType::BdcsPowerOn; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 40 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(40);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -249,10 +281,10 @@ public:
 	CommandType Type() { return CommandType::BdcsPowerOff; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 41 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(41);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -269,10 +301,10 @@ public:
 	CommandType Type() { return CommandType::BdcsQueryPower; }
 	unsigned long CommandId() { return _commandId; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 42 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(42);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -294,12 +326,11 @@ public:
 
 	CommandType Type() { return CommandType::BdcCoast; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 43 %d %ld", _bdcIndex,  _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(43);
+		text.Append(_bdcIndex);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -325,12 +356,14 @@ public:
 
 	CommandType Type() { return CommandType::BdcReverse; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 44 %d %d %d %d %ld", _bdcIndex, _lowClks, _highClks, _cycles, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(44);
+		text.Append(_bdcIndex);
+		text.Append(_lowClks);
+		text.Append(_highClks);
+		text.Append(_cycles);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -359,12 +392,14 @@ public:
 
 	CommandType Type() { return CommandType::BdcForward; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 45 %d %d %d %d %ld", _bdcIndex, _lowClks, _highClks, _cycles,  _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(45);
+		text.Append(_bdcIndex);
+		text.Append(_lowClks);
+		text.Append(_highClks);
+		text.Append(_cycles);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -390,12 +425,11 @@ public:
 
 	CommandType Type() { return CommandType::BdcBreak; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 46 %d %ld", _bdcIndex,  _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(46);
+		text.Append(_bdcIndex);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -418,12 +452,11 @@ public:
 
 	CommandType Type() { return CommandType::BdcQuery; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 47 %d %ld", _bdcIndex,  _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(47);
+		text.Append(_bdcIndex);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -444,10 +477,10 @@ public:
 
 	CommandType Type() { return CommandType::SteppersPowerOn; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 20 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(20);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -467,10 +500,10 @@ public:
 
 	CommandType Type() { return CommandType::SteppersPowerOff; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 21 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(21);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -490,10 +523,10 @@ public:
 
 	CommandType Type() { return CommandType::SteppersQueryPower; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 22 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(22);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -513,10 +546,10 @@ public:
 
 	CommandType Type() { return CommandType::StepperQueryResolution; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		std::string cmd = "C 50 " + std::to_string(_commandId & 0xffff);
-		return cmd;
+		text.Begin(50);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -548,12 +581,13 @@ public:
 
 	CommandType Type() { return CommandType::StepperConfigStep; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 51 %d %d %d %ld", _stepperIndex, _lowClks, _highClks, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(51);
+		text.Append(_stepperIndex);
+		text.Append(_lowClks);
+		text.Append(_highClks);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -579,12 +613,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperAccelerationBuffer; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 52 %d %d %ld", _stepperIndex, _buffer, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(52);
+		text.Append(_stepperIndex);
+		text.Append(_buffer);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -610,12 +644,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperAccelerationBufferDecrement; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 53 %d %d %ld", _stepperIndex, _decrement, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(53);
+		text.Append(_stepperIndex);
+		text.Append(_decrement);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -641,12 +675,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperDecelerationBuffer; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 54 %d %d %ld", _stepperIndex, _buffer, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(54);
+		text.Append(_stepperIndex);
+		text.Append(_buffer);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -672,12 +706,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperDecelerationBufferIncrement; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 55 %d %d %ld", _stepperIndex, _increment, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(55);
+		text.Append(_stepperIndex);
+		text.Append(_increment);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -703,12 +737,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperEnable; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 56 %d %d %ld", _stepperIndex, _enable ? 1 : 0, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(56);
+		text.Append(_stepperIndex);
+		text.Append(_enable ? 1 : 0);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -734,12 +768,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperForward; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 57 %d %d %ld", _stepperIndex, _forward ? 1 : 0, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(57);
+		text.Append(_stepperIndex);
+		text.Append(_forward ? 1 : 0);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -765,12 +799,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperSteps; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 58 %d %d %ld", _stepperIndex, _steps, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(58);
+		text.Append(_stepperIndex);
+		text.Append(_steps);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -788,12 +822,11 @@ public:
 
 	CommandType Type() { return CommandType::StepperRun; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 59 %d %ld", _stepperIndex, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(59);
+		text.Append(_stepperIndex);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -829,17 +862,14 @@ public:
 
 	CommandType Type() { return CommandType::StepperConfigHome; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 60 %d %d %d %d %ld",
-				_stepperIndex,
-				_locatorIndex,
-				_lineNumberStart,
-				_lineNumberTerminal,
-				_commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(60);
+		text.Append(_stepperIndex);
+		text.Append(_locatorIndex);
+		text.Append(_lineNumberStart);
+		text.Append(_lineNumberTerminal);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -862,12 +892,11 @@ public:
 
 	CommandType Type() { return CommandType::StepperQuery; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 61 %d %ld", _stepperIndex, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(61);
+		text.Append(_stepperIndex);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -893,12 +922,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperQuery; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 62 %d %d %ld", _stepperIndex, _state, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(62);
+		text.Append(_stepperIndex);
+		text.Append(_state);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -919,12 +948,12 @@ public:
 
 	CommandType Type() { return CommandType::StepperForwardClockwise; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 63 %d %d %ld", _stepperIndex, _clockwise?1:0, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(63);
+		text.Append(_stepperIndex);
+		text.Append(_clockwise?1:0);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -952,12 +981,11 @@ public:
 
 	CommandType Type() { return CommandType::LocatorQuery; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 100 %d %ld", _locatorIndex, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(100);
+		text.Append(_locatorIndex);
+		text.Append(_commandId & 0xffff);
 	}
 };
 
@@ -974,12 +1002,10 @@ public:
 
 	CommandType Type() { return CommandType::OptPowerOn; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 10 %ld", _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(10);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -999,12 +1025,10 @@ public:
 
 	CommandType Type() { return CommandType::OptPowerOff; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 11 %ld", _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(11);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1024,12 +1048,10 @@ public:
 
 	CommandType Type() { return CommandType::OptQueryPower; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 12 %ld", _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(12);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1051,12 +1073,11 @@ public:
 
 	CommandType Type() { return CommandType::DcmPowerOn; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 30 %d %ld", _index, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(30);
+		text.Append(_index);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1079,12 +1100,11 @@ public:
 
 	CommandType Type() { return CommandType::DcmPowerOff; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 31 %d %ld", _index, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(31);
+		text.Append(_index);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1107,12 +1127,11 @@ public:
 
 	CommandType Type() { return CommandType::DcmQueryPower; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-		sprintf(buf, "C 32 %d %ld", _index, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(32);
+		text.Append(_index);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1139,13 +1158,13 @@ public:
 
 	CommandType Type() { return CommandType::SolenoidActivate; }
 
-	std::string ToString()
+	void Encode(DeviceCommandText& text)
 	{
-		char buf[256];
-
-		sprintf(buf, "C 200 %d %d %d %ld", _index, _lowClks, _highClks, _commandId & 0xffff);
-		std::string cmd(buf);
-		return cmd;
+		text.Begin(200);
+		text.Append(_index);
+		text.Append(_lowClks);
+		text.Append(_highClks);
+		text.Append(_commandId & 0xffff);
 	}
 
 private:
@@ -1155,6 +1174,141 @@ private:
 	unsigned int _highClks;
 };
 
+//{
+//	"command":"steppers move",
+//	"movements":[{"index":0,"forward":true,"steps":100,"withPrevious":false},{"index":1,"forward":false,"steps":20,"withPrevious":true}]
+//}
+// device command: C 64 movementAmount index flags steps [index flags steps ...] commandId
+//   flags bit0: forward
+//   flags bit1: start together with the previous movement
+// device runs a group of concurrent movements, waits until all of them finish, then starts the next group.
+// device replies once after the last movement.
+class CommandSteppersMove
+{
+public:
+	struct Movement
+	{
+		unsigned int index;
+		bool forward;
+		unsigned long steps;
+		bool withPrevious;
+	};
+
+	CommandSteppersMove(const std::vector<Movement>& movements, unsigned long commandId)
+	{
+		_movements = movements;
+		_commandId = commandId;
+	}
+
+	CommandType Type() { return CommandType::SteppersMove; }
+
+	void Encode(DeviceCommandText& text)
+	{
+		text.Begin(64);
+		text.Append((int)_movements.size());
+		for(auto it = _movements.begin(); it != _movements.end(); it++)
+		{
+			int flags = (it->forward?1:0) | (it->withPrevious?2:0);
+
+			text.Append(it->index);
+			text.Append(flags);
+			text.Append(it->steps);
+		}
+		text.Append(_commandId & 0xffff);
+	}
+
+private:
+	std::vector<Movement> _movements;
+	unsigned long _commandId;
+};
+
+//{
+//	"command":"macro upload",
+//	"commandId":1,
+//	"macroId":0,
+//	"steps":[{"command":"bdc reverse","commandId":0,"index":0,"lowClks":3,"highClks":2,"cycles":3000},
+//			{"command":"steppers move to","movements":[{"index":4,"position":0,"withPrevious":false,"parameter":0}]}]
+//}
+// device command: C 65 macroId stepAmount commandNumber argumentAmount arguments [commandNumber argumentAmount arguments ...] commandId
+// a step is a device command without command id, device stores the steps and runs them when the macro is run.
+// "steppers move to" only exists in macro, it moves steppers to absolute positions:
+//   67 argumentAmount movementAmount index flags position [index flags position ...]
+//   flags bit0: start together with the previous movement
+//   flags bit1~7: 0 if position is used as it is, otherwise (parameter + 1), macro parameter is added to position.
+class CommandMacroUpload
+{
+public:
+	static const unsigned int STEPPERS_MOVE_TO = 67;
+
+	//step[0] is device command number, the rest are its arguments
+	CommandMacroUpload(unsigned int macroId, const std::vector<std::vector<long>>& steps, unsigned long commandId)
+	{
+		_macroId = macroId;
+		_steps = steps;
+		_commandId = commandId;
+	}
+
+	CommandType Type() { return CommandType::MacroUpload; }
+
+	void Encode(DeviceCommandText& text)
+	{
+		text.Begin(65);
+		text.Append(_macroId);
+		text.Append((unsigned int)_steps.size());
+		for(auto it = _steps.begin(); it != _steps.end(); it++)
+		{
+			text.Append(it->front());
+			text.Append((unsigned int)(it->size() - 1));
+			for(auto argIt = it->begin() + 1; argIt != it->end(); argIt++) {
+				text.Append(*argIt);
+			}
+		}
+		text.Append(_commandId & 0xffff);
+	}
+
+private:
+	unsigned int _macroId;
+	std::vector<std::vector<long>> _steps;
+	unsigned long _commandId;
+};
+
+//{
+//	"command":"macro run",
+//	"commandId":1,
+//	"macroId":0,
+//	"parameters":[1200, -3]
+//}
+// device command: C 66 macroId parameterAmount parameters commandId
+// device replies once after the last step, with positions of all steppers.
+class CommandMacroRun
+{
+public:
+	CommandMacroRun(unsigned int macroId, const std::vector<long>& parameters, unsigned long commandId)
+	{
+		_macroId = macroId;
+		_parameters = parameters;
+		_commandId = commandId;
+	}
+
+	CommandType Type() { return CommandType::MacroRun; }
+
+	void Encode(DeviceCommandText& text)
+	{
+		text.Begin(66);
+		text.Append(_macroId);
+		text.Append((unsigned int)_parameters.size());
+		for(auto it = _parameters.begin(); it != _parameters.end(); it++) {
+			text.Append(*it);
+		}
+		text.Append(_commandId & 0xffff);
+	}
+
+private:
+	unsigned int _macroId;
+	std::vector<long> _parameters;
+	unsigned long _commandId;
+};
+
 // translate JSON command to device command
 class CommandTranslator
 {
@@ -1164,10 +1318,14 @@ public:
 	CommandType Type();
 	std::string JsonCommand();
 
+	// command type of a JSON command name, Invalid if name is unknown.
+	static CommandType ToType(const std::string& command);
+
 	std::shared_ptr<CommandDevicesGet> GetCommandDevicesGet();
 	std::shared_ptr<CommandDeviceConnect> GetCommandDeviceConnect();
 	std::shared_ptr<CommandDeviceQueryPower> GetCommandDeviceQueryPower();
 	std::shared_ptr<CommandDeviceQueryFuse> GetCommandDeviceQueryFuse();
+	std::shared_ptr<CommandDeviceQueryStatus> GetCommandDeviceQueryStatus();
 	std::shared_ptr<CommandDeviceDelay> GetCommandDeviceDelay();
 	std::shared_ptr<CommandBdcsPowerOn> GetCommandBdcsPowerOn();
 	std::shared_ptr<CommandBdcsPowerOff> GetCommandBdcsPowerOff();
@@ -1202,49 +1360,18 @@ public:
 	std::shared_ptr<CommandDcmPowerOff> GetCommandDcmPowerOff();
 	std::shared_ptr<CommandDcmQueryPower> GetCommandDcmQueryPower();
 	std::shared_ptr<CommandSolenoidActivate> GetCommandSolenoidActivate();
+	std::shared_ptr<CommandSteppersMove> GetCommandSteppersMove();
+	std::shared_ptr<CommandMacroUpload> GetCommandMacroUpload();
+	std::shared_ptr<CommandMacroRun> GetCommandMacroRun();
 
 private:
 	std::string _jsonCmd;
 	CommandType _type;
 
-	const std::string strCommandDevicesGet = "devices get";
-	const std::string strCommandDeviceConnect = "device connect";
-	const std::string strCommandDeviceQueryPower = "device query power";
-	const std::string strCommandDeviceQueryFuse = "device query fuse";
-	const std::string strCommandDeviceDelay = "device delay";
-	const std::string strCommandBdcsPowerOn = "bdcs power on";
-	const std::string strCommandBdcsPowerOff = "bdcs power off";
-	const std::string strCommandBdcsQueryPower = "bdcs query power";
-	const std::string strCommandBdcCoast = "bdc coast";
-	const std::string strCommandBdcReverse = "bdc reverse";
-	const std::string strCommandBdcForward = "bdc forward";
-	const std::string strCommandBdcBreak = "bdc break";
-	const std::string strCommandBdcQuery = "bdc query";
-	const std::string strCommandSteppersPowerOn = "steppers power on";
-	const std::string strCommandSteppersPowerOff = "steppers power off";
-	const std::string strCommandSteppersQueryPower = "steppers query power";
-	const std::string strCommandStepperQueryResolution = "stepper query resolution";
-	const std::string strCommandStepperConfigStep = "stepper config step";
-	const std::string strCommandStepperAccelerationBuffer = "stepper acceleration buffer";
-	const std::string strCommandStepperAccelerationBufferDecrement = "stepper acceleration buffer decrement";
-	const std::string strCommandStepperDecelerationBuffer = "stepper deceleration buffer";
-	const std::string strCommandStepperDecelerationBufferIncrement = "stepper deceleration buffer increment";
-	const std::string strCommandStepperEnable = "stepper enable";
-	const std::string strCommandStepperForward = "stepper forward";
-	const std::string strCommandStepperSteps = "stepper steps";
-	const std::string strCommandStepperRun = "stepper run";
-	const std::string strCommandStepperConfigHome = "stepper config home";
-	const std::string strCommandStepperQuery = "stepper query";
-	const std::string strCommandStepperSetState = "stepper set state";
-	const std::string strCommandStepperForwardClockwise = "stepper forward clockwise";
-	const std::string strCommandLocatorQuery = "locator query";
-	const std::string strCommandOptPowerOn = "opt power on";
-	const std::string strCommandOptPowerOff = "opt power off";
-	const std::string strCommandOptQueryPower = "opt query power";
-	const std::string strCommandDcmPowerOn = "dcm power on";
-	const std::string strCommandDcmPowerOff = "dcm power off";
-	const std::string strCommandDcmQueryPower = "dcm query power";
-	const std::string strCommandSolenoidActivate = "solenoid activate";
+	//encode a step of macro upload into device command number and arguments
+	static bool getMacroStep(Poco::JSON::Object::Ptr& stepPtr, std::vector<long>& step);
+	static bool getMacroStepSteppersMoveTo(Poco::JSON::Object::Ptr& stepPtr, std::vector<long>& step);
+	template<typename Command> static bool toMacroStep(std::shared_ptr<Command> cmdPtr, std::vector<long>& step);
 };
 
 #endif /* COMMANDPARSER_H_ */
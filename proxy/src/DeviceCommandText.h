@@ -0,0 +1,96 @@
+/*
+ * DeviceCommandText.h
+ */
+
+#ifndef DEVICECOMMANDTEXT_H_
+#define DEVICECOMMANDTEXT_H_
+
+#include <string>
+
+/**
+ * Text of a device command, such as "C 58 1 200 17".
+ * The text is built in a buffer inside this object, so a command can be encoded on stack without heap allocation.
+ * Numbers are converted to decimal digits directly, sprintf and std::string aren't involved.
+ */
+class DeviceCommandText
+{
+public:
+	static const unsigned int MAX_LENGTH = 4096;
+
+	DeviceCommandText()
+	{
+		_length = 0;
+		_overflow = false;
+	}
+
+	// start a command, text is "C <commandNumber>" afterwards.
+	void Begin(unsigned int commandNumber)
+	{
+		_length = 0;
+		_overflow = false;
+		if(reserve(1)) {
+			_buffer[_length++] = 'C';
+		}
+		Append(commandNumber);
+	}
+
+	// append " <value>"
+	void Append(unsigned long value) { appendNumber(value, false); }
+	void Append(unsigned int value) { appendNumber(value, false); }
+	void Append(long value)
+	{
+		if(value < 0) {
+			appendNumber(0UL - (unsigned long)value, true);
+		}
+		else {
+			appendNumber(value, false);
+		}
+	}
+	void Append(int value) { Append((long)value); }
+
+	const char * Data() const { return _buffer; }
+	unsigned int Length() const { return _length; }
+	// text is truncated if it is too long, such command shouldn't be sent.
+	bool Overflow() const { return _overflow; }
+
+	std::string ToString() const { return std::string(_buffer, _length); }
+
+private:
+	char _buffer[MAX_LENGTH];
+	unsigned int _length;
+	bool _overflow;
+
+	bool reserve(unsigned int amount)
+	{
+		if(_overflow || (_length + amount > MAX_LENGTH)) {
+			_overflow = true;
+			return false;
+		}
+		return true;
+	}
+
+	void appendNumber(unsigned long value, bool negative)
+	{
+		char digits[24];
+		unsigned int amount = 0;
+
+		do
+		{
+			digits[amount++] = '0' + (value % 10);
+			value = value / 10;
+		} while(value > 0);
+
+		if(!reserve(amount + (negative ? 2 : 1))) {
+			return;
+		}
+		_buffer[_length++] = ' ';
+		if(negative) {
+			_buffer[_length++] = '-';
+		}
+		while(amount > 0) {
+			_buffer[_length++] = digits[--amount];
+		}
+	}
+};
+
+#endif /* DEVICECOMMANDTEXT_H_ */
@@ -0,0 +1,250 @@
+/*
+ * FirmwareReply.cpp
+ */
+
+#include <string.h>
+#include "FirmwareReply.h"
+
+bool FirmwareReply::Text::Equals(const char * pText) const
+{
+	return (strlen(pText) == length) && (memcmp(pData, pText, length) == 0);
+}
+
+bool FirmwareReply::Text::Equals(const std::string & text) const
+{
+	return (text.size() == length) && (memcmp(pData, text.data(), length) == 0);
+}
+
+FirmwareReply::FirmwareReply()
+{
+	_memberAmount = 0;
+	_itemAmount = 0;
+}
+
+void FirmwareReply::skipSpaces(const char *& p, const char * pEnd)
+{
+	while((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))) {
+		p++;
+	}
+}
+
+bool FirmwareReply::parseText(const char *& p, const char * pEnd, Text & text)
+{
+	if((p >= pEnd) || (*p != '"')) {
+		return false;
+	}
+	p++;
+
+	const char * pStart = p;
+	for(; p < pEnd; p++)
+	{
+		if(*p == '"') {
+			break;
+		}
+		if((*p == '\\') || ((unsigned char)(*p) < 0x20)) {
+			return false; //escaped text is left to generic parser
+		}
+	}
+	if(p >= pEnd) {
+		return false;
+	}
+
+	text.pData = pStart;
+	text.length = p - pStart;
+	p++;
+
+	return true;
+}
+
+bool FirmwareReply::parseArray(const char *& p, const char * pEnd, Member & member)
+{
+	//p points to '['
+	p++;
+	member.isArray = true;
+	member.firstItem = _itemAmount;
+	member.itemAmount = 0;
+
+	skipSpaces(p, pEnd);
+	if((p < pEnd) && (*p == ']')) {
+		p++;
+		return true;
+	}
+	for(;;)
+	{
+		if(_itemAmount >= MAX_ITEMS) {
+			return false;
+		}
+		if(!parseText(p, pEnd, _items[_itemAmount])) {
+			return false;
+		}
+		_itemAmount++;
+		member.itemAmount++;
+
+		skipSpaces(p, pEnd);
+		if(p >= pEnd) {
+			return false;
+		}
+		if(*p == ']') {
+			p++;
+			return true;
+		}
+		if(*p != ',') {
+			return false;
+		}
+		p++;
+		skipSpaces(p, pEnd);
+	}
+}
+
+bool FirmwareReply::Parse(const char * pData, unsigned int length)
+{
+	const char * p = pData;
+	const char * pEnd = pData + length;
+
+	_memberAmount = 0;
+	_itemAmount = 0;
+
+	skipSpaces(p, pEnd);
+	if((p >= pEnd) || (*p != '{')) {
+		return false;
+	}
+	p++;
+	skipSpaces(p, pEnd);
+
+	if((p < pEnd) && (*p == '}')) {
+		p++;
+	}
+	else
+	{
+		for(;;)
+		{
+			Member member;
+
+			if(_memberAmount >= MAX_MEMBERS) {
+				return false;
+			}
+			if(!parseText(p, pEnd, member.key)) {
+				return false;
+			}
+			skipSpaces(p, pEnd);
+			if((p >= pEnd) || (*p != ':')) {
+				return false;
+			}
+			p++;
+			skipSpaces(p, pEnd);
+
+			if((p < pEnd) && (*p == '['))
+			{
+				if(!parseArray(p, pEnd, member)) {
+					return false;
+				}
+			}
+			else
+			{
+				member.isArray = false;
+				member.firstItem = 0;
+				member.itemAmount = 0;
+				if(!parseText(p, pEnd, member.value)) {
+					return false; //number, object, etc.
+				}
+			}
+			_members[_memberAmount++] = member;
+
+			skipSpaces(p, pEnd);
+			if(p >= pEnd) {
+				return false;
+			}
+			if(*p == '}') {
+				p++;
+				break;
+			}
+			if(*p != ',') {
+				return false;
+			}
+			p++;
+			skipSpaces(p, pEnd);
+		}
+	}
+
+	skipSpaces(p, pEnd);
+
+	return p == pEnd;
+}
+
+const FirmwareReply::Member * FirmwareReply::find(const char * pKey) const
+{
+	//the last one wins if a key is duplicated, same as Poco::JSON::Object
+	for(unsigned int i = _memberAmount; i > 0; i--)
+	{
+		if(_members[i - 1].key.Equals(pKey)) {
+			return &_members[i - 1];
+		}
+	}
+
+	return nullptr;
+}
+
+bool FirmwareReply::Has(const char * pKey) const
+{
+	return find(pKey) != nullptr;
+}
+
+bool FirmwareReply::GetText(const char * pKey, Text & value) const
+{
+	auto pMember = find(pKey);
+
+	if((pMember == nullptr) || pMember->isArray) {
+		return false;
+	}
+	value = pMember->value;
+
+	return true;
+}
+
+bool FirmwareReply::GetHexValue(const char * pKey, unsigned long & value) const
+{
+	Text text;
+
+	if(!GetText(pKey, text)) {
+		return false;
+	}
+
+	return ToHexValue(text, value);
+}
+
+bool FirmwareReply::GetArray(const char * pKey, unsigned int & first, unsigned int & amount) const
+{
+	auto pMember = find(pKey);
+
+	if((pMember == nullptr) || !pMember->isArray) {
+		return false;
+	}
+	first = pMember->firstItem;
+	amount = pMember->itemAmount;
+
+	return true;
+}
+
+bool FirmwareReply::ToHexValue(const Text & text, unsigned long & value)
+{
+	value = 0;
+	for(unsigned int i=0; i<text.length; i++)
+	{
+		char c = text.pData[i];
+
+		if((c >= '0') && (c <= '9')) {
+			value = (value << 4) + (c - '0');
+		}
+		else if((c >= 'a') && (c <= 'f')) {
+			value = (value << 4) + (c - 'a' + 10);
+		}
+		else if((c >= 'A') && (c <= 'F')) {
+			value = (value << 4) + (c - 'A' + 10);
+		}
+		else {
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,71 @@
+/*
+ * FirmwareReply.h
+ */
+
+#ifndef FIRMWAREREPLY_H_
+#define FIRMWAREREPLY_H_
+
+#include <string>
+
+/**
+ * Flat view of a reply from firmware, such as
+ *   {"command":"3b","params":["1","2","ff"],"state":"idle"}
+ *   {"event":"stepper known position","index":"2"}
+ * Keys and values point into the parsed text, nothing is allocated or copied.
+ * Only string values and arrays of strings without escapes are accepted.
+ * Parse() returns false for any other shape, the caller then falls back to a generic JSON parser.
+ */
+class FirmwareReply
+{
+public:
+	struct Text
+	{
+		const char * pData;
+		unsigned int length;
+
+		bool Equals(const char * pText) const;
+		bool Equals(const std::string & text) const;
+	};
+
+	FirmwareReply();
+
+	// text must outlive this object.
+	bool Parse(const char * pData, unsigned int length);
+
+	bool Has(const char * pKey) const;
+	// false if member doesn't exist or isn't a string.
+	bool GetText(const char * pKey, Text & value) const;
+	// false if member doesn't exist, isn't a string or isn't hexadecimal.
+	bool GetHexValue(const char * pKey, unsigned long & value) const;
+	// false if member doesn't exist or isn't an array.
+	bool GetArray(const char * pKey, unsigned int & first, unsigned int & amount) const;
+	const Text & Item(unsigned int index) const { return _items[index]; }
+
+	// same conversion as ReplyTranslater::getHexValue(), empty text is 0.
+	static bool ToHexValue(const Text & text, unsigned long & value);
+
+private:
+	static const unsigned int MAX_MEMBERS = 24;
+	static const unsigned int MAX_ITEMS = 64;
+
+	struct Member
+	{
+		Text key;
+		Text value;
+		bool isArray;
+		unsigned int firstItem;
+		unsigned int itemAmount;
+	};
+
+	Member _members[MAX_MEMBERS];
+	unsigned int _memberAmount;
+	Text _items[MAX_ITEMS];
+	unsigned int _itemAmount;
+
+	const Member * find(const char * pKey) const;
+	static void skipSpaces(const char *& p, const char * pEnd);
+	static bool parseText(const char *& p, const char * pEnd, Text & text);
+	bool parseArray(const char *& p, const char * pEnd, Member & member);
+};
+
+#endif /* FIRMWAREREPLY_H_ */
@@ -3,7 +3,8 @@
 class IDevice
 {
 public:
-    virtual void SendCommand(const std::string& deviceName, const std::string& command) = 0;
+    //command is text of "length" characters, without terminator
+    virtual void SendCommand(const std::string& deviceName, const char * pCommand, unsigned int length) = 0;
     virtual ~IDevice() {}
 };
 
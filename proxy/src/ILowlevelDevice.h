@@ -4,8 +4,6 @@
 #include <deque>
 #include <vector>
 
-#include "Poco/Task.h"
-
 enum class LowlevelDeviceState
 {
 	DeviceConnected,
@@ -24,26 +22,31 @@ class ILowlevelDeviceObsesrver
 public:
 	virtual ~ILowlevelDeviceObsesrver() {}
 
-	virtual void onLowlevelDeviceReply(const std::string & deviceName, std::deque<unsigned char> & data) = 0;
+	// data is valid only in this call.
+	virtual void onLowlevelDeviceReply(const std::string & deviceName, const unsigned char * pData, unsigned int length) = 0;
 	virtual void onLowlevelDeviceWritable(const std::string & deviceName, ILowlevelDevice * pLowlevelDevice) = 0;
 	virtual void onLowlevelDeviceState(const std::string & deviceName, const LowlevelDeviceState state, const std::string & info) = 0;
 };
 
 /**
-sub class implements the run() in Poco::Task, exchange data with device specified by parameter 'name'.
+sub class exchanges data with device specified by parameter 'name'.
 */
-class ILowlevelDevice: public Poco::Task
+class ILowlevelDevice
 {
 public:
-	ILowlevelDevice(const std::string & name, ILowlevelDeviceObsesrver * pObserver): Task(name)
+	ILowlevelDevice(const std::string & name, ILowlevelDeviceObsesrver * pObserver)
 	{
 		_name = name;
 		_pObserver = pObserver;
 	}
 	virtual ~ILowlevelDevice() {}
 
-	virtual bool SendData(const std::vector<unsigned char> & command, std::string & info) = 0;
+	// data is copied to device's output buffer.
+	virtual bool SendData(const unsigned char * pData, unsigned int length, std::string & info) = 0;
 	virtual void Disconnect() = 0;
+	// observer has data for device, onLowlevelDeviceWritable() will be called once device can be written.
+	// sub class which asks observer for data all the time doesn't need it.
+	virtual void RequestWriting() {}
 
 protected:
 	std::string _name;
@@ -2,17 +2,18 @@
 #if defined(_WIN32) || defined(_WIN64)
 #else
 
-#include <poll.h>
 #include <stddef.h>
 #include <termios.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <string.h>
 
 #include "Poco/File.h"
 
 #include "LinuxComDevice.h"
+#include "LinuxComEngine.h"
 #include "ProxyLogger.h"
 
 extern ProxyLogger * pLogger;
@@ -22,12 +23,16 @@ LinuxComDevice::LinuxComDevice(const std::string & name, ILowlevelDeviceObsesrve
 {
 	_fd = -1;
 	_bExit = false;
+	_bWritingRequested = false;
 	_state = LowlevelDeviceState::DeviceNotConnected;
+	_pEngine = nullptr;
+	_outputOffset = 0;
+	_outputBuffer.reserve(BUFFER_SIZE);
 }
 
 LinuxComDevice::~LinuxComDevice()
 {
-
+	closeDevice();
 }
 
 void LinuxComDevice::openDevice()
@@ -52,6 +57,7 @@ void LinuxComDevice::openDevice()
 			auto e = errno;
 			pLogger->LogError("LinuxComDevice::openDevice tcgetattr errno: " + std::to_string(e));
 			close(_fd);
+			_fd = -1;
 			return;
 		}
 		rc = cfsetspeed(&tios, B115200);
@@ -60,6 +66,7 @@ void LinuxComDevice::openDevice()
 			auto e = errno;
 			pLogger->LogError("LinuxComDevice::openDevice cfsetspeed errno: " + std::to_string(e));
 			close(_fd);
+			_fd = -1;
 			return;
 		}
 #if 0
@@ -108,6 +115,7 @@ void LinuxComDevice::openDevice()
 			auto e = errno;
 			pLogger->LogError("LinuxComDevice::openDevice tcsetattr errno: " + std::to_string(e));
 			close(_fd);
+			_fd = -1;
 			return;
 		}
 	}
@@ -116,226 +124,189 @@ void LinuxComDevice::openDevice()
 	_state = LowlevelDeviceState::DeviceNormal;
 }
 
-bool LinuxComDevice::receiveData()
+void LinuxComDevice::closeDevice()
 {
-	pollfd desc;
-
-	desc.fd = _fd;
-	desc.events = POLLIN | POLLERR;
-	desc.revents = 0;
-
-	if(!_inputQueue.empty()) {
-		_pObserver->onLowlevelDeviceReply(_name, _inputQueue);
+	if(_fd >= 0) {
+		close(_fd);
+		_fd = -1;
+		pLogger->LogInfo("LinuxComDevice::closeDevice file is closed: " + _name);
 	}
+}
 
-	auto rc = poll(&desc, 1, READING_TIMEOUT);
-	auto errorNumber = errno;
+Poco::Timestamp::TimeDiff LinuxComDevice::checkState()
+{
+	Poco::Timestamp::TimeDiff delay = 0;
 
-	if(rc == 0) {
-		return true; //nothing to read
+	if(_bExit) {
+		closeDevice();
+		return 0;
 	}
-	if(rc < 0)
-	{
-		pLogger->LogError("LinuxComDevice::receiveData error in poll: " + _name + " errno: " + std::to_string(errorNumber));
-		_state = LowlevelDeviceState::DeviceError;
-		return false;
-	}
-	if((desc.events & POLLERR) && (errorNumber > 0)) {
-		pLogger->LogError("LinuxComDevice::receiveData error in poll: " + _name + " errno: " + std::to_string(errorNumber));
-		_state = LowlevelDeviceState::DeviceError;
-		return false;
-	}
-
-	auto amount = read(_fd, _inputBuffer, 1024);
-	errorNumber = errno;
 
-	if(amount < 0) {
-		pLogger->LogError("LinuxComDevice::receiveData failed in reading device: " + _name + " errno: " + std::to_string(errorNumber));
-		_state = LowlevelDeviceState::DeviceError;
-	}
-	else if (amount == 0) {
-		pLogger->LogError("LinuxComDevice::receiveData no data is read from device: " + _name + " errno: " + std::to_string(errorNumber));
-	}
-	else if(amount > 0)
+	switch(_state)
 	{
-		std::string content;
+		case LowlevelDeviceState::DeviceNotConnected:
+		{
+			if(_stateStamp.elapsed() < CHECKING_INTERVAL) {
+				delay = CHECKING_INTERVAL - _stateStamp.elapsed();
+				break;
+			}
 
-		for(unsigned int i=0; i<amount; i++) {
-			_inputQueue.push_back(_inputBuffer[i]);
-			content.push_back((_inputBuffer[i]));
-		}
-		pLogger->LogInfo("LinuxComDevice::receiveData received " + std::to_string(amount) + " bytes from " + _name);
-		pLogger->LogInfo("LinuxComDevice::receiveData << " + _name + ": " + content);
+			Poco::File file(_name);
 
-		_pObserver->onLowlevelDeviceReply(_name, _inputQueue);
-	}
+			_stateStamp.update();
+			if(file.exists()) {
+				_state = LowlevelDeviceState::DeviceConnected;
+				_pObserver->onLowlevelDeviceState(_name, _state, _name + " connected");
+				delay = OPENING_DELAY;
+			}
+			else {
+				_pObserver->onLowlevelDeviceState(_name, _state, _name + " not connected");
+				delay = CHECKING_INTERVAL; //continue to check device existence 1 second later.
+			}
+		}
+		break;
 
-	return true;
-}
+		case LowlevelDeviceState::DeviceConnected:
+		{
+			if(_stateStamp.elapsed() < OPENING_DELAY) {
+				delay = OPENING_DELAY - _stateStamp.elapsed();
+				break;
+			}
 
-bool LinuxComDevice::sendData()
-{
-	int amount = 0;
+			openDevice();
+			_stateStamp.update();
+			if(_state == LowlevelDeviceState::DeviceNormal) {
+				_pObserver->onLowlevelDeviceState(_name, _state, _name + " is opened successfully");
+			}
+			else {
+				_state = LowlevelDeviceState::DeviceNotConnected;
+				delay = CHECKING_INTERVAL;
+			}
+		}
+		break;
 
-	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+		case LowlevelDeviceState::DeviceNormal:
+			break;
 
-	if(_outputQueue.empty()) {
-		_pObserver->onLowlevelDeviceWritable(_name, this); //ask for data from observer
-	}
+		case LowlevelDeviceState::DeviceError:
+		{
+			pLogger->LogError("LinuxComDevice::checkState device error: " + _name);
+			closeDevice();
+			_pObserver->onLowlevelDeviceState(_name, _state, "");
+			_bExit = true;
+		}
+		break;
 
-	if(_outputQueue.empty()) {
-		return true;
+		default:
+		{
+			pLogger->LogError("LinuxComDevice::checkState wrong device state in " + _name + " : " + std::to_string((int)_state));
+			closeDevice();
+			_bExit = true;
+		}
+		break;
 	}
 
-	std::vector<unsigned char> data;
-	for(unsigned int i=0; i<_outputQueue.size(); i++) {
-		data.push_back(_outputQueue[i]);
-	}
+	return delay;
+}
 
-	//write data to device
+bool LinuxComDevice::receiveData()
+{
+	for(;;)
 	{
-		pollfd desc;
-
-		desc.fd = _fd;
-		desc.events = POLLOUT | POLLERR;
-
-		auto rc = poll(&desc, 1, WRITING_TIMEOUT);
+		auto amount = read(_fd, _inputBuffer, BUFFER_SIZE);
 		auto errorNumber = errno;
 
-		if(rc == 0)
-		{
-			pLogger->LogError("LinuxComDevice::sendData device not respond: " + _name);
-			_state = LowlevelDeviceState::DeviceError;
-			return false;
-		}
-		if(rc < 0)
+		if(amount < 0)
 		{
-			pLogger->LogError("LinuxComDevice::sendData error in polling: " + _name);
+			if((errorNumber == EAGAIN) || (errorNumber == EWOULDBLOCK) || (errorNumber == EINTR)) {
+				break; //nothing more to read
+			}
+			pLogger->LogError("LinuxComDevice::receiveData failed in reading device: " + _name + " errno: " + std::to_string(errorNumber));
 			_state = LowlevelDeviceState::DeviceError;
 			return false;
 		}
-		if((desc.events & POLLERR) && (errorNumber > 0)) {
-			pLogger->LogError("LinuxComDevice::sendData error in events: " + _name + " errno: " + std::to_string((int)errorNumber));
-			_state = LowlevelDeviceState::DeviceError;
-			return false;
+		if(amount == 0) {
+			break; //nothing more to read
 		}
 
-		if(desc.events & POLLOUT)
-		{
-			amount = write(_fd, data.data(), data.size());
-			errorNumber = errno;
-
-			if(amount < 0)
-			{
-				pLogger->LogError("LinuxComDevice::sendData error in sending: " + _name + " errno: " + std::to_string((int)errorNumber));
-				_state = LowlevelDeviceState::DeviceError;
-				return false;
-			}
-			else if(amount > 0)
-			{
-				std::string info;
-				pLogger->LogInfo("LinuxComDevice::sendData wrote " + std::to_string(amount) + " bytes to " + _name);
-				for(int i=0; i<amount; i++) {
-					info.push_back(data[i]);
-				}
-				pLogger->LogInfo("LinuxComDevice::sendData >> " + _name + ": " + info);
-			}
-			else if(amount == 0)
-			{
-				pLogger->LogError("LinuxComDevice::sendData failed in writing device: " + _name);
-			}
+		if(pLogger->IsTraceEnabled()) {
+			pLogger->LogTrace("LinuxComDevice::receiveData << " + _name + " " + std::to_string(amount) + " bytes: " + std::string((char *)_inputBuffer, amount));
 		}
-	}
+		_pObserver->onLowlevelDeviceReply(_name, _inputBuffer, amount);
 
-	//remove data which has been sent.
-	for(int i=0; i<amount; i++) {
-		_outputQueue.pop_front();
+		if(amount < (ssize_t)BUFFER_SIZE) {
+			break; //device input buffer is drained
+		}
 	}
 
 	return true;
 }
 
-void LinuxComDevice::runTask()
+bool LinuxComDevice::sendData()
 {
-	pLogger->LogInfo("LinuxComDevice::runTask runs for: " + _name);
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	_bWritingRequested = false;
 
 	for(;;)
 	{
-		if(isCancelled()) {
-			break;
+		if(_outputOffset >= _outputBuffer.size())
+		{
+			_outputBuffer.clear();
+			_outputOffset = 0;
+			_pObserver->onLowlevelDeviceWritable(_name, this); //ask for data from observer
 		}
-		else if(_bExit) {
+		if(_outputBuffer.empty()) {
 			break;
 		}
 
-		switch(_state)
-		{
-			case LowlevelDeviceState::DeviceConnected:
-			{
-				sleep(1000);
-
-				openDevice();
-				if(_state == LowlevelDeviceState::DeviceNormal) {
-					_pObserver->onLowlevelDeviceState(_name, _state, _name + " is opened successfully");
-				}
-				else {
-					_state = LowlevelDeviceState::DeviceNotConnected;
-				}
-			}
-			break;
-
-			case LowlevelDeviceState::DeviceNormal:
-			{
-				// _state is changed if any error in data exchange
-				if(sendData()) {
-					//no error in sendData(), then readData.
-					receiveData();
-				}
-			}
-			break;
+		auto pData = _outputBuffer.data() + _outputOffset;
+		auto size = _outputBuffer.size() - _outputOffset;
+		auto amount = write(_fd, pData, size);
+		auto errorNumber = errno;
 
-			case LowlevelDeviceState::DeviceError:
-			{
-				pLogger->LogError("LinuxComDevice::runTask device error: " + _name);
-				_pObserver->onLowlevelDeviceState(_name, _state, "");
-				_bExit = true;
+		if(amount < 0)
+		{
+			if((errorNumber == EAGAIN) || (errorNumber == EWOULDBLOCK) || (errorNumber == EINTR)) {
+				break; //device can't accept more data, LinuxComEngine waits for it to be writable
 			}
+			pLogger->LogError("LinuxComDevice::sendData error in sending: " + _name + " errno: " + std::to_string((int)errorNumber));
+			_state = LowlevelDeviceState::DeviceError;
+			return false;
+		}
+		else if(amount == 0)
+		{
+			pLogger->LogError("LinuxComDevice::sendData failed in writing device: " + _name);
 			break;
+		}
 
-			case LowlevelDeviceState::DeviceNotConnected:
-			{
-				Poco::File file(_name);
-
-				if(file.exists()) {
-					_state = LowlevelDeviceState::DeviceConnected;
-					_pObserver->onLowlevelDeviceState(_name, _state, _name + " connected");
-				}
-				else {
-					_pObserver->onLowlevelDeviceState(_name, _state, _name + " not connected");
-					sleep(1000); //continue to check device existence 1 second later.
-				}
-			}
-			break;
+		if(pLogger->IsTraceEnabled()) {
+			pLogger->LogTrace("LinuxComDevice::sendData >> " + _name + " " + std::to_string(amount) + " bytes: " + std::string((char *)pData, amount));
+		}
+		_outputOffset += amount;
 
-			default:
-			{
-				pLogger->LogError("LinuxComDevice::runTask wrong device state in " + _name + " : " + std::to_string((int)_state));
-				_bExit = true;
-			}
-			break;
+		if((size_t)amount < size) {
+			break; //device output buffer is full
 		}
 	}
 
-	pLogger->LogInfo("LinuxComDevice::runTask for " + _name + " existed");
+	return true;
 }
 
-bool LinuxComDevice::SendData(const std::vector<unsigned char> & command, std::string & info)
+bool LinuxComDevice::hasOutput()
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	return _outputOffset < _outputBuffer.size();
+}
+
+bool LinuxComDevice::SendData(const unsigned char * pData, unsigned int length, std::string & info)
 {
 	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
 
 	info.clear();
 
-	if(command.empty()) {
+	if((pData == nullptr) || (length == 0)) {
 		info = EMPTY_COMMAND;
 		return false;
 	}
@@ -351,14 +322,12 @@ bool LinuxComDevice::SendData(const std::vector<unsigned char> & command, std::s
 		info = DEVICE_NOT_NORMAL;
 		return false;
 	}
-	if(_outputQueue.size() > MAX_OUTPUT_QUEUE_SIZE) {
+	if((_outputBuffer.size() - _outputOffset) > MAX_OUTPUT_QUEUE_SIZE) {
 		info = DEVICE_NOT_ACCEPT_FURTHER_DATA;
 		return false;
 	}
 
-	for (unsigned int i = 0; i < command.size(); i++) {
-		_outputQueue.push_back(command[i]);
-	}
+	_outputBuffer.insert(_outputBuffer.end(), pData, pData + length);
 
 	return true;
 }
@@ -366,6 +335,20 @@ bool LinuxComDevice::SendData(const std::vector<unsigned char> & command, std::s
 void LinuxComDevice::Disconnect()
 {
 	_bExit = true;
+	if(_pEngine != nullptr) {
+		_pEngine->Wakeup();
+	}
+}
+
+void LinuxComDevice::RequestWriting()
+{
+	//wake up engine only once till the request is served.
+	if(!_bWritingRequested.exchange(true))
+	{
+		if(_pEngine != nullptr) {
+			_pEngine->Wakeup();
+		}
+	}
 }
 
 #endif
@@ -3,22 +3,32 @@
 #if defined(_WIN32) || defined(_WIN64)
 #else
 
+#include <atomic>
+#include <vector>
+
 #include "ILowlevelDevice.h"
 #include "Poco/Mutex.h"
 #include "Poco/Timestamp.h"
 
+class LinuxComEngine;
+
+/**
+A serial device file driven by LinuxComEngine.
+Member functions other than the public ones are called in LinuxComEngine's thread.
+*/
 class LinuxComDevice : public ILowlevelDevice
 {
 public:
 	LinuxComDevice(const std::string & name, ILowlevelDeviceObsesrver * pObserver);
 	virtual ~LinuxComDevice();
 
-private:
-	virtual void runTask() override;
-	virtual bool SendData(const std::vector<unsigned char> & command, std::string & info) override;
+	virtual bool SendData(const unsigned char * pData, unsigned int length, std::string & info) override;
 	virtual void Disconnect() override;
+	virtual void RequestWriting() override;
 
 private:
+	friend class LinuxComEngine;
+
 	LinuxComDevice();
 
 	const unsigned int MAX_OUTPUT_QUEUE_SIZE = 1024;
@@ -28,21 +38,29 @@ private:
 	const std::string DEVICE_NOT_ACCEPT_FURTHER_DATA = "device not accept further data";
 	const std::string EMPTY_COMMAND = "empty command";
 
-	const unsigned int WRITING_TIMEOUT = 50; // 50 milliseconds
-	const unsigned int READING_TIMEOUT = 10; // 10 milliseconds
+	static const Poco::Timestamp::TimeDiff CHECKING_INTERVAL = 1000000; // 1 second between checks of device file existence
+	static const Poco::Timestamp::TimeDiff OPENING_DELAY = 1000000; // 1 second from device file appearing to opening it
+	static const unsigned int BUFFER_SIZE = 1024;
 
 	Poco::Mutex _mutex;
 
 	int _fd;
-	bool _bExit;
+	std::atomic<bool> _bExit;
+	std::atomic<bool> _bWritingRequested;
 	LowlevelDeviceState _state;
-	unsigned char _inputBuffer[1024];
-	std::deque<unsigned char> _inputQueue;
-	std::deque<unsigned char> _outputQueue;
+	Poco::Timestamp _stateStamp; //when _state changed or device file was checked
+	LinuxComEngine * _pEngine;
+	unsigned char _inputBuffer[BUFFER_SIZE];
+	std::vector<unsigned char> _outputBuffer; //reused, bytes before _outputOffset have been written
+	size_t _outputOffset;
 
 	void openDevice();
+	void closeDevice();
+	// return microseconds till the next state check, 0 if device is open or finished.
+	Poco::Timestamp::TimeDiff checkState();
 	bool receiveData();
 	bool sendData();
+	bool hasOutput();
 };
 
 #endif
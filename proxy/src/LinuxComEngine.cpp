@@ -0,0 +1,302 @@
+
+#if defined(_WIN32) || defined(_WIN64)
+#else
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "LinuxComEngine.h"
+#include "ProxyLogger.h"
+
+extern ProxyLogger * pLogger;
+
+LinuxComEngine::LinuxComEngine(): Task("LinuxComEngine")
+{
+	_nextKey = WAKEUP_KEY + 1;
+
+	_epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(_epollFd < 0) {
+		auto errorNumber = errno;
+		pLogger->LogError("LinuxComEngine::LinuxComEngine failed in creating epoll: " + std::string(strerror(errorNumber)));
+	}
+
+	_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(_eventFd < 0) {
+		auto errorNumber = errno;
+		pLogger->LogError("LinuxComEngine::LinuxComEngine failed in creating eventfd: " + std::string(strerror(errorNumber)));
+	}
+
+	if((_epollFd >= 0) && (_eventFd >= 0))
+	{
+		struct epoll_event event;
+
+		event.events = EPOLLIN;
+		event.data.u64 = WAKEUP_KEY;
+		if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _eventFd, &event) < 0) {
+			auto errorNumber = errno;
+			pLogger->LogError("LinuxComEngine::LinuxComEngine failed in watching eventfd: " + std::string(strerror(errorNumber)));
+		}
+	}
+}
+
+LinuxComEngine::~LinuxComEngine()
+{
+	if(_eventFd >= 0) {
+		close(_eventFd);
+	}
+	if(_epollFd >= 0) {
+		close(_epollFd);
+	}
+}
+
+void LinuxComEngine::AddDevice(LinuxComDevice * pDevice)
+{
+	if(pDevice == nullptr) {
+		return;
+	}
+
+	{
+		Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+		Entry entry;
+
+		entry.key = _nextKey++;
+		entry.pDevice = pDevice;
+		entry.registered = false;
+		entry.writingWatched = false;
+		_entries[entry.key] = entry;
+
+		pDevice->_pEngine = this;
+		pLogger->LogInfo("LinuxComEngine::AddDevice " + pDevice->_name);
+	}
+
+	Wakeup();
+}
+
+void LinuxComEngine::RemoveDevice(LinuxComDevice * pDevice)
+{
+	Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+	for(auto it = _entries.begin(); it != _entries.end(); it++)
+	{
+		if(it->second.pDevice == pDevice)
+		{
+			unwatch(it->second);
+			pDevice->closeDevice();
+			pDevice->_pEngine = nullptr;
+			_entries.erase(it);
+			pLogger->LogInfo("LinuxComEngine::RemoveDevice " + pDevice->_name);
+			break;
+		}
+	}
+}
+
+void LinuxComEngine::Wakeup()
+{
+	uint64_t counter = 1;
+
+	if(write(_eventFd, &counter, sizeof(counter)) < 0) {
+		//counter is saturated, engine wakes up anyway.
+	}
+}
+
+void LinuxComEngine::cancel()
+{
+	Task::cancel();
+	Wakeup();
+}
+
+void LinuxComEngine::watch(Entry& entry)
+{
+	struct epoll_event event;
+
+	if(entry.registered) {
+		return;
+	}
+
+	event.events = EPOLLIN;
+	event.data.u64 = entry.key;
+	if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, entry.pDevice->_fd, &event) < 0) {
+		auto errorNumber = errno;
+		pLogger->LogError("LinuxComEngine::watch failed in watching " + entry.pDevice->_name + ": " + std::string(strerror(errorNumber)));
+		entry.pDevice->_state = LowlevelDeviceState::DeviceError;
+		return;
+	}
+
+	entry.registered = true;
+	entry.writingWatched = false;
+}
+
+void LinuxComEngine::unwatch(Entry& entry)
+{
+	struct epoll_event event;
+
+	if(!entry.registered) {
+		return;
+	}
+
+	event.events = 0;
+	event.data.u64 = entry.key;
+	if(epoll_ctl(_epollFd, EPOLL_CTL_DEL, entry.pDevice->_fd, &event) < 0) {
+		auto errorNumber = errno;
+		pLogger->LogError("LinuxComEngine::unwatch failed in unwatching " + entry.pDevice->_name + ": " + std::string(strerror(errorNumber)));
+	}
+
+	entry.registered = false;
+	entry.writingWatched = false;
+}
+
+void LinuxComEngine::watchWriting(Entry& entry, bool bWatch)
+{
+	struct epoll_event event;
+
+	if(!entry.registered || (entry.writingWatched == bWatch)) {
+		return;
+	}
+
+	event.events = bWatch ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	event.data.u64 = entry.key;
+	if(epoll_ctl(_epollFd, EPOLL_CTL_MOD, entry.pDevice->_fd, &event) < 0) {
+		auto errorNumber = errno;
+		pLogger->LogError("LinuxComEngine::watchWriting failed in " + entry.pDevice->_name + ": " + std::string(strerror(errorNumber)));
+		entry.pDevice->_state = LowlevelDeviceState::DeviceError;
+		return;
+	}
+
+	entry.writingWatched = bWatch;
+}
+
+void LinuxComEngine::sendData(Entry& entry)
+{
+	auto pDevice = entry.pDevice;
+
+	pDevice->sendData();
+	if(pDevice->_state == LowlevelDeviceState::DeviceNormal) {
+		//wait for device to be writable if not all data is written.
+		watchWriting(entry, pDevice->hasOutput());
+	}
+}
+
+int LinuxComEngine::checkDevices()
+{
+	Poco::Timestamp::TimeDiff timeout = -1;
+
+	for(auto it = _entries.begin(); it != _entries.end(); it++)
+	{
+		Entry& entry = it->second;
+		auto pDevice = entry.pDevice;
+
+		if(pDevice->_bExit || (pDevice->_state == LowlevelDeviceState::DeviceError)) {
+			unwatch(entry);
+		}
+
+		auto delay = pDevice->checkState();
+
+		if((pDevice->_state == LowlevelDeviceState::DeviceNormal) && !pDevice->_bExit)
+		{
+			watch(entry);
+			if(pDevice->_bWritingRequested || (!entry.writingWatched && pDevice->hasOutput())) {
+				sendData(entry);
+			}
+			if(pDevice->_state == LowlevelDeviceState::DeviceError) {
+				unwatch(entry);
+				delay = pDevice->checkState();
+			}
+		}
+
+		if((delay > 0) && ((timeout < 0) || (delay < timeout))) {
+			timeout = delay;
+		}
+	}
+
+	if(timeout < 0) {
+		return -1; //no device needs to be checked, wait for data or wakeup.
+	}
+	return (int)((timeout + 999) / 1000);
+}
+
+void LinuxComEngine::onEvent(Entry& entry, uint32_t events)
+{
+	auto pDevice = entry.pDevice;
+
+	if(!entry.registered || pDevice->_bExit) {
+		return;
+	}
+
+	if(events & EPOLLIN) {
+		pDevice->receiveData();
+	}
+	if((pDevice->_state == LowlevelDeviceState::DeviceNormal) && (events & (EPOLLERR | EPOLLHUP))) {
+		pLogger->LogError("LinuxComEngine::onEvent error in events: " + pDevice->_name + " events: " + std::to_string(events));
+		pDevice->_state = LowlevelDeviceState::DeviceError;
+	}
+	if((pDevice->_state == LowlevelDeviceState::DeviceNormal) && (events & EPOLLOUT)) {
+		sendData(entry);
+	}
+	//device error is handled in checkDevices()
+}
+
+void LinuxComEngine::runTask()
+{
+	struct epoll_event events[MAX_EVENTS];
+
+	pLogger->LogInfo("LinuxComEngine::runTask starts");
+
+	if((_epollFd < 0) || (_eventFd < 0)) {
+		pLogger->LogError("LinuxComEngine::runTask no epoll or eventfd, serial devices are not served");
+		return;
+	}
+
+	for(;;)
+	{
+		if(isCancelled()) {
+			break;
+		}
+
+		int timeout;
+		{
+			Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+			timeout = checkDevices();
+		}
+
+		auto amount = epoll_wait(_epollFd, events, MAX_EVENTS, timeout);
+		auto errorNumber = errno;
+
+		if(amount < 0)
+		{
+			if(errorNumber != EINTR) {
+				pLogger->LogError("LinuxComEngine::runTask error in epoll_wait: " + std::string(strerror(errorNumber)));
+				sleep(10);
+			}
+			continue;
+		}
+
+		Poco::ScopedLock<Poco::Mutex> lock(_mutex);
+
+		for(int i=0; i<amount; i++)
+		{
+			if(events[i].data.u64 == WAKEUP_KEY)
+			{
+				uint64_t counter;
+
+				if(read(_eventFd, &counter, sizeof(counter)) < 0) {
+					//already drained
+				}
+				continue;
+			}
+
+			auto it = _entries.find(events[i].data.u64);
+			if(it == _entries.end()) {
+				continue; //device has been removed
+			}
+			onEvent(it->second, events[i].events);
+		}
+	}
+
+	pLogger->LogInfo("LinuxComEngine::runTask exited");
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#if defined(_WIN32) || defined(_WIN64)
+#else
+
+#include <map>
+#include <stdint.h>
+
+#include "Poco/Task.h"
+#include "Poco/Mutex.h"
+#include "LinuxComDevice.h"
+
+/**
+One thread serves all serial device files.
+Device files are multiplexed with epoll, data is read and written as soon as a device is ready,
+and replies are dispatched to ILowlevelDeviceObsesrver in this thread.
+*/
+class LinuxComEngine: public Poco::Task
+{
+public:
+	LinuxComEngine();
+	virtual ~LinuxComEngine();
+
+	// device is opened and served after it is added, it is closed after it is removed.
+	void AddDevice(LinuxComDevice * pDevice);
+	void RemoveDevice(LinuxComDevice * pDevice);
+	// make engine check devices, thread safe.
+	void Wakeup();
+
+	virtual void cancel() override;
+
+private:
+	virtual void runTask() override;
+
+	static const int MAX_EVENTS = 16;
+	static const uint64_t WAKEUP_KEY = 0; //key of event file descriptor
+
+	struct Entry
+	{
+		uint64_t key; //epoll data of device file
+		LinuxComDevice * pDevice;
+		bool registered; //device file is in epoll
+		bool writingWatched; //EPOLLOUT is in epoll
+	};
+
+	Poco::Mutex _mutex;
+	int _epollFd;
+	int _eventFd;
+	uint64_t _nextKey;
+	std::map<uint64_t, Entry> _entries;
+
+	// return epoll timeout in milliseconds
+	int checkDevices();
+	void onEvent(Entry& entry, uint32_t events);
+	void sendData(Entry& entry);
+	void watch(Entry& entry);
+	void unwatch(Entry& entry);
+	void watchWriting(Entry& entry, bool bWatch);
+};
+
+#endif
@@ -21,6 +21,7 @@ ProxyLogger::ProxyLogger(const std::string& folder,
 	_logFileInitialized = false;
 	_overflowed = false;
 	_copyToConsole = false;
+	_traceEnabled = false;
 
 	try
 	{
@@ -105,11 +106,23 @@ void ProxyLogger::LogInfo(const std::string& info)
 	Log(info);
 }
 
+void ProxyLogger::LogTrace(const std::string& trace)
+{
+	if(_traceEnabled) {
+		Log(trace);
+	}
+}
+
 void ProxyLogger::CopyToConsole(bool copyToConsole)
 {
 	_copyToConsole = copyToConsole;
 }
 
+void ProxyLogger::SetTraceEnabled(bool enabled)
+{
+	_traceEnabled = enabled;
+}
+
 void ProxyLogger::runTask()
 {
 	while(1)
@@ -9,6 +9,7 @@
 #define PROXYLOGGER_H_
 
 #include <deque>
+#include <atomic>
 #include <memory>
 #include "Poco/Task.h"
 #include "Poco/Path.h"
@@ -27,8 +28,12 @@ public:
 	void LogError(const std::string& err);
 	void LogDebug(const std::string& debug);
 	void LogInfo(const std::string& info);
+	// trace logs carry data exchanged with devices, callers check IsTraceEnabled() before composing them.
+	void LogTrace(const std::string& trace);
 
 	void CopyToConsole(bool copyToConsole);
+	void SetTraceEnabled(bool enabled);
+	bool IsTraceEnabled() const { return _traceEnabled; }
 
 private:
 	void runTask();
@@ -39,6 +44,7 @@ private:
 
 	bool _overflowed;
 	bool _copyToConsole;
+	std::atomic<bool> _traceEnabled;
 
 	Poco::Mutex _mutex;
 	std::deque<std::string> _logBuffer;
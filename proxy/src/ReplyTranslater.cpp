@@ -4,6 +4,8 @@
  *  Created on: Oct 26, 2018
  *      Author: mikez
  */
+#include <stdio.h>
+#include <vector>
 #include "ReplyTranslater.h"
 #include "Poco/Dynamic/Struct.h"
 #include "ProxyLogger.h"
@@ -162,6 +164,101 @@ std::string ReplyTranslater::deviceQueryFuse(Poco::JSON::Object::Ptr& replyPtr)
 	return reply;
 }
 
+//device replies:
+//{"command":"5","params":["cmdId"],
+// "power":"powered on","fuse":"main fuse is on","bdcsPower":"BDCs are powered on","steppersPower":"steppers are powered on",
+// "bdcs":["coast",...],
+// "steppers":[{"state":..,"enabled":..,"forward":..,"locatorIndex":..,...same as stepper query},...],
+// "locators":["ff",...]}
+std::string ReplyTranslater::deviceQueryStatus(Poco::JSON::Object::Ptr& replyPtr)
+{
+	std::string reply;
+	std::string strCmdId;
+	Poco::DynamicStruct ds = *replyPtr;
+	long commandId;
+	std::string error;
+
+	auto size = ds["params"].size();
+	if(size != 1) {
+		throw Poco::JSON::JSONException("ReplyTranslater::deviceQueryStatus wrong parameter amount: " + std::to_string(size));
+	}
+
+	strCmdId = ds["params"][size - 1].toString();
+	commandId = getHexValue(strCmdId);
+
+	reply = "{";
+	reply = reply + "\"command\":\"" + strCommandDeviceQueryStatus + "\",";
+	reply = reply + "\"commandId\":" + std::to_string(commandId);
+
+	if (replyPtr->has("error"))
+	{
+		error = ds["error"].toString();
+		reply = reply + ",\"error\":\"" + error + "\"";
+		//"\"error\":\"invalid command\""
+		//"\"error\":\"too many parameters\""
+		//"\"error\":\"unknown command\""
+		//"\"error\":\"wrong parameter amount\""
+	}
+	else
+	{
+		reply = reply + ",\"power\":\"" + ds["power"].toString() + "\"";
+		reply = reply + ",\"fuse\":\"" + ds["fuse"].toString() + "\"";
+		reply = reply + ",\"bdcsPower\":\"" + ds["bdcsPower"].toString() + "\"";
+		reply = reply + ",\"steppersPower\":\"" + ds["steppersPower"].toString() + "\"";
+
+		reply += ",\"bdcs\":[";
+		for(unsigned int i=0; i<ds["bdcs"].size(); i++)
+		{
+			if(i > 0) {
+				reply += ",";
+			}
+			reply = reply + "\"" + ds["bdcs"][i].toString() + "\"";
+		}
+		reply += "]";
+
+		reply += ",\"steppers\":[";
+		for(unsigned int i=0; i<ds["steppers"].size(); i++)
+		{
+			auto stepper = ds["steppers"][i];
+			bool enabled = (stepper["enabled"].toString() != "0") ? true : false;
+			bool forward = (stepper["forward"].toString() != "0") ? true : false;
+
+			if(i > 0) {
+				reply += ",";
+			}
+			reply = reply + "{\"index\":" + std::to_string(i);
+			reply = reply + ",\"state\":\"" + stepper["state"].toString() + "\"";
+			reply = reply + ",\"enabled\":" + (enabled ? "true" : "false");
+			reply = reply + ",\"forward\":" + (forward ? "true" : "false");
+			reply = reply + ",\"locatorIndex\":" + std::to_string(getHexValue(stepper["locatorIndex"].toString()));
+			reply = reply + ",\"locatorLineNumberStart\":" + std::to_string(getHexValue(stepper["locatorLineNumberStart"].toString()));
+			reply = reply + ",\"locatorLineNumberTerminal\":" + std::to_string(getHexValue(stepper["locatorLineNumberTerminal"].toString()));
+			reply = reply + ",\"homeOffset\":" + std::to_string(getHexValue(stepper["homeOffset"].toString()));
+			reply = reply + ",\"lowClks\":" + std::to_string(getHexValue(stepper["lowClks"].toString()));
+			reply = reply + ",\"highClks\":" + std::to_string(getHexValue(stepper["highClks"].toString()));
+			reply = reply + ",\"accelerationBuffer\":" + std::to_string(getHexValue(stepper["accelerationBuffer"].toString()));
+			reply = reply + ",\"accelerationBufferDecrement\":" + std::to_string(getHexValue(stepper["accelerationDecrement"].toString()));
+			reply = reply + ",\"decelerationBuffer\":" + std::to_string(getHexValue(stepper["decelerationBuffer"].toString()));
+			reply = reply + ",\"decelerationBufferIncrement\":" + std::to_string(getHexValue(stepper["decelerationIncrement"].toString()));
+			reply += "}";
+		}
+		reply += "]";
+
+		reply += ",\"locators\":[";
+		for(unsigned int i=0; i<ds["locators"].size(); i++)
+		{
+			if(i > 0) {
+				reply += ",";
+			}
+			reply += std::to_string(getHexValue(ds["locators"][i].toString()));
+		}
+		reply += "]";
+	}
+	reply += "}";
+
+	return reply;
+}
+
 std::string ReplyTranslater::deviceDelay(Poco::JSON::Object::Ptr& replyPtr)
 {
 	std::string reply;
@@ -1650,6 +1747,167 @@ std::string ReplyTranslater::solenoidActivate(Poco::JSON::Object::Ptr& replyPtr)
 	return reply;
 }
 
+// params: movementAmount index flags steps [index flags steps ...] commandId
+// "positions" holds final position of each movement in order.
+std::string ReplyTranslater::steppersMove(Poco::JSON::Object::Ptr& replyPtr)
+{
+	std::string reply;
+	std::string strCmdId;
+	std::string error;
+	Poco::DynamicStruct ds = *replyPtr;
+	long commandId;
+	unsigned long amount;
+	std::vector<long> indexes;
+	std::vector<long> positions;
+
+	//parameters
+	auto size = ds["params"].size();
+	if(size < 5) {
+		throw Poco::JSON::JSONException("ReplyTranslater::steppersMove wrong parameter amount: " + std::to_string(size));
+	}
+	amount = getHexValue(ds["params"][0].toString());
+	if(size != (amount * 3 + 2)) {
+		throw Poco::JSON::JSONException("ReplyTranslater::steppersMove wrong parameter amount: " + std::to_string(size) + ", movements: " + std::to_string(amount));
+	}
+	for(unsigned long i=0; i<amount; i++) {
+		indexes.push_back(getHexValue(ds["params"][1 + i*3].toString()));
+	}
+	strCmdId = ds["params"][size - 1].toString();
+	commandId = getHexValue(strCmdId);
+
+	if (replyPtr->has("error")) {
+		error = ds["error"].toString();
+		//"\"error\":\"invalid command\""
+		//"\"error\":\"too many parameters\""
+		//"\"error\":\"unknown command\""
+		//"\"error\":\"wrong parameter amount\""
+		//"\"error\":\"stepper index is out of scope\""
+	}
+	else {
+		if(ds["positions"].size() != amount) {
+			throw Poco::JSON::JSONException("ReplyTranslater::steppersMove wrong position amount: " + std::to_string(ds["positions"].size()));
+		}
+		for(unsigned long i=0; i<amount; i++) {
+			positions.push_back(getHexValue(ds["positions"][i].toString()));
+		}
+	}
+
+	reply = "{";
+	reply = reply + "\"command\":\"" + strCommandSteppersMove + "\",";
+	reply = reply + "\"commandId\":" + std::to_string(commandId);
+	if(!error.empty()) {
+		reply = reply + ",\"error\":\"" + error + "\"";
+	}
+	else {
+		reply = reply + ",\"positions\":[";
+		for(unsigned long i=0; i<amount; i++)
+		{
+			if(i > 0) {
+				reply += ",";
+			}
+			reply = reply + "{\"index\":" + std::to_string(indexes[i]) + ",\"position\":" + std::to_string(positions[i]) + "}";
+		}
+		reply += "]";
+	}
+	reply += "}";
+
+	return reply;
+}
+
+// params: macroId stepAmount commandId
+std::string ReplyTranslater::macroUpload(Poco::JSON::Object::Ptr& replyPtr)
+{
+	std::string reply;
+	std::string error;
+	Poco::DynamicStruct ds = *replyPtr;
+	long macroId;
+	long commandId;
+
+	//parameters
+	auto size = ds["params"].size();
+	if(size != 3) {
+		throw Poco::JSON::JSONException("ReplyTranslater::macroUpload wrong parameter amount: " + std::to_string(size));
+	}
+	macroId = getHexValue(ds["params"][0].toString());
+	commandId = getHexValue(ds["params"][size - 1].toString());
+
+	if (replyPtr->has("error")) {
+		error = ds["error"].toString();
+		//"\"error\":\"invalid command\""
+		//"\"error\":\"wrong parameter amount\""
+		//"\"error\":\"macro index is out of scope\""
+		//"\"error\":\"macro is too long\""
+		//"\"error\":\"command is not allowed in macro\""
+	}
+
+	reply = "{";
+	reply = reply + "\"command\":\"" + strCommandMacroUpload + "\",";
+	reply = reply + "\"macroId\":" + std::to_string(macroId) + ",";
+	reply = reply + "\"commandId\":" + std::to_string(commandId);
+	if(!error.empty()) {
+		reply = reply + ",\"error\":\"" + error + "\"";
+	}
+	reply += "}";
+
+	return reply;
+}
+
+// params: macroId commandId
+// device replies after the last step, "positions" holds position of each stepper.
+std::string ReplyTranslater::macroRun(Poco::JSON::Object::Ptr& replyPtr)
+{
+	std::string reply;
+	std::string error;
+	Poco::DynamicStruct ds = *replyPtr;
+	long macroId;
+	long commandId;
+	std::vector<long> positions;
+
+	//parameters
+	auto size = ds["params"].size();
+	if(size != 2) {
+		throw Poco::JSON::JSONException("ReplyTranslater::macroRun wrong parameter amount: " + std::to_string(size));
+	}
+	macroId = getHexValue(ds["params"][0].toString());
+	commandId = getHexValue(ds["params"][size - 1].toString());
+
+	if (replyPtr->has("error")) {
+		error = ds["error"].toString();
+		//"\"error\":\"invalid command\""
+		//"\"error\":\"wrong parameter amount\""
+		//"\"error\":\"macro index is out of scope\""
+		//"\"error\":\"macro is empty\""
+		//"\"error\":\"stepper index is out of scope\""
+	}
+	else {
+		for(unsigned long i=0; i<ds["positions"].size(); i++) {
+			positions.push_back(getHexValue(ds["positions"][i].toString()));
+		}
+	}
+
+	reply = "{";
+	reply = reply + "\"command\":\"" + strCommandMacroRun + "\",";
+	reply = reply + "\"macroId\":" + std::to_string(macroId) + ",";
+	reply = reply + "\"commandId\":" + std::to_string(commandId);
+	if(!error.empty()) {
+		reply = reply + ",\"error\":\"" + error + "\"";
+	}
+	else {
+		reply = reply + ",\"positions\":[";
+		for(unsigned long i=0; i<positions.size(); i++)
+		{
+			if(i > 0) {
+				reply += ",";
+			}
+			reply += std::to_string(positions[i]);
+		}
+		reply += "]";
+	}
+	reply += "}";
+
+	return reply;
+}
+
 std::string ReplyTranslater::formatCmdReply(Poco::JSON::Object::Ptr& replyPtr)
 {
 	std::string reply;
@@ -1667,6 +1925,10 @@ std::string ReplyTranslater::formatCmdReply(Poco::JSON::Object::Ptr& replyPtr)
 		reply = deviceQueryFuse(replyPtr);
 		break;
 
+	case 5:
+		reply = deviceQueryStatus(replyPtr);
+		break;
+
 	case 4:
 		reply = deviceDelay(replyPtr);
 		break;
@@ -1799,6 +2061,18 @@ std::string ReplyTranslater::formatCmdReply(Poco::JSON::Object::Ptr& replyPtr)
 		reply = stepperForwardClockwise(replyPtr);
 		break;
 
+	case 64:
+		reply = steppersMove(replyPtr);
+		break;
+
+	case 65:
+		reply = macroUpload(replyPtr);
+		break;
+
+	case 66:
+		reply = macroRun(replyPtr);
+		break;
+
 	case 100:
 		reply = locatorQuery(replyPtr);
 		break;
@@ -1994,10 +2268,657 @@ std::string ReplyTranslater::formatEvent(Poco::JSON::Object::Ptr& replyPtr)
 }
 
 
+void ReplyTranslater::appendText(std::string& jsonReply, const FirmwareReply::Text& text)
+{
+	jsonReply.append(text.pData, text.length);
+}
+
+void ReplyTranslater::appendNumber(std::string& jsonReply, long value)
+{
+	char buffer[32];
+
+	sprintf(buffer, "%ld", value);
+	jsonReply += buffer;
+}
+
+void ReplyTranslater::appendNumber(std::string& jsonReply, unsigned long value)
+{
+	char buffer[32];
+
+	sprintf(buffer, "%lu", value);
+	jsonReply += buffer;
+}
+
+//members are appended as ,"key":value
+void ReplyTranslater::appendKey(std::string& jsonReply, const char * pKey)
+{
+	jsonReply += ",\"";
+	jsonReply += pKey;
+	jsonReply += "\":";
+}
+
+void ReplyTranslater::appendNumberMember(std::string& jsonReply, const char * pKey, long value)
+{
+	appendKey(jsonReply, pKey);
+	appendNumber(jsonReply, value);
+}
+
+void ReplyTranslater::appendTextMember(std::string& jsonReply, const char * pKey, const FirmwareReply::Text& text)
+{
+	appendKey(jsonReply, pKey);
+	jsonReply += "\"";
+	appendText(jsonReply, text);
+	jsonReply += "\"";
+}
+
+void ReplyTranslater::appendBoolMember(std::string& jsonReply, const char * pKey, bool value)
+{
+	appendKey(jsonReply, pKey);
+	jsonReply += value ? "true" : "false";
+}
+
+//{"command":"<command>", members follow and "}" closes the reply.
+void ReplyTranslater::beginCommandReply(std::string& jsonReply, const std::string& command)
+{
+	jsonReply = "{\"command\":\"";
+	jsonReply += command;
+	jsonReply += "\"";
+}
+
+bool ReplyTranslater::getParamsFast(const FirmwareReply& reply, unsigned int amount, unsigned int& first)
+{
+	unsigned int size;
+
+	if(!reply.GetArray("params", first, size)) {
+		return false;
+	}
+
+	return size == amount;
+}
+
+//all params are hex values
+bool ReplyTranslater::getHexParamsFast(const FirmwareReply& reply, unsigned int amount, unsigned long * pValues)
+{
+	unsigned int first;
+
+	if(!getParamsFast(reply, amount, first)) {
+		return false;
+	}
+	for(unsigned int i=0; i<amount; i++)
+	{
+		if(!FirmwareReply::ToHexValue(reply.Item(first + i), pValues[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//false if error can't be handled in the same way as generic translation.
+bool ReplyTranslater::getErrorFast(const FirmwareReply& reply, FirmwareReply::Text& error, bool& hasError)
+{
+	hasError = reply.Has("error");
+	if(!hasError) {
+		return true;
+	}
+	if(!reply.GetText("error", error)) {
+		return false;
+	}
+
+	return error.length > 0;
+}
+
+//replies which have command id, optional index and optional result.
+bool ReplyTranslater::commandFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, unsigned int paramAmount,
+		IndexPosition indexPosition, const char * pResultKey, ResultKind resultKind)
+{
+	unsigned int first;
+	unsigned long commandId;
+	unsigned long index = 0;
+	bool hasError;
+	FirmwareReply::Text error;
+	FirmwareReply::Text result;
+	unsigned long resultValue = 0;
+
+	if(!getParamsFast(reply, paramAmount, first)) {
+		return false;
+	}
+	if(!FirmwareReply::ToHexValue(reply.Item(first + paramAmount - 1), commandId)) {
+		return false;
+	}
+	if((indexPosition != IndexPosition::None) && !FirmwareReply::ToHexValue(reply.Item(first), index)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+	if(!hasError && (resultKind != ResultKind::None))
+	{
+		if(!reply.GetText(pResultKey, result)) {
+			return false;
+		}
+		if((resultKind == ResultKind::Number) && !FirmwareReply::ToHexValue(result, resultValue)) {
+			return false;
+		}
+	}
+
+	beginCommandReply(jsonReply, command);
+	if(indexPosition == IndexPosition::BeforeCommandId) {
+		appendNumberMember(jsonReply, "index", index);
+	}
+	appendNumberMember(jsonReply, "commandId", commandId);
+	if(indexPosition == IndexPosition::AfterCommandId) {
+		appendNumberMember(jsonReply, "index", index);
+	}
+	if(hasError) {
+		appendTextMember(jsonReply, "error", error);
+	}
+	else if(resultKind == ResultKind::Text) {
+		appendTextMember(jsonReply, pResultKey, result);
+	}
+	else if(resultKind == ResultKind::Number) {
+		appendNumberMember(jsonReply, pResultKey, resultValue);
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+//stepper enable, stepper forward and stepper forward clockwise: params are index, flag and command id.
+bool ReplyTranslater::stepperFlagFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, const char * pFlagKey)
+{
+	unsigned long params[3];
+	bool hasError;
+	FirmwareReply::Text error;
+
+	if(!getHexParamsFast(reply, 3, params)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+
+	beginCommandReply(jsonReply, command);
+	appendNumberMember(jsonReply, "index", params[0]);
+	if(command == strCommandStepperForwardClockwise)
+	{
+		//a number after command id
+		appendNumberMember(jsonReply, "commandId", params[2]);
+		appendNumberMember(jsonReply, pFlagKey, (int)params[1]);
+	}
+	else
+	{
+		appendBoolMember(jsonReply, pFlagKey, params[1] != 0);
+		appendNumberMember(jsonReply, "commandId", params[2]);
+	}
+	if(hasError) {
+		appendTextMember(jsonReply, "error", error);
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+bool ReplyTranslater::stepperQueryFast(const FirmwareReply& reply, std::string& jsonReply)
+{
+	//output key, reply key
+	static const char * numberKeys[][2] = {
+		{"locatorIndex", "locatorIndex"},
+		{"locatorLineNumberStart", "locatorLineNumberStart"},
+		{"locatorLineNumberTerminal", "locatorLineNumberTerminal"},
+		{"homeOffset", "homeOffset"},
+		{"lowClks", "lowClks"},
+		{"highClks", "highClks"},
+		{"accelerationBuffer", "accelerationBuffer"},
+		{"accelerationBufferDecrement", "accelerationDecrement"},
+		{"decelerationBuffer", "decelerationBuffer"},
+		{"decelerationBufferIncrement", "decelerationIncrement"}
+	};
+	const unsigned int numberAmount = sizeof(numberKeys) / sizeof(numberKeys[0]);
+	unsigned long params[2];
+	bool hasError;
+	FirmwareReply::Text error;
+	FirmwareReply::Text state;
+	FirmwareReply::Text enabled;
+	FirmwareReply::Text forward;
+	unsigned long numbers[numberAmount];
+
+	if(!getHexParamsFast(reply, 2, params)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+	if(!hasError)
+	{
+		if(!reply.GetText("state", state) || !reply.GetText("enabled", enabled) || !reply.GetText("forward", forward)) {
+			return false;
+		}
+		for(unsigned int i=0; i<numberAmount; i++)
+		{
+			if(!reply.GetHexValue(numberKeys[i][1], numbers[i])) {
+				return false;
+			}
+		}
+	}
+
+	beginCommandReply(jsonReply, strCommandStepperQuery);
+	appendNumberMember(jsonReply, "index", params[0]);
+	appendNumberMember(jsonReply, "commandId", params[1]);
+	if(!hasError)
+	{
+		appendTextMember(jsonReply, "state", state);
+		appendBoolMember(jsonReply, "enabled", !enabled.Equals("0"));
+		appendBoolMember(jsonReply, "forward", !forward.Equals("0"));
+		for(unsigned int i=0; i<numberAmount; i++) {
+			appendNumberMember(jsonReply, numberKeys[i][0], numbers[i]);
+		}
+	}
+	else {
+		appendTextMember(jsonReply, "error", error);
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+bool ReplyTranslater::solenoidActivateFast(const FirmwareReply& reply, std::string& jsonReply)
+{
+	unsigned long params[4];
+	bool hasError;
+	FirmwareReply::Text error;
+
+	if(!getHexParamsFast(reply, 4, params)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+
+	beginCommandReply(jsonReply, strCommandSolenoidActivate);
+	appendNumberMember(jsonReply, "index", params[0]);
+	//clocks are unsigned in generic translation
+	appendKey(jsonReply, "lowClks");
+	appendNumber(jsonReply, params[1]);
+	appendKey(jsonReply, "highClks");
+	appendNumber(jsonReply, params[2]);
+	appendNumberMember(jsonReply, "commandId", params[3]);
+	if(hasError) {
+		appendTextMember(jsonReply, "error", error);
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+bool ReplyTranslater::steppersMoveFast(const FirmwareReply& reply, std::string& jsonReply)
+{
+	unsigned int first;
+	unsigned int size;
+	unsigned long amount;
+	unsigned long commandId;
+	bool hasError;
+	FirmwareReply::Text error;
+	unsigned int firstPosition;
+	unsigned int positionAmount;
+
+	if(!reply.GetArray("params", first, size) || (size < 5)) {
+		return false;
+	}
+	if(!FirmwareReply::ToHexValue(reply.Item(first), amount) || (size != (amount * 3 + 2))) {
+		return false;
+	}
+	if(!FirmwareReply::ToHexValue(reply.Item(first + size - 1), commandId)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+	if(!hasError)
+	{
+		if(!reply.GetArray("positions", firstPosition, positionAmount) || (positionAmount != amount)) {
+			return false;
+		}
+	}
+
+	beginCommandReply(jsonReply, strCommandSteppersMove);
+	appendNumberMember(jsonReply, "commandId", commandId);
+	if(hasError) {
+		appendTextMember(jsonReply, "error", error);
+	}
+	else
+	{
+		appendKey(jsonReply, "positions");
+		jsonReply += "[";
+		for(unsigned long i=0; i<amount; i++)
+		{
+			unsigned long index;
+			unsigned long position;
+
+			if(!FirmwareReply::ToHexValue(reply.Item(first + 1 + i*3), index) ||
+				!FirmwareReply::ToHexValue(reply.Item(firstPosition + i), position)) {
+				return false;
+			}
+			if(i > 0) {
+				jsonReply += ",";
+			}
+			jsonReply += "{\"index\":";
+			appendNumber(jsonReply, (long)index);
+			appendNumberMember(jsonReply, "position", position);
+			jsonReply += "}";
+		}
+		jsonReply += "]";
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+//macro upload and macro run, params start with macro id and end with command id.
+bool ReplyTranslater::macroFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, unsigned int paramAmount, bool withPositions)
+{
+	unsigned int first;
+	unsigned long macroId;
+	unsigned long commandId;
+	bool hasError;
+	FirmwareReply::Text error;
+	unsigned int firstPosition = 0;
+	unsigned int positionAmount = 0;
+
+	if(!getParamsFast(reply, paramAmount, first)) {
+		return false;
+	}
+	if(!FirmwareReply::ToHexValue(reply.Item(first), macroId) ||
+		!FirmwareReply::ToHexValue(reply.Item(first + paramAmount - 1), commandId)) {
+		return false;
+	}
+	if(!getErrorFast(reply, error, hasError)) {
+		return false;
+	}
+	if(withPositions && !hasError && !reply.GetArray("positions", firstPosition, positionAmount)) {
+		return false;
+	}
+
+	beginCommandReply(jsonReply, command);
+	appendNumberMember(jsonReply, "macroId", macroId);
+	appendNumberMember(jsonReply, "commandId", commandId);
+	if(hasError) {
+		appendTextMember(jsonReply, "error", error);
+	}
+	else if(withPositions)
+	{
+		appendKey(jsonReply, "positions");
+		jsonReply += "[";
+		for(unsigned int i=0; i<positionAmount; i++)
+		{
+			unsigned long position;
+
+			if(!FirmwareReply::ToHexValue(reply.Item(firstPosition + i), position)) {
+				return false;
+			}
+			if(i > 0) {
+				jsonReply += ",";
+			}
+			appendNumber(jsonReply, (long)position);
+		}
+		jsonReply += "]";
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+//same layouts as formatCmdReply(), false lets generic translation handle the reply.
+bool ReplyTranslater::formatCmdReplyFast(const FirmwareReply& reply, std::string& jsonReply)
+{
+	unsigned long cmdValue;
+	FirmwareReply::Text state;
+
+	if(!reply.GetHexValue("command", cmdValue)) {
+		return false;
+	}
+
+	switch((long)cmdValue)
+	{
+	case 2:
+		//state is read even if there is an error
+		return reply.GetText("state", state) && commandFast(reply, jsonReply, strCommandDeviceQueryPower, 1, IndexPosition::None, "state", ResultKind::Text);
+
+	case 3:
+		return reply.GetText("state", state) && commandFast(reply, jsonReply, strCommandDeviceQueryFuse, 1, IndexPosition::None, "state", ResultKind::Text);
+
+	case 4:
+		return commandFast(reply, jsonReply, strCommandDeviceDelay, 2, IndexPosition::None);
+
+	case 10:
+		return commandFast(reply, jsonReply, strCommandOptPowerOn, 1, IndexPosition::None);
+
+	case 11:
+		return commandFast(reply, jsonReply, strCommandOptPowerOff, 1, IndexPosition::None);
+
+	case 13:
+	case 20:
+		return commandFast(reply, jsonReply, strCommandSteppersPowerOn, 1, IndexPosition::None);
+
+	case 14:
+	case 21:
+		return commandFast(reply, jsonReply, strCommandSteppersPowerOff, 1, IndexPosition::None);
+
+	case 15:
+	case 22:
+		return commandFast(reply, jsonReply, strCommandSteppersQueryPower, 1, IndexPosition::None, "state", ResultKind::Text);
+
+	case 30:
+		return commandFast(reply, jsonReply, strCommandDcmPowerOn, 2, IndexPosition::AfterCommandId);
+
+	case 31:
+		return commandFast(reply, jsonReply, strCommandDcmPowerOff, 2, IndexPosition::AfterCommandId);
+
+	case 40:
+		return commandFast(reply, jsonReply, strCommandBdcsPowerOn, 1, IndexPosition::None);
+
+	case 41:
+		return commandFast(reply, jsonReply, strCommandBdcsPowerOff, 1, IndexPosition::None);
+
+	case 42:
+		return commandFast(reply, jsonReply, strCommandBdcsQueryPower, 1, IndexPosition::None, "state", ResultKind::Text);
+
+	case 43:
+		return commandFast(reply, jsonReply, strCommandBdcCoast, 2, IndexPosition::BeforeCommandId);
+
+	case 44:
+		return commandFast(reply, jsonReply, strCommandBdcReverse, 5, IndexPosition::BeforeCommandId);
+
+	case 45:
+		return commandFast(reply, jsonReply, strCommandBdcForward, 5, IndexPosition::BeforeCommandId);
+
+	case 46:
+		return commandFast(reply, jsonReply, strCommandBdcBreak, 2, IndexPosition::BeforeCommandId);
+
+	case 47:
+		return commandFast(reply, jsonReply, strCommandBdcQuery, 2, IndexPosition::BeforeCommandId, "state", ResultKind::Text);
+
+	case 50:
+		return commandFast(reply, jsonReply, strCommandStepperQueryResolution, 1, IndexPosition::None, "resolution", ResultKind::Number);
+
+	case 51:
+		return commandFast(reply, jsonReply, strCommandStepperConfigStep, 4, IndexPosition::BeforeCommandId);
+
+	case 52:
+		return commandFast(reply, jsonReply, strCommandStepperAccelerationBuffer, 3, IndexPosition::BeforeCommandId);
+
+	case 53:
+		return commandFast(reply, jsonReply, strCommandStepperAccelerationBufferDecrement, 3, IndexPosition::BeforeCommandId);
+
+	case 54:
+		return commandFast(reply, jsonReply, strCommandStepperDecelerationBuffer, 3, IndexPosition::BeforeCommandId);
+
+	case 55:
+		return commandFast(reply, jsonReply, strCommandStepperDecelerationBufferIncrement, 3, IndexPosition::BeforeCommandId);
+
+	case 56:
+		return stepperFlagFast(reply, jsonReply, strCommandStepperEnable, "enabled");
+
+	case 57:
+		return stepperFlagFast(reply, jsonReply, strCommandStepperForward, "forward");
+
+	case 58:
+		return commandFast(reply, jsonReply, strCommandStepperSteps, 3, IndexPosition::BeforeCommandId);
+
+	case 59:
+		return commandFast(reply, jsonReply, strCommandStepperRun, 2, IndexPosition::BeforeCommandId, "position", ResultKind::Number);
+
+	case 60:
+		return commandFast(reply, jsonReply, strCommandStepperConfigHome, 5, IndexPosition::BeforeCommandId);
+
+	case 61:
+		return stepperQueryFast(reply, jsonReply);
+
+	case 62:
+		return commandFast(reply, jsonReply, strCommandStepperSetState, 3, IndexPosition::BeforeCommandId);
+
+	case 63:
+		return stepperFlagFast(reply, jsonReply, strCommandStepperForwardClockwise, "forwardClockwise");
+
+	case 64:
+		return steppersMoveFast(reply, jsonReply);
+
+	case 65:
+		return macroFast(reply, jsonReply, strCommandMacroUpload, 3, false);
+
+	case 66:
+		return macroFast(reply, jsonReply, strCommandMacroRun, 2, true);
+
+	case 100:
+		return commandFast(reply, jsonReply, strCommandLocatorQuery, 2, IndexPosition::BeforeCommandId, "lowInput", ResultKind::Number);
+
+	case 200:
+		return solenoidActivateFast(reply, jsonReply);
+
+	default:
+		//device query status has nested members, unknown commands are reported by generic translation.
+		return false;
+	}
+}
+
+//same layouts as formatEvent()
+bool ReplyTranslater::formatEventFast(const FirmwareReply& reply, std::string& jsonReply)
+{
+	struct EventFormat
+	{
+		const std::string * pEvent;
+		bool hasIndex;
+	};
+	const EventFormat formats[] = {
+		{&strEventMainPowerOn, false},
+		{&strEventMainPowerOff, false},
+		{&strEventOptPoweredOn, false},
+		{&strEventOptPoweredOff, false},
+		{&strEventBdcsPoweredOn, false},
+		{&strEventBdcsPoweredOff, false},
+		{&strEventBdcCoast, true},
+		{&strEventBdcReverse, true},
+		{&strEventBdcForward, true},
+		{&strEventBdcBreak, true},
+		{&strEventBdcWrongState, true},
+		{&strEventSteppersPoweredOn, false},
+		{&strEventSteppersPoweredOff, false},
+		{&strEventStepperEnabled, true},
+		{&strEventStepperDisabled, true},
+		{&strEventStepperForward, true},
+		{&strEventStepperBackward, true},
+		{&strEventStepperUnknownPosition, true},
+		{&strEventStepperApproachingHomeLocator, true},
+		{&strEventStepperLeavingHomeLocator, true},
+		{&strEventStepperGoHome, true},
+		{&strEventStepperKnownPosition, true},
+		{&strEventStepperAccelerate, true},
+		{&strEventStepperCruise, true},
+		{&strEventStepperDecelerate, true},
+		{&strEventStepperWrongState, true},
+		{&strEventLocator, true}
+	};
+	FirmwareReply::Text strEvent;
+	bool found = false;
+
+	if(!reply.GetText("event", strEvent)) {
+		return false;
+	}
+
+	jsonReply = "{\"event\":\"";
+	for(unsigned int i=0; i<sizeof(formats)/sizeof(formats[0]); i++)
+	{
+		if(!strEvent.Equals(*formats[i].pEvent)) {
+			continue;
+		}
+
+		jsonReply += *formats[i].pEvent;
+		jsonReply += "\"";
+		if(formats[i].hasIndex)
+		{
+			unsigned long index;
+
+			if(!reply.GetHexValue("index", index)) {
+				return false;
+			}
+			appendNumberMember(jsonReply, "index", index);
+		}
+		if(formats[i].pEvent == &strEventLocator)
+		{
+			unsigned long input;
+
+			if(!reply.GetHexValue("input", input)) {
+				return false;
+			}
+			appendNumberMember(jsonReply, "input", input);
+		}
+		found = true;
+		break;
+	}
+	if(!found) {
+		jsonReply += "unknown event\"";
+	}
+	jsonReply += "}";
+
+	return true;
+}
+
+bool ReplyTranslater::ToJsonReplyFast(std::string& jsonReply)
+{
+	FirmwareReply reply;
+
+	jsonReply.clear();
+	jsonReply.reserve(256);
+
+	if(!reply.Parse(_reply.data(), _reply.size())) {
+		return false;
+	}
+	if(reply.Has("command")) {
+		return formatCmdReplyFast(reply, jsonReply);
+	}
+	else if(reply.Has("event")) {
+		return formatEventFast(reply, jsonReply);
+	}
+
+	return false;
+}
+
 std::string ReplyTranslater::ToJsonReply()
 {
 	std::string formatedReply;
 
+	if(ToJsonReplyFast(formatedReply)) {
+		return formatedReply;
+	}
+
+	//unknown shapes and malformed replies are handled and reported by generic translation.
+	return ToJsonReplyGeneric();
+}
+
+std::string ReplyTranslater::ToJsonReplyGeneric()
+{
+	std::string formatedReply;
+
 	try
 	{
 		Poco::JSON::Parser parser;
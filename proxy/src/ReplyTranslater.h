@@ -13,6 +13,7 @@
 #include "Poco/Dynamic/Var.h"
 #include "Poco/JSON/Object.h"
 #include "Poco/JSON/JSONException.h"
+#include "FirmwareReply.h"
 
 //translate device reply to JSON reply
 class ReplyTranslater
@@ -20,6 +21,10 @@ class ReplyTranslater
 public:
 	ReplyTranslater(const std::string& reply) { _reply = reply; }
 	std::string ToJsonReply();
+	// schema specific translation without JSON DOM, false if reply has a shape it doesn't handle.
+	bool ToJsonReplyFast(std::string& jsonReply);
+	// translation through Poco JSON parser, it handles all replies.
+	std::string ToJsonReplyGeneric();
 
 private:
 	std::string _reply;
@@ -29,6 +34,7 @@ private:
 	const std::string strCommandDeviceConnect = "device connect";
 	const std::string strCommandDeviceQueryPower = "device query power";
 	const std::string strCommandDeviceQueryFuse = "device query fuse";
+	const std::string strCommandDeviceQueryStatus = "device query status";
 	const std::string strCommandDeviceDelay = "device delay";
 	const std::string strCommandOptPowerOn = "opt power on";
 	const std::string strCommandOptPowerOff = "opt power off";
@@ -63,6 +69,9 @@ private:
 	const std::string strCommandStepperForwardClockwise = "stepper forward clockwise";
 	const std::string strCommandLocatorQuery = "locator query";
 	const std::string strCommandSolenoidActivate = "solenoid activate";
+	const std::string strCommandSteppersMove = "steppers move";
+	const std::string strCommandMacroUpload = "macro upload";
+	const std::string strCommandMacroRun = "macro run";
 	//events
 	const std::string strEventMainPowerOn = "main power is on";
 	const std::string strEventMainPowerOff = "main fuse is off";
@@ -101,6 +110,7 @@ private:
 	std::string formatCmdReply(Poco::JSON::Object::Ptr& replyPtr);
 	std::string deviceQueryPower(Poco::JSON::Object::Ptr& replyPtr);
 	std::string deviceQueryFuse(Poco::JSON::Object::Ptr& replyPtr);
+	std::string deviceQueryStatus(Poco::JSON::Object::Ptr& replyPtr);
 	std::string deviceDelay(Poco::JSON::Object::Ptr& replyPtr);
 	std::string optPowerOn(Poco::JSON::Object::Ptr& replyPtr);
 	std::string optPowerOff(Poco::JSON::Object::Ptr& replyPtr);
@@ -135,8 +145,45 @@ private:
 	std::string stepperForwardClockwise(Poco::JSON::Object::Ptr& replyPtr);
 	std::string locatorQuery(Poco::JSON::Object::Ptr& replyPtr);
 	std::string solenoidActivate(Poco::JSON::Object::Ptr& replyPtr);
+	std::string steppersMove(Poco::JSON::Object::Ptr& replyPtr);
+	std::string macroUpload(Poco::JSON::Object::Ptr& replyPtr);
+	std::string macroRun(Poco::JSON::Object::Ptr& replyPtr);
 	//events
 	std::string formatEvent(Poco::JSON::Object::Ptr& replyPtr);
+
+	//schema specific translation
+	enum class IndexPosition
+	{
+		None,
+		BeforeCommandId,
+		AfterCommandId
+	};
+	enum class ResultKind
+	{
+		None,
+		Text,
+		Number
+	};
+	bool formatCmdReplyFast(const FirmwareReply& reply, std::string& jsonReply);
+	bool formatEventFast(const FirmwareReply& reply, std::string& jsonReply);
+	bool getParamsFast(const FirmwareReply& reply, unsigned int amount, unsigned int& first);
+	bool getHexParamsFast(const FirmwareReply& reply, unsigned int amount, unsigned long * pValues);
+	bool getErrorFast(const FirmwareReply& reply, FirmwareReply::Text& error, bool& hasError);
+	bool commandFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, unsigned int paramAmount,
+			IndexPosition indexPosition, const char * pResultKey = nullptr, ResultKind resultKind = ResultKind::None);
+	bool stepperFlagFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, const char * pFlagKey);
+	bool stepperQueryFast(const FirmwareReply& reply, std::string& jsonReply);
+	bool solenoidActivateFast(const FirmwareReply& reply, std::string& jsonReply);
+	bool steppersMoveFast(const FirmwareReply& reply, std::string& jsonReply);
+	bool macroFast(const FirmwareReply& reply, std::string& jsonReply, const std::string& command, unsigned int paramAmount, bool withPositions);
+	static void appendText(std::string& jsonReply, const FirmwareReply::Text& text);
+	static void appendNumber(std::string& jsonReply, long value);
+	static void appendNumber(std::string& jsonReply, unsigned long value);
+	static void appendKey(std::string& jsonReply, const char * pKey);
+	static void appendNumberMember(std::string& jsonReply, const char * pKey, long value);
+	static void appendTextMember(std::string& jsonReply, const char * pKey, const FirmwareReply::Text& text);
+	static void appendBoolMember(std::string& jsonReply, const char * pKey, bool value);
+	static void beginCommandReply(std::string& jsonReply, const std::string& command);
 };
 
 
@@ -8,11 +8,12 @@
 extern ProxyLogger * pLogger;
 
 WinComDevice::WinComDevice(const std::string & name, ILowlevelDeviceObsesrver * pObserver)
-	:ILowlevelDevice(name, pObserver)
+	:ILowlevelDevice(name, pObserver), Task(name)
 {
 	_handle = INVALID_HANDLE_VALUE;
 	_bExit = false;
 	_state = LowlevelDeviceState::DeviceNotConnected;
+	_outputOffset = 0;
 }
 
 void WinComDevice::runTask()
@@ -89,7 +90,7 @@ void WinComDevice::runTask()
 	pLogger->LogInfo("WinComDevice::runTask for " + _name + " existed");
 }
 
-bool WinComDevice::SendData(const std::vector<unsigned char> & command, std::string & info)
+bool WinComDevice::SendData(const unsigned char * pData, unsigned int length, std::string & info)
 {
 	info.clear();
 	if (_state == LowlevelDeviceState::DeviceNotConnected) {
@@ -104,14 +105,13 @@ bool WinComDevice::SendData(const std::vector<unsigned char> & command, std::str
 		info = DEVICE_NOT_NORMAL;
 		return false;
 	}
-	if (!_outputQueue.empty()) {
+	if (_outputOffset < _outputBuffer.size()) {
 		info = DEVICE_NOT_ACCEPT_FURTHER_DATA;
 		return false;
 	}
 
-	for (unsigned int i = 0; i < command.size(); i++) {
-		_outputQueue.push_back(command[i]);
-	}
+	_outputBuffer.assign(pData, pData + length);
+	_outputOffset = 0;
 
 	return true;
 }
@@ -181,26 +181,21 @@ void WinComDevice::openDevice()
 
 bool WinComDevice::receiveData()
 {
-	unsigned char buffer[1024];
 	DWORD amount;
 
 	//read until timeout
 	for (;;)
 	{
 		amount = 0;
-		auto rc = ReadFile(_handle, buffer, 1024, &amount, NULL);
+		auto rc = ReadFile(_handle, _inputBuffer, sizeof(_inputBuffer), &amount, NULL);
 		if (rc)
 		{
 			if (amount > 0)
 			{
-				std::string content;
-
-				pLogger->LogInfo("WinComDevice::receiveData received " + std::to_string(amount) + " bytes from " + _name);
-				for (unsigned int i = 0; i < amount; i++) {
-					content.push_back(buffer[i]);
-					_inputQueue.push_back(buffer[i]);
+				if (pLogger->IsTraceEnabled()) {
+					pLogger->LogTrace("WinComDevice::receiveData << " + _name + " " + std::to_string(amount) + " bytes: " + std::string((char *)_inputBuffer, amount));
 				}
-				pLogger->LogInfo("WinComDevice::receiveData << " + content);
+				_pObserver->onLowlevelDeviceReply(_name, _inputBuffer, amount);
 			}
 			else
 			{
@@ -215,11 +210,6 @@ bool WinComDevice::receiveData()
 		}
 	}
 
-	if (!_inputQueue.empty()) {
-		//notify observer of the remaining data.
-		_pObserver->onLowlevelDeviceReply(_name, _inputQueue);
-	}
-
 	return true;
 }
 
@@ -227,40 +217,34 @@ bool WinComDevice::sendData()
 {
 	DWORD amount;
 
-	if (_outputQueue.empty()) {
+	if (_outputOffset >= _outputBuffer.size()) {
+		_outputBuffer.clear();
+		_outputOffset = 0;
 		_pObserver->onLowlevelDeviceWritable(_name, this); //ask for data from observer
 	}
 
-	if (_outputQueue.empty()) {
+	if (_outputBuffer.empty()) {
 		return true;
 	}
 
-	std::vector<unsigned char> data;
-	for (unsigned int i = 0; i < _outputQueue.size(); i++) {
-		data.push_back(_outputQueue[i]);
-	}
-
 	//write data to device
-	auto rc = WriteFile(_handle, data.data(), data.size(), &amount, NULL);
+	auto pData = _outputBuffer.data() + _outputOffset;
+	auto rc = WriteFile(_handle, pData, _outputBuffer.size() - _outputOffset, &amount, NULL);
 	if (rc)
 	{
-		std::string content;
-		pLogger->LogInfo("WinComDevice::sendData wrote " + std::to_string(amount) + " bytes to " + _name);
-		for (unsigned int i = 0; i < amount; i++) 
-		{
-			unsigned char c = _outputQueue[0];
-			content.push_back(c);
-			_outputQueue.pop_front();
+		if (pLogger->IsTraceEnabled()) {
+			pLogger->LogTrace("WinComDevice::sendData >> " + _name + " " + std::to_string(amount) + " bytes: " + std::string((char *)pData, amount));
 		}
-		pLogger->LogInfo("WinComDevice::sendData >> " + content);
+		_outputOffset += amount;
 	}
 	else
 	{
 		auto errorCode = GetLastError();
 		pLogger->LogError("WinComDevice::sendData error code: " + std::to_string(errorCode) + " to " + _name);
-		if (_outputQueue.size() > MAXIMUM_QUEUE_SIZE) {
-			pLogger->LogError("WinComDevice::sendData discard " + std::to_string(_outputQueue.size()) + " bytes");
-			_outputQueue.clear();
+		if ((_outputBuffer.size() - _outputOffset) > MAXIMUM_QUEUE_SIZE) {
+			pLogger->LogError("WinComDevice::sendData discard " + std::to_string(_outputBuffer.size() - _outputOffset) + " bytes");
+			_outputBuffer.clear();
+			_outputOffset = 0;
 		}
 	}
 
@@ -2,10 +2,11 @@
 #if defined(_WIN32) || defined(_WIN64)
 
 #include "ILowlevelDevice.h"
+#include "Poco/Task.h"
 #include "Poco/Mutex.h"
 #include "Poco/Timestamp.h"
 
-class WinComDevice : public ILowlevelDevice
+class WinComDevice : public ILowlevelDevice, public Poco::Task
 {
 public:
 	WinComDevice(const std::string & name, ILowlevelDeviceObsesrver * pObserver);
@@ -13,7 +14,7 @@ public:
 
 private:
 	virtual void runTask() override;
-	virtual bool SendData(const std::vector<unsigned char> & command, std::string & info) override;
+	virtual bool SendData(const unsigned char * pData, unsigned int length, std::string & info) override;
 	virtual void Disconnect() override;
 
 private:
@@ -32,8 +33,9 @@ private:
 	HANDLE _handle;
 	bool _bExit;
 	LowlevelDeviceState _state;
-	std::deque<unsigned char> _inputQueue;
-	std::deque<unsigned char> _outputQueue;
+	unsigned char _inputBuffer[1024];
+	std::vector<unsigned char> _outputBuffer; //reused, bytes before _outputOffset have been written
+	size_t _outputOffset;
 	Poco::Timestamp _timeLastWrite;
 
 	void openDevice();
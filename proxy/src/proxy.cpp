@@ -16,6 +16,10 @@
 #include "CListener.h"
 #include "ProxyLogger.h"
 #include "CDeviceMonitor.h"
+#if defined(_WIN32) || defined(_WIN64)
+#else
+#include "LinuxComEngine.h"
+#endif
 
 
 using Poco::Util::Application;
@@ -29,6 +33,10 @@ using Poco::TaskManager;
 using Poco::DateTimeFormatter;
 
 ProxyLogger * pLogger;
+#if defined(_WIN32) || defined(_WIN64)
+#else
+LinuxComEngine * pComEngine; //serves all serial device files
+#endif
 
 class Proxy: public ServerApplication
 {
@@ -88,6 +96,7 @@ protected:
 		{
 			Poco::ThreadPool threadPool(2, 64);
 			TaskManager tmLogger;
+			TaskManager tmComEngine;
 			TaskManager tm(threadPool);
 			Poco::Net::SocketAddress serverAddress;
 			std::string logFolder;
@@ -96,6 +105,8 @@ protected:
 			std::string logFileAmount;
 			std::vector<std::string> monitorFileVec;
 			std::vector<std::string> controllingFileVec;
+			int dataExchangeWindow = 1;
+			bool logDeviceData = false;
 			std::vector<CDeviceMonitor *> monitorPointerVec;
 
 			//use the designated configuration if it exist
@@ -126,6 +137,7 @@ protected:
 				logFile = config().getString("log_file_name", "proxyLog");
 				logFileSize = config().getString("log_file_size", "1M");
 				logFileAmount = config().getString("log_file_amount", "10");
+				logDeviceData = config().getBool("log_device_data", false);
 				//controlling device file
 				for(int i=0; ; i++)
 				{
@@ -142,6 +154,8 @@ protected:
 						controllingFileVec.push_back(controllingFile);
 					}
 				}
+				//packets in flight to a controlling device
+				dataExchangeWindow = config().getInt("data_exchange_window_size", 1);
 				//monitorFile
 				for(int i=0; ; i++)
 				{
@@ -178,8 +192,14 @@ protected:
 
 			pLogger = new ProxyLogger(logFolder, logFile, logFileSize, logFileAmount);
 			pLogger->CopyToConsole(true);
+			pLogger->SetTraceEnabled(logDeviceData);
 			tmLogger.start(pLogger);
 			pLogger->LogInfo("**** proxy verion 1.0.0 ****");
+#if defined(_WIN32) || defined(_WIN64)
+#else
+			pComEngine = new LinuxComEngine;
+			tmComEngine.start(pComEngine);
+#endif
 
 			CDeviceManager * pDeviceManager = new CDeviceManager;
 			CSocketManager * pSocketManager = new CSocketManager;
@@ -190,6 +210,7 @@ protected:
 			{
 				pDeviceManager->AddDeviceFile(controllingFileVec[i]);
 			}
+			pDeviceManager->SetDataExchangeWindow(dataExchangeWindow);
 			pDeviceManager->SetObserver(pSocketManager);
 			pSocketManager->SetDevice(pDeviceManager);
 
@@ -218,6 +239,9 @@ protected:
 			//stop tasks
 			tm.cancelAll();
 			tm.joinAll();
+			//stop serial device engine after all devices are removed
+			tmComEngine.cancelAll();
+			tmComEngine.joinAll();
 			//stop logger
 			tmLogger.cancelAll();
 			tmLogger.joinAll();
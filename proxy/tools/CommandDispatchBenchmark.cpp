@@ -0,0 +1,269 @@
+/*
+ * CommandDispatchBenchmark.cpp
+ *
+ * Compare command name lookup of CommandTranslator and of SmartCardSwitch UserCommandTable
+ * with the string comparison chains they replaced.
+ * All JSON command names and user command names are looked up in both ways, results must be the same.
+ * Cost of CommandTranslator::Type() is printed as well, it includes JSON parsing.
+ *
+ * Build: g++ -O2 -std=c++11 -I../src -I../../SmartCardSwitch/src -o CommandDispatchBenchmark CommandDispatchBenchmark.cpp
+ *        ../src/CommandTranslater.cpp ../src/ProxyLogger.cpp
+ *        -lPocoJSON -lPocoFoundation -lpthread
+ * Usage: CommandDispatchBenchmark [<rounds>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "CommandTranslater.h"
+#include "ProxyLogger.h"
+#include "UserCommandTable.h"
+
+ProxyLogger * pLogger;
+
+struct ChainEntry
+{
+	std::string name;
+	CommandType type;
+};
+
+//same order as the former comparison chain in CommandTranslator::Type()
+static const std::vector<ChainEntry> chain = {
+	{"devices get", CommandType::DevicesGet},
+	{"device connect", CommandType::DeviceConnect},
+	{"device delay", CommandType::DeviceDelay},
+	{"device query power", CommandType::DeviceQueryPower},
+	{"device query fuse", CommandType::DeviceQueryFuse},
+	{"device query status", CommandType::DeviceQueryStatus},
+	{"bdcs power on", CommandType::BdcsPowerOn},
+	{"bdcs power off", CommandType::BdcsPowerOff},
+	{"bdcs query power", CommandType::BdcsQueryPower},
+	{"bdc coast", CommandType::BdcCoast},
+	{"bdc reverse", CommandType::BdcReverse},
+	{"bdc forward", CommandType::BdcForward},
+	{"bdc break", CommandType::BdcBreak},
+	{"bdc query", CommandType::BdcQuery},
+	{"steppers power on", CommandType::SteppersPowerOn},
+	{"steppers power off", CommandType::SteppersPowerOff},
+	{"steppers query power", CommandType::SteppersQueryPower},
+	{"stepper query resolution", CommandType::StepperQueryResolution},
+	{"stepper config step", CommandType::StepperConfigStep},
+	{"stepper acceleration buffer", CommandType::StepperAccelerationBuffer},
+	{"stepper acceleration buffer decrement", CommandType::StepperAccelerationBufferDecrement},
+	{"stepper deceleration buffer", CommandType::StepperDecelerationBuffer},
+	{"stepper deceleration buffer increment", CommandType::StepperDecelerationBufferIncrement},
+	{"stepper enable", CommandType::StepperEnable},
+	{"stepper forward", CommandType::StepperForward},
+	{"stepper steps", CommandType::StepperSteps},
+	{"stepper run", CommandType::StepperRun},
+	{"stepper config home", CommandType::StepperConfigHome},
+	{"stepper query", CommandType::StepperQuery},
+	{"stepper set state", CommandType::StepperSetState},
+	{"stepper forward clockwise", CommandType::StepperForwardClockwise},
+	{"locator query", CommandType::LocatorQuery},
+	{"opt power on", CommandType::OptPowerOn},
+	{"opt power off", CommandType::OptPowerOff},
+	{"opt query power", CommandType::OptQueryPower},
+	{"dcm power on", CommandType::DcmPowerOn},
+	{"dcm power off", CommandType::DcmPowerOff},
+	{"dcm query power", CommandType::DcmQueryPower},
+	{"solenoid activate", CommandType::SolenoidActivate},
+	{"steppers move", CommandType::SteppersMove},
+	{"macro upload", CommandType::MacroUpload},
+	{"macro run", CommandType::MacroRun}
+};
+
+static CommandType chainType(const std::string& command)
+{
+	for(auto it = chain.begin(); it != chain.end(); it++)
+	{
+		if(command == it->name) {
+			return it->type;
+		}
+	}
+
+	return CommandType::Invalid;
+}
+
+struct UserChainEntry
+{
+	std::string name;
+	UserCommandType type;
+};
+
+//same order as the former comparison chain in UserCommandRunner::RunCommand()
+static const std::vector<UserChainEntry> userChain = {
+	{"connect device", UserCommandType::ConnectDevice},
+	{"check reset pressed", UserCommandType::CheckResetPressed},
+	{"check reset released", UserCommandType::CheckResetReleased},
+	{"reset device", UserCommandType::ResetDevice},
+	{"move card from bay to smartCardGate", UserCommandType::CardFromBayToSmartCardGate},
+	{"adjust stepper w", UserCommandType::AdjustStepperW},
+	{"move card from smartCardGate to bay", UserCommandType::CardFromSmartCardGateToBay},
+	{"finish stepper w adjustment", UserCommandType::FinishStepperWAdjustment},
+	{"insert smart card", UserCommandType::InsertSmartCard},
+	{"remove smart card", UserCommandType::RemoveSmartCard},
+	{"swipe smart card", UserCommandType::SwipeSmartCard},
+	{"tap smart card", UserCommandType::TapSmartCard},
+	{"tap bar code", UserCommandType::TapBarCode},
+	{"press PED key", UserCommandType::PressPedKey},
+	{"press soft key", UserCommandType::PressSoftKey},
+	{"press assist key", UserCommandType::PressAssistKey},
+	{"touch screen", UserCommandType::TouchScreen},
+	{"back to home", UserCommandType::BackToHome},
+	{"power on opt", UserCommandType::PowerOnOpt},
+	{"power off opt", UserCommandType::PowerOffOpt},
+	{"power on dcm", UserCommandType::PowerOnDcm},
+	{"power off dcm", UserCommandType::PowerOffDcm},
+	{"move card from smartCardGate to smartCardReaderGate", UserCommandType::CardFromSmartCardGateToSmartCardReaderGate},
+	{"move card from smartCardReaderGate to smartCardReader", UserCommandType::CardFromSmartCardReaderGateToSmartCardReader},
+	{"move card from smartCardReader to smartCardReaderGate", UserCommandType::CardFromSmartCardReaderToSmartCardReaderGate},
+	{"move card from smartCardReaderGate to smartCardGate", UserCommandType::CardFromSmartCardReaderGateToSmartCardGate},
+	{"move card from smartCardGate to barcodeReaderGate", UserCommandType::CardFromSmartCardGateToBarcodeReaderGate},
+	{"move card from barcodeReaderGate to barcodeReader", UserCommandType::CardFromBarcodeReaderGateToBarcodeReader},
+	{"move card barcode to extra position", UserCommandType::CardBarcodeToExtraPosition},
+	{"move card from barcodeReader to barcodeReaderGate", UserCommandType::CardFromBarcodeReaderToBarcodeReaderGate},
+	{"move card from barcodeReaderGate to smartCardGate", UserCommandType::CardFromBarcodeReaderGateToSmartCardGate},
+	{"return smart card", UserCommandType::ReturnSmartCard}
+};
+
+static UserCommandType userChainType(const std::string& command)
+{
+	for(auto it = userChain.begin(); it != userChain.end(); it++)
+	{
+		if(command == it->name) {
+			return it->type;
+		}
+	}
+
+	return UserCommandType::Invalid;
+}
+
+static UserCommandType userTableType(const std::string& command)
+{
+	auto pUserCommandName = UserCommandTable::Find(command);
+
+	return (pUserCommandName == nullptr) ? UserCommandType::Invalid : pUserCommandName->type;
+}
+
+//names are looked up in random order, so branch predictor cannot learn the order.
+static std::vector<std::string> shuffledSequence(const std::vector<std::string>& names)
+{
+	std::vector<std::string> sequence;
+
+	srand(1);
+	for(unsigned int i=0; i<4096; i++) {
+		sequence.push_back(names[rand() % names.size()]);
+	}
+
+	return sequence;
+}
+
+//nanoseconds of all lookups
+template<typename Lookup>
+static long long timeLookups(const std::vector<std::string>& sequence, unsigned int rounds, Lookup lookup, long& checksum)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned int round=0; round<rounds; round++)
+	{
+		for(auto it = sequence.begin(); it != sequence.end(); it++) {
+			checksum += (long)lookup(*it);
+		}
+	}
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned int rounds = 1000;
+	int rc = 0;
+
+	if(argc > 1) {
+		rounds = atoi(argv[1]);
+	}
+
+	std::vector<std::string> names;
+	for(auto it = chain.begin(); it != chain.end(); it++) {
+		names.push_back(it->name);
+	}
+	//unknown names go through the whole chain
+	names.push_back("stepper");
+	names.push_back("steppers move all");
+	names.push_back("");
+
+	for(auto it = names.begin(); it != names.end(); it++)
+	{
+		if(CommandTranslator::ToType(*it) != chainType(*it)) {
+			printf("MISMATCH \"%s\": table %d, chain %d\n", it->c_str(), (int)CommandTranslator::ToType(*it), (int)chainType(*it));
+			rc = 1;
+		}
+	}
+	if(chain.size() != (size_t)CommandType::CommandTypeLast + 1) {
+		printf("chain has %lu commands, CommandType has %d\n", (unsigned long)chain.size(), (int)CommandType::CommandTypeLast + 1);
+		rc = 1;
+	}
+
+	std::vector<std::string> sequence = shuffledSequence(names);
+	long checksum = 0;
+	auto chainTime = timeLookups(sequence, rounds, chainType, checksum);
+	auto tableTime = timeLookups(sequence, rounds, CommandTranslator::ToType, checksum);
+
+	std::vector<std::string> userNames;
+	for(auto it = userChain.begin(); it != userChain.end(); it++) {
+		userNames.push_back(it->name);
+	}
+	userNames.push_back("tap");
+	userNames.push_back("tap smart card now");
+	userNames.push_back("");
+
+	for(auto it = userNames.begin(); it != userNames.end(); it++)
+	{
+		if(userTableType(*it) != userChainType(*it)) {
+			printf("MISMATCH \"%s\": user table %d, user chain %d\n", it->c_str(), (int)userTableType(*it), (int)userChainType(*it));
+			rc = 1;
+		}
+	}
+	if(userChain.size() != (size_t)UserCommandType::Last + 1) {
+		printf("user chain has %lu commands, UserCommandType has %d\n", (unsigned long)userChain.size(), (int)UserCommandType::Last + 1);
+		rc = 1;
+	}
+
+	std::vector<std::string> userSequence = shuffledSequence(userNames);
+	auto userChainTime = timeLookups(userSequence, rounds, userChainType, checksum);
+	auto userTableTime = timeLookups(userSequence, rounds, userTableType, checksum);
+
+	//whole Type() with JSON parsing, one command of each type in a round
+	std::vector<std::string> jsonCommands;
+	for(auto it = chain.begin(); it != chain.end(); it++) {
+		jsonCommands.push_back("{\"command\":\"" + it->name + "\",\"commandId\":1}");
+	}
+
+	//logs of unknown commands are dropped, logger task isn't started.
+	pLogger = new ProxyLogger("/tmp/CommandDispatchBenchmark", "log", "1M", "1");
+
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned int round=0; round<rounds; round++)
+	{
+		for(auto it = jsonCommands.begin(); it != jsonCommands.end(); it++)
+		{
+			CommandTranslator translator(*it);
+			checksum += translator.Type();
+		}
+	}
+	auto jsonTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	auto amount = (double)rounds * sequence.size();
+	printf("%lu names, %lu commands\n", (unsigned long)names.size(), (unsigned long)chain.size());
+	printf("chain:    %.1f ns/lookup\n", chainTime / amount);
+	printf("table:    %.1f ns/lookup\n", tableTime / amount);
+	printf("%lu user command names, %lu user commands\n", (unsigned long)userNames.size(), (unsigned long)userChain.size());
+	printf("user chain: %.1f ns/lookup\n", userChainTime / amount);
+	printf("user table: %.1f ns/lookup\n", userTableTime / amount);
+	printf("Type():   %.1f ns/command\n", jsonTime / ((double)rounds * jsonCommands.size()));
+	printf("checksum: %ld\n", checksum);
+
+	return rc;
+}
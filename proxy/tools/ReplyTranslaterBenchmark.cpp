@@ -0,0 +1,106 @@
+/*
+ * ReplyTranslaterBenchmark.cpp
+ *
+ * Compare schema specific and generic translation of firmware replies.
+ * Each reply in corpus is translated in both ways, outputs must be the same
+ * unless schema specific translation hands the reply over to generic one.
+ *
+ * Build: g++ -O2 -std=c++11 -I../src -o ReplyTranslaterBenchmark ReplyTranslaterBenchmark.cpp
+ *        ../src/ReplyTranslater.cpp ../src/FirmwareReply.cpp ../src/ProxyLogger.cpp
+ *        -lPocoJSON -lPocoFoundation -lpthread
+ * Usage: ReplyTranslaterBenchmark <corpus file> [<rounds>]
+ *   corpus file has a reply in each line, replyCorpus.txt is an example.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ReplyTranslater.h"
+#include "ProxyLogger.h"
+
+ProxyLogger * pLogger;
+
+int main(int argc, char * argv[])
+{
+	std::vector<std::string> replies;
+	std::string line;
+	unsigned int rounds = 10000;
+	unsigned int fastAmount = 0;
+	int rc = 0;
+
+	if(argc < 2) {
+		fprintf(stderr, "Usage: %s <corpus file> [<rounds>]\n", argv[0]);
+		return 1;
+	}
+	if(argc > 2) {
+		rounds = atoi(argv[2]);
+	}
+
+	std::ifstream file(argv[1]);
+	if(!file) {
+		fprintf(stderr, "ReplyTranslaterBenchmark cannot open %s\n", argv[1]);
+		return 1;
+	}
+	while(std::getline(file, line))
+	{
+		if(!line.empty()) {
+			replies.push_back(line);
+		}
+	}
+
+	//logs of malformed replies are dropped, logger task isn't started.
+	pLogger = new ProxyLogger("/tmp/ReplyTranslaterBenchmark", "log", "1M", "1");
+
+	for(auto it = replies.begin(); it != replies.end(); it++)
+	{
+		ReplyTranslater translater(*it);
+		std::string fastReply;
+		std::string genericReply = translater.ToJsonReplyGeneric();
+
+		if(translater.ToJsonReplyFast(fastReply))
+		{
+			fastAmount++;
+			if(fastReply != genericReply) {
+				printf("MISMATCH %s\n  fast:    %s\n  generic: %s\n", it->c_str(), fastReply.c_str(), genericReply.c_str());
+				rc = 1;
+			}
+		}
+		else {
+			printf("GENERIC  %s\n", it->c_str());
+		}
+	}
+	printf("%u of %lu replies are translated by schema specific translation\n", fastAmount, (unsigned long)replies.size());
+
+	size_t checksum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned int round=0; round<rounds; round++)
+	{
+		for(auto it = replies.begin(); it != replies.end(); it++)
+		{
+			ReplyTranslater translater(*it);
+			checksum += translater.ToJsonReplyGeneric().size();
+		}
+	}
+	auto genericTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for(unsigned int round=0; round<rounds; round++)
+	{
+		for(auto it = replies.begin(); it != replies.end(); it++)
+		{
+			ReplyTranslater translater(*it);
+			checksum += translater.ToJsonReply().size();
+		}
+	}
+	auto currentTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	auto amount = (double)rounds * replies.size();
+	printf("generic:  %.1f ns/reply\n", genericTime / amount);
+	printf("current:  %.1f ns/reply\n", currentTime / amount);
+	printf("checksum: %lu\n", (unsigned long)checksum);
+
+	return rc;
+}